@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/aabb.hpp>
+#include <vmmlib/aabb4f.hpp>
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/types.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+template< typename T >
+std::vector< vmml::vector< 3, T > > _makePoints( const size_t size )
+{
+    std::vector< vmml::vector< 3, T > > points( size );
+    srand( 42 );
+    for( size_t i = 0; i < size; ++i )
+        for( size_t j = 0; j < 3; ++j )
+            points[i][j] = T( rand( )) / T( RAND_MAX ) - T( .5 );
+    return points;
+}
+
+template< typename T >
+std::vector< vmml::AABB< T > > _makeBoxes( const size_t size )
+{
+    const std::vector< vmml::vector< 3, T > > points =
+        _makePoints< T >( size );
+    std::vector< vmml::AABB< T > > boxes( size );
+    for( size_t i = 0; i < size; ++i )
+        boxes[i] = vmml::AABB< T >( points[i], points[i] +
+                                    vmml::vector< 3, T >( T( .1 )));
+    return boxes;
+}
+
+// one merge per point as reference
+template< typename T, size_t size > void mergePoints( State& state )
+{
+    const std::vector< vmml::vector< 3, T > > points =
+        _makePoints< T >( size );
+    while( state.keepRunning( ))
+    {
+        vmml::AABB< T > aabb;
+        for( size_t i = 0; i < size; ++i )
+            aabb.merge( points[i] );
+        doNotOptimize( aabb );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void fromPoints( State& state )
+{
+    const std::vector< vmml::vector< 3, T > > points =
+        _makePoints< T >( size );
+    while( state.keepRunning( ))
+    {
+        vmml::AABB< T > aabb =
+            vmml::AABB< T >::fromPoints( &points[0], &points[0] + size );
+        doNotOptimize( aabb );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void mergeBoxes( State& state )
+{
+    const std::vector< vmml::AABB< T > > boxes = _makeBoxes< T >( size );
+    while( state.keepRunning( ))
+    {
+        vmml::AABB< T > aabb;
+        for( size_t i = 0; i < size; ++i )
+            aabb.merge( boxes[i] );
+        doNotOptimize( aabb );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void fromBoxes( State& state )
+{
+    const std::vector< vmml::AABB< T > > boxes = _makeBoxes< T >( size );
+    while( state.keepRunning( ))
+    {
+        vmml::AABB< T > aabb =
+            vmml::AABB< T >::fromBoxes( &boxes[0], &boxes[0] + size );
+        doNotOptimize( aabb );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+// The sweep of a SAH build: the surface area of all prefixes of a box array
+template< typename T, size_t size > void sweep( State& state )
+{
+    const std::vector< vmml::AABB< T > > boxes = _makeBoxes< T >( size );
+    std::vector< T > areas( size );
+    while( state.keepRunning( ))
+    {
+        vmml::AABB< T > aabb;
+        for( size_t i = 0; i < size; ++i )
+        {
+            aabb.merge( boxes[i] );
+            const vmml::vector< 3, T > extent = aabb.getSize();
+            areas[i] = T( 2 ) * ( extent.x() * extent.y() +
+                                  extent.y() * extent.z() +
+                                  extent.z() * extent.x( ));
+        }
+        doNotOptimize( areas[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void sweep4f( State& state )
+{
+    const std::vector< vmml::AABB< float > > input =
+        _makeBoxes< float >( size );
+    const std::vector< vmml::AABB4f > boxes( input.begin(), input.end( ));
+    std::vector< float > areas( size );
+    while( state.keepRunning( ))
+    {
+        vmml::AABB4f aabb;
+        for( size_t i = 0; i < size; ++i )
+        {
+            aabb.merge( boxes[i] );
+            areas[i] = aabb.getSurfaceArea();
+        }
+        doNotOptimize( areas[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+// A broad phase: count the boxes overlapping each of 16 query boxes
+template< typename T, size_t size > void overlap( State& state )
+{
+    const std::vector< vmml::AABB< T > > boxes = _makeBoxes< T >( size );
+    while( state.keepRunning( ))
+    {
+        size_t count = 0;
+        for( size_t j = 0; j < 16; ++j )
+        {
+            const vmml::AABB< T >& query = boxes[j];
+            for( size_t i = 0; i < size; ++i )
+            {
+                const vmml::AABB< T >& box = boxes[i];
+                bool overlaps = true;
+                for( size_t k = 0; k < 3; ++k )
+                    overlaps = overlaps &&
+                               query.getMin()[k] <= box.getMax()[k] &&
+                               box.getMin()[k] <= query.getMax()[k];
+                count += overlaps;
+            }
+        }
+        doNotOptimize( count );
+    }
+    state.setItemsProcessed( state.getIterations() * size * 16 );
+}
+
+template< typename T, size_t size > void overlap4f( State& state )
+{
+    const std::vector< vmml::AABB< float > > input =
+        _makeBoxes< float >( size );
+    const std::vector< vmml::AABB4f > boxes( input.begin(), input.end( ));
+    while( state.keepRunning( ))
+    {
+        size_t count = 0;
+        for( size_t j = 0; j < 16; ++j )
+            for( size_t i = 0; i < size; ++i )
+                count += boxes[j].intersects( boxes[i] );
+        doNotOptimize( count );
+    }
+    state.setItemsProcessed( state.getIterations() * size * 16 );
+}
+
+template< typename T >
+std::vector< vmml::Matrix< 4, 4, T > > _makeMatrices( const size_t size )
+{
+    std::vector< vmml::Matrix< 4, 4, T > > matrices( size );
+    srand( 23 );
+    for( size_t i = 0; i < size; ++i )
+        for( size_t j = 0; j < 3; ++j )
+            for( size_t k = 0; k < 4; ++k )
+                matrices[i]( j, k ) = T( rand( )) / T( RAND_MAX ) - T( .5 );
+    return matrices;
+}
+
+// The transformation of the eight corners as reference
+template< typename T, size_t size > void transformCorners( State& state )
+{
+    const std::vector< vmml::AABB< T > > boxes = _makeBoxes< T >( size );
+    const std::vector< vmml::Matrix< 4, 4, T > > matrices =
+        _makeMatrices< T >( size );
+    std::vector< vmml::AABB< T > > result( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+        {
+            const vmml::vector< 3, T >& min = boxes[i].getMin();
+            const vmml::vector< 3, T >& max = boxes[i].getMax();
+            vmml::AABB< T > aabb;
+            for( size_t j = 0; j < 8; ++j )
+            {
+                const vmml::vector< 4, T > corner =
+                    matrices[i] * vmml::vector< 4, T >(
+                        j & 1 ? max.x() : min.x(), j & 2 ? max.y() : min.y(),
+                        j & 4 ? max.z() : min.z(), 1 );
+                aabb.merge( vmml::vector< 3, T >( corner.x(), corner.y(),
+                                                  corner.z( )));
+            }
+            result[i] = aabb;
+        }
+        doNotOptimize( result[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void transform( State& state )
+{
+    const std::vector< vmml::AABB< T > > boxes = _makeBoxes< T >( size );
+    const std::vector< vmml::Matrix< 4, 4, T > > matrices =
+        _makeMatrices< T >( size );
+    std::vector< vmml::AABB< T > > result( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            result[i] = boxes[i].transform( matrices[i] );
+        doNotOptimize( result[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void transformBatch( State& state )
+{
+    const std::vector< vmml::AABB< T > > boxes = _makeBoxes< T >( size );
+    const std::vector< vmml::Matrix< 4, 4, T > > matrices =
+        _makeMatrices< T >( size );
+    std::vector< vmml::AABB< T > > result( size );
+    while( state.keepRunning( ))
+    {
+        vmml::transform( &matrices[0], &boxes[0], &result[0], size );
+        doNotOptimize( result[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+#ifdef _OPENMP
+// The thread scaling of the reductions over the DRAM working set
+template< typename T, int threads > void fromPointsThreads( State& state )
+{
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads( threads );
+    fromPoints< T, vmml::benchmark::DRAM >( state );
+    omp_set_num_threads( maxThreads );
+}
+
+template< typename T, int threads > void fromBoxesThreads( State& state )
+{
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads( threads );
+    fromBoxes< T, vmml::benchmark::DRAM >( state );
+    omp_set_num_threads( maxThreads );
+}
+#endif
+}
+
+VMMLIB_BENCHMARK_SIZES( mergePoints );
+VMMLIB_BENCHMARK_SIZES( fromPoints );
+VMMLIB_BENCHMARK_SIZES( mergeBoxes );
+VMMLIB_BENCHMARK_SIZES( fromBoxes );
+VMMLIB_BENCHMARK_SIZE( sweep, float, L1 );
+VMMLIB_BENCHMARK_SIZE( sweep, float, L2 );
+VMMLIB_BENCHMARK_SIZE( sweep, float, DRAM );
+VMMLIB_BENCHMARK_SIZE( sweep4f, float, L1 );
+VMMLIB_BENCHMARK_SIZE( sweep4f, float, L2 );
+VMMLIB_BENCHMARK_SIZE( sweep4f, float, DRAM );
+VMMLIB_BENCHMARK_SIZE( overlap, float, L1 );
+VMMLIB_BENCHMARK_SIZE( overlap, float, L2 );
+VMMLIB_BENCHMARK_SIZE( overlap4f, float, L1 );
+VMMLIB_BENCHMARK_SIZE( overlap4f, float, L2 );
+VMMLIB_BENCHMARK_SIZES( transformCorners );
+VMMLIB_BENCHMARK_SIZES( transform );
+VMMLIB_BENCHMARK_SIZES( transformBatch );
+
+// Only with OpenMP, e.g. configured with CMAKE_CXX_FLAGS=-fopenmp
+#ifdef _OPENMP
+VMMLIB_BENCHMARK_TEMPLATE( fromPointsThreads, float, 1 );
+VMMLIB_BENCHMARK_TEMPLATE( fromPointsThreads, float, 2 );
+VMMLIB_BENCHMARK_TEMPLATE( fromPointsThreads, float, 4 );
+VMMLIB_BENCHMARK_TEMPLATE( fromPointsThreads, float, 8 );
+VMMLIB_BENCHMARK_TEMPLATE( fromBoxesThreads, float, 1 );
+VMMLIB_BENCHMARK_TEMPLATE( fromBoxesThreads, float, 2 );
+VMMLIB_BENCHMARK_TEMPLATE( fromBoxesThreads, float, 4 );
+VMMLIB_BENCHMARK_TEMPLATE( fromBoxesThreads, float, 8 );
+#endif
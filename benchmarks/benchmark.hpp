@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__BENCHMARK__HPP__
+#define __VMML__BENCHMARK__HPP__
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace vmml
+{
+namespace benchmark
+{
+/**
+ * Iteration state passed to each benchmark function.
+ *
+ * Only the loop driven by keepRunning() is timed, so that the setup of the
+ * input data before the loop is excluded from the measurement.
+ */
+class State
+{
+public:
+    explicit State( const size_t iterations )
+        : _iterations( iterations ), _remaining( iterations ), _items( 0 )
+        , _started( false ), _time( 0. ) {}
+
+    /** @return true while the timed loop shall run another iteration. */
+    bool keepRunning()
+    {
+        if( !_started )
+        {
+            _started = true;
+            _start = Clock::now();
+        }
+        if( _remaining > 0 )
+        {
+            --_remaining;
+            return true;
+        }
+        _time = std::chrono::duration< double >( Clock::now() -
+                                                 _start ).count();
+        return false;
+    }
+
+    /** @return the number of iterations of this run. */
+    size_t getIterations() const { return _iterations; }
+
+    /** @return the time of the timed loop in seconds. */
+    double getTime() const { return _time; }
+
+    /** Set the number of items processed over all iterations. */
+    void setItemsProcessed( const size_t items ) { _items = items; }
+
+    /** @return the number of items processed over all iterations. */
+    size_t getItemsProcessed() const { return _items; }
+
+private:
+    typedef std::chrono::high_resolution_clock Clock;
+
+    const size_t _iterations;
+    size_t _remaining;
+    size_t _items;
+    bool _started;
+    Clock::time_point _start;
+    double _time;
+};
+
+/**
+ * Working set sizes in elements, for benchmarks over arrays of 16 to 64 byte
+ * elements such as vectors, matrices or bounding volumes.
+ */
+const size_t L1 = 1024; //!< fits into the L1 data cache
+const size_t L2 = 16384; //!< fits into the L2 cache
+const size_t DRAM = 4194304; //!< exceeds the last level cache
+
+typedef void (*Function)( State& );
+
+struct Benchmark
+{
+    std::string name;
+    Function function;
+};
+
+/** @return all registered benchmarks in registration order. */
+inline std::vector< Benchmark >& getBenchmarks()
+{
+    static std::vector< Benchmark > benchmarks;
+    return benchmarks;
+}
+
+inline bool registerBenchmark( const char* name, const Function function )
+{
+    const Benchmark benchmark = { name, function };
+    getBenchmarks().push_back( benchmark );
+    return true;
+}
+
+/** Prevent the compiler from optimizing away the computation of value. */
+template< typename T > inline void doNotOptimize( T& value )
+{
+#if defined( __GNUC__ ) || defined( __clang__ )
+    asm volatile( "" : : "r"( &value ) : "memory" );
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast< volatile char* >( &value );
+#endif
+}
+}
+}
+
+/** Register a benchmark function of type void( vmml::benchmark::State& ). */
+#define VMMLIB_BENCHMARK( function )                                    \
+    static const bool function##Registered =                           \
+        ::vmml::benchmark::registerBenchmark( #function, function )
+
+#define VMMLIB_BENCHMARK_CONCAT_( a, b ) a##b
+#define VMMLIB_BENCHMARK_CONCAT( a, b ) VMMLIB_BENCHMARK_CONCAT_( a, b )
+
+/**
+ * Register an instance of a benchmark function template, named after its
+ * template arguments, e.g. 'transformPoints< float, L1 >'.
+ */
+#define VMMLIB_BENCHMARK_TEMPLATE( function, ... )                      \
+    static const bool VMMLIB_BENCHMARK_CONCAT( function##Registered,   \
+                                               __COUNTER__ ) =         \
+        ::vmml::benchmark::registerBenchmark( #function "< "            \
+                                              #__VA_ARGS__ " >",        \
+                                              function< __VA_ARGS__ > )
+
+/** Register an instance of a benchmark over the given working set size. */
+#define VMMLIB_BENCHMARK_SIZE( function, type, size )                   \
+    static const bool VMMLIB_BENCHMARK_CONCAT( function##Registered,   \
+                                               __COUNTER__ ) =         \
+        ::vmml::benchmark::registerBenchmark( #function "< " #type ", " \
+                                              #size " >",               \
+                                  function< type, ::vmml::benchmark::size > )
+
+/**
+ * Register a benchmark function template< typename T, size_t size > for
+ * float and double and each working set size.
+ */
+#define VMMLIB_BENCHMARK_SIZES( function )                              \
+    VMMLIB_BENCHMARK_SIZE( function, float, L1 );                       \
+    VMMLIB_BENCHMARK_SIZE( function, float, L2 );                       \
+    VMMLIB_BENCHMARK_SIZE( function, float, DRAM );                     \
+    VMMLIB_BENCHMARK_SIZE( function, double, L1 );                      \
+    VMMLIB_BENCHMARK_SIZE( function, double, L2 );                      \
+    VMMLIB_BENCHMARK_SIZE( function, double, DRAM )
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/bvh.hpp>
+#include <vmmlib/frustum.hpp>
+#include <vmmlib/types.hpp>
+
+#include <cmath>
+#include <cstdlib>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+const size_t nQueries = 1024;
+
+float _random( const float min, const float max )
+{
+    return min + ( max - min ) * float( rand( )) / float( RAND_MAX );
+}
+
+// Spheres of constant density in a box growing with the primitive count
+struct Scene
+{
+    explicit Scene( const size_t n )
+        : spheres( n ), boxes( n )
+    {
+        const float size = 100.f * std::cbrt( float( n ) / 1e6f );
+        srand( 42 );
+        for( size_t i = 0; i < n; ++i )
+        {
+            const vmml::Vector3f center( _random( -size, size ),
+                                         _random( -size, size ),
+                                         _random( -size, size ));
+            const float radius = _random( 0.05f, 0.5f );
+            spheres[i] = vmml::Vector4f( center, radius );
+            boxes[i] = vmml::AABBf( center - radius, center + radius );
+        }
+        bvh.buildSAH( boxes.data(), n );
+    }
+
+    std::vector< vmml::Vector4f > spheres;
+    std::vector< vmml::AABBf > boxes;
+    vmml::BVHf bvh;
+};
+
+template< size_t N > Scene& _getScene()
+{
+    static Scene scene( N );
+    return scene;
+}
+
+struct SphereIntersector
+{
+    explicit SphereIntersector( const std::vector< vmml::Vector4f >& s )
+        : spheres( s ) {}
+
+    float operator()( const vmml::Rayf& ray, const uint32_t primitive ) const
+        { return ray.test( spheres[ primitive ] ); }
+
+    const std::vector< vmml::Vector4f >& spheres;
+};
+
+template< size_t N > void bvhBuildSAH( State& state )
+{
+    Scene& scene = _getScene< N >();
+    while( state.keepRunning( ))
+    {
+        vmml::BVHf bvh;
+        bvh.buildSAH( scene.boxes.data(), N );
+        doNotOptimize( bvh );
+    }
+    state.setItemsProcessed( state.getIterations() * N );
+}
+
+template< size_t N > void bvhBuildLBVH( State& state )
+{
+    Scene& scene = _getScene< N >();
+    while( state.keepRunning( ))
+    {
+        vmml::BVHf bvh;
+        bvh.buildLBVH( scene.boxes.data(), N );
+        doNotOptimize( bvh );
+    }
+    state.setItemsProcessed( state.getIterations() * N );
+}
+
+template< size_t N > void bvhRefit( State& state )
+{
+    Scene& scene = _getScene< N >();
+    while( state.keepRunning( ))
+    {
+        scene.bvh.refit( scene.boxes.data( ));
+        doNotOptimize( scene.bvh );
+    }
+    state.setItemsProcessed( state.getIterations() * N );
+}
+
+template< size_t N > void bvhCull( State& state )
+{
+    Scene& scene = _getScene< N >();
+    const vmml::Frustumf frustum( -.1f, .1f, -.1f, .1f, 1.f, 100.f );
+    const vmml::FrustumCullerf culler( frustum.computePerspectiveMatrix( ));
+    std::vector< uint32_t > visible;
+    while( state.keepRunning( ))
+    {
+        visible.clear();
+        scene.bvh.cull( culler, visible );
+        doNotOptimize( visible );
+    }
+    state.setItemsProcessed( state.getIterations( ));
+}
+
+template< size_t N > void bvhRay( State& state )
+{
+    Scene& scene = _getScene< N >();
+    const SphereIntersector intersector( scene.spheres );
+    std::vector< vmml::Rayf > rays;
+    for( size_t i = 0; i < nQueries; ++i )
+        rays.push_back( vmml::Rayf( vmml::Vector3f::ZERO,
+                                    vmml::Vector3f( _random( -1, 1 ),
+                                                    _random( -1, 1 ),
+                                                    _random( -1, 1 ))));
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < nQueries; ++i )
+        {
+            float distance = 0;
+            uint32_t hit = scene.bvh.intersect( rays[i], intersector,
+                                                distance );
+            doNotOptimize( hit );
+        }
+    }
+    state.setItemsProcessed( state.getIterations() * nQueries );
+}
+
+const size_t M = 1000000;
+}
+
+// The 100M variants need about 8 GB of memory. Run selected sizes using the
+// benchmark filter, e.g. 'vmmlib_benchmarks bvhBuildSAH< 1M'
+#define VMMLIB_BVH_BENCHMARK( name, size, label )                      \
+    static const bool name##label##Registered =                        \
+        ::vmml::benchmark::registerBenchmark( #name "< " #label " >",   \
+                                              name< size > )
+VMMLIB_BVH_BENCHMARK( bvhBuildSAH, 1 * M, 1M );
+VMMLIB_BVH_BENCHMARK( bvhBuildSAH, 10 * M, 10M );
+VMMLIB_BVH_BENCHMARK( bvhBuildSAH, 100 * M, 100M );
+VMMLIB_BVH_BENCHMARK( bvhBuildLBVH, 1 * M, 1M );
+VMMLIB_BVH_BENCHMARK( bvhBuildLBVH, 10 * M, 10M );
+VMMLIB_BVH_BENCHMARK( bvhBuildLBVH, 100 * M, 100M );
+VMMLIB_BVH_BENCHMARK( bvhRefit, 1 * M, 1M );
+VMMLIB_BVH_BENCHMARK( bvhRefit, 10 * M, 10M );
+VMMLIB_BVH_BENCHMARK( bvhRefit, 100 * M, 100M );
+VMMLIB_BVH_BENCHMARK( bvhCull, 1 * M, 1M );
+VMMLIB_BVH_BENCHMARK( bvhCull, 10 * M, 10M );
+VMMLIB_BVH_BENCHMARK( bvhCull, 100 * M, 100M );
+VMMLIB_BVH_BENCHMARK( bvhRay, 1 * M, 1M );
+VMMLIB_BVH_BENCHMARK( bvhRay, 10 * M, 10M );
+VMMLIB_BVH_BENCHMARK( bvhRay, 100 * M, 100M );
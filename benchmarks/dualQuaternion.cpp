@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/dualQuaternion.hpp>
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/types.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+const size_t smallPalette = 64;
+// A palette larger than the caches, where the 8 instead of 12 values per bone
+// save memory bandwidth
+const size_t largePalette = 65536;
+
+// Rest pose vertices with four bone influences each
+template< typename T > struct Vertices
+{
+    Vertices( const size_t n, const size_t nBones )
+        : indices( n ), weights( n ), positions( n ), result( n )
+    {
+        srand( 42 );
+        for( size_t i = 0; i < n; ++i )
+        {
+            for( size_t j = 0; j < 4; ++j )
+                indices[i][j] = unsigned( rand( )) % nBones;
+            weights[i] = vmml::vector< 4, T >( T( .4 ), T( .3 ), T( .2 ),
+                                               T( .1 ));
+            positions[i] = vmml::vector< 3, T >( T( i % 7 ), T( i % 11 ),
+                                                 T( i % 13 ));
+        }
+    }
+
+    std::vector< vmml::Vector4ui > indices;
+    std::vector< vmml::vector< 4, T > > weights;
+    std::vector< vmml::vector< 3, T > > positions;
+    std::vector< vmml::vector< 3, T > > result;
+};
+
+template< typename T > vmml::DualQuaternion< T > _makeBone( const size_t i )
+{
+    return vmml::DualQuaternion< T >(
+        vmml::Quaternion< T >( T( i ) * T( .1 ),
+                               vmml::vector< 3, T >( 0, 1, 1 )),
+        vmml::vector< 3, T >( T( i ), 0, 0 ));
+}
+
+// Linear blend skinning with a palette of 3x4 matrices as reference
+template< typename T, size_t size >
+void _skinMatrixPalette( State& state, const size_t nBones )
+{
+    typedef vmml::Matrix< 3, 4, T > Matrix;
+    std::vector< Matrix > palette;
+    for( size_t i = 0; i < nBones; ++i )
+        palette.push_back( _makeBone< T >( i ).getMatrix()
+                               .template getSubMatrix< 3, 4 >( 0, 0 ));
+    Vertices< T > vertices( size, nBones );
+
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+        {
+            const vmml::Vector4ui& index = vertices.indices[i];
+            const vmml::vector< 4, T >& weight = vertices.weights[i];
+            T blend[ 12 ];
+            for( size_t k = 0; k < 12; ++k )
+                blend[k] = palette[ index[0] ].array[k] * weight[0] +
+                           palette[ index[1] ].array[k] * weight[1] +
+                           palette[ index[2] ].array[k] * weight[2] +
+                           palette[ index[3] ].array[k] * weight[3];
+
+            const vmml::vector< 3, T >& p = vertices.positions[i];
+            for( size_t row = 0; row < 3; ++row )
+                vertices.result[i][row] = blend[ row ] * p[0] +
+                                          blend[ 3 + row ] * p[1] +
+                                          blend[ 6 + row ] * p[2] +
+                                          blend[ 9 + row ];
+        }
+        doNotOptimize( vertices.result[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size >
+void _skinDualQuaternion( State& state, const size_t nBones )
+{
+    std::vector< vmml::DualQuaternion< T > > bones;
+    for( size_t i = 0; i < nBones; ++i )
+        bones.push_back( _makeBone< T >( i ));
+    Vertices< T > vertices( size, nBones );
+
+    while( state.keepRunning( ))
+    {
+        vmml::skin( bones.data(), vertices.indices.data(),
+                    vertices.weights.data(), vertices.positions.data(),
+                    vertices.result.data(), size );
+        doNotOptimize( vertices.result[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void skinMatrixPalette( State& state )
+{
+    _skinMatrixPalette< T, size >( state, smallPalette );
+}
+
+template< typename T, size_t size > void skinDualQuaternion( State& state )
+{
+    _skinDualQuaternion< T, size >( state, smallPalette );
+}
+
+template< typename T, size_t size > void skinMatrixPaletteLarge( State& state )
+{
+    _skinMatrixPalette< T, size >( state, largePalette );
+}
+
+template< typename T, size_t size >
+void skinDualQuaternionLarge( State& state )
+{
+    _skinDualQuaternion< T, size >( state, largePalette );
+}
+}
+
+VMMLIB_BENCHMARK_SIZES( skinMatrixPalette );
+VMMLIB_BENCHMARK_SIZES( skinDualQuaternion );
+VMMLIB_BENCHMARK_SIZES( skinMatrixPaletteLarge );
+VMMLIB_BENCHMARK_SIZES( skinDualQuaternionLarge );
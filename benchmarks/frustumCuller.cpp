@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/frustum.hpp>
+#include <vmmlib/frustumCuller.hpp>
+#include <vmmlib/lodSelector.hpp>
+#include <vmmlib/multiFrustumCuller.hpp>
+#include <vmmlib/quaternion.hpp>
+#include <vmmlib/types.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+template< typename T > T _random( const T min, const T max )
+{
+    return min + ( max - min ) * T( rand( )) / T( RAND_MAX );
+}
+
+template< typename T > struct Objects
+{
+    typedef vmml::vector< 3, T > vec3;
+
+    explicit Objects( const size_t n )
+        : x( n ), y( n ), z( n ), radius( n ), spheres( n ), boxes( n )
+        , visibility( n ), indices( n )
+    {
+        srand( 42 );
+        for( size_t i = 0; i < n; ++i )
+        {
+            x[i] = _random< T >( -50, 50 );
+            y[i] = _random< T >( -50, 50 );
+            z[i] = _random< T >( -120, 20 );
+            radius[i] = _random< T >( 0, 2 );
+            spheres[i] = vmml::vector< 4, T >( x[i], y[i], z[i], radius[i] );
+            boxes[i] = vmml::AABB< T >( vec3( x[i], y[i], z[i] ) - radius[i],
+                                        vec3( x[i], y[i], z[i] ) + radius[i] );
+        }
+        for( size_t i = 0; i < 3; ++i )
+        {
+            boxMin[i].resize( n );
+            boxMax[i].resize( n );
+            for( size_t j = 0; j < n; ++j )
+            {
+                boxMin[i][j] = boxes[j].getMin()[i];
+                boxMax[i][j] = boxes[j].getMax()[i];
+            }
+        }
+    }
+
+    std::vector< T > x, y, z, radius;
+    std::vector< T > boxMin[3], boxMax[3];
+    std::vector< vmml::vector< 4, T > > spheres;
+    std::vector< vmml::AABB< T > > boxes;
+    std::vector< vmml::Visibility > visibility;
+    std::vector< uint32_t > indices;
+};
+
+template< typename T > vmml::FrustumCuller< T > _getCuller()
+{
+    const vmml::Frustum< T > frustum( -1, 1, -1, 1, 1, 100 );
+    return vmml::FrustumCuller< T >( frustum.computePerspectiveMatrix( ));
+}
+
+template< typename T, size_t size > void frustumCullerSpheres( State& state )
+{
+    Objects< T > objects( size );
+    const vmml::FrustumCuller< T > culler = _getCuller< T >();
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            objects.visibility[i] = culler.test( objects.spheres[i] );
+        doNotOptimize( objects.visibility[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size >
+void frustumCullerSpheresBatch( State& state )
+{
+    Objects< T > objects( size );
+    const vmml::FrustumCuller< T > culler = _getCuller< T >();
+    while( state.keepRunning( ))
+    {
+        culler.test( objects.x.data(), objects.y.data(), objects.z.data(),
+                     objects.radius.data(), size, objects.visibility.data( ));
+        doNotOptimize( objects.visibility[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size >
+void frustumCullerSpheresCull( State& state )
+{
+    Objects< T > objects( size );
+    const vmml::FrustumCuller< T > culler = _getCuller< T >();
+    while( state.keepRunning( ))
+    {
+        size_t visible = culler.cull( objects.x.data(), objects.y.data(),
+                                      objects.z.data(), objects.radius.data(),
+                                      size, objects.indices.data( ));
+        doNotOptimize( visible );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void frustumCullerAABBs( State& state )
+{
+    Objects< T > objects( size );
+    const vmml::FrustumCuller< T > culler = _getCuller< T >();
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            objects.visibility[i] = culler.test( objects.boxes[i] );
+        doNotOptimize( objects.visibility[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size >
+void frustumCullerAABBsBatch( State& state )
+{
+    Objects< T > objects( size );
+    const vmml::FrustumCuller< T > culler = _getCuller< T >();
+    while( state.keepRunning( ))
+    {
+        culler.test( objects.boxMin[0].data(), objects.boxMin[1].data(),
+                     objects.boxMin[2].data(), objects.boxMax[0].data(),
+                     objects.boxMax[1].data(), objects.boxMax[2].data(),
+                     size, objects.visibility.data( ));
+        doNotOptimize( objects.visibility[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+// Recursive culling of an implicit octree: returns the number of visible
+// leaves. Fully visible subtrees are accepted without further tests.
+const size_t octreeDepth = 6;
+
+vmml::AABBf _getOctant( const vmml::AABBf& box, const size_t i )
+{
+    const vmml::Vector3f& center = box.getCenter();
+    vmml::Vector3f min = box.getMin();
+    vmml::Vector3f max = center;
+    for( size_t j = 0; j < 3; ++j )
+    {
+        if( i & ( 1u << j ))
+        {
+            min[j] = center[j];
+            max[j] = box.getMax()[j];
+        }
+    }
+    return vmml::AABBf( min, max );
+}
+
+size_t _cullOctree( const vmml::FrustumCullerf& culler,
+                    const vmml::AABBf& box, const size_t depth )
+{
+    switch( culler.test( box ))
+    {
+    case vmml::VISIBILITY_NONE: return 0;
+    case vmml::VISIBILITY_FULL: return size_t( 1 ) << ( 3 * depth );
+    case vmml::VISIBILITY_PARTIAL: break;
+    }
+    if( depth == 0 )
+        return 1;
+
+    size_t visible = 0;
+    for( size_t i = 0; i < 8; ++i )
+        visible += _cullOctree( culler, _getOctant( box, i ), depth - 1 );
+    return visible;
+}
+
+size_t _cullOctree( const vmml::FrustumCullerf& culler,
+                    const vmml::AABBf& box, const size_t depth,
+                    unsigned planes, size_t& lastPlane )
+{
+    switch( culler.test( box, planes, lastPlane ))
+    {
+    case vmml::VISIBILITY_NONE: return 0;
+    case vmml::VISIBILITY_FULL: return size_t( 1 ) << ( 3 * depth );
+    case vmml::VISIBILITY_PARTIAL: break;
+    }
+    if( depth == 0 )
+        return 1;
+
+    size_t visible = 0;
+    for( size_t i = 0; i < 8; ++i )
+        visible += _cullOctree( culler, _getOctant( box, i ), depth - 1,
+                                planes, lastPlane );
+    return visible;
+}
+
+const vmml::AABBf octreeBounds( vmml::Vector3f( -60.f, -60.f, -130.f ),
+                                vmml::Vector3f( 60.f, 60.f, 10.f ));
+
+void frustumCullerOctree( State& state )
+{
+    const vmml::FrustumCullerf culler = _getCuller< float >();
+    while( state.keepRunning( ))
+    {
+        size_t visible = _cullOctree( culler, octreeBounds, octreeDepth );
+        doNotOptimize( visible );
+    }
+    state.setItemsProcessed( state.getIterations() << ( 3 * octreeDepth ));
+}
+
+void frustumCullerOctreeMasked( State& state )
+{
+    const vmml::FrustumCullerf culler = _getCuller< float >();
+    size_t lastPlane = 0;
+    while( state.keepRunning( ))
+    {
+        size_t visible = _cullOctree( culler, octreeBounds, octreeDepth,
+                                      vmml::FrustumCullerf::PLANES_ALL,
+                                      lastPlane );
+        doNotOptimize( visible );
+    }
+    state.setItemsProcessed( state.getIterations() << ( 3 * octreeDepth ));
+}
+
+// The six faces of a cube map, e.g. of a point light shadow
+template< typename T > void _getCubeCullers( vmml::FrustumCuller< T >* cullers )
+{
+    typedef vmml::vector< 3, T > vec3;
+    const vmml::Frustum< T > frustum( -1, 1, -1, 1, 1, 100 );
+    const vmml::Matrix< 4, 4, T > projection =
+        frustum.computePerspectiveMatrix();
+    const vmml::Quaternion< T > rotations[6] = {
+        vmml::Quaternion< T >( 0, vec3::UNIT_Y ),
+        vmml::Quaternion< T >( T( M_PI_2 ), vec3::UNIT_Y ),
+        vmml::Quaternion< T >( T( M_PI ), vec3::UNIT_Y ),
+        vmml::Quaternion< T >( T( -M_PI_2 ), vec3::UNIT_Y ),
+        vmml::Quaternion< T >( T( M_PI_2 ), vec3::UNIT_X ),
+        vmml::Quaternion< T >( T( -M_PI_2 ), vec3::UNIT_X ) };
+    for( size_t i = 0; i < 6; ++i )
+        cullers[i] = vmml::FrustumCuller< T >(
+            projection * vmml::Matrix< 4, 4, T >( rotations[i], vec3::ZERO ));
+}
+
+// One batch test per cube face as reference
+template< typename T, size_t size > void cubeSpheres( State& state )
+{
+    Objects< T > objects( size );
+    vmml::FrustumCuller< T > cullers[6];
+    _getCubeCullers( cullers );
+    std::vector< uint32_t > views( size );
+    while( state.keepRunning( ))
+    {
+        std::fill( views.begin(), views.end(), 0 );
+        for( size_t i = 0; i < 6; ++i )
+        {
+            cullers[i].test( objects.x.data(), objects.y.data(),
+                             objects.z.data(), objects.radius.data(), size,
+                             objects.visibility.data( ));
+            for( size_t j = 0; j < size; ++j )
+                views[j] |= uint32_t( objects.visibility[j] != 0 ) << i;
+        }
+        doNotOptimize( views[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void cubeSpheresMulti( State& state )
+{
+    Objects< T > objects( size );
+    vmml::FrustumCuller< T > cullers[6];
+    _getCubeCullers( cullers );
+    const vmml::MultiFrustumCuller< T, 6 > culler( cullers );
+    std::vector< uint32_t > views( size );
+    while( state.keepRunning( ))
+    {
+        culler.test( objects.x.data(), objects.y.data(), objects.z.data(),
+                     objects.radius.data(), size, views.data( ));
+        doNotOptimize( views[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void cubeAABBs( State& state )
+{
+    Objects< T > objects( size );
+    vmml::FrustumCuller< T > cullers[6];
+    _getCubeCullers( cullers );
+    std::vector< uint32_t > views( size );
+    while( state.keepRunning( ))
+    {
+        std::fill( views.begin(), views.end(), 0 );
+        for( size_t i = 0; i < 6; ++i )
+        {
+            cullers[i].test( objects.boxMin[0].data(),
+                             objects.boxMin[1].data(),
+                             objects.boxMin[2].data(),
+                             objects.boxMax[0].data(),
+                             objects.boxMax[1].data(),
+                             objects.boxMax[2].data(), size,
+                             objects.visibility.data( ));
+            for( size_t j = 0; j < size; ++j )
+                views[j] |= uint32_t( objects.visibility[j] != 0 ) << i;
+        }
+        doNotOptimize( views[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void cubeAABBsMulti( State& state )
+{
+    Objects< T > objects( size );
+    vmml::FrustumCuller< T > cullers[6];
+    _getCubeCullers( cullers );
+    const vmml::MultiFrustumCuller< T, 6 > culler( cullers );
+    std::vector< uint32_t > views( size );
+    while( state.keepRunning( ))
+    {
+        culler.test( objects.boxMin[0].data(), objects.boxMin[1].data(),
+                     objects.boxMin[2].data(), objects.boxMax[0].data(),
+                     objects.boxMax[1].data(), objects.boxMax[2].data(),
+                     size, views.data( ));
+        doNotOptimize( views[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T > vmml::LODSelector< T > _getLODSelector()
+{
+    const vmml::Frustum< T > frustum( -1, 1, -1, 1, 1, 100 );
+    const T thresholds[] = { 100, 30, 10 };
+    return vmml::LODSelector< T >( frustum.computePerspectiveMatrix(),
+                                   vmml::Matrix< 4, 4, T >(), 1000,
+                                   thresholds, 3, 2 );
+}
+
+// A batch visibility test and a second pass for the level of detail
+template< typename T, size_t size > void lodSpheres( State& state )
+{
+    Objects< T > objects( size );
+    const vmml::LODSelector< T > selector = _getLODSelector< T >();
+    const vmml::FrustumCuller< T >& culler = selector.getFrustumCuller();
+    const T thresholds[] = { 100, 30, 10 };
+    std::vector< uint32_t > lods( size );
+    while( state.keepRunning( ))
+    {
+        culler.test( objects.x.data(), objects.y.data(), objects.z.data(),
+                     objects.radius.data(), size, objects.visibility.data( ));
+        for( size_t i = 0; i < size; ++i )
+        {
+            const T radius =
+                selector.getProjectedRadius( objects.spheres[i] );
+            if( radius < 2 )
+                objects.visibility[i] = vmml::VISIBILITY_NONE;
+            uint32_t lod = 0;
+            for( size_t j = 0; j < 3; ++j )
+                lod += radius < thresholds[j];
+            lods[i] = lod;
+        }
+        doNotOptimize( lods[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void lodSpheresSelector( State& state )
+{
+    Objects< T > objects( size );
+    const vmml::LODSelector< T > selector = _getLODSelector< T >();
+    std::vector< uint32_t > lods( size );
+    while( state.keepRunning( ))
+    {
+        selector.test( objects.x.data(), objects.y.data(), objects.z.data(),
+                       objects.radius.data(), size,
+                       objects.visibility.data(), lods.data( ));
+        doNotOptimize( lods[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+}
+
+VMMLIB_BENCHMARK_SIZES( frustumCullerSpheres );
+VMMLIB_BENCHMARK_SIZES( frustumCullerSpheresBatch );
+VMMLIB_BENCHMARK_SIZES( frustumCullerSpheresCull );
+VMMLIB_BENCHMARK_SIZES( frustumCullerAABBs );
+VMMLIB_BENCHMARK_SIZES( frustumCullerAABBsBatch );
+VMMLIB_BENCHMARK( frustumCullerOctree );
+VMMLIB_BENCHMARK( frustumCullerOctreeMasked );
+VMMLIB_BENCHMARK_SIZES( cubeSpheres );
+VMMLIB_BENCHMARK_SIZES( cubeSpheresMulti );
+VMMLIB_BENCHMARK_SIZES( cubeAABBs );
+VMMLIB_BENCHMARK_SIZES( cubeAABBsMulti );
+VMMLIB_BENCHMARK_SIZES( lodSpheres );
+VMMLIB_BENCHMARK_SIZES( lodSpheresSelector );
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/exponentialFilter.hpp>
+#include <vmmlib/lowpassFilter.hpp>
+#include <vmmlib/types.hpp>
+#include <vmmlib/vector.hpp>
+
+#include <deque>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+const size_t nSamples = 1024;
+const size_t nChannels = 4096;
+const size_t windowSize = 10;
+
+// The previous std::deque based implementation of LowpassFilter
+template< size_t M, typename T > class DequeLowpassFilter
+{
+public:
+    DequeLowpassFilter( const float F ) : _smoothFactor( F ) {}
+
+    const T& add( const T& value )
+    {
+        _data.push_front( value );
+        while( _data.size() > M )
+            _data.pop_back();
+
+        typename std::deque< T >::const_iterator i = _data.begin();
+        _value = *i;
+        double weight = _smoothFactor;
+        for( ++i ; i != _data.end(); ++i )
+        {
+            _value = _value * (1 - weight) + (*i) * weight;
+            weight *= _smoothFactor;
+        }
+        return _value;
+    }
+
+private:
+    std::deque< T > _data;
+    float _smoothFactor;
+    T _value;
+};
+
+template< typename T > vmml::vector< 3, T > _getSample( const size_t i )
+{
+    return vmml::vector< 3, T >( T( i % 7 ), T( i % 5 ), T( i % 3 ));
+}
+
+// The filter state is independent of the number of samples, so these are
+// only run for float and double, without working set sizes.
+template< class Filter, typename T > void _filterSamples( State& state )
+{
+    while( state.keepRunning( ))
+    {
+        Filter filter( .5f );
+        for( size_t i = 0; i < nSamples; ++i )
+            filter.add( _getSample< T >( i ));
+        doNotOptimize( filter );
+    }
+    state.setItemsProcessed( state.getIterations() * nSamples );
+}
+
+template< typename T > void lowpassFilterDeque( State& state )
+{
+    typedef DequeLowpassFilter< windowSize, vmml::vector< 3, T > > Filter;
+    _filterSamples< Filter, T >( state );
+}
+
+template< typename T > void lowpassFilter( State& state )
+{
+    typedef vmml::LowpassFilter< windowSize, vmml::vector< 3, T > > Filter;
+    _filterSamples< Filter, T >( state );
+}
+
+template< typename T > void exponentialFilter( State& state )
+{
+    typedef vmml::ExponentialFilter< vmml::vector< 3, T > > Filter;
+    _filterSamples< Filter, T >( state );
+}
+
+// one update of many scalar channels, e.g. all tracked pose components
+void exponentialFilterChannels( State& state )
+{
+    std::vector< vmml::ExponentialFilter< float > > filters( nChannels,
+                                      vmml::ExponentialFilter< float >( .5f ));
+    std::vector< float > values( nChannels, 1.f );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < nChannels; ++i )
+            filters[i].add( values[i] );
+        doNotOptimize( filters[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * nChannels );
+}
+
+void exponentialFilterArray( State& state )
+{
+    vmml::ExponentialFilterArray< float > filters( nChannels, .5f );
+    std::vector< float > values( nChannels, 1.f );
+    while( state.keepRunning( ))
+    {
+        const float* result = filters.add( values.data( ));
+        doNotOptimize( result );
+    }
+    state.setItemsProcessed( state.getIterations() * nChannels );
+}
+}
+
+VMMLIB_BENCHMARK_TEMPLATE( lowpassFilterDeque, float );
+VMMLIB_BENCHMARK_TEMPLATE( lowpassFilterDeque, double );
+VMMLIB_BENCHMARK_TEMPLATE( lowpassFilter, float );
+VMMLIB_BENCHMARK_TEMPLATE( lowpassFilter, double );
+VMMLIB_BENCHMARK_TEMPLATE( exponentialFilter, float );
+VMMLIB_BENCHMARK_TEMPLATE( exponentialFilter, double );
+VMMLIB_BENCHMARK( exponentialFilterChannels );
+VMMLIB_BENCHMARK( exponentialFilterArray );
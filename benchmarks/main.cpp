@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/dispatch.hpp>
+#include <vmmlib/simd.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+const double minTime = 0.2; // seconds per benchmark
+
+struct Result
+{
+    std::string name;
+    size_t iterations;
+    double time; // seconds
+    size_t items;
+};
+
+Result _run( const vmml::benchmark::Benchmark& benchmark,
+             const size_t iterations )
+{
+    vmml::benchmark::State state( iterations );
+    benchmark.function( state );
+    const Result result = { benchmark.name, iterations, state.getTime(),
+                            state.getItemsProcessed() };
+    return result;
+}
+
+Result _run( const vmml::benchmark::Benchmark& benchmark )
+{
+    // warm-up run without iterations to set up static data
+    _run( benchmark, 0 );
+
+    Result result = _run( benchmark, 1 );
+    while( result.time < minTime )
+    {
+        const double scale = result.time > 0. ? 1.5 * minTime / result.time
+                                              : 100.;
+        const size_t iterations = size_t( result.iterations *
+                                          std::min( scale, 100. )) + 1;
+        result = _run( benchmark, iterations );
+    }
+    return result;
+}
+
+double _getItemsPerSecond( const Result& result )
+{
+    return result.items ? double( result.items ) / result.time : 0.;
+}
+
+std::string _getSIMD()
+{
+    std::string simd;
+#ifdef VMMLIB_SSE2
+    simd += " SSE2";
+#endif
+#ifdef VMMLIB_SSE41
+    simd += " SSE4.1";
+#endif
+#ifdef VMMLIB_AVX
+    simd += " AVX";
+#endif
+#ifdef VMMLIB_AVX2
+    simd += " AVX2";
+#endif
+#ifdef VMMLIB_FMA
+    simd += " FMA";
+#endif
+#ifdef VMMLIB_AVX512
+    simd += " AVX512";
+#endif
+    return simd.empty() ? "none" : simd.substr( 1 );
+}
+
+void _printTableHeader()
+{
+    std::cout << std::left << std::setw( 48 ) << "Benchmark" << std::right
+              << std::setw( 12 ) << "ns/iter" << std::setw( 14 )
+              << "iterations" << std::setw( 16 ) << "items/s" << std::endl;
+}
+
+void _printTableRow( const Result& result )
+{
+    std::cout << std::left << std::setw( 48 ) << result.name
+              << std::right << std::fixed << std::setprecision( 2 )
+              << std::setw( 12 ) << result.time * 1e9 / result.iterations
+              << std::setw( 14 ) << result.iterations << std::setw( 16 )
+              << std::scientific << _getItemsPerSecond( result )
+              << std::endl;
+}
+
+std::string _quote( const std::string& string )
+{
+    std::string quoted = "\"";
+    for( size_t i = 0; i < string.size(); ++i )
+    {
+        if( string[i] == '"' || string[i] == '\\' )
+            quoted += '\\';
+        quoted += string[i];
+    }
+    return quoted + '"';
+}
+
+// The JSON output follows the format of Google Benchmark, so that existing
+// tools for comparing and tracking results can be used.
+void _printJSONHeader( const char* executable )
+{
+    char date[32];
+    const time_t now = time( 0 );
+    strftime( date, sizeof( date ), "%Y-%m-%dT%H:%M:%S", localtime( &now ));
+
+    std::cout << "{\n  \"context\": {\n"
+              << "    \"date\": " << _quote( date ) << ",\n"
+              << "    \"executable\": " << _quote( executable ) << ",\n"
+#ifdef NDEBUG
+              << "    \"library_build_type\": \"release\",\n"
+#else
+              << "    \"library_build_type\": \"debug\",\n"
+#endif
+              << "    \"simd\": \"" << _getSIMD() << "\",\n"
+              << "    \"simd_dispatch\": \""
+              << vmml::getName( vmml::getSIMDLevel( )) << "\"\n"
+              << "  },\n  \"benchmarks\": [";
+}
+
+void _printJSONRow( const Result& result, const bool first )
+{
+    std::cout << ( first ? "\n" : ",\n" ) << std::setprecision( 9 )
+              << "    {\n"
+              << "      \"name\": " << _quote( result.name ) << ",\n"
+              << "      \"iterations\": " << result.iterations << ",\n"
+              << "      \"real_time\": "
+              << result.time * 1e9 / result.iterations << ",\n"
+              << "      \"time_unit\": \"ns\",\n"
+              << "      \"items_per_second\": " << _getItemsPerSecond( result )
+              << "\n    }" << std::flush;
+}
+}
+
+/**
+ * Usage: vmmlib_benchmarks [--json] [filter]
+ *
+ * Runs all benchmarks whose name contains filter, and prints the results as a
+ * table or in JSON format.
+ */
+int main( const int argc, char** argv )
+{
+    bool json = false;
+    const char* filter = "";
+    for( int i = 1; i < argc; ++i )
+    {
+        if( strcmp( argv[i], "--json" ) == 0 )
+            json = true;
+        else
+            filter = argv[i];
+    }
+
+    if( json )
+        _printJSONHeader( argv[0] );
+    else
+        _printTableHeader();
+
+    bool first = true;
+    for( const auto& benchmark : vmml::benchmark::getBenchmarks( ))
+    {
+        if( benchmark.name.find( filter ) == std::string::npos )
+            continue;
+
+        const Result result = _run( benchmark );
+        if( json )
+            _printJSONRow( result, first );
+        else
+            _printTableRow( result );
+        first = false;
+    }
+
+    if( json )
+        std::cout << "\n  ]\n}" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/transform.hpp>
+#include <vmmlib/types.hpp>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+// the generic, element-accessor based product as reference
+template< typename T >
+void _multiplyScalar( vmml::Matrix< 4, 4, T >& result,
+                      const vmml::Matrix< 4, 4, T >& left,
+                      const vmml::Matrix< 4, 4, T >& right )
+{
+    for( size_t row = 0; row < 4; ++row )
+        for( size_t col = 0; col < 4; ++col )
+        {
+            T& component = result( row, col );
+            component = 0;
+            for( size_t i = 0; i < 4; ++i )
+                component += left( row, i ) * right( i, col );
+        }
+}
+
+template< typename T > vmml::Matrix< 4, 4, T > _makeMatrix()
+{
+    vmml::Matrix< 4, 4, T > matrix;
+    matrix.rotate_x( T( .1 ));
+    matrix.rotate_y( T( .2 ));
+    matrix.setTranslation( vmml::vector< 3, T >( 1, 2, 3 ));
+    return matrix;
+}
+
+template< typename T > void _multiply( State& state )
+{
+    const vmml::Matrix< 4, 4, T > left = _makeMatrix< T >();
+    vmml::Matrix< 4, 4, T > right = _makeMatrix< T >();
+    vmml::Matrix< 4, 4, T > result;
+    while( state.keepRunning( ))
+    {
+        doNotOptimize( right );
+        result.multiply( left, right );
+        doNotOptimize( result );
+    }
+    state.setItemsProcessed( state.getIterations( ));
+}
+
+template< typename T > void _multiplyScalar( State& state )
+{
+    const vmml::Matrix< 4, 4, T > left = _makeMatrix< T >();
+    vmml::Matrix< 4, 4, T > right = _makeMatrix< T >();
+    vmml::Matrix< 4, 4, T > result;
+    while( state.keepRunning( ))
+    {
+        doNotOptimize( right );
+        _multiplyScalar( result, left, right );
+        doNotOptimize( result );
+    }
+    state.setItemsProcessed( state.getIterations( ));
+}
+
+template< typename T, vmml::Matrix< 4, 4, T >
+                      ( vmml::Matrix< 4, 4, T >::*inverse )( ) const >
+void _inverse( State& state )
+{
+    vmml::Matrix< 4, 4, T > matrix = _makeMatrix< T >();
+    vmml::Matrix< 4, 4, T > result;
+    while( state.keepRunning( ))
+    {
+        doNotOptimize( matrix );
+        result = ( matrix.*inverse )();
+        doNotOptimize( result );
+    }
+    state.setItemsProcessed( state.getIterations( ));
+}
+
+template< typename T > void _transformInverse( State& state )
+{
+    vmml::Transform< T > transform( _makeMatrix< T >( ));
+    while( state.keepRunning( ))
+    {
+        doNotOptimize( transform );
+        vmml::Transform< T > result = transform.inverse();
+        doNotOptimize( result );
+    }
+    state.setItemsProcessed( state.getIterations( ));
+}
+
+// Arrays of matrices, e.g. the world transformations of a scene graph
+template< typename T, size_t size > void matrix4Multiply( State& state )
+{
+    const vmml::Matrix< 4, 4, T > right = _makeMatrix< T >();
+    std::vector< vmml::Matrix< 4, 4, T > > matrices( size, right );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            matrices[i].multiply( matrices[i], right );
+        doNotOptimize( matrices[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void matrix4Inverse( State& state )
+{
+    std::vector< vmml::Matrix< 4, 4, T > > matrices( size,
+                                                     _makeMatrix< T >( ));
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            matrices[i] = matrices[i].inverse();
+        doNotOptimize( matrices[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+void matrix4fMultiply( State& state ) { _multiply< float >( state ); }
+void matrix4fMultiplyScalar( State& state ) { _multiplyScalar< float >( state ); }
+void matrix4dMultiply( State& state ) { _multiply< double >( state ); }
+void matrix4dMultiplyScalar( State& state ) { _multiplyScalar< double >( state ); }
+
+void matrix4fInverse( State& state )
+    { _inverse< float, &vmml::Matrix4f::inverse >( state ); }
+void matrix4fInverseAffine( State& state )
+    { _inverse< float, &vmml::Matrix4f::inverseAffine >( state ); }
+void matrix4fInverseRigid( State& state )
+    { _inverse< float, &vmml::Matrix4f::inverseRigid >( state ); }
+void matrix4dInverse( State& state )
+    { _inverse< double, &vmml::Matrix4d::inverse >( state ); }
+void matrix4dInverseAffine( State& state )
+    { _inverse< double, &vmml::Matrix4d::inverseAffine >( state ); }
+void matrix4dInverseRigid( State& state )
+    { _inverse< double, &vmml::Matrix4d::inverseRigid >( state ); }
+void transformfInverse( State& state ) { _transformInverse< float >( state ); }
+void transformdInverse( State& state ) { _transformInverse< double >( state ); }
+}
+
+VMMLIB_BENCHMARK( matrix4fMultiply );
+VMMLIB_BENCHMARK( matrix4fMultiplyScalar );
+VMMLIB_BENCHMARK( matrix4dMultiply );
+VMMLIB_BENCHMARK( matrix4dMultiplyScalar );
+VMMLIB_BENCHMARK( matrix4fInverse );
+VMMLIB_BENCHMARK( matrix4fInverseAffine );
+VMMLIB_BENCHMARK( matrix4fInverseRigid );
+VMMLIB_BENCHMARK( matrix4dInverse );
+VMMLIB_BENCHMARK( matrix4dInverseAffine );
+VMMLIB_BENCHMARK( matrix4dInverseRigid );
+VMMLIB_BENCHMARK( transformfInverse );
+VMMLIB_BENCHMARK( transformdInverse );
+VMMLIB_BENCHMARK_SIZES( matrix4Multiply );
+VMMLIB_BENCHMARK_SIZES( matrix4Inverse );
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/aabb.hpp>
+#include <vmmlib/frustum.hpp>
+#include <vmmlib/frustumCuller.hpp>
+#include <vmmlib/obb.hpp>
+#include <vmmlib/quaternion.hpp>
+#include <vmmlib/types.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+template< typename T > T _random( const T min, const T max )
+{
+    return min + ( max - min ) * T( rand( )) / T( RAND_MAX );
+}
+
+// points in a rotated, elongated box
+template< typename T >
+std::vector< vmml::vector< 3, T > > _makePoints( const size_t size )
+{
+    typedef vmml::vector< 3, T > vec3;
+    srand( 42 );
+    const vmml::Matrix< 3, 3, T > rotation = vmml::Quaternion< T >(
+        T( .7 ), vmml::normalize( vec3( 1, 2, 3 ))).getRotationMatrix();
+    std::vector< vec3 > points( size );
+    for( size_t i = 0; i < size; ++i )
+        points[i] = rotation * vec3( _random< T >( -10, 10 ),
+                                     _random< T >( -2, 2 ),
+                                     _random< T >( -1, 1 ));
+    return points;
+}
+
+// the axis-aligned box of the points as reference
+template< typename T, size_t size > void aabb( State& state )
+{
+    const std::vector< vmml::vector< 3, T > > points =
+        _makePoints< T >( size );
+    while( state.keepRunning( ))
+    {
+        vmml::AABB< T > box;
+        for( size_t i = 0; i < size; ++i )
+            box.merge( points[i] );
+        doNotOptimize( box );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void pca( State& state )
+{
+    const std::vector< vmml::vector< 3, T > > points =
+        _makePoints< T >( size );
+    while( state.keepRunning( ))
+    {
+        const vmml::OBB< T > box =
+            vmml::OBB< T >::fromPointsPCA( points.data(), size );
+        doNotOptimize( box );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void dito( State& state )
+{
+    const std::vector< vmml::vector< 3, T > > points =
+        _makePoints< T >( size );
+    while( state.keepRunning( ))
+    {
+        const vmml::OBB< T > box =
+            vmml::OBB< T >::fromPointsDiTO( points.data(), size );
+        doNotOptimize( box );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T >
+std::vector< vmml::OBB< T > > _makeBoxes( const size_t size )
+{
+    typedef vmml::vector< 3, T > vec3;
+    srand( 42 );
+    std::vector< vmml::OBB< T > > boxes( size );
+    for( size_t i = 0; i < size; ++i )
+    {
+        const vec3 axis( _random< T >( -1, 1 ), _random< T >( -1, 1 ),
+                         _random< T >( -1, 1 ));
+        boxes[i] = vmml::OBB< T >(
+            vec3( _random< T >( -50, 50 ), _random< T >( -50, 50 ),
+                  _random< T >( -120, 20 )),
+            vmml::Quaternion< T >( _random< T >( 0, 3 ),
+                                   vmml::normalize( axis )).
+                getRotationMatrix(),
+            vec3( _random< T >( 0, 10 ), _random< T >( 0, 10 ),
+                  _random< T >( 0, 10 )));
+    }
+    return boxes;
+}
+
+template< typename T > vmml::FrustumCuller< T > _makeCuller()
+{
+    const vmml::Frustum< T > frustum( -1, 1, -1, 1, 1, 100 );
+    return vmml::FrustumCuller< T >( frustum.computePerspectiveMatrix( ));
+}
+
+// one test per call as reference
+template< typename T, size_t size > void testOBBScalar( State& state )
+{
+    const vmml::FrustumCuller< T > culler = _makeCuller< T >();
+    const std::vector< vmml::OBB< T > > boxes = _makeBoxes< T >( size );
+    std::vector< vmml::Visibility > visibility( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            visibility[i] = culler.test( boxes[i] );
+        doNotOptimize( visibility[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void testOBB( State& state )
+{
+    const vmml::FrustumCuller< T > culler = _makeCuller< T >();
+    const std::vector< vmml::OBB< T > > boxes = _makeBoxes< T >( size );
+    std::vector< vmml::Visibility > visibility( size );
+    while( state.keepRunning( ))
+    {
+        culler.test( boxes.data(), size, visibility.data( ));
+        doNotOptimize( visibility[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void cullOBB( State& state )
+{
+    const vmml::FrustumCuller< T > culler = _makeCuller< T >();
+    const std::vector< vmml::OBB< T > > boxes = _makeBoxes< T >( size );
+    std::vector< uint32_t > indices( size );
+    while( state.keepRunning( ))
+    {
+        size_t count = culler.cull( boxes.data(), size, indices.data( ));
+        doNotOptimize( count );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+}
+
+VMMLIB_BENCHMARK_SIZES( aabb );
+VMMLIB_BENCHMARK_SIZES( pca );
+VMMLIB_BENCHMARK_SIZES( dito );
+VMMLIB_BENCHMARK_SIZES( testOBBScalar );
+VMMLIB_BENCHMARK_SIZES( testOBB );
+VMMLIB_BENCHMARK_SIZES( cullOBB );
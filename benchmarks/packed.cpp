@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/packed.hpp>
+#include <vmmlib/types.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+template< typename T >
+std::vector< vmml::Quaternion< T > > _makeQuaternions( const size_t size )
+{
+    std::vector< vmml::Quaternion< T > > quaternions( size );
+    srand( 42 );
+    for( size_t i = 0; i < size; ++i )
+        quaternions[i] = vmml::Quaternion< T >(
+            T( rand( )) / T( RAND_MAX ),
+            vmml::vector< 3, T >( T( rand( )) / T( RAND_MAX ), 1, 0 ));
+    return quaternions;
+}
+
+template< typename T >
+std::vector< vmml::vector< 3, T > > _makeNormals( const size_t size )
+{
+    std::vector< vmml::vector< 3, T > > normals( size );
+    srand( 42 );
+    for( size_t i = 0; i < size; ++i )
+        normals[i] = vmml::normalize( vmml::vector< 3, T >(
+            T( rand( )) / T( RAND_MAX ) - T( .5 ), T( .5 ),
+            T( rand( )) / T( RAND_MAX ) - T( .5 )));
+    return normals;
+}
+
+template< typename T, size_t size, class Packed >
+void _encodeQuaternions( State& state )
+{
+    const std::vector< vmml::Quaternion< T > > quaternions =
+        _makeQuaternions< T >( size );
+    std::vector< Packed > packed( size );
+    while( state.keepRunning( ))
+    {
+        vmml::encode( quaternions.data(), packed.data(), size );
+        doNotOptimize( packed[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size, class Packed >
+void _decodeQuaternions( State& state )
+{
+    const std::vector< vmml::Quaternion< T > > quaternions =
+        _makeQuaternions< T >( size );
+    std::vector< Packed > packed( size );
+    vmml::encode( quaternions.data(), packed.data(), size );
+    std::vector< vmml::Quaternion< T > > decoded( size );
+    while( state.keepRunning( ))
+    {
+        vmml::decode( packed.data(), decoded.data(), size );
+        doNotOptimize( decoded[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size, class Packed >
+void _encodeNormals( State& state )
+{
+    const std::vector< vmml::vector< 3, T > > normals =
+        _makeNormals< T >( size );
+    std::vector< Packed > packed( size );
+    while( state.keepRunning( ))
+    {
+        vmml::encode( normals.data(), packed.data(), size );
+        doNotOptimize( packed[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size, class Packed >
+void _decodeNormals( State& state )
+{
+    const std::vector< vmml::vector< 3, T > > normals =
+        _makeNormals< T >( size );
+    std::vector< Packed > packed( size );
+    vmml::encode( normals.data(), packed.data(), size );
+    std::vector< vmml::vector< 3, T > > decoded( size );
+    while( state.keepRunning( ))
+    {
+        vmml::decode( packed.data(), decoded.data(), size );
+        doNotOptimize( decoded[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void encodeQuaternion32( State& state )
+{
+    _encodeQuaternions< T, size, vmml::PackedQuaternion32 >( state );
+}
+
+template< typename T, size_t size > void decodeQuaternion32( State& state )
+{
+    _decodeQuaternions< T, size, vmml::PackedQuaternion32 >( state );
+}
+
+template< typename T, size_t size > void encodeQuaternion48( State& state )
+{
+    _encodeQuaternions< T, size, vmml::PackedQuaternion48 >( state );
+}
+
+template< typename T, size_t size > void decodeQuaternion48( State& state )
+{
+    _decodeQuaternions< T, size, vmml::PackedQuaternion48 >( state );
+}
+
+template< typename T, size_t size > void encodeNormal16( State& state )
+{
+    _encodeNormals< T, size, vmml::PackedNormal16 >( state );
+}
+
+template< typename T, size_t size > void decodeNormal16( State& state )
+{
+    _decodeNormals< T, size, vmml::PackedNormal16 >( state );
+}
+
+template< typename T, size_t size > void encodeNormal32( State& state )
+{
+    _encodeNormals< T, size, vmml::PackedNormal32 >( state );
+}
+
+template< typename T, size_t size > void decodeNormal32( State& state )
+{
+    _decodeNormals< T, size, vmml::PackedNormal32 >( state );
+}
+
+template< typename T, size_t size > void encodeHalf( State& state )
+{
+    const std::vector< vmml::vector< 3, T > > vectors =
+        _makeNormals< T >( size );
+    std::vector< vmml::Half > halves( 3 * size );
+    while( state.keepRunning( ))
+    {
+        vmml::encode( vectors.data(), halves.data(), size );
+        doNotOptimize( halves[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void decodeHalf( State& state )
+{
+    std::vector< vmml::Half > halves( 3 * size );
+    vmml::encode( _makeNormals< T >( size ).data(), halves.data(), size );
+    std::vector< vmml::vector< 3, T > > vectors( size );
+    while( state.keepRunning( ))
+    {
+        vmml::decode( halves.data(), vectors.data(), size );
+        doNotOptimize( vectors[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+}
+
+VMMLIB_BENCHMARK_SIZES( encodeQuaternion32 );
+VMMLIB_BENCHMARK_SIZES( decodeQuaternion32 );
+VMMLIB_BENCHMARK_SIZES( encodeQuaternion48 );
+VMMLIB_BENCHMARK_SIZES( decodeQuaternion48 );
+VMMLIB_BENCHMARK_SIZES( encodeNormal16 );
+VMMLIB_BENCHMARK_SIZES( decodeNormal16 );
+VMMLIB_BENCHMARK_SIZES( encodeNormal32 );
+VMMLIB_BENCHMARK_SIZES( decodeNormal32 );
+VMMLIB_BENCHMARK_SIZES( encodeHalf );
+VMMLIB_BENCHMARK_SIZES( decodeHalf );
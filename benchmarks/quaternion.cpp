@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/quaternion.hpp>
+#include <vmmlib/quaternionArray.hpp>
+#include <vmmlib/types.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+template< typename T >
+std::vector< vmml::Quaternion< T > > _makeQuaternions( const size_t size )
+{
+    std::vector< vmml::Quaternion< T > > quaternions;
+    quaternions.reserve( size );
+    srand( 42 );
+    for( size_t i = 0; i < size; ++i )
+    {
+        const vmml::vector< 3, T > axis( T( rand( )) / T( RAND_MAX ), 1, 0 );
+        quaternions.push_back( vmml::Quaternion< T >(
+                                   T( rand( )) / T( RAND_MAX ),
+                                   vmml::normalize( axis )));
+    }
+    return quaternions;
+}
+
+template< typename T, size_t size > void quaternionMultiply( State& state )
+{
+    std::vector< vmml::Quaternion< T > > quaternions =
+        _makeQuaternions< T >( size );
+    const vmml::Quaternion< T > rotation( T( .1 ),
+                                          vmml::vector< 3, T >( 0, 0, 1 ));
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            quaternions[i] = quaternions[i] * rotation;
+        doNotOptimize( quaternions[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void quaternionNormalize( State& state )
+{
+    std::vector< vmml::Quaternion< T > > quaternions =
+        _makeQuaternions< T >( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            quaternions[i].normalize();
+        doNotOptimize( quaternions[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size >
+void quaternionRotationMatrix( State& state )
+{
+    const std::vector< vmml::Quaternion< T > > quaternions =
+        _makeQuaternions< T >( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+        {
+            vmml::Matrix< 3, 3, T > matrix = quaternions[i].getRotationMatrix();
+            doNotOptimize( matrix );
+        }
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+// Scalar reference of the batch interpolation
+template< typename T, size_t size > void quaternionSlerp( State& state )
+{
+    const std::vector< vmml::Quaternion< T > > a =
+        _makeQuaternions< T >( size );
+    std::vector< vmml::Quaternion< T > > b = _makeQuaternions< T >( size );
+    std::reverse( b.begin(), b.end( ));
+    std::vector< vmml::Quaternion< T > > result( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            result[i] = vmml::slerp( a[i], b[i], T( .3 ));
+        doNotOptimize( result[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size, int method >
+void _interpolateArray( State& state )
+{
+    std::vector< vmml::Quaternion< T > > quaternions =
+        _makeQuaternions< T >( size );
+    const vmml::QuaternionArray< T > a( quaternions.data(), size );
+    std::reverse( quaternions.begin(), quaternions.end( ));
+    const vmml::QuaternionArray< T > b( quaternions.data(), size );
+    vmml::QuaternionArray< T > result( size );
+    while( state.keepRunning( ))
+    {
+        if( method == 0 )
+            vmml::nlerp( a, b, T( .3 ), result );
+        else
+            vmml::slerp( a, b, T( .3 ), result,
+                         method == 1 ? vmml::SLERP_EXACT : vmml::SLERP_FAST );
+        doNotOptimize( result.getX()[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void quaternionArrayNlerp( State& state )
+{
+    _interpolateArray< T, size, 0 >( state );
+}
+
+template< typename T, size_t size > void quaternionArraySlerp( State& state )
+{
+    _interpolateArray< T, size, 1 >( state );
+}
+
+template< typename T, size_t size >
+void quaternionArrayFastSlerp( State& state )
+{
+    _interpolateArray< T, size, 2 >( state );
+}
+
+template< typename T, size_t size >
+void quaternionArrayRotationMatrices( State& state )
+{
+    const std::vector< vmml::Quaternion< T > > quaternions =
+        _makeQuaternions< T >( size );
+    const vmml::QuaternionArray< T > array( quaternions.data(), size );
+    std::vector< vmml::Matrix< 3, 3, T > > matrices( size );
+    while( state.keepRunning( ))
+    {
+        array.getRotationMatrices( matrices.data( ));
+        doNotOptimize( matrices[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+}
+
+VMMLIB_BENCHMARK_SIZES( quaternionMultiply );
+VMMLIB_BENCHMARK_SIZES( quaternionNormalize );
+VMMLIB_BENCHMARK_SIZES( quaternionRotationMatrix );
+VMMLIB_BENCHMARK_SIZES( quaternionSlerp );
+VMMLIB_BENCHMARK_SIZES( quaternionArrayNlerp );
+VMMLIB_BENCHMARK_SIZES( quaternionArraySlerp );
+VMMLIB_BENCHMARK_SIZES( quaternionArrayFastSlerp );
+VMMLIB_BENCHMARK_SIZES( quaternionArrayRotationMatrices );
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/aabb.hpp>
+#include <vmmlib/ray.hpp>
+#include <vmmlib/rayPacket.hpp>
+#include <vmmlib/types.hpp>
+
+#include <cstdlib>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+// Throughput of ray-object tests, items/s are rays tested against one object.
+// The working set size is the number of rays.
+namespace
+{
+const size_t nPacketRays = 1024;
+const size_t nObjects = 16;
+
+template< typename T > T _random( const T min, const T max )
+{
+    return min + ( max - min ) * T( rand( )) / T( RAND_MAX );
+}
+
+template< typename T > struct Scene
+{
+    typedef vmml::vector< 3, T > vec3;
+
+    explicit Scene( const size_t nRays )
+    {
+        srand( 42 );
+        rays.reserve( nRays );
+        for( size_t i = 0; i < nRays; ++i )
+            rays.push_back( vmml::Ray< T >( vec3( 0, 0, 10 ),
+                                            vec3( _random< T >( -.2, .2 ),
+                                                  _random< T >( -.2, .2 ),
+                                                  -1 )));
+        for( size_t i = 0; i < nObjects; ++i )
+        {
+            const vec3 center( _random< T >( -1, 1 ), _random< T >( -1, 1 ),
+                               _random< T >( -1, 1 ));
+            const T radius = _random< T >( .05, .2 );
+            spheres.push_back( vmml::vector< 4, T >( center, radius ));
+            boxes.push_back( vmml::AABB< T >( center - radius,
+                                              center + radius ));
+        }
+    }
+
+    std::vector< vmml::Ray< T > > rays;
+    std::vector< vmml::vector< 4, T > > spheres;
+    std::vector< vmml::AABB< T > > boxes;
+};
+
+template< typename T, size_t size > void raySphere( State& state )
+{
+    const Scene< T > scene( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+        {
+            T distance = -1;
+            for( size_t j = 0; j < nObjects; ++j )
+                distance = std::max( distance,
+                                     scene.rays[i].test( scene.spheres[j] ));
+            doNotOptimize( distance );
+        }
+    }
+    state.setItemsProcessed( state.getIterations() * size * nObjects );
+}
+
+template< typename T, size_t size > void rayAABB( State& state )
+{
+    const Scene< T > scene( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+        {
+            T distance = -1;
+            for( size_t j = 0; j < nObjects; ++j )
+                distance = std::max( distance,
+                                     scene.rays[i].test( scene.boxes[j] ));
+            doNotOptimize( distance );
+        }
+    }
+    state.setItemsProcessed( state.getIterations() * size * nObjects );
+}
+
+template< typename T, size_t size > void rayTriangle( State& state )
+{
+    typedef vmml::vector< 3, T > vec3;
+    const Scene< T > scene( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+        {
+            T distance = -1;
+            for( size_t j = 0; j < nObjects; ++j )
+            {
+                const vec3& a = scene.boxes[j].getMin();
+                const vec3& b = scene.boxes[j].getMax();
+                distance = std::max( distance, scene.rays[i].test( a, b,
+                                         vec3( a.x(), b.y(), a.z( ))));
+            }
+            doNotOptimize( distance );
+        }
+    }
+    state.setItemsProcessed( state.getIterations() * size * nObjects );
+}
+
+template< size_t N > void rayPacketSphere( State& state )
+{
+    const Scene< float > scene( nPacketRays );
+    std::vector< vmml::RayPacket< float, N > > packets;
+    for( size_t i = 0; i < nPacketRays; i += N )
+        packets.push_back( vmml::RayPacket< float, N >( &scene.rays[i] ));
+
+    float distances[ N ];
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < packets.size(); ++i )
+        {
+            unsigned hits = 0;
+            for( size_t j = 0; j < nObjects; ++j )
+                hits |= packets[i].test( scene.spheres[j], distances );
+            doNotOptimize( hits );
+        }
+    }
+    state.setItemsProcessed( state.getIterations() * nPacketRays * nObjects );
+}
+
+template< size_t N > void rayPacketAABB( State& state )
+{
+    const Scene< float > scene( nPacketRays );
+    std::vector< vmml::RayPacket< float, N > > packets;
+    for( size_t i = 0; i < nPacketRays; i += N )
+        packets.push_back( vmml::RayPacket< float, N >( &scene.rays[i] ));
+
+    float distances[ N ];
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < packets.size(); ++i )
+        {
+            unsigned hits = 0;
+            for( size_t j = 0; j < nObjects; ++j )
+                hits |= packets[i].test( scene.boxes[j], distances );
+            doNotOptimize( hits );
+        }
+    }
+    state.setItemsProcessed( state.getIterations() * nPacketRays * nObjects );
+}
+}
+
+VMMLIB_BENCHMARK_SIZES( raySphere );
+VMMLIB_BENCHMARK_SIZES( rayAABB );
+VMMLIB_BENCHMARK_SIZES( rayTriangle );
+VMMLIB_BENCHMARK_TEMPLATE( rayPacketSphere, 4 );
+VMMLIB_BENCHMARK_TEMPLATE( rayPacketSphere, 8 );
+VMMLIB_BENCHMARK_TEMPLATE( rayPacketSphere, 16 );
+VMMLIB_BENCHMARK_TEMPLATE( rayPacketAABB, 4 );
+VMMLIB_BENCHMARK_TEMPLATE( rayPacketAABB, 8 );
+VMMLIB_BENCHMARK_TEMPLATE( rayPacketAABB, 16 );
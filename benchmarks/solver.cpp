@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/solver.hpp>
+#include <vmmlib/types.hpp>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+// symmetric positive definite and diagonally dominant, valid for all solvers
+template< size_t N, typename T > vmml::Matrix< N, N, T > _makeMatrix()
+{
+    vmml::Matrix< N, N, T > matrix;
+    for( size_t i = 0; i < N; ++i )
+        for( size_t j = 0; j < N; ++j )
+            matrix( i, j ) = i == j ? T( N ) : T( 1 ) / T( 1 + i + j );
+    return matrix;
+}
+
+template< size_t N, typename T > vmml::vector< N, T > _makeVector()
+{
+    vmml::vector< N, T > vector;
+    for( size_t i = 0; i < N; ++i )
+        vector[i] = T( i % 3 ) - T( 1 );
+    return vector;
+}
+
+template< typename T > void inverse4ClosedForm( State& state )
+{
+    vmml::Matrix< 4, 4, T > matrix = _makeMatrix< 4, T >();
+    while( state.keepRunning( ))
+    {
+        doNotOptimize( matrix );
+        vmml::Matrix< 4, 4, T > result = matrix.inverse();
+        doNotOptimize( result );
+    }
+    state.setItemsProcessed( state.getIterations( ));
+}
+
+template< class Solver, size_t N, typename T > void _inverse( State& state )
+{
+    vmml::Matrix< N, N, T > matrix = _makeMatrix< N, T >();
+    while( state.keepRunning( ))
+    {
+        doNotOptimize( matrix );
+        vmml::Matrix< N, N, T > result = Solver( matrix ).inverse();
+        doNotOptimize( result );
+    }
+    state.setItemsProcessed( state.getIterations( ));
+}
+
+template< class Solver, size_t N, typename T > void _solve( State& state )
+{
+    vmml::Matrix< N, N, T > matrix = _makeMatrix< N, T >();
+    const vmml::vector< N, T > b = _makeVector< N, T >();
+    while( state.keepRunning( ))
+    {
+        doNotOptimize( matrix );
+        vmml::vector< N, T > x = Solver( matrix ).solve( b );
+        doNotOptimize( x );
+    }
+    state.setItemsProcessed( state.getIterations( ));
+}
+
+template< typename T, size_t N > void inverseLU( State& state )
+    { _inverse< vmml::LU< N, T >, N, T >( state ); }
+template< typename T, size_t N > void inverseCholesky( State& state )
+    { _inverse< vmml::Cholesky< N, T >, N, T >( state ); }
+template< typename T, size_t N > void inverseQR( State& state )
+    { _inverse< vmml::QR< N, N, T >, N, T >( state ); }
+
+template< typename T, size_t N > void solveLU( State& state )
+    { _solve< vmml::LU< N, T >, N, T >( state ); }
+template< typename T, size_t N > void solveCholesky( State& state )
+    { _solve< vmml::Cholesky< N, T >, N, T >( state ); }
+template< typename T, size_t N > void solveQR( State& state )
+    { _solve< vmml::QR< N, N, T >, N, T >( state ); }
+}
+
+VMMLIB_BENCHMARK_TEMPLATE( inverse4ClosedForm, float );
+VMMLIB_BENCHMARK_TEMPLATE( inverseLU, float, 4 );
+VMMLIB_BENCHMARK_TEMPLATE( inverseCholesky, float, 4 );
+VMMLIB_BENCHMARK_TEMPLATE( inverseQR, float, 4 );
+VMMLIB_BENCHMARK_TEMPLATE( inverse4ClosedForm, double );
+VMMLIB_BENCHMARK_TEMPLATE( inverseLU, double, 4 );
+VMMLIB_BENCHMARK_TEMPLATE( inverseCholesky, double, 4 );
+VMMLIB_BENCHMARK_TEMPLATE( inverseQR, double, 4 );
+
+VMMLIB_BENCHMARK_TEMPLATE( solveLU, float, 6 );
+VMMLIB_BENCHMARK_TEMPLATE( solveCholesky, float, 6 );
+VMMLIB_BENCHMARK_TEMPLATE( solveQR, float, 6 );
+VMMLIB_BENCHMARK_TEMPLATE( solveLU, double, 6 );
+VMMLIB_BENCHMARK_TEMPLATE( solveCholesky, double, 6 );
+VMMLIB_BENCHMARK_TEMPLATE( solveQR, double, 6 );
+VMMLIB_BENCHMARK_TEMPLATE( solveLU, double, 12 );
+VMMLIB_BENCHMARK_TEMPLATE( solveCholesky, double, 12 );
+VMMLIB_BENCHMARK_TEMPLATE( solveQR, double, 12 );
+VMMLIB_BENCHMARK_TEMPLATE( solveLU, double, 32 );
+VMMLIB_BENCHMARK_TEMPLATE( solveCholesky, double, 32 );
+VMMLIB_BENCHMARK_TEMPLATE( solveQR, double, 32 );
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/svd.hpp>
+#include <vmmlib/types.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+template< typename T >
+std::vector< vmml::Matrix< 3, 3, T > > _makeMatrices( const size_t size )
+{
+    std::vector< vmml::Matrix< 3, 3, T > > matrices( size );
+    srand( 42 );
+    for( size_t i = 0; i < size; ++i )
+        for( size_t j = 0; j < 9; ++j )
+            matrices[i].array[j] = T( rand( )) / T( RAND_MAX ) - T( .5 );
+    return matrices;
+}
+
+template< typename T >
+std::vector< vmml::Matrix< 3, 3, T > > _makeSymmetric( const size_t size )
+{
+    std::vector< vmml::Matrix< 3, 3, T > > matrices =
+        _makeMatrices< T >( size );
+    for( size_t i = 0; i < size; ++i )
+        matrices[i] = matrices[i] + vmml::transpose( matrices[i] );
+    return matrices;
+}
+
+// one decomposition per call as reference
+template< typename T, size_t size > void eigenScalar( State& state )
+{
+    const std::vector< vmml::Matrix< 3, 3, T > > matrices =
+        _makeSymmetric< T >( size );
+    std::vector< vmml::vector< 3, T > > values( size );
+    std::vector< vmml::Matrix< 3, 3, T > > vectors( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            vmml::computeEigen( matrices[i], values[i], vectors[i] );
+        doNotOptimize( values[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void eigen( State& state )
+{
+    const std::vector< vmml::Matrix< 3, 3, T > > matrices =
+        _makeSymmetric< T >( size );
+    std::vector< vmml::vector< 3, T > > values( size );
+    std::vector< vmml::Matrix< 3, 3, T > > vectors( size );
+    while( state.keepRunning( ))
+    {
+        vmml::computeEigen( matrices.data(), values.data(), vectors.data(),
+                            size );
+        doNotOptimize( values[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void svdScalar( State& state )
+{
+    const std::vector< vmml::Matrix< 3, 3, T > > matrices =
+        _makeMatrices< T >( size );
+    std::vector< vmml::Matrix< 3, 3, T > > u( size ), v( size );
+    std::vector< vmml::vector< 3, T > > sigma( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            vmml::computeSVD( matrices[i], u[i], sigma[i], v[i] );
+        doNotOptimize( sigma[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void svd( State& state )
+{
+    const std::vector< vmml::Matrix< 3, 3, T > > matrices =
+        _makeMatrices< T >( size );
+    std::vector< vmml::Matrix< 3, 3, T > > u( size ), v( size );
+    std::vector< vmml::vector< 3, T > > sigma( size );
+    while( state.keepRunning( ))
+    {
+        vmml::computeSVD( matrices.data(), u.data(), sigma.data(), v.data(),
+                          size );
+        doNotOptimize( sigma[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+}
+
+// The decompositions are compute bound; the DRAM working set of several
+// hundred MB would only add the page faults of its first run.
+VMMLIB_BENCHMARK_SIZE( eigenScalar, float, L1 );
+VMMLIB_BENCHMARK_SIZE( eigen, float, L1 );
+VMMLIB_BENCHMARK_SIZE( eigen, float, L2 );
+VMMLIB_BENCHMARK_SIZE( eigenScalar, double, L1 );
+VMMLIB_BENCHMARK_SIZE( eigen, double, L1 );
+VMMLIB_BENCHMARK_SIZE( eigen, double, L2 );
+VMMLIB_BENCHMARK_SIZE( svdScalar, float, L1 );
+VMMLIB_BENCHMARK_SIZE( svd, float, L1 );
+VMMLIB_BENCHMARK_SIZE( svd, float, L2 );
+VMMLIB_BENCHMARK_SIZE( svdScalar, double, L1 );
+VMMLIB_BENCHMARK_SIZE( svd, double, L1 );
+VMMLIB_BENCHMARK_SIZE( svd, double, L2 );
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/transformArray.hpp>
+#include <vmmlib/types.hpp>
+
+#include <vector>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+namespace
+{
+template< typename T > vmml::Matrix< 4, 4, T > _makeMatrix()
+{
+    vmml::Matrix< 4, 4, T > matrix;
+    matrix.rotate_x( T( .1 ));
+    matrix.rotate_y( T( .2 ));
+    matrix.setTranslation( vmml::vector< 3, T >( 1, 2, 3 ));
+    return matrix;
+}
+
+// one matrix-vector product per point as reference
+template< typename T, size_t size > void transformPointsScalar( State& state )
+{
+    typedef vmml::vector< 3, T > vec3;
+    const vmml::Matrix< 4, 4, T > matrix = _makeMatrix< T >();
+    std::vector< vec3 > points( size, vec3( 1, 2, 3 ));
+    std::vector< vec3 > result( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            result[i] = matrix * points[i];
+        doNotOptimize( result[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size, vmml::TransformMode mode >
+void _transformPoints( State& state )
+{
+    typedef vmml::vector< 3, T > vec3;
+    const vmml::Matrix< 4, 4, T > matrix = _makeMatrix< T >();
+    std::vector< vec3 > points( size, vec3( 1, 2, 3 ));
+    std::vector< vec3 > result( size );
+    while( state.keepRunning( ))
+    {
+        vmml::transform( matrix, points.data(), result.data(), size, mode );
+        doNotOptimize( result[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void transformPoints( State& state )
+{
+    _transformPoints< T, size, vmml::TRANSFORM_POINT >( state );
+}
+
+template< typename T, size_t size >
+void transformPointsProjective( State& state )
+{
+    _transformPoints< T, size, vmml::TRANSFORM_PROJECTIVE >( state );
+}
+
+template< typename T, size_t size > void transformNormals( State& state )
+{
+    _transformPoints< T, size, vmml::TRANSFORM_NORMAL >( state );
+}
+
+template< typename T, size_t size > void transformVector4( State& state )
+{
+    typedef vmml::vector< 4, T > vec4;
+    const vmml::Matrix< 4, 4, T > matrix = _makeMatrix< T >();
+    std::vector< vec4 > points( size, vec4( 1, 2, 3, 1 ));
+    std::vector< vec4 > result( size );
+    while( state.keepRunning( ))
+    {
+        vmml::transform( matrix, points.data(), result.data(), size );
+        doNotOptimize( result[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+}
+
+VMMLIB_BENCHMARK_SIZES( transformPointsScalar );
+VMMLIB_BENCHMARK_SIZES( transformPoints );
+VMMLIB_BENCHMARK_SIZES( transformPointsProjective );
+VMMLIB_BENCHMARK_SIZES( transformNormals );
+VMMLIB_BENCHMARK_SIZES( transformVector4 );
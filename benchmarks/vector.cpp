@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "benchmark.hpp"
+
+#include <vmmlib/expression.hpp>
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/types.hpp>
+#include <vmmlib/vector.hpp>
+
+#include <cstdlib>
+
+using vmml::benchmark::State;
+using vmml::benchmark::doNotOptimize;
+
+// Compares the kernels using unchecked element access against the same loops
+// written with the range-checked at(), which is what operator() did before.
+// With constant indices the compiler often removes the checks after
+// unrolling; with runtime indices they remain as a compare and branch per
+// access and prevent vectorization. Compare the generated code with -S.
+namespace
+{
+const size_t nVectors = 4096;
+
+struct Data
+{
+    Data() : vectors( nVectors ), results( nVectors )
+    {
+        srand( 42 );
+        for( size_t i = 0; i < nVectors; ++i )
+            for( size_t j = 0; j < 4; ++j )
+                vectors[i]( j ) = float( rand( )) / float( RAND_MAX );
+        for( size_t i = 0; i < 16; ++i )
+            matrix.array[i] = float( rand( )) / float( RAND_MAX );
+    }
+
+    std::vector< vmml::Vector4f > vectors;
+    std::vector< vmml::Vector4f > results;
+    vmml::Matrix4f matrix;
+};
+
+Data& _getData()
+{
+    static Data data;
+    return data;
+}
+
+float _checkedDot( const vmml::Vector4f& a, const vmml::Vector4f& b )
+{
+    float result = 0;
+    for( size_t i = 0; i < 4; ++i )
+        result += a.at( i ) * b.at( i );
+    return result;
+}
+
+vmml::Vector4f _checkedMultiply( const vmml::Matrix4f& matrix,
+                                 const vmml::Vector4f& vector )
+{
+    vmml::Vector4f result;
+    for( size_t i = 0; i < 4; ++i )
+    {
+        float tmp = 0;
+        for( size_t j = 0; j < 4; ++j )
+            tmp += matrix( i, j ) * vector.at( j );
+        result.at( i ) = tmp;
+    }
+    return result;
+}
+
+void vectorAccessChecked( State& state )
+{
+    Data& data = _getData();
+    while( state.keepRunning( ))
+    {
+        float sum = 0;
+        for( size_t i = 0; i < nVectors; ++i )
+            sum += data.vectors[i].at( i % 3 );
+        doNotOptimize( sum );
+    }
+    state.setItemsProcessed( state.getIterations() * nVectors );
+}
+
+void vectorAccess( State& state )
+{
+    Data& data = _getData();
+    while( state.keepRunning( ))
+    {
+        float sum = 0;
+        for( size_t i = 0; i < nVectors; ++i )
+            sum += data.vectors[i]( i % 3 );
+        doNotOptimize( sum );
+    }
+    state.setItemsProcessed( state.getIterations() * nVectors );
+}
+
+void vectorDotChecked( State& state )
+{
+    Data& data = _getData();
+    while( state.keepRunning( ))
+    {
+        float sum = 0;
+        for( size_t i = 1; i < nVectors; ++i )
+            sum += _checkedDot( data.vectors[i - 1], data.vectors[i] );
+        doNotOptimize( sum );
+    }
+    state.setItemsProcessed( state.getIterations() * ( nVectors - 1 ));
+}
+
+void vectorDot( State& state )
+{
+    Data& data = _getData();
+    while( state.keepRunning( ))
+    {
+        float sum = 0;
+        for( size_t i = 1; i < nVectors; ++i )
+            sum += data.vectors[i - 1].dot( data.vectors[i] );
+        doNotOptimize( sum );
+    }
+    state.setItemsProcessed( state.getIterations() * ( nVectors - 1 ));
+}
+
+void vectorMatrixMultiplyChecked( State& state )
+{
+    Data& data = _getData();
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < nVectors; ++i )
+            data.results[i] = _checkedMultiply( data.matrix, data.vectors[i] );
+        doNotOptimize( data.results[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * nVectors );
+}
+
+void vectorMatrixMultiply( State& state )
+{
+    Data& data = _getData();
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < nVectors; ++i )
+            data.results[i] = data.matrix * data.vectors[i];
+        doNotOptimize( data.results[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * nVectors );
+}
+
+// Element-wise operations on arrays of 3-component vectors
+template< typename T > std::vector< vmml::vector< 3, T > > _makeVectors(
+    const size_t size )
+{
+    std::vector< vmml::vector< 3, T > > vectors( size );
+    srand( 42 );
+    for( size_t i = 0; i < size; ++i )
+        for( size_t j = 0; j < 3; ++j )
+            vectors[i].array[j] = T( rand( )) / T( RAND_MAX ) + T( .1 );
+    return vectors;
+}
+
+template< typename T, size_t size > void vector3Add( State& state )
+{
+    std::vector< vmml::vector< 3, T > > vectors = _makeVectors< T >( size );
+    const vmml::vector< 3, T > offset( 1, 2, 3 );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            vectors[i] += offset;
+        doNotOptimize( vectors[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void vector3Dot( State& state )
+{
+    const std::vector< vmml::vector< 3, T > > vectors =
+        _makeVectors< T >( size );
+    const vmml::vector< 3, T > axis( 1, 2, 3 );
+    while( state.keepRunning( ))
+    {
+        T sum = 0;
+        for( size_t i = 0; i < size; ++i )
+            sum += vectors[i].dot( axis );
+        doNotOptimize( sum );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void vector3Cross( State& state )
+{
+    std::vector< vmml::vector< 3, T > > vectors = _makeVectors< T >( size );
+    const vmml::vector< 3, T > axis( 0, 0, 1 );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            vectors[i] = vmml::cross( vectors[i], axis );
+        doNotOptimize( vectors[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+template< typename T, size_t size > void vector3Normalize( State& state )
+{
+    std::vector< vmml::vector< 3, T > > vectors = _makeVectors< T >( size );
+    while( state.keepRunning( ))
+    {
+        for( size_t i = 0; i < size; ++i )
+            vectors[i].normalize();
+        doNotOptimize( vectors[0] );
+    }
+    state.setItemsProcessed( state.getIterations() * size );
+}
+
+// a * s + b * t - c on long vectors, with the eager operators creating a
+// temporary per operation versus a single pass through vmml::lazy()
+template< size_t M, typename T > struct Axpby
+{
+    Axpby()
+    {
+        srand( 42 );
+        for( size_t i = 0; i < M; ++i )
+        {
+            a.array[i] = T( rand( )) / T( RAND_MAX );
+            b.array[i] = T( rand( )) / T( RAND_MAX );
+            c.array[i] = T( rand( )) / T( RAND_MAX );
+        }
+    }
+
+    vmml::vector< M, T > a, b, c, result;
+};
+
+template< size_t M, typename T > void vectorAxpbyEager( State& state )
+{
+    Axpby< M, T > data;
+    const T s = T( .5 );
+    const T t = T( 2 );
+    while( state.keepRunning( ))
+    {
+        doNotOptimize( data.a );
+        data.result = data.a * s + data.b * t - data.c;
+        doNotOptimize( data.result );
+    }
+    state.setItemsProcessed( state.getIterations( ));
+}
+
+template< size_t M, typename T > void vectorAxpbyLazy( State& state )
+{
+    Axpby< M, T > data;
+    const T s = T( .5 );
+    const T t = T( 2 );
+    while( state.keepRunning( ))
+    {
+        doNotOptimize( data.a );
+        data.result = vmml::lazy( data.a ) * s + vmml::lazy( data.b ) * t -
+                      data.c;
+        doNotOptimize( data.result );
+    }
+    state.setItemsProcessed( state.getIterations( ));
+}
+}
+
+VMMLIB_BENCHMARK( vectorAccessChecked );
+VMMLIB_BENCHMARK( vectorAccess );
+VMMLIB_BENCHMARK( vectorDotChecked );
+VMMLIB_BENCHMARK( vectorDot );
+VMMLIB_BENCHMARK( vectorMatrixMultiplyChecked );
+VMMLIB_BENCHMARK( vectorMatrixMultiply );
+VMMLIB_BENCHMARK_SIZES( vector3Add );
+VMMLIB_BENCHMARK_SIZES( vector3Dot );
+VMMLIB_BENCHMARK_SIZES( vector3Cross );
+VMMLIB_BENCHMARK_SIZES( vector3Normalize );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyEager, 16, float );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyLazy, 16, float );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyEager, 16, double );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyLazy, 16, double );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyEager, 64, float );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyLazy, 64, float );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyEager, 64, double );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyLazy, 64, double );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyEager, 256, float );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyLazy, 256, float );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyEager, 256, double );
+VMMLIB_BENCHMARK_TEMPLATE( vectorAxpbyLazy, 256, double );
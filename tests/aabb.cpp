@@ -27,11 +27,17 @@
  */
 
 #include <vmmlib/aabb.hpp>
+#include <vmmlib/matrix.hpp>
 #include <vmmlib/types.hpp>
 
 #define BOOST_TEST_MODULE axisAlignedBoundingBox
 #include <boost/test/unit_test.hpp>
 
+#include "random.hpp"
+
+#include <cstdlib>
+#include <vector>
+
 BOOST_AUTO_TEST_CASE(axisAlignedBoundingBox_base)
 {
     vmml::AABBf box1;
@@ -59,3 +65,140 @@ BOOST_AUTO_TEST_CASE(axisAlignedBoundingBox_base)
     box1.merge( box2 );
     BOOST_CHECK_EQUAL( box1, box2 );
 }
+
+template< typename T > static void _testFromPoints()
+{
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::AABB< T > AABB;
+
+    BOOST_CHECK( AABB::fromPoints( 0, 0 ) == AABB( ));
+    BOOST_CHECK( AABB::fromBoxes( 0, 0 ) == AABB( ));
+
+    // sizes around the SIMD widths and several parallel chunks
+    const size_t sizes[] = { 1, 2, 3, 5, 8, 17, 33, 1003, 50001 };
+    srand( 42 );
+    for( size_t i = 0; i < sizeof( sizes ) / sizeof( size_t ); ++i )
+    {
+        const size_t n = sizes[i];
+        std::vector< vec3 > points( n );
+        std::vector< AABB > boxes( n );
+        AABB expectedPoints, expectedBoxes;
+        for( size_t j = 0; j < n; ++j )
+        {
+            points[j] = vec3( _random< T >( -10, 10 ), _random< T >( -20, 5 ),
+                              _random< T >( -1, 30 ));
+            expectedPoints.merge( points[j] );
+
+            // including empty boxes, which are ignored
+            if( j % 7 != 3 )
+                boxes[j] = AABB( points[j], points[j] +
+                                    vec3( _random< T >( 0, 1 )));
+            expectedBoxes.merge( boxes[j] );
+        }
+
+        BOOST_CHECK_EQUAL( AABB::fromPoints( &points[0], &points[0] + n ),
+                           expectedPoints );
+        BOOST_CHECK_EQUAL( AABB::fromBoxes( &boxes[0], &boxes[0] + n ),
+                           expectedBoxes );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( fromPoints )
+{
+    _testFromPoints< float >();
+    _testFromPoints< double >();
+}
+
+template< typename T > static vmml::Matrix< 4, 4, T > _randomAffine()
+{
+    vmml::Matrix< 4, 4, T > matrix;
+    for( size_t i = 0; i < 3; ++i )
+        for( size_t j = 0; j < 4; ++j )
+            matrix( i, j ) = _random< T >( -3, 3 );
+    return matrix;
+}
+
+template< typename T >
+static void _checkClose( const vmml::AABB< T >& a, const vmml::AABB< T >& b )
+{
+    for( size_t k = 0; k < 3; ++k )
+    {
+        BOOST_CHECK_SMALL( a.getMin()[k] - b.getMin()[k], T( 1e-4 ));
+        BOOST_CHECK_SMALL( a.getMax()[k] - b.getMax()[k], T( 1e-4 ));
+    }
+}
+
+template< typename T > static void _testTransform()
+{
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::vector< 4, T > vec4;
+    typedef vmml::Matrix< 4, 4, T > Matrix4;
+    typedef vmml::AABB< T > AABB;
+
+    srand( 42 );
+    const AABB box( vec3( -1, 2, 0 ), vec3( 3, 5, 1 ));
+    BOOST_CHECK_EQUAL( box.transform( Matrix4( )), box );
+    BOOST_CHECK( AABB().transform( _randomAffine< T >( )) == AABB( ));
+
+    // the bounding box of the transformed corners, up to rounding
+    for( size_t i = 0; i < 100; ++i )
+    {
+        const Matrix4 matrix = _randomAffine< T >();
+        const AABB transformed = box.transform( matrix );
+        AABB expected;
+        for( size_t j = 0; j < 8; ++j )
+        {
+            const vec4 corner( j & 1 ? box.getMax().x() : box.getMin().x(),
+                               j & 2 ? box.getMax().y() : box.getMin().y(),
+                               j & 4 ? box.getMax().z() : box.getMin().z(),
+                               1 );
+            const vec4 point = matrix * corner;
+            expected.merge( vec3( point.x(), point.y(), point.z( )));
+        }
+        _checkClose( transformed, expected );
+    }
+
+    // batches around the SIMD widths and several parallel chunks
+    const size_t sizes[] = { 1, 3, 8, 17, 1003, 50001 };
+    for( size_t i = 0; i < sizeof( sizes ) / sizeof( size_t ); ++i )
+    {
+        const size_t n = sizes[i];
+        std::vector< Matrix4 > matrices( n );
+        std::vector< AABB > boxes( n );
+        for( size_t j = 0; j < n; ++j )
+        {
+            matrices[j] = _randomAffine< T >();
+            const vec3 point( _random< T >( -10, 10 ), _random< T >( -20, 5 ),
+                              _random< T >( -1, 30 ));
+            if( j % 7 != 3 )
+                boxes[j] = AABB( point, point + vec3( _random< T >( 0, 1 )));
+        }
+
+        std::vector< AABB > result( n );
+        vmml::transform( &matrices[0], &boxes[0], &result[0], n );
+        for( size_t j = 0; j < n; ++j )
+        {
+            if( j % 7 == 3 )
+                BOOST_CHECK( result[j] == AABB( ));
+            else
+                _checkClose( result[j], boxes[j].transform( matrices[j] ));
+        }
+
+        // one matrix for all boxes, in place
+        result = boxes;
+        vmml::transform( matrices[0], &result[0], &result[0], n );
+        for( size_t j = 0; j < n; ++j )
+        {
+            if( j % 7 == 3 )
+                BOOST_CHECK( result[j] == AABB( ));
+            else
+                _checkClose( result[j], boxes[j].transform( matrices[0] ));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( transform )
+{
+    _testTransform< float >();
+    _testTransform< double >();
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/aabb.hpp>
+#include <vmmlib/aabb4f.hpp>
+#include <vmmlib/types.hpp>
+#include <vmmlib/vector.hpp>
+
+#define BOOST_TEST_MODULE aabb4f
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+vmml::Vector3f _randomPoint()
+{
+    return vmml::Vector3f( _random< float >( -10, 10 ),
+                           _random< float >( -10, 10 ),
+                           _random< float >( -10, 10 ));
+}
+
+vmml::AABBf _randomBox()
+{
+    const vmml::Vector3f min = _randomPoint();
+    return vmml::AABBf( min, min + vmml::Vector3f( _random< float >( 0, 8 ),
+                                                   _random< float >( 0, 8 ),
+                                                   _random< float >( 0, 8 )));
+}
+
+// reference overlap test on the scalar boxes
+bool _intersects( const vmml::AABBf& a, const vmml::AABBf& b )
+{
+    for( size_t i = 0; i < 3; ++i )
+        if( a.getMin()[i] > b.getMax()[i] || b.getMin()[i] > a.getMax()[i] )
+            return false;
+    return true;
+}
+}
+
+BOOST_AUTO_TEST_CASE( base )
+{
+    BOOST_CHECK_EQUAL( sizeof( vmml::AABB4f ), 32 );
+
+    vmml::AABB4f box;
+    BOOST_CHECK( box.isEmpty( ));
+    BOOST_CHECK_EQUAL( box.getSurfaceArea(), 0.f );
+    BOOST_CHECK( box.getAABB() == vmml::AABBf( ));
+    BOOST_CHECK( vmml::AABB4f( vmml::AABBf( )) == box );
+    BOOST_CHECK( !box.isIn( vmml::Vector3f( 0.f, 0.f, 0.f )));
+
+    const vmml::Vector3f p1( 0.f, 0.f, 0.f );
+    const vmml::Vector3f p2( 1.f, 2.f, 3.f );
+    box.merge( p1 );
+    BOOST_CHECK( !box.isEmpty( ));
+    BOOST_CHECK_EQUAL( box.getMin(), p1 );
+    BOOST_CHECK_EQUAL( box.getMax(), p1 );
+    BOOST_CHECK( box.isIn( p1 ));
+
+    box.merge( p2 );
+    BOOST_CHECK_EQUAL( box.getMin(), p1 );
+    BOOST_CHECK_EQUAL( box.getMax(), p2 );
+    BOOST_CHECK_EQUAL( box.getSize(), p2 );
+    BOOST_CHECK_EQUAL( box.getCenter(), p2 * .5f );
+    BOOST_CHECK_EQUAL( box.getSurfaceArea(), 22.f );
+    BOOST_CHECK( box == vmml::AABB4f( p2, p1 ));
+    BOOST_CHECK( box != vmml::AABB4f( p1, p1 ));
+
+    box.reset();
+    BOOST_CHECK( box.isEmpty( ));
+}
+
+BOOST_AUTO_TEST_CASE( compare )
+{
+    // the same results as AABB< float > for random boxes and points
+    srand( 42 );
+    std::vector< vmml::AABB4f > boxes;
+    size_t nOverlaps = 0;
+    for( size_t i = 0; i < 1000; ++i )
+    {
+        const vmml::AABBf a = _randomBox();
+        const vmml::AABBf b = _randomBox();
+        const vmml::Vector3f point = _randomPoint();
+        const vmml::AABB4f a4( a );
+        const vmml::AABB4f b4( b );
+        boxes.push_back( a4 );
+
+        BOOST_CHECK_EQUAL( a4.getAABB(), a );
+        BOOST_CHECK_EQUAL( a4.getMin(), a.getMin( ));
+        BOOST_CHECK_EQUAL( a4.getMax(), a.getMax( ));
+        BOOST_CHECK_EQUAL( a4.getSize(), a.getSize( ));
+        BOOST_CHECK_EQUAL( a4.getCenter(), a.getCenter( ));
+        BOOST_CHECK_EQUAL( a4.isIn( point ), a.isIn( point ));
+        BOOST_CHECK_EQUAL( a4.intersects( b4 ), _intersects( a, b ));
+        BOOST_CHECK_EQUAL( a4.intersects( b4 ), b4.intersects( a4 ));
+        if( a4.intersects( b4 ))
+            ++nOverlaps;
+
+        const vmml::Vector3f size = a.getSize();
+        BOOST_CHECK_CLOSE( a4.getSurfaceArea(),
+                           2.f * ( size.x() * size.y() + size.y() * size.z() +
+                                   size.z() * size.x( )), 1e-4f );
+
+        vmml::AABBf merged = a;
+        merged.merge( b );
+        merged.merge( point );
+        vmml::AABB4f merged4 = a4;
+        merged4.merge( b4 );
+        merged4.merge( point );
+        BOOST_CHECK_EQUAL( merged4.getAABB(), merged );
+        BOOST_CHECK( merged4.isIn( point ));
+    }
+    BOOST_CHECK_GT( nOverlaps, 0 );
+    BOOST_CHECK_LT( nOverlaps, 1000 );
+
+    // boxes in arrays are aligned for the SIMD loads
+    for( size_t i = 0; i < boxes.size(); ++i )
+        BOOST_CHECK_EQUAL( size_t( &boxes[i] ) % 16, 0 );
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/bvh.hpp>
+#include <vmmlib/frustum.hpp>
+#include <vmmlib/types.hpp>
+
+#define BOOST_TEST_MODULE bvh
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+template< typename T >
+vmml::AABB< T > _getBounds( const vmml::vector< 4, T >& sphere )
+{
+    const vmml::vector< 3, T > center( sphere.x(), sphere.y(), sphere.z( ));
+    return vmml::AABB< T >( center - sphere.w(), center + sphere.w( ));
+}
+
+template< typename T > struct SphereIntersector
+{
+    explicit SphereIntersector( const std::vector< vmml::vector< 4, T > >& s )
+        : spheres( s ) {}
+
+    T operator()( const vmml::Ray< T >& ray, const uint32_t primitive ) const
+        { return ray.test( spheres[ primitive ] ); }
+
+    const std::vector< vmml::vector< 4, T > >& spheres;
+};
+
+template< typename T >
+void _checkTree( const vmml::BVH< T >& bvh,
+                 const std::vector< vmml::AABB< T > >& boxes,
+                 const size_t leafSize )
+{
+    typedef typename vmml::BVH< T >::Node Node;
+    const std::vector< Node >& nodes = bvh.getNodes();
+    const std::vector< uint32_t >& indices = bvh.getIndices();
+
+    std::vector< uint32_t > sorted( indices );
+    std::sort( sorted.begin(), sorted.end( ));
+    for( size_t i = 0; i < sorted.size(); ++i )
+        BOOST_REQUIRE_EQUAL( sorted[i], i );
+
+    size_t primitives = 0;
+    for( size_t i = 0; i < nodes.size(); ++i )
+    {
+        const Node& node = nodes[i];
+        const vmml::AABB< T > bounds = node.getBounds();
+        if( node.isLeaf( ))
+        {
+            BOOST_CHECK_LE( node.count, leafSize );
+            primitives += node.count;
+            for( size_t j = 0; j < node.count; ++j )
+            {
+                const vmml::AABB< T >& box = boxes[ indices[ node.offset + j ]];
+                BOOST_CHECK( bounds.isIn( box.getMin( )));
+                BOOST_CHECK( bounds.isIn( box.getMax( )));
+            }
+            continue;
+        }
+        BOOST_REQUIRE_GT( node.offset, i + 1 );
+        BOOST_REQUIRE_LT( node.offset, nodes.size( ));
+        for( size_t child = i + 1; child <= node.offset; child += node.offset -
+                                                                  i - 1 )
+        {
+            BOOST_CHECK( bounds.isIn( nodes[ child ].min ));
+            BOOST_CHECK( bounds.isIn( nodes[ child ].max ));
+        }
+    }
+    BOOST_CHECK_EQUAL( primitives, boxes.size( ));
+}
+
+template< typename T >
+void _checkQueries( const vmml::BVH< T >& bvh,
+                    const std::vector< vmml::vector< 4, T > >& spheres,
+                    const std::vector< vmml::AABB< T > >& boxes,
+                    const bool exact )
+{
+    typedef vmml::vector< 3, T > vec3;
+
+    const vmml::Frustum< T > frustum( -1, 1, -1, 1, 1, 100 );
+    const vmml::FrustumCuller< T > culler( frustum.computePerspectiveMatrix( ));
+    std::vector< uint32_t > visible;
+    const size_t nVisible = bvh.cull( culler, visible );
+    BOOST_CHECK_EQUAL( nVisible, visible.size( ));
+    std::sort( visible.begin(), visible.end( ));
+
+    std::vector< uint32_t > expected;
+    for( size_t i = 0; i < boxes.size(); ++i )
+        if( culler.test( boxes[i] ) != vmml::VISIBILITY_NONE )
+            expected.push_back( uint32_t( i ));
+    BOOST_CHECK( !expected.empty( ));
+    if( exact )
+        BOOST_CHECK( visible == expected );
+    else
+        BOOST_CHECK( std::includes( visible.begin(), visible.end(),
+                                    expected.begin(), expected.end( )));
+
+    const SphereIntersector< T > intersector( spheres );
+    size_t hits = 0;
+    for( size_t i = 0; i < 200; ++i )
+    {
+        const vmml::Ray< T > ray( vec3( 0, 0, 20 ),
+                                  vec3( _random< T >( -1, 1 ),
+                                        _random< T >( -1, 1 ), -1 ));
+        uint32_t closest = vmml::BVH< T >::INVALID;
+        T closestDistance = std::numeric_limits< T >::max();
+        for( size_t j = 0; j < spheres.size(); ++j )
+        {
+            const T t = ray.test( spheres[j] );
+            if( t >= 0 && t < closestDistance )
+            {
+                closest = uint32_t( j );
+                closestDistance = t;
+            }
+        }
+
+        T distance = -1;
+        BOOST_CHECK_EQUAL( bvh.intersect( ray, intersector, distance ),
+                           closest );
+        if( closest != vmml::BVH< T >::INVALID )
+        {
+            BOOST_CHECK_EQUAL( distance, closestDistance );
+            ++hits;
+        }
+    }
+    BOOST_CHECK_GT( hits, 0 );
+}
+
+template< typename T > void _testBVH( const bool lbvh )
+{
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::vector< 4, T > vec4;
+
+    const size_t n = 2000;
+    std::vector< vec4 > spheres( n );
+    std::vector< vmml::AABB< T > > boxes( n );
+    srand( 42 );
+    for( size_t i = 0; i < n; ++i )
+    {
+        spheres[i] = vec4( _random< T >( -50, 50 ), _random< T >( -50, 50 ),
+                           _random< T >( -120, 20 ), _random< T >( 0, 2 ));
+        boxes[i] = _getBounds( spheres[i] );
+    }
+
+    for( size_t leafSize = 1; leafSize <= 8; leafSize *= 8 )
+    {
+        vmml::BVH< T > bvh;
+        if( lbvh )
+            bvh.buildLBVH( boxes.data(), n, leafSize );
+        else
+            bvh.buildSAH( boxes.data(), n, leafSize );
+        _checkTree( bvh, boxes, leafSize );
+        _checkQueries( bvh, spheres, boxes, leafSize == 1 );
+
+        // move all primitives and update the tree
+        for( size_t i = 0; i < n; ++i )
+        {
+            spheres[i] += vec4( _random< T >( -5, 5 ), _random< T >( -5, 5 ),
+                                _random< T >( -5, 5 ), 0 );
+            boxes[i] = _getBounds( spheres[i] );
+        }
+        bvh.refit( boxes.data( ));
+        _checkTree( bvh, boxes, leafSize );
+        _checkQueries( bvh, spheres, boxes, leafSize == 1 );
+    }
+
+    // degenerate input: all primitives at the same position
+    const std::vector< vmml::AABB< T > > same( 100, vmml::AABB< T >(
+                                                   vec3( 1, 2, 3 ),
+                                                   vec3( 2, 3, 4 )));
+    vmml::BVH< T > bvh;
+    if( lbvh )
+        bvh.buildLBVH( same.data(), same.size( ));
+    else
+        bvh.buildSAH( same.data(), same.size( ));
+    _checkTree( bvh, same, 4 );
+    BOOST_CHECK_EQUAL( bvh.getBounds(), same.front( ));
+}
+}
+
+BOOST_AUTO_TEST_CASE( empty )
+{
+    vmml::BVHf bvh;
+    bvh.buildSAH( 0, 0 );
+    BOOST_CHECK( bvh.isEmpty( ));
+
+    const vmml::Frustumf frustum( -1, 1, -1, 1, 1, 100 );
+    const vmml::FrustumCullerf culler( frustum.computePerspectiveMatrix( ));
+    std::vector< uint32_t > visible;
+    BOOST_CHECK_EQUAL( bvh.cull( culler, visible ), 0 );
+
+    const std::vector< vmml::Vector4f > spheres;
+    SphereIntersector< float > intersector( spheres );
+    float distance = 0;
+    BOOST_CHECK_EQUAL( bvh.intersect( vmml::Rayf( vmml::Vector3f::ZERO,
+                                                  vmml::Vector3f::UNIT_Z ),
+                                      intersector, distance ),
+                       vmml::BVHf::INVALID );
+
+    BOOST_CHECK_THROW( bvh.buildLBVH( 0, 0, 0 ), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( sah )
+{
+    _testBVH< float >( false );
+    _testBVH< double >( false );
+}
+
+BOOST_AUTO_TEST_CASE( lbvh )
+{
+    _testBVH< float >( true );
+    _testBVH< double >( true );
+}
@@ -0,0 +1,540 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/dispatch.hpp>
+#include <vmmlib/dualQuaternion.hpp>
+#include <vmmlib/frustum.hpp>
+#include <vmmlib/frustumCuller.hpp>
+#include <vmmlib/lodSelector.hpp>
+#include <vmmlib/multiFrustumCuller.hpp>
+#include <vmmlib/obb.hpp>
+#include <vmmlib/packed.hpp>
+#include <vmmlib/quaternionArray.hpp>
+#include <vmmlib/rayPacket.hpp>
+#include <vmmlib/svd.hpp>
+#include <vmmlib/transformArray.hpp>
+#include <vmmlib/types.hpp>
+
+#define BOOST_TEST_MODULE dispatch
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+#include <cstdlib>
+
+namespace
+{
+template< typename T > bool _equals( const std::vector< T >& a,
+                                     const std::vector< T >& b,
+                                     const T epsilon )
+{
+    if( a.size() != b.size( ))
+        return false;
+    for( size_t i = 0; i < a.size(); ++i )
+        if( std::abs( a[i] - b[i] ) > epsilon * std::max( T( 1 ),
+                                                          std::abs( b[i] )))
+            return false;
+    return true;
+}
+
+// The results of all batch kernels at the current SIMD level
+template< typename T > struct Results
+{
+    std::vector< vmml::Visibility > spheres, boxes;
+    std::vector< uint32_t > visibleSpheres, visibleBoxes;
+    std::vector< uint32_t > sphereViews, boxViews;
+    std::vector< vmml::Visibility > lodSpheres, lodBoxes;
+    std::vector< uint32_t > sphereLODs, boxLODs;
+    std::vector< T > points, projected, homogeneous, products, skinned;
+    std::vector< T > interpolated, rotations;
+    std::vector< T > quaternions, normals, halves;
+    std::vector< uint16_t > halfBits;
+    std::vector< T > eigenvalues, singularValues;
+    std::vector< T > sphereDistances, boxDistances;
+    std::vector< unsigned > sphereHits, boxHits;
+    std::vector< T > obbAxes, obbBoxes, bounds, transformedBoxes;
+};
+
+template< typename T > class Kernels
+{
+public:
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::vector< 4, T > vec4;
+    typedef vmml::Matrix< 4, 4, T > Matrix;
+    enum { PACKET_SIZE = 16, VIEWS = 3 };
+
+    // odd sizes to exercise the scalar tails
+    Kernels()
+        : _culler( vmml::Frustum< T >( -1, 1, -1, 1, 1, 100 )
+                       .computePerspectiveMatrix( ))
+        , _n( 1001 )
+        , _quaternionsA( _n )
+        , _quaternionsB( _n )
+    {
+        srand( 42 );
+        for( size_t i = 0; i < _n; ++i )
+        {
+            const vec4 sphere( _random< T >( -50, 50 ),
+                               _random< T >( -50, 50 ),
+                               _random< T >( -120, 20 ),
+                               _random< T >( 0, 10 ));
+            for( size_t j = 0; j < 3; ++j )
+            {
+                _centers[j].push_back( sphere[j] );
+                _min[j].push_back( sphere[j] - sphere.w( ));
+                _max[j].push_back( sphere[j] + sphere.w( ));
+            }
+            _radii.push_back( sphere.w( ));
+            _boxes.push_back( vmml::AABB< T >(
+                vec3( _min[0].back(), _min[1].back(), _min[2].back( )),
+                vec3( _max[0].back(), _max[1].back(), _max[2].back( ))));
+            _transforms.push_back( Matrix( vmml::Quaternion< T >(
+                _random< T >( -3, 3 ), vec3( _random< T >( -1, 1 ), 0, 1 )),
+                vec3( _random< T >( -5, 5 ), _random< T >( -5, 5 ), 0 )));
+            for( size_t j = 0; j < 4; ++j )
+                _vectors.push_back( j < 3 ? sphere[j] : T( 1 ));
+
+            vmml::Vector4ui indices;
+            vec4 weights;
+            for( size_t j = 0; j < 4; ++j )
+            {
+                indices[j] = unsigned( rand( )) % 16;
+                weights[j] = _random< T >( 0, 1 );
+            }
+            _boneIndices.push_back( indices );
+            _boneWeights.push_back( weights / ( weights.x() + weights.y() +
+                                                weights.z() + weights.w( )));
+
+            _quaternionsA.set( i, vmml::Quaternion< T >(
+                _random< T >( -3, 3 ), vec3( 1, _random< T >( -1, 1 ), 0 )));
+            _quaternionsB.set( i, vmml::Quaternion< T >(
+                _random< T >( -3, 3 ), vec3( 0, 1, _random< T >( -1, 1 ))));
+            _parameters.push_back( _random< T >( 0, 1 ));
+        }
+        for( size_t i = 0; i < 16; ++i )
+            _bones.push_back( vmml::DualQuaternion< T >(
+                vmml::Quaternion< T >( _random< T >( -3, 3 ),
+                                       vec3( _random< T >( -1, 1 ), 1, 0 )),
+                vec3( _random< T >( -5, 5 ), _random< T >( -5, 5 ), 0 )));
+
+        _matrix.rotate_x( T( .3 ));
+        _matrix.scale( vec3( 1, 2, 3 ));
+        _matrix.setTranslation( vec3( 4, 5, 6 ));
+        _projection = vmml::Frustum< T >( -1, 1, -1, 1, 1, 100 )
+                          .computePerspectiveMatrix();
+
+        // views turned and moved along the x axis
+        Matrix views[ VIEWS ];
+        for( size_t i = 0; i < VIEWS; ++i )
+            views[i] = _projection * Matrix( vmml::Quaternion< T >(
+                           T( i ) * T( .5 ), vec3::UNIT_Y ),
+                           vec3( T( i ) * T( 10 ), 0, 0 ));
+        _multiCuller = vmml::MultiFrustumCuller< T, VIEWS >( views );
+
+        const T thresholds[] = { 100, 30, 10 };
+        _selector = vmml::LODSelector< T >( _projection, Matrix(), 1000,
+                                            thresholds, 3, 2 );
+
+        for( size_t i = 0; i < 33; ++i )
+        {
+            Matrix left, right;
+            for( size_t j = 0; j < 16; ++j )
+            {
+                left.array[j] = _random< T >( -2, 2 );
+                right.array[j] = _random< T >( -2, 2 );
+            }
+            _left.push_back( left );
+            _right.push_back( right );
+        }
+
+        for( size_t i = 0; i < PACKET_SIZE; ++i )
+            _rays.push_back( vmml::Ray< T >(
+                vec3( _random< T >( -1, 1 ), _random< T >( -1, 1 ), 10 ),
+                vec3( _random< T >( -.2f, .2f ), _random< T >( -.2f, .2f ),
+                      -1 )));
+        for( size_t i = 0; i < 100; ++i )
+            _targets.push_back( vec4( _random< T >( -1, 1 ),
+                                      _random< T >( -1, 1 ),
+                                      _random< T >( -1, 1 ),
+                                      _random< T >( .1f, 1 )));
+
+        // several chunks of points in a rotated box, including duplicates of
+        // the extremal points
+        const vmml::Matrix< 3, 3, T > rotation = vmml::Quaternion< T >(
+            T( .7 ), vmml::normalize( vec3( 1, 2, 3 ))).getRotationMatrix();
+        for( size_t i = 0; i < 50001; ++i )
+            _points.push_back( rotation * vec3( _random< T >( -3, 3 ),
+                                                _random< T >( -2, 2 ),
+                                                _random< T >( -1, 1 )));
+        for( size_t i = 0; i < 1000; ++i )
+            _points[ 20000 + i * 17 ] = _points[ i * 13 ];
+    }
+
+    Results< T > run() const
+    {
+        Results< T > results;
+        results.spheres.resize( _n );
+        results.boxes.resize( _n );
+        results.visibleSpheres.resize( _n );
+        results.visibleBoxes.resize( _n );
+        _culler.test( _centers[0].data(), _centers[1].data(),
+                      _centers[2].data(), _radii.data(), _n,
+                      results.spheres.data( ));
+        _culler.test( _min[0].data(), _min[1].data(), _min[2].data(),
+                      _max[0].data(), _max[1].data(), _max[2].data(), _n,
+                      results.boxes.data( ));
+        results.visibleSpheres.resize(
+            _culler.cull( _centers[0].data(), _centers[1].data(),
+                          _centers[2].data(), _radii.data(), _n,
+                          results.visibleSpheres.data( )));
+        results.visibleBoxes.resize(
+            _culler.cull( _min[0].data(), _min[1].data(), _min[2].data(),
+                          _max[0].data(), _max[1].data(), _max[2].data(), _n,
+                          results.visibleBoxes.data( )));
+
+        results.sphereViews.resize( _n );
+        results.boxViews.resize( _n );
+        _multiCuller.test( _centers[0].data(), _centers[1].data(),
+                           _centers[2].data(), _radii.data(), _n,
+                           results.sphereViews.data( ));
+        _multiCuller.test( _min[0].data(), _min[1].data(), _min[2].data(),
+                           _max[0].data(), _max[1].data(), _max[2].data(),
+                           _n, results.boxViews.data( ));
+
+        results.lodSpheres.resize( _n );
+        results.lodBoxes.resize( _n );
+        results.sphereLODs.resize( _n );
+        results.boxLODs.resize( _n );
+        _selector.test( _centers[0].data(), _centers[1].data(),
+                        _centers[2].data(), _radii.data(), _n,
+                        results.lodSpheres.data(), results.sphereLODs.data( ));
+        _selector.test( _min[0].data(), _min[1].data(), _min[2].data(),
+                        _max[0].data(), _max[1].data(), _max[2].data(), _n,
+                        results.lodBoxes.data(), results.boxLODs.data( ));
+
+        results.points = _vectors;
+        vmml::transform( _matrix, _vectors.data(), 4, results.points.data(),
+                         4, _n );
+        results.projected = _vectors;
+        vmml::transform( _projection, _vectors.data(), 4,
+                         results.projected.data(), 4, _n,
+                         vmml::TRANSFORM_PROJECTIVE );
+        results.homogeneous = _vectors;
+        vmml::transform( _matrix,
+                         reinterpret_cast< const vec4* >( _vectors.data( )),
+                         reinterpret_cast< vec4* >(
+                             results.homogeneous.data( )), _n );
+
+        std::vector< Matrix > products( _left.size( ));
+        vmml::multiply( _left.data(), _right.data(), products.data(),
+                        products.size( ));
+        for( size_t i = 0; i < products.size(); ++i )
+            results.products.insert( results.products.end(),
+                                     products[i].array,
+                                     products[i].array + 16 );
+
+        std::vector< vec3 > skinned( _n );
+        vmml::skin( _bones.data(), _boneIndices.data(), _boneWeights.data(),
+                    reinterpret_cast< const vec3* >( _centers[0].data( )),
+                    skinned.data(), _n / 3 );
+        for( size_t i = 0; i < skinned.size(); ++i )
+            results.skinned.insert( results.skinned.end(), skinned[i].array,
+                                    skinned[i].array + 3 );
+
+        vmml::QuaternionArray< T > interpolated;
+        vmml::nlerp( _quaternionsA, _quaternionsB, _parameters.data(),
+                     interpolated );
+        _append( interpolated, results.interpolated );
+        vmml::slerp( _quaternionsA, _quaternionsB, _parameters.data(),
+                     interpolated );
+        _append( interpolated, results.interpolated );
+        vmml::slerp( _quaternionsA, _quaternionsB, _parameters.data(),
+                     interpolated, vmml::SLERP_FAST );
+        _append( interpolated, results.interpolated );
+
+        std::vector< vmml::Matrix< 3, 3, T > > rotations( _n );
+        _quaternionsA.getRotationMatrices( rotations.data( ));
+        for( size_t i = 0; i < rotations.size(); ++i )
+            results.rotations.insert( results.rotations.end(),
+                                      rotations[i].array,
+                                      rotations[i].array + 9 );
+
+        std::vector< vmml::Quaternion< T > > quaternions( _n );
+        for( size_t i = 0; i < _n; ++i )
+            quaternions[i] = _quaternionsA.get( i );
+        std::vector< vmml::PackedQuaternion48 > packedQuaternions( _n );
+        vmml::encode( quaternions.data(), packedQuaternions.data(), _n );
+        vmml::decode( packedQuaternions.data(), quaternions.data(), _n );
+        for( size_t i = 0; i < _n; ++i )
+        {
+            results.quaternions.push_back( quaternions[i].x( ));
+            results.quaternions.push_back( quaternions[i].y( ));
+            results.quaternions.push_back( quaternions[i].z( ));
+            results.quaternions.push_back( quaternions[i].w( ));
+        }
+
+        std::vector< vec3 > normals( _n / 3 );
+        std::vector< vmml::PackedNormal32 > packedNormals( normals.size( ));
+        vmml::encode( reinterpret_cast< const vec3* >( _centers[0].data( )),
+                      packedNormals.data(), normals.size( ));
+        vmml::decode( packedNormals.data(), normals.data(), normals.size( ));
+        for( size_t i = 0; i < normals.size(); ++i )
+            results.normals.insert( results.normals.end(), normals[i].array,
+                                    normals[i].array + 3 );
+
+        std::vector< vmml::Half > halves( _n );
+        vmml::encode( _centers[0].data(), halves.data(), _n );
+        results.halves.resize( _n );
+        vmml::decode( halves.data(), results.halves.data(), _n );
+        for( size_t i = 0; i < _n; ++i )
+            results.halfBits.push_back( halves[i].getBits( ));
+
+        std::vector< vmml::Matrix< 3, 3, T > > matrices( _n / 9 ), symmetric;
+        for( size_t i = 0; i < matrices.size(); ++i )
+        {
+            for( size_t j = 0; j < 9; ++j )
+                matrices[i].array[j] = _vectors[ 9 * i + j ] / T( 120 );
+            symmetric.push_back( matrices[i] + vmml::transpose( matrices[i] ));
+        }
+        std::vector< vec3 > values( matrices.size( ));
+        std::vector< vmml::Matrix< 3, 3, T > > u( matrices.size( ));
+        std::vector< vmml::Matrix< 3, 3, T > > v( matrices.size( ));
+        vmml::computeEigen( symmetric.data(), values.data(), u.data(),
+                            matrices.size( ));
+        for( size_t i = 0; i < values.size(); ++i )
+            results.eigenvalues.insert( results.eigenvalues.end(),
+                                        values[i].array, values[i].array + 3 );
+        vmml::computeSVD( matrices.data(), u.data(), values.data(), v.data(),
+                          matrices.size( ));
+        for( size_t i = 0; i < values.size(); ++i )
+            results.singularValues.insert( results.singularValues.end(),
+                                           values[i].array,
+                                           values[i].array + 3 );
+
+        const vmml::RayPacket< T, PACKET_SIZE > packet( _rays.data( ));
+        for( size_t i = 0; i < _targets.size(); ++i )
+        {
+            const vec4& sphere = _targets[i];
+            const vec3 center( sphere.x(), sphere.y(), sphere.z( ));
+            const vmml::AABB< T > box( center - sphere.w(),
+                                       center + sphere.w( ));
+            T distances[ PACKET_SIZE ];
+            results.sphereHits.push_back( packet.test( sphere, distances ));
+            results.sphereDistances.insert( results.sphereDistances.end(),
+                                            distances,
+                                            distances + PACKET_SIZE );
+            results.boxHits.push_back( packet.test( box, distances ));
+            results.boxDistances.insert( results.boxDistances.end(),
+                                         distances, distances + PACKET_SIZE );
+        }
+
+        _append( vmml::OBB< T >::fromPointsDiTO( _points.data(),
+                                                 _points.size( )),
+                 results.obbAxes, results.obbBoxes );
+        _append( vmml::OBB< T >::fromPointsPCA( _points.data(),
+                                                _points.size( )),
+                 results.obbAxes, results.obbBoxes );
+
+        _append( vmml::AABB< T >::fromPoints( _points.data(),
+                                              _points.data() + _points.size( )),
+                 results.bounds );
+        _append( vmml::AABB< T >::fromBoxes( _boxes.data(),
+                                             _boxes.data() + _boxes.size( )),
+                 results.bounds );
+
+        std::vector< vmml::AABB< T > > boxes( _n );
+        vmml::transform( _transforms.data(), _boxes.data(), boxes.data(), _n );
+        for( size_t i = 0; i < _n; ++i )
+            _append( boxes[i], results.transformedBoxes );
+        vmml::transform( _matrix, _boxes.data(), boxes.data(), _n );
+        for( size_t i = 0; i < _n; ++i )
+            _append( boxes[i], results.transformedBoxes );
+        return results;
+    }
+
+private:
+    const vmml::FrustumCuller< T > _culler;
+    vmml::MultiFrustumCuller< T, VIEWS > _multiCuller;
+    vmml::LODSelector< T > _selector;
+    const size_t _n;
+    vmml::QuaternionArray< T > _quaternionsA, _quaternionsB;
+    std::vector< T > _parameters;
+    std::vector< T > _centers[3], _radii, _min[3], _max[3], _vectors;
+    std::vector< vmml::AABB< T > > _boxes;
+    std::vector< Matrix > _transforms;
+    Matrix _matrix, _projection;
+    std::vector< Matrix > _left, _right;
+    std::vector< vmml::DualQuaternion< T > > _bones;
+    std::vector< vmml::Vector4ui > _boneIndices;
+    std::vector< vec4 > _boneWeights;
+    std::vector< vmml::Ray< T > > _rays;
+    std::vector< vec4 > _targets;
+    std::vector< vec3 > _points;
+
+    static void _append( const vmml::QuaternionArray< T >& quaternions,
+                         std::vector< T >& values )
+    {
+        values.insert( values.end(), quaternions.getX(),
+                       quaternions.getX() + quaternions.getSize( ));
+        values.insert( values.end(), quaternions.getY(),
+                       quaternions.getY() + quaternions.getSize( ));
+        values.insert( values.end(), quaternions.getZ(),
+                       quaternions.getZ() + quaternions.getSize( ));
+        values.insert( values.end(), quaternions.getW(),
+                       quaternions.getW() + quaternions.getSize( ));
+    }
+
+    static void _append( const vmml::AABB< T >& box, std::vector< T >& values )
+    {
+        values.insert( values.end(), box.getMin().array,
+                       box.getMin().array + 3 );
+        values.insert( values.end(), box.getMax().array,
+                       box.getMax().array + 3 );
+    }
+
+    static void _append( const vmml::OBB< T >& box, std::vector< T >& axes,
+                         std::vector< T >& values )
+    {
+        axes.insert( axes.end(), box.getAxes().array,
+                     box.getAxes().array + 9 );
+        values.insert( values.end(), box.getCenter().array,
+                       box.getCenter().array + 3 );
+        values.insert( values.end(), box.getExtents().array,
+                       box.getExtents().array + 3 );
+    }
+};
+
+template< typename T > void _testKernels()
+{
+    // FMA and a different evaluation order change the rounding, which the
+    // square root amplifies for rays almost tangent to a sphere
+    const T epsilon = std::numeric_limits< T >::epsilon() * 64;
+    const T rayEpsilon = std::numeric_limits< T >::epsilon() * 1000;
+    const Kernels< T > kernels;
+
+    BOOST_CHECK_EQUAL( vmml::setSIMDLevel( vmml::SIMD_SCALAR ),
+                       vmml::SIMD_SCALAR );
+    const Results< T > expected = kernels.run();
+
+    for( int i = vmml::SIMD_SSE2; i <= vmml::getSupportedSIMDLevel(); ++i )
+    {
+        const vmml::SIMDLevel level = vmml::SIMDLevel( i );
+        BOOST_CHECK_EQUAL( vmml::setSIMDLevel( level ), level );
+        const Results< T > results = kernels.run();
+
+        BOOST_CHECK_MESSAGE( results.spheres == expected.spheres, level );
+        BOOST_CHECK_MESSAGE( results.boxes == expected.boxes, level );
+        BOOST_CHECK_MESSAGE( results.visibleSpheres == expected.visibleSpheres,
+                             level );
+        BOOST_CHECK_MESSAGE( results.visibleBoxes == expected.visibleBoxes,
+                             level );
+        BOOST_CHECK_MESSAGE( results.sphereViews == expected.sphereViews,
+                             level );
+        BOOST_CHECK_MESSAGE( results.boxViews == expected.boxViews, level );
+        BOOST_CHECK_MESSAGE( results.lodSpheres == expected.lodSpheres, level );
+        BOOST_CHECK_MESSAGE( results.lodBoxes == expected.lodBoxes, level );
+        BOOST_CHECK_MESSAGE( results.sphereLODs == expected.sphereLODs, level );
+        BOOST_CHECK_MESSAGE( results.boxLODs == expected.boxLODs, level );
+        BOOST_CHECK_MESSAGE( _equals( results.points, expected.points,
+                                      epsilon ), level );
+        BOOST_CHECK_MESSAGE( _equals( results.projected, expected.projected,
+                                      epsilon ), level );
+        BOOST_CHECK_MESSAGE( _equals( results.homogeneous,
+                                      expected.homogeneous, epsilon ), level );
+        BOOST_CHECK_MESSAGE( _equals( results.products, expected.products,
+                                      epsilon ), level );
+        // skinned coordinates of up to 50 may cancel to small values
+        BOOST_CHECK_MESSAGE( _equals( results.skinned, expected.skinned,
+                                      epsilon * 50 ), level );
+        BOOST_CHECK_MESSAGE( _equals( results.interpolated,
+                                      expected.interpolated, epsilon ),
+                             level );
+        BOOST_CHECK_MESSAGE( _equals( results.rotations, expected.rotations,
+                                      epsilon ), level );
+        // rounding may move a value to the neighbouring grid step
+        BOOST_CHECK_MESSAGE( _equals( results.quaternions,
+                                      expected.quaternions, T( 1e-4 )),
+                             level );
+        BOOST_CHECK_MESSAGE( _equals( results.normals, expected.normals,
+                                      T( 1e-4 )), level );
+        BOOST_CHECK_MESSAGE( results.halfBits == expected.halfBits, level );
+        BOOST_CHECK_MESSAGE( results.halves == expected.halves, level );
+        // the Jacobi sweeps accumulate the rounding differences
+        BOOST_CHECK_MESSAGE( _equals( results.eigenvalues, expected.eigenvalues,
+                                      epsilon * 16 ), level );
+        BOOST_CHECK_MESSAGE( _equals( results.singularValues,
+                                      expected.singularValues, epsilon * 16 ),
+                             level );
+        BOOST_CHECK_MESSAGE( results.sphereHits == expected.sphereHits, level );
+        BOOST_CHECK_MESSAGE( results.boxHits == expected.boxHits, level );
+        BOOST_CHECK_MESSAGE( _equals( results.sphereDistances,
+                                      expected.sphereDistances, rayEpsilon ),
+                             level );
+        BOOST_CHECK_MESSAGE( _equals( results.boxDistances,
+                                      expected.boxDistances, rayEpsilon ),
+                             level );
+        // the extremal points and thus the axes do not depend on the level
+        BOOST_CHECK_MESSAGE( results.obbAxes == expected.obbAxes, level );
+        BOOST_CHECK_MESSAGE( _equals( results.obbBoxes, expected.obbBoxes,
+                                      epsilon ), level );
+        BOOST_CHECK_MESSAGE( results.bounds == expected.bounds, level );
+        BOOST_CHECK_MESSAGE( _equals( results.transformedBoxes,
+                                      expected.transformedBoxes, epsilon ),
+                             level );
+    }
+    vmml::setSIMDLevel( vmml::getSupportedSIMDLevel( ));
+}
+}
+
+BOOST_AUTO_TEST_CASE( level )
+{
+    const vmml::SIMDLevel supported = vmml::getSupportedSIMDLevel();
+    BOOST_CHECK_GE( supported, vmml::simd::NATIVE_LEVEL );
+    BOOST_CHECK_LE( vmml::getSIMDLevel(), supported );
+
+    BOOST_CHECK_EQUAL( vmml::setSIMDLevel( vmml::SIMD_SCALAR ),
+                       vmml::SIMD_SCALAR );
+    BOOST_CHECK_EQUAL( vmml::getSIMDLevel(), vmml::SIMD_SCALAR );
+    BOOST_CHECK_EQUAL( vmml::setSIMDLevel( vmml::SIMD_AVX512 ), supported );
+    BOOST_CHECK_EQUAL( vmml::getSIMDLevel(), supported );
+
+    BOOST_CHECK_EQUAL( std::string( vmml::getName( vmml::SIMD_SSE41 )),
+                       "sse4.1" );
+    BOOST_CHECK_EQUAL( std::string( vmml::getName( vmml::SIMD_AVX512 )),
+                       "avx512" );
+}
+
+BOOST_AUTO_TEST_CASE( kernels )
+{
+    _testKernels< float >();
+    _testKernels< double >();
+}
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/dualQuaternion.hpp>
+#include <vmmlib/types.hpp>
+
+#define BOOST_TEST_MODULE dualQuaternion
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+#include <cstdlib>
+
+namespace
+{
+using vmml::DualQuaterniond;
+using vmml::DualQuaternionf;
+
+template< typename T > vmml::Quaternion< T > _randomRotation()
+{
+    return vmml::Quaternion< T >( _random< T >( -3, 3 ),
+                                  vmml::vector< 3, T >( _random< T >( -1, 1 ),
+                                                        _random< T >( -1, 1 ),
+                                                        1 ));
+}
+
+template< typename T > vmml::vector< 3, T > _randomVector()
+{
+    return vmml::vector< 3, T >( _random< T >( -10, 10 ),
+                                 _random< T >( -10, 10 ),
+                                 _random< T >( -10, 10 ));
+}
+
+vmml::Vector3d _transform( const vmml::Matrix4d& matrix,
+                           const vmml::Vector3d& point )
+{
+    const vmml::Vector4d result = matrix * vmml::Vector4d( point.x(),
+                                                           point.y(),
+                                                           point.z(), 1 );
+    return vmml::Vector3d( result.x(), result.y(), result.z( ));
+}
+
+// scalar dual quaternion linear blending, see skin()
+template< typename T >
+vmml::vector< 3, T > _skin( const vmml::DualQuaternion< T >* bones,
+                            const vmml::Vector4ui& indices,
+                            const vmml::vector< 4, T >& weights,
+                            const vmml::vector< 3, T >& position,
+                            const bool translate )
+{
+    const vmml::DualQuaternion< T >& first = bones[ indices[0] ];
+    vmml::DualQuaternion< T > blend = first * weights[0];
+    for( size_t i = 1; i < 4; ++i )
+    {
+        const vmml::DualQuaternion< T >& bone = bones[ indices[i] ];
+        const T sign = dot( first.getReal(), bone.getReal( )) < 0 ? -1 : 1;
+        blend = blend + bone * ( sign * weights[i] );
+    }
+    blend.normalize();
+    return translate ? blend * position : blend.rotate( position );
+}
+}
+
+BOOST_AUTO_TEST_CASE( base )
+{
+    const DualQuaterniond identity;
+    BOOST_CHECK_EQUAL( identity.getReal(), vmml::Quaterniond( ));
+    BOOST_CHECK_EQUAL( identity.getDual(), vmml::Quaterniond( 0, 0, 0, 0 ));
+    BOOST_CHECK_EQUAL( identity.getMatrix(), vmml::Matrix4d( ));
+    BOOST_CHECK_EQUAL( identity * vmml::Vector3d( 1, 2, 3 ),
+                       vmml::Vector3d( 1, 2, 3 ));
+
+    srand( 42 );
+    for( size_t i = 0; i < 100; ++i )
+    {
+        const vmml::Quaterniond rotation = _randomRotation< double >();
+        const vmml::Vector3d translation = _randomVector< double >();
+        const vmml::Vector3d point = _randomVector< double >();
+        const DualQuaterniond dq( rotation, translation );
+        const vmml::Matrix4d matrix( rotation, translation );
+
+        BOOST_CHECK( dq.getRotation().equals( rotation ));
+        BOOST_CHECK_MESSAGE( dq.getTranslation().equals( translation, 1e-12 ),
+                             dq.getTranslation() << " != " << translation );
+        BOOST_CHECK( dq.getMatrix().equals( matrix, 1e-12 ));
+        BOOST_CHECK( ( dq * point ).equals( _transform( matrix, point ),
+                                            1e-12 ));
+        BOOST_CHECK( dq.rotate( point ).equals(
+                         rotation.getRotationMatrix() * point, 1e-12 ));
+
+        // the matrix conversion gives the rotation up to its sign
+        const DualQuaterniond fromMatrix( matrix );
+        BOOST_CHECK( fromMatrix.getMatrix().equals( matrix, 1e-12 ));
+        BOOST_CHECK( fromMatrix.equals( dq, 1e-12 ) ||
+                     fromMatrix.equals( -dq, 1e-12 ));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( multiply )
+{
+    srand( 42 );
+    for( size_t i = 0; i < 100; ++i )
+    {
+        const DualQuaterniond a( _randomRotation< double >(),
+                                 _randomVector< double >( ));
+        const DualQuaterniond b( _randomRotation< double >(),
+                                 _randomVector< double >( ));
+        BOOST_CHECK( ( a * b ).getMatrix().equals(
+                         a.getMatrix() * b.getMatrix(), 1e-12 ));
+
+        DualQuaterniond c( a );
+        c *= b;
+        BOOST_CHECK_EQUAL( c, a * b );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( inverse )
+{
+    srand( 42 );
+    for( size_t i = 0; i < 100; ++i )
+    {
+        const DualQuaterniond dq( _randomRotation< double >(),
+                                  _randomVector< double >( ));
+        BOOST_CHECK( ( dq * dq.inverse( )).equals( DualQuaterniond(), 1e-12 ));
+        BOOST_CHECK( dq.inverse().equals( dq.getConjugate(), 1e-12 ));
+
+        // also for non-unit dual quaternions
+        const DualQuaterniond scaled = dq * 3.;
+        BOOST_CHECK( ( scaled.inverse() * scaled ).equals( DualQuaterniond(),
+                                                           1e-12 ));
+    }
+}
+
+BOOST_AUTO_TEST_CASE( normalize )
+{
+    srand( 42 );
+    for( size_t i = 0; i < 100; ++i )
+    {
+        const DualQuaterniond dq( _randomRotation< double >(),
+                                  _randomVector< double >( ));
+
+        DualQuaterniond scaled = dq * 2.5;
+        scaled.normalize();
+        BOOST_CHECK( scaled.equals( dq, 1e-12 ));
+
+        // a blend of two transformations is rigid after normalization
+        DualQuaterniond blend = dq + DualQuaterniond(
+            _randomRotation< double >(), _randomVector< double >( ));
+        blend.normalize();
+        BOOST_CHECK_CLOSE( blend.getReal().abs(), 1., 1e-10 );
+        BOOST_CHECK_SMALL( dot( blend.getReal(), blend.getDual( )), 1e-12 );
+    }
+
+    DualQuaterniond zero( vmml::Quaterniond( 0, 0, 0, 0 ),
+                          vmml::Quaterniond( 0, 0, 0, 0 ));
+    zero.normalize();
+    BOOST_CHECK_EQUAL( zero.getReal(), vmml::Quaterniond( 0, 0, 0, 0 ));
+}
+
+BOOST_AUTO_TEST_CASE( sclerp )
+{
+    const vmml::Vector3d axis( 0, 0, 1 );
+    const vmml::Vector3d center( 1, 2, 0 );
+    const DualQuaterniond toCenter( vmml::Quaterniond(), center );
+    const DualQuaterniond fromCenter( vmml::Quaterniond(), -center );
+
+    // a screw motion around an axis through center: rotation by 90 degrees and
+    // translation by 2 along the axis
+    const DualQuaterniond a;
+    const DualQuaterniond b = toCenter *
+        DualQuaterniond( vmml::Quaterniond( M_PI_2, axis ), axis * 2. ) *
+        fromCenter;
+
+    BOOST_CHECK( vmml::sclerp( a, b, 0. ).equals( a, 1e-12 ));
+    BOOST_CHECK( vmml::sclerp( a, b, 1. ).equals( b, 1e-12 ));
+    for( double t = 0; t <= 1; t += .125 )
+    {
+        const DualQuaterniond expected = toCenter *
+            DualQuaterniond( vmml::Quaterniond( M_PI_2 * t, axis ),
+                             axis * ( 2. * t )) * fromCenter;
+        BOOST_CHECK_MESSAGE( vmml::sclerp( a, b, t ).equals( expected, 1e-12 ),
+                             vmml::sclerp( a, b, t ) << " != " << expected );
+    }
+
+    // relative to a start transformation, and on the shorter rotation
+    srand( 42 );
+    const DualQuaterniond start( _randomRotation< double >(),
+                                 _randomVector< double >( ));
+    BOOST_CHECK( vmml::sclerp( start * a, start * b, .5 ).equals(
+                     vmml::sclerp( start * a, -( start * b ), .5 ), 1e-12 ));
+    BOOST_CHECK( vmml::sclerp( start * a, start * b, .5 ).equals(
+                     start * vmml::sclerp( a, b, .5 ), 1e-12 ));
+
+    // pure translations are interpolated linearly
+    const DualQuaterniond translation( vmml::Quaterniond(),
+                                       vmml::Vector3d( 2, 4, 6 ));
+    BOOST_CHECK( vmml::sclerp( a, translation, .25 ).equals(
+                     DualQuaterniond( vmml::Quaterniond(),
+                                      vmml::Vector3d( .5, 1, 1.5 )), 1e-12 ));
+}
+
+template< typename T > void _testSkin()
+{
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::vector< 4, T > vec4;
+    const T epsilon = std::numeric_limits< T >::epsilon() * 256;
+
+    srand( 42 );
+    std::vector< vmml::DualQuaternion< T > > bones;
+    for( size_t i = 0; i < 16; ++i )
+        bones.push_back( vmml::DualQuaternion< T >( _randomRotation< T >(),
+                                                    _randomVector< T >( )));
+
+    // odd size to exercise the scalar tail
+    const size_t n = 1001;
+    std::vector< vmml::Vector4ui > indices( n );
+    std::vector< vec4 > weights( n );
+    std::vector< vec3 > positions( n ), normals( n );
+    for( size_t i = 0; i < n; ++i )
+    {
+        for( size_t j = 0; j < 4; ++j )
+        {
+            indices[i][j] = unsigned( rand( )) % bones.size();
+            weights[i][j] = _random< T >( 0, 1 );
+        }
+        if( i % 3 == 0 )
+            weights[i][3] = weights[i][2] = 0; // two influences
+        weights[i] /= weights[i].x() + weights[i].y() + weights[i].z() +
+                      weights[i].w();
+        positions[i] = _randomVector< T >();
+        normals[i] = vmml::normalize( _randomVector< T >( ));
+    }
+
+    std::vector< vec3 > result( n ), resultPositions( n ), resultNormals( n );
+    vmml::skin( bones.data(), indices.data(), weights.data(),
+                positions.data(), result.data(), n );
+    vmml::skin( bones.data(), indices.data(), weights.data(),
+                positions.data(), normals.data(), resultPositions.data(),
+                resultNormals.data(), n );
+
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vec3 position = _skin( bones.data(), indices[i], weights[i],
+                                     positions[i], true );
+        const vec3 normal = _skin( bones.data(), indices[i], weights[i],
+                                   normals[i], false );
+        BOOST_CHECK_MESSAGE( result[i].equals( position, epsilon * 16 ),
+                             result[i] << " != " << position );
+        BOOST_CHECK_EQUAL( resultPositions[i], result[i] );
+        BOOST_CHECK_MESSAGE( resultNormals[i].equals( normal, epsilon ),
+                             resultNormals[i] << " != " << normal );
+    }
+
+    // a single influence is the rigid transformation of the bone
+    const vmml::Vector4ui single( 3, 0, 0, 0 );
+    const vec4 one( 1, 0, 0, 0 );
+    vec3 skinned;
+    vmml::skin( bones.data(), &single, &one, &positions[0], &skinned, 1 );
+    BOOST_CHECK( skinned.equals( bones[3] * positions[0], epsilon * 16 ));
+}
+
+BOOST_AUTO_TEST_CASE( skin )
+{
+    _testSkin< float >();
+    _testSkin< double >();
+}
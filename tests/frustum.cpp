@@ -28,11 +28,18 @@
 
 #include <vmmlib/frustum.hpp>
 #include <vmmlib/frustumCuller.hpp>
+#include <vmmlib/multiFrustumCuller.hpp>
+#include <vmmlib/obb.hpp>
+#include <vmmlib/quaternion.hpp>
 #include <vmmlib/types.hpp>
 
 #define BOOST_TEST_MODULE frustum
 #include <boost/test/unit_test.hpp>
 
+#include "random.hpp"
+
+#include <cstdlib>
+
 static void _testCull( const vmml::FrustumCullerf& fc )
 {
     const vmml::vector< 4, float > sphereIn( 0.f, 0.f, -10.f, 1.f );
@@ -88,3 +95,342 @@ BOOST_AUTO_TEST_CASE( base )
     const vmml::FrustumCullerf fc2( a, b, c, d, e, f, g, h );
     _testCull( fc2 );
 }
+
+template< typename T > static void _testBatch()
+{
+    const vmml::Frustum< T > frustum( -1, 1, -1, 1, 1, 100 );
+    const vmml::FrustumCuller< T > fc( frustum.computePerspectiveMatrix( ));
+
+    // not a multiple of any SIMD width to cover the scalar remainder
+    const size_t n = 1003;
+    std::vector< T > x( n ), y( n ), z( n ), r( n );
+    std::vector< T > minX( n ), minY( n ), minZ( n );
+    std::vector< T > maxX( n ), maxY( n ), maxZ( n );
+    srand( 42 );
+    for( size_t i = 0; i < n; ++i )
+    {
+        x[i] = _random< T >( -50, 50 );
+        y[i] = _random< T >( -50, 50 );
+        z[i] = _random< T >( -120, 20 );
+        r[i] = _random< T >( 0, 10 );
+        minX[i] = x[i] - _random< T >( 0, 10 );
+        minY[i] = y[i] - _random< T >( 0, 10 );
+        minZ[i] = z[i] - _random< T >( 0, 10 );
+        maxX[i] = x[i] + r[i];
+        maxY[i] = y[i] + r[i];
+        maxZ[i] = z[i] + r[i];
+    }
+
+    std::vector< vmml::Visibility > spheres( n ), boxes( n );
+    std::vector< uint32_t > visibleSpheres( n ), visibleBoxes( n );
+    fc.test( x.data(), y.data(), z.data(), r.data(), n, spheres.data( ));
+    fc.test( minX.data(), minY.data(), minZ.data(),
+             maxX.data(), maxY.data(), maxZ.data(), n, boxes.data( ));
+    visibleSpheres.resize( fc.cull( x.data(), y.data(), z.data(), r.data(), n,
+                                    visibleSpheres.data( )));
+    visibleBoxes.resize( fc.cull( minX.data(), minY.data(), minZ.data(),
+                                  maxX.data(), maxY.data(), maxZ.data(), n,
+                                  visibleBoxes.data( )));
+
+    std::vector< uint32_t > expectedSpheres, expectedBoxes;
+    size_t partial = 0;
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vmml::vector< 4, T > sphere( x[i], y[i], z[i], r[i] );
+        const vmml::AABB< T > box(
+            vmml::vector< 3, T >( minX[i], minY[i], minZ[i] ),
+            vmml::vector< 3, T >( maxX[i], maxY[i], maxZ[i] ));
+
+        BOOST_CHECK_EQUAL( spheres[i], fc.test( sphere ));
+        BOOST_CHECK_EQUAL( boxes[i], fc.test( box ));
+        if( spheres[i] != vmml::VISIBILITY_NONE )
+            expectedSpheres.push_back( uint32_t( i ));
+        if( boxes[i] != vmml::VISIBILITY_NONE )
+            expectedBoxes.push_back( uint32_t( i ));
+        if( spheres[i] == vmml::VISIBILITY_PARTIAL )
+            ++partial;
+    }
+    BOOST_CHECK( visibleSpheres == expectedSpheres );
+    BOOST_CHECK( visibleBoxes == expectedBoxes );
+
+    // make sure the data covers all cases
+    BOOST_CHECK_GT( partial, 0 );
+    BOOST_CHECK_GT( expectedSpheres.size(), partial );
+    BOOST_CHECK_LT( expectedSpheres.size(), n );
+}
+
+BOOST_AUTO_TEST_CASE( batch )
+{
+    _testBatch< float >();
+    _testBatch< double >();
+}
+
+template< typename T > static void _testHierarchical()
+{
+    typedef vmml::FrustumCuller< T > FrustumCuller;
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::vector< 4, T > vec4;
+
+    const vmml::Frustum< T > frustum( -1, 1, -1, 1, 1, 100 );
+    const FrustumCuller fc( frustum.computePerspectiveMatrix( ));
+
+    unsigned planes = FrustumCuller::PLANES_ALL;
+    size_t lastPlane = 0;
+    BOOST_CHECK_EQUAL( fc.test( vec4( 0, 0, -50, 1 ), planes ),
+                       vmml::VISIBILITY_FULL );
+    BOOST_CHECK_EQUAL( planes, 0 );
+
+    planes = FrustumCuller::PLANES_ALL;
+    BOOST_CHECK_EQUAL( fc.test( vec4( 0, 0, -1, .5f ), planes ),
+                       vmml::VISIBILITY_PARTIAL );
+    BOOST_CHECK_EQUAL( planes, unsigned( FrustumCuller::PLANE_NEAR ));
+
+    // a child tested against the remaining planes only
+    const vec4 child( .2f, 0, -1, .1f );
+    BOOST_CHECK_EQUAL( fc.test( child, planes ), vmml::VISIBILITY_PARTIAL );
+    BOOST_CHECK_EQUAL( planes, unsigned( FrustumCuller::PLANE_NEAR ));
+
+    planes = FrustumCuller::PLANES_ALL;
+    BOOST_CHECK_EQUAL( fc.test( vec4( 0, 0, -200, 1 ), planes, lastPlane ),
+                       vmml::VISIBILITY_NONE );
+    BOOST_CHECK_EQUAL( lastPlane, 5 );
+
+    planes = FrustumCuller::PLANES_ALL;
+    BOOST_CHECK_EQUAL( fc.test( vmml::AABB< T >( vec3( 10, -1, -5 ),
+                                                 vec3( 12, 1, -4 )),
+                                planes, lastPlane ), vmml::VISIBILITY_NONE );
+    BOOST_CHECK_EQUAL( lastPlane, 1 );
+
+    // the masked tests must agree with the plain ones for any mask state
+    srand( 42 );
+    for( size_t i = 0; i < 1000; ++i )
+    {
+        const vec4 sphere( _random< T >( -50, 50 ), _random< T >( -50, 50 ),
+                           _random< T >( -120, 20 ), _random< T >( 0, 10 ));
+        const vec3 center( sphere.x(), sphere.y(), sphere.z( ));
+        const vmml::AABB< T > box( center - vec3( sphere.w( )),
+                                   center + vec3( sphere.w( )));
+
+        unsigned sphereMask = FrustumCuller::PLANES_ALL;
+        unsigned boxMask = FrustumCuller::PLANES_ALL;
+        const vmml::Visibility sphereVis = fc.test( sphere, sphereMask,
+                                                    lastPlane );
+        const vmml::Visibility boxVis = fc.test( box, boxMask, lastPlane );
+        BOOST_CHECK_EQUAL( sphereVis, fc.test( sphere ));
+        BOOST_CHECK_EQUAL( boxVis, fc.test( box ));
+        if( sphereVis == vmml::VISIBILITY_NONE ||
+            boxVis == vmml::VISIBILITY_NONE )
+        {
+            continue;
+        }
+
+        // contained volumes only need the planes left in the mask
+        const vec4 inner( sphere.x(), sphere.y(), sphere.z(), sphere.w() / 2 );
+        unsigned innerMask = sphereMask;
+        BOOST_CHECK_EQUAL( fc.test( inner, innerMask ), fc.test( inner ));
+        BOOST_CHECK_EQUAL( innerMask & ~sphereMask, 0 );
+        BOOST_CHECK_EQUAL( fc.test( box, boxMask ), boxVis );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( hierarchical )
+{
+    _testHierarchical< float >();
+    _testHierarchical< double >();
+}
+
+template< typename T > static void _testOBB()
+{
+    typedef vmml::FrustumCuller< T > FrustumCuller;
+    typedef vmml::vector< 3, T > vec3;
+
+    const vmml::Frustum< T > frustum( -1, 1, -1, 1, 1, 100 );
+    const FrustumCuller fc( frustum.computePerspectiveMatrix( ));
+
+    const size_t n = 1003;
+    std::vector< vmml::OBB< T > > obbs( n );
+    srand( 42 );
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vec3 center( _random< T >( -50, 50 ), _random< T >( -50, 50 ),
+                           _random< T >( -120, 20 ));
+        const vec3 axis( _random< T >( -1, 1 ), _random< T >( -1, 1 ),
+                         _random< T >( -1, 1 ));
+        const vec3 extents( _random< T >( 0, 10 ), _random< T >( 0, 10 ),
+                            _random< T >( 0, 1 ));
+        obbs[i] = vmml::OBB< T >( center, vmml::Quaternion< T >(
+                                      _random< T >( 0, 3 ),
+                                      vmml::normalize( axis )).
+                                          getRotationMatrix(), extents );
+    }
+
+    std::vector< vmml::Visibility > visibility( n );
+    std::vector< uint32_t > visible( n );
+    fc.test( obbs.data(), n, visibility.data( ));
+    visible.resize( fc.cull( obbs.data(), n, visible.data( )));
+
+    std::vector< uint32_t > expected;
+    size_t partial = 0;
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vmml::OBB< T >& obb = obbs[i];
+        BOOST_CHECK_EQUAL( visibility[i], fc.test( obb ));
+        if( visibility[i] != vmml::VISIBILITY_NONE )
+            expected.push_back( uint32_t( i ));
+        if( visibility[i] == vmml::VISIBILITY_PARTIAL )
+            ++partial;
+
+        // the oriented box is within its axis-aligned box
+        if( fc.test( obb.getAABB( )) == vmml::VISIBILITY_NONE )
+            BOOST_CHECK_EQUAL( visibility[i], vmml::VISIBILITY_NONE );
+        else if( fc.test( obb.getAABB( )) == vmml::VISIBILITY_FULL )
+            BOOST_CHECK_EQUAL( visibility[i], vmml::VISIBILITY_FULL );
+
+        // axis-aligned oriented boxes are identical to their AABB
+        const vmml::AABB< T > aabb( obb.getCenter() - obb.getExtents(),
+                                    obb.getCenter() + obb.getExtents( ));
+        BOOST_CHECK_EQUAL( fc.test( vmml::OBB< T >( aabb )), fc.test( aabb ));
+
+        unsigned planes = FrustumCuller::PLANES_ALL;
+        size_t lastPlane = 0;
+        BOOST_CHECK_EQUAL( fc.test( obb, planes, lastPlane ), visibility[i] );
+        if( visibility[i] != vmml::VISIBILITY_NONE )
+            BOOST_CHECK_EQUAL( fc.test( obb, planes ), visibility[i] );
+    }
+    BOOST_CHECK( visible == expected );
+    BOOST_CHECK_GT( partial, 0 );
+    BOOST_CHECK_GT( expected.size(), partial );
+    BOOST_CHECK_LT( expected.size(), n );
+}
+
+BOOST_AUTO_TEST_CASE( obb )
+{
+    _testOBB< float >();
+    _testOBB< double >();
+}
+
+template< typename T > static void _testMultiFrustum()
+{
+    typedef vmml::vector< 3, T > vec3;
+
+    // the six faces of a cube map around a point
+    const vmml::Frustum< T > frustum( -1, 1, -1, 1, 1, 100 );
+    const vmml::Matrix< 4, 4, T > projection =
+        frustum.computePerspectiveMatrix();
+    const vec3 eye( 1, 2, 3 );
+    const vmml::Quaternion< T > rotations[6] = {
+        vmml::Quaternion< T >( 0, vec3::UNIT_Y ),
+        vmml::Quaternion< T >( T( M_PI_2 ), vec3::UNIT_Y ),
+        vmml::Quaternion< T >( T( M_PI ), vec3::UNIT_Y ),
+        vmml::Quaternion< T >( T( -M_PI_2 ), vec3::UNIT_Y ),
+        vmml::Quaternion< T >( T( M_PI_2 ), vec3::UNIT_X ),
+        vmml::Quaternion< T >( T( -M_PI_2 ), vec3::UNIT_X ) };
+    vmml::Matrix< 4, 4, T > matrices[6];
+    vmml::FrustumCuller< T > cullers[6];
+    for( size_t i = 0; i < 6; ++i )
+    {
+        const vmml::Matrix< 4, 4, T > view( rotations[i], -eye );
+        matrices[i] = projection * view;
+        cullers[i] = vmml::FrustumCuller< T >( matrices[i] );
+    }
+    const vmml::MultiFrustumCuller< T, 6 > culler( matrices );
+    const vmml::MultiFrustumCuller< T, 6 > copy( cullers );
+
+    const size_t n = 1003;
+    std::vector< T > x( n ), y( n ), z( n ), r( n );
+    std::vector< T > minX( n ), minY( n ), minZ( n );
+    std::vector< T > maxX( n ), maxY( n ), maxZ( n );
+    srand( 42 );
+    for( size_t i = 0; i < n; ++i )
+    {
+        x[i] = _random< T >( -150, 150 );
+        y[i] = _random< T >( -150, 150 );
+        z[i] = _random< T >( -150, 150 );
+        r[i] = _random< T >( 0, 20 );
+        minX[i] = x[i] - r[i];
+        minY[i] = y[i] - _random< T >( 0, 10 );
+        minZ[i] = z[i] - r[i];
+        maxX[i] = x[i] + _random< T >( 0, 10 );
+        maxY[i] = y[i] + r[i];
+        maxZ[i] = z[i] + r[i];
+    }
+
+    std::vector< uint32_t > spheres( n ), boxes( n );
+    culler.test( x.data(), y.data(), z.data(), r.data(), n, spheres.data( ));
+    culler.test( minX.data(), minY.data(), minZ.data(),
+                 maxX.data(), maxY.data(), maxZ.data(), n, boxes.data( ));
+
+    // the same result as the batch tests of each view
+    std::vector< uint32_t > expectedSpheres( n, 0 ), expectedBoxes( n, 0 );
+    std::vector< vmml::Visibility > visibility( n );
+    for( size_t i = 0; i < 6; ++i )
+    {
+        cullers[i].test( x.data(), y.data(), z.data(), r.data(), n,
+                         visibility.data( ));
+        for( size_t j = 0; j < n; ++j )
+            if( visibility[j] != vmml::VISIBILITY_NONE )
+                expectedSpheres[j] |= 1u << i;
+
+        cullers[i].test( minX.data(), minY.data(), minZ.data(),
+                         maxX.data(), maxY.data(), maxZ.data(), n,
+                         visibility.data( ));
+        for( size_t j = 0; j < n; ++j )
+            if( visibility[j] != vmml::VISIBILITY_NONE )
+                expectedBoxes[j] |= 1u << i;
+    }
+
+    size_t multiple = 0, none = 0;
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vmml::vector< 4, T > sphere( x[i], y[i], z[i], r[i] );
+        const vmml::AABB< T > box( vec3( minX[i], minY[i], minZ[i] ),
+                                   vec3( maxX[i], maxY[i], maxZ[i] ));
+
+        BOOST_CHECK_EQUAL( spheres[i], expectedSpheres[i] );
+        BOOST_CHECK_EQUAL( boxes[i], expectedBoxes[i] );
+        BOOST_CHECK_EQUAL( culler.test( sphere ), spheres[i] );
+        BOOST_CHECK_EQUAL( culler.test( box ), boxes[i] );
+        BOOST_CHECK_EQUAL( copy.test( sphere ), spheres[i] );
+        if( spheres[i] == 0 )
+            ++none;
+        else if( spheres[i] & ( spheres[i] - 1 ))
+            ++multiple;
+    }
+
+    // make sure the data covers all cases
+    BOOST_CHECK_GT( none, 0 );
+    BOOST_CHECK_GT( multiple, 0 );
+    BOOST_CHECK_LT( none + multiple, n );
+}
+
+BOOST_AUTO_TEST_CASE( multiFrustum )
+{
+    _testMultiFrustum< float >();
+    _testMultiFrustum< double >();
+}
+
+namespace
+{
+// evaluated by the compiler with C++14, at static initialization otherwise
+VMMLIB_CONSTEXPR_OR_CONST vmml::Frustumf frustum( -1, 1, -1, 1, 1, 3 );
+VMMLIB_CONSTEXPR_OR_CONST vmml::Matrix4f projection =
+    frustum.computePerspectiveMatrix();
+VMMLIB_CONSTEXPR_OR_CONST vmml::Matrix4f viewProjection =
+    projection * vmml::Matrix4f().setTranslation( vmml::Vector3f( 0, 0, -2 ));
+
+#ifdef VMMLIB_HAS_CONSTEXPR
+static_assert( projection( 2, 2 ) == -2 && projection( 2, 3 ) == -3,
+               "constexpr projection" );
+static_assert( viewProjection( 2, 3 ) == 1 && viewProjection( 3, 3 ) == 2,
+               "constexpr multiply" );
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( constantExpression )
+{
+    BOOST_CHECK_EQUAL( projection, frustum.computePerspectiveMatrix( ));
+    BOOST_CHECK_EQUAL( projection( 2, 2 ), -2 );
+    BOOST_CHECK_EQUAL( projection( 2, 3 ), -3 );
+    BOOST_CHECK_EQUAL( viewProjection( 2, 3 ), 1 );
+    BOOST_CHECK_EQUAL( viewProjection( 3, 3 ), 2 );
+}
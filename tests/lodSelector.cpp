@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/frustum.hpp>
+#include <vmmlib/frustumCuller.hpp>
+#include <vmmlib/lodSelector.hpp>
+#include <vmmlib/types.hpp>
+
+#define BOOST_TEST_MODULE lodSelector
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+const float thresholds[] = { 100.f, 30.f, 10.f };
+const size_t nThresholds = sizeof( thresholds ) / sizeof( float );
+
+template< typename T > vmml::LODSelector< T > _getSelector(
+    const vmml::Matrix< 4, 4, T >& modelView )
+{
+    const vmml::Frustum< T > frustum( -1, 1, -1, 1, 1, 100 );
+    const T levels[] = { thresholds[0], thresholds[1], thresholds[2] };
+    return vmml::LODSelector< T >( frustum.computePerspectiveMatrix(),
+                                   modelView, 1000, levels, nThresholds, 2 );
+}
+
+template< typename T > uint32_t _getLOD( const T radius )
+{
+    uint32_t lod = 0;
+    for( size_t i = 0; i < nThresholds; ++i )
+        lod += radius < T( thresholds[i] );
+    return lod;
+}
+}
+
+BOOST_AUTO_TEST_CASE( base )
+{
+    const vmml::LODSelectorf selector = _getSelector( vmml::Matrix4f( ));
+    uint32_t lod = 0;
+
+    // 1 / 10 of the half height of 500 pixels
+    const vmml::Vector4f sphere( 0.f, 0.f, -10.f, 1.f );
+    BOOST_CHECK_CLOSE( selector.getProjectedRadius( sphere ), 50.f, 1e-4f );
+    BOOST_CHECK_EQUAL( selector.test( sphere, lod ), vmml::VISIBILITY_FULL );
+    BOOST_CHECK_EQUAL( lod, 1 );
+
+    const vmml::Vector4f nearSphere( 0.f, 0.f, -2.f, 1.f );
+    BOOST_CHECK_EQUAL( selector.test( nearSphere, lod ),
+                       vmml::VISIBILITY_FULL );
+    BOOST_CHECK_EQUAL( lod, 0 );
+
+    const vmml::Vector4f farSphere( 0.f, 0.f, -90.f, 1.f );
+    BOOST_CHECK_EQUAL( selector.test( farSphere, lod ),
+                       vmml::VISIBILITY_FULL );
+    BOOST_CHECK_EQUAL( lod, 3 );
+
+    // contribution culled below two pixels
+    const vmml::Vector4f tinySphere( 0.f, 0.f, -90.f, .2f );
+    BOOST_CHECK_EQUAL( selector.test( tinySphere, lod ),
+                       vmml::VISIBILITY_NONE );
+    BOOST_CHECK_EQUAL( lod, 3 );
+
+    // intersecting the eye plane
+    const vmml::Vector4f eyeSphere( 0.f, 0.f, 0.f, 2.f );
+    BOOST_CHECK_EQUAL( selector.test( eyeSphere, lod ),
+                       vmml::VISIBILITY_PARTIAL );
+    BOOST_CHECK_EQUAL( lod, 0 );
+
+    const vmml::Vector4f outSphere( 0.f, 0.f, 10.f, 1.f );
+    BOOST_CHECK_EQUAL( selector.test( outSphere, lod ),
+                       vmml::VISIBILITY_NONE );
+
+    const vmml::AABBf box( vmml::Vector3f( -1.f, -1.f, -11.f ),
+                           vmml::Vector3f( 1.f, 1.f, -9.f ));
+    BOOST_CHECK_EQUAL( selector.test( box, lod ), vmml::VISIBILITY_FULL );
+    BOOST_CHECK_EQUAL( lod, 1 ); // sqrt( 3 ) * 50 pixels
+}
+
+template< typename T > static void _testBatch()
+{
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::vector< 4, T > vec4;
+
+    vmml::Matrix< 4, 4, T > modelView;
+    modelView.setTranslation( vec3( 1, 2, -5 ));
+    const vmml::LODSelector< T > selector = _getSelector( modelView );
+    const vmml::FrustumCuller< T >& culler = selector.getFrustumCuller();
+
+    // not a multiple of any SIMD width to cover the scalar remainder
+    const size_t n = 1003;
+    std::vector< T > x( n ), y( n ), z( n ), r( n );
+    std::vector< T > minX( n ), minY( n ), minZ( n );
+    std::vector< T > maxX( n ), maxY( n ), maxZ( n );
+    srand( 42 );
+    for( size_t i = 0; i < n; ++i )
+    {
+        x[i] = _random< T >( -50, 50 );
+        y[i] = _random< T >( -50, 50 );
+        z[i] = _random< T >( -120, 20 );
+        r[i] = _random< T >( 0, 3 );
+        minX[i] = x[i] - r[i];
+        minY[i] = y[i] - _random< T >( 0, 3 );
+        minZ[i] = z[i] - r[i];
+        maxX[i] = x[i] + _random< T >( 0, 3 );
+        maxY[i] = y[i] + r[i];
+        maxZ[i] = z[i] + r[i];
+    }
+
+    std::vector< vmml::Visibility > spheres( n ), boxes( n );
+    std::vector< vmml::Visibility > culledSpheres( n ), culledBoxes( n );
+    std::vector< uint32_t > sphereLODs( n ), boxLODs( n );
+    selector.test( x.data(), y.data(), z.data(), r.data(), n,
+                   spheres.data(), sphereLODs.data( ));
+    selector.test( minX.data(), minY.data(), minZ.data(), maxX.data(),
+                   maxY.data(), maxZ.data(), n, boxes.data(),
+                   boxLODs.data( ));
+    culler.test( x.data(), y.data(), z.data(), r.data(), n,
+                 culledSpheres.data( ));
+    culler.test( minX.data(), minY.data(), minZ.data(), maxX.data(),
+                 maxY.data(), maxZ.data(), n, culledBoxes.data( ));
+
+    std::vector< size_t > levels( nThresholds + 1, 0 );
+    size_t small = 0;
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vec4 sphere( x[i], y[i], z[i], r[i] );
+        const vmml::AABB< T > box( vec3( minX[i], minY[i], minZ[i] ),
+                                   vec3( maxX[i], maxY[i], maxZ[i] ));
+        const vec4 boxSphere( box.getCenter(), box.getSize().length() / 2 );
+        const T sphereRadius = selector.getProjectedRadius( sphere );
+        const T boxRadius = selector.getProjectedRadius( boxSphere );
+
+        // the visibility of the frustum culler unless too small
+        BOOST_CHECK_EQUAL( spheres[i], sphereRadius < 2 ?
+                                       vmml::VISIBILITY_NONE :
+                                       culledSpheres[i] );
+        BOOST_CHECK_EQUAL( boxes[i], boxRadius < 2 ?
+                                     vmml::VISIBILITY_NONE : culledBoxes[i] );
+        BOOST_CHECK_EQUAL( sphereLODs[i], _getLOD( sphereRadius ));
+        BOOST_CHECK_EQUAL( boxLODs[i], _getLOD( boxRadius ));
+
+        uint32_t lod = 0;
+        BOOST_CHECK_EQUAL( selector.test( sphere, lod ), spheres[i] );
+        BOOST_CHECK_EQUAL( lod, sphereLODs[i] );
+        BOOST_CHECK_EQUAL( selector.test( box, lod ), boxes[i] );
+        BOOST_CHECK_EQUAL( lod, boxLODs[i] );
+
+        if( culledSpheres[i] != vmml::VISIBILITY_NONE )
+        {
+            ++levels[ sphereLODs[i] ];
+            small += spheres[i] == vmml::VISIBILITY_NONE;
+        }
+    }
+
+    // make sure the data covers all cases
+    for( size_t i = 0; i <= nThresholds; ++i )
+        BOOST_CHECK_GT( levels[i], 0 );
+    BOOST_CHECK_GT( small, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( batch )
+{
+    _testBatch< float >();
+    _testBatch< double >();
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/exponentialFilter.hpp>
+#include <vmmlib/lowpassFilter.hpp>
+#include <vmmlib/types.hpp>
+#include <vmmlib/vector.hpp>
+
+#define BOOST_TEST_MODULE lowpassFilter
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <deque>
+
+namespace
+{
+// reference implementation re-filtering the whole history on each value
+template< size_t M, typename T > struct Reference
+{
+    explicit Reference( const float F ) : smoothFactor( F ) {}
+
+    T add( const T& value )
+    {
+        data.push_front( value );
+        while( data.size() > M )
+            data.pop_back();
+
+        typename std::deque< T >::const_iterator i = data.begin();
+        T result = *i;
+        double weight = smoothFactor;
+        for( ++i ; i != data.end(); ++i )
+        {
+            result = result * (1 - weight) + (*i) * weight;
+            weight *= smoothFactor;
+        }
+        return result;
+    }
+
+    std::deque< T > data;
+    float smoothFactor;
+};
+}
+
+BOOST_AUTO_TEST_CASE( lowpass )
+{
+    vmml::LowpassFilter< 5, vmml::Vector3f > filter( .7f );
+    Reference< 5, vmml::Vector3f > reference( .7f );
+    for( size_t i = 0; i < 23; ++i )
+    {
+        const vmml::Vector3f value( std::sin( float( i )), float( i ),
+                                    float( i % 3 ));
+        const vmml::Vector3f expected = reference.add( value );
+        BOOST_CHECK_EQUAL( filter.add( value ), expected );
+        BOOST_CHECK_EQUAL( *filter, expected );
+    }
+
+    vmml::LowpassFilter< 1, float > passThrough( .5f );
+    BOOST_CHECK_EQUAL( passThrough.add( 2.f ), 2.f );
+    BOOST_CHECK_EQUAL( passThrough.add( 3.f ), 3.f );
+}
+
+BOOST_AUTO_TEST_CASE( exponential )
+{
+    vmml::ExponentialFilter< vmml::Vector2f > filter( .25f );
+    BOOST_CHECK_EQUAL( filter.add( vmml::Vector2f( 4.f, 8.f )),
+                       vmml::Vector2f( 4.f, 8.f ));
+    BOOST_CHECK_EQUAL( filter.add( vmml::Vector2f( 8.f, 0.f )),
+                       vmml::Vector2f( 7.f, 2.f ));
+    BOOST_CHECK_EQUAL( filter->x(), 7.f );
+
+    filter.reset();
+    BOOST_CHECK_EQUAL( filter.add( vmml::Vector2f( 1.f, 1.f )),
+                       vmml::Vector2f( 1.f, 1.f ));
+
+    // smoothing in the precision of the filtered values
+    vmml::ExponentialFilter< double > precise( .1 );
+    precise.add( 0. );
+    BOOST_CHECK_EQUAL( precise.add( 1. ), 1. - .1 );
+}
+
+template< typename T > static void _testExponentialArray()
+{
+    // not a multiple of any SIMD width to cover the scalar remainder
+    const size_t n = 37;
+    const T smoothing = T( .8 );
+    vmml::ExponentialFilterArray< T > filters( n, smoothing );
+    const vmml::ExponentialFilter< T > reference( smoothing );
+    std::vector< vmml::ExponentialFilter< T > > references( n, reference );
+    BOOST_CHECK_EQUAL( filters.getSize(), n );
+
+    std::vector< T > values( n );
+    for( size_t i = 0; i < 10; ++i )
+    {
+        for( size_t j = 0; j < n; ++j )
+            values[j] = std::sin( T( i * n + j ));
+        const T* result = filters.add( values.data( ));
+        BOOST_CHECK_EQUAL( result, filters.get( ));
+
+        for( size_t j = 0; j < n; ++j )
+        {
+            const T expected = references[j].add( values[j] );
+            BOOST_CHECK_SMALL( result[j] - expected, T( 1e-5 ));
+            BOOST_CHECK_EQUAL( filters[j], result[j] );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( exponentialArray )
+{
+    _testExponentialArray< float >();
+    _testExponentialArray< double >();
+}
@@ -26,7 +26,9 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <vmmlib/expression.hpp>
 #include <vmmlib/matrix.hpp>
+#include <vmmlib/transformArray.hpp>
 #include <vmmlib/types.hpp>
 
 #define BOOST_TEST_MODULE matrix
@@ -76,6 +78,50 @@ BOOST_AUTO_TEST_CASE( lookat )
     BOOST_CHECK_EQUAL( up, newUp );
 }
 
+template< typename T > static void _testMultiply()
+{
+    // small integers give exact products, independent of FMA
+    T leftData[16], rightData[16];
+    for( size_t i = 0; i < 16; ++i )
+    {
+        leftData[i] = T( i + 1 );
+        rightData[i] = T( int( i % 5 ) - 2 );
+    }
+    const vmml::Matrix< 4, 4, T > left( leftData, leftData + 16 );
+    const vmml::Matrix< 4, 4, T > right( rightData, rightData + 16 );
+
+    vmml::Matrix< 4, 4, T > expected;
+    for( size_t row = 0; row < 4; ++row )
+        for( size_t col = 0; col < 4; ++col )
+        {
+            T value = 0;
+            for( size_t i = 0; i < 4; ++i )
+                value += left( row, i ) * right( i, col );
+            expected( row, col ) = value;
+        }
+
+    BOOST_CHECK_EQUAL( left * right, expected );
+
+    vmml::Matrix< 4, 4, T > product( left );
+    product *= right;
+    BOOST_CHECK_EQUAL( product, expected );
+
+    product = right;
+    product.multiply( left, product );
+    BOOST_CHECK_EQUAL( product, expected );
+
+    product = left;
+    product.multiply( product, product );
+    BOOST_CHECK_EQUAL( product, left * left );
+}
+
+BOOST_AUTO_TEST_CASE( multiply )
+{
+    _testMultiply< float >();
+    _testMultiply< double >();
+    _testMultiply< int >();
+}
+
 BOOST_AUTO_TEST_CASE( nonInvertible )
 {
     vmml::Matrix2f matrix;
@@ -83,6 +129,217 @@ BOOST_AUTO_TEST_CASE( nonInvertible )
     matrix( 1, 1 ) = 0.f;
     const vmml::Matrix2f inverse = matrix.inverse();
     BOOST_CHECK( std::isnan( inverse( 0, 1 )));
+
+    vmml::Matrix3f matrix3;
+    matrix3( 1, 1 ) = 0.f;
+    BOOST_CHECK( std::isnan( vmml::computeInverse( matrix3 )( 0, 1 )));
+}
+
+template< typename T > void _testTransformArray()
+{
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::vector< 4, T > vec4;
+
+    vmml::Matrix< 4, 4, T > matrix;
+    matrix.rotate_x( T( .3 ));
+    matrix.rotate_y( T( -.7 ));
+    matrix.scale( vec3( 1, 2, 3 ));
+    matrix.setTranslation( vec3( 4, 5, 6 ));
+    const T tolerance = std::numeric_limits< T >::epsilon() * 64;
+
+    // odd size to exercise the scalar tail after the SIMD packs
+    const size_t n = 37;
+    std::vector< vec3 > points( n );
+    std::vector< vec4 > homogeneous( n );
+    for( size_t i = 0; i < n; ++i )
+    {
+        points[i] = vec3( T( i ), T( 1 ) - T( i ) / 2, T( i % 5 ));
+        homogeneous[i] = vec4( points[i], T( i % 3 ));
+    }
+
+    std::vector< vec3 > result( n );
+    vmml::transform( matrix, &points[0], &result[0], n );
+    for( size_t i = 0; i < n; ++i )
+        BOOST_CHECK( result[i].equals( matrix * points[i], tolerance * 16 ));
+
+    vmml::transform( matrix, &points[0], &result[0], n,
+                     vmml::TRANSFORM_DIRECTION );
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vec4 expected = matrix * vec4( points[i], 0 );
+        BOOST_CHECK( result[i].equals( vec3( expected.array ), tolerance * 16));
+    }
+
+    // normals stay perpendicular to transformed tangents
+    const vec3 tangent( 1, 1, 0 );
+    const vec3 normal( 1, -1, 0 );
+    vec3 transformedTangent, transformedNormal;
+    vmml::transform( matrix, &tangent, &transformedTangent, 1,
+                     vmml::TRANSFORM_DIRECTION );
+    vmml::transform( matrix, &normal, &transformedNormal, 1,
+                     vmml::TRANSFORM_NORMAL );
+    BOOST_CHECK_SMALL( transformedTangent.dot( transformedNormal ),
+                       tolerance * 16 );
+
+    std::vector< vec4 > result4( n );
+    vmml::transform( matrix, &homogeneous[0], &result4[0], n );
+    for( size_t i = 0; i < n; ++i )
+        BOOST_CHECK( result4[i].equals( matrix * homogeneous[i],
+                                        tolerance * 16 ));
+
+    // projective, in place on an interleaved position/color stream
+    vmml::Matrix< 4, 4, T > projection;
+    projection.array[11] = -1;
+    projection.array[14] = 2;
+    projection.array[15] = 0;
+    std::vector< T > stream( n * 6 );
+    for( size_t i = 0; i < n; ++i )
+        for( size_t j = 0; j < 6; ++j )
+            stream[ i * 6 + j ] = j < 3 ? points[i][j] - T( 50 ) : T( j );
+    const std::vector< T > original( stream );
+    vmml::transform( projection, &stream[0], 6, &stream[0], 6, n,
+                     vmml::TRANSFORM_PROJECTIVE );
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vec4 expected = projection * vec4( original[ i * 6 ],
+                                                 original[ i * 6 + 1 ],
+                                                 original[ i * 6 + 2 ], 1 );
+        for( size_t j = 0; j < 3; ++j )
+            BOOST_CHECK_CLOSE( stream[ i * 6 + j ], expected[j] / expected[3],
+                               tolerance * 100 );
+        for( size_t j = 3; j < 6; ++j )
+            BOOST_CHECK_EQUAL( stream[ i * 6 + j ], T( j ));
+    }
+
+    // several chunks, transformed in parallel when built with OpenMP
+    std::vector< vec3 > large( 40000 );
+    for( size_t i = 0; i < large.size(); ++i )
+        large[i] = points[ i % n ];
+    vmml::transform( matrix, &large[0], &large[0], large.size( ));
+    for( size_t i = 0; i < large.size(); ++i )
+        BOOST_CHECK( large[i].equals( matrix * points[ i % n ],
+                                      tolerance * 16 ));
+
+    vmml::Matrix< 4, 4, T > singular;
+    singular.array[5] = 0;
+    BOOST_CHECK_THROW( vmml::transform( singular, &normal, &transformedNormal,
+                                        1, vmml::TRANSFORM_NORMAL ),
+                       std::runtime_error );
+
+    // a small uniform scale is not singular, e.g. millimeters to meters
+    vmml::Matrix< 4, 4, T > scale;
+    for( size_t i = 0; i < 3; ++i )
+        scale( i, i ) = T( .001 );
+    vmml::transform( scale, &normal, &transformedNormal, 1,
+                     vmml::TRANSFORM_NORMAL );
+    BOOST_CHECK( transformedNormal.equals( normal * T( 1000 ),
+                                           tolerance * 1000 ));
+}
+
+BOOST_AUTO_TEST_CASE( transformArray )
+{
+    _testTransformArray< float >();
+    _testTransformArray< double >();
+}
+
+template< typename T > void _testInverse()
+{
+    typedef vmml::vector< 3, T > vec3;
+    const T tolerance = std::numeric_limits< T >::epsilon() * 64;
+    const vmml::Matrix< 4, 4, T > identity;
+
+    vmml::Matrix< 4, 4, T > rigid;
+    rigid.rotate_x( T( .3 ));
+    rigid.rotate_z( T( 1.2 ));
+    rigid.setTranslation( vec3( 4, -5, 6 ));
+    BOOST_CHECK( ( rigid * rigid.inverseRigid( )).equals( identity,
+                                                          tolerance ));
+    BOOST_CHECK( rigid.inverseRigid().equals( rigid.inverse(), tolerance ));
+
+    vmml::Matrix< 4, 4, T > affine = rigid;
+    affine.scale( vec3( 2, 3, .5 ));
+    affine( 0, 1 ) += T( .7 ); // shear
+    BOOST_CHECK( ( affine * affine.inverseAffine( )).equals( identity,
+                                                             tolerance ));
+    BOOST_CHECK( affine.inverseAffine().equals( affine.inverse(), tolerance ));
+
+    vmml::Matrix< 4, 4, T > projective = affine;
+    projective( 3, 0 ) = T( .1 );
+    projective( 3, 2 ) = T( -.4 );
+    projective( 3, 3 ) = T( 2 );
+    BOOST_CHECK( ( projective * projective.inverse( )).equals( identity,
+                                                               tolerance ));
+
+    vmml::Matrix< 4, 4, T > singular = affine;
+    singular.setRow( 2, singular.getRow( 0 ) * T( 2 ));
+    BOOST_CHECK( std::isnan( singular.inverseAffine()( 0, 0 )));
+    singular( 3, 0 ) = T( 1 );
+    BOOST_CHECK( std::isnan( singular.inverse()( 0, 0 )));
+
+    const vmml::Matrix< 3, 3, T > matrix3;
+    BOOST_CHECK_THROW( matrix3.inverseAffine(), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( inverse )
+{
+    _testInverse< float >();
+    _testInverse< double >();
+
+    // the float Cramer's rule kernel against the double cofactor expansion
+    vmml::Matrix4d matrix;
+    for( size_t i = 0; i < 16; ++i )
+        matrix.array[i] = double(( i * 7 ) % 11 ) - 5.;
+    vmml::Matrix4f matrixf;
+    for( size_t i = 0; i < 16; ++i )
+        matrixf.array[i] = float( matrix.array[i] );
+
+    const vmml::Matrix4d inverted = matrix.inverse();
+    const vmml::Matrix4f invertedf = matrixf.inverse();
+    for( size_t i = 0; i < 16; ++i )
+        BOOST_CHECK_CLOSE( invertedf.array[i], float( inverted.array[i] ),
+                           1e-4f );
+}
+
+BOOST_AUTO_TEST_CASE( lazyExpression )
+{
+    double data[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+    const vmml::Matrix4d a( data, data + 16 );
+    const vmml::Matrix4d b;
+
+    vmml::Matrix4d result = vmml::lazy( a ) * 2. - vmml::lazy( b ) / 4.;
+    for( size_t i = 0; i < 16; ++i )
+        BOOST_CHECK_EQUAL( result.array[i], a.array[i] * 2. - b.array[i] / 4. );
+
+    result = -vmml::lazy( result ) + a - b;
+    for( size_t i = 0; i < 16; ++i )
+        BOOST_CHECK_EQUAL( result.array[i], b.array[i] / 4. - a.array[i] -
+                                            b.array[i] );
+}
+
+namespace
+{
+// evaluated by the compiler with C++14, at static initialization otherwise
+const float data[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+VMMLIB_CONSTEXPR_OR_CONST vmml::Matrix4f matrix( data, data + 16 );
+VMMLIB_CONSTEXPR_OR_CONST vmml::Matrix4f product =
+    vmml::transpose( matrix ) * matrix;
+VMMLIB_CONSTEXPR_OR_CONST vmml::Vector4f column =
+    matrix * vmml::Vector4f( 0, 0, 1, 0 );
+
+#ifdef VMMLIB_HAS_CONSTEXPR
+static_assert( product( 0, 0 ) == 30 && product( 3, 2 ) == 614,
+               "constexpr multiply" );
+static_assert( column == vmml::Vector4f( 9, 10, 11, 12 ),
+               "constexpr vector multiply" );
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( constantExpression )
+{
+    BOOST_CHECK_EQUAL( product, vmml::transpose( matrix ) * matrix );
+    BOOST_CHECK_EQUAL( product( 0, 0 ), 30 );
+    BOOST_CHECK_EQUAL( product( 3, 2 ), 614 );
+    BOOST_CHECK_EQUAL( column, matrix.getColumn( 2 ));
 }
 
 // Verify code by instantiating some templates:
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/obb.hpp>
+#include <vmmlib/quaternion.hpp>
+#include <vmmlib/types.hpp>
+#include <vmmlib/vector.hpp>
+
+#define BOOST_TEST_MODULE obb
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+template< typename T > vmml::Matrix< 3, 3, T > _randomRotation()
+{
+    const vmml::vector< 3, T > axis( _random< T >( -1, 1 ),
+                                     _random< T >( -1, 1 ),
+                                     _random< T >( -1, 1 ));
+    return vmml::Quaternion< T >( _random< T >( 0, 3 ),
+                                  vmml::normalize( axis )).getRotationMatrix();
+}
+
+// n random points in a rotated box
+template< typename T >
+std::vector< vmml::vector< 3, T > > _points( const vmml::OBB< T >& box,
+                                             const size_t n )
+{
+    std::vector< vmml::vector< 3, T > > points( n );
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vmml::vector< 3, T > local(
+            _random( -box.getExtents()[0], box.getExtents()[0] ),
+            _random( -box.getExtents()[1], box.getExtents()[1] ),
+            _random( -box.getExtents()[2], box.getExtents()[2] ));
+        points[i] = box.getCenter() + box.getAxes() * local;
+    }
+    return points;
+}
+
+template< typename T >
+bool _contains( const vmml::OBB< T >& box,
+                const std::vector< vmml::vector< 3, T > >& points )
+{
+    // the boxes are computed from the projections of the points, which are
+    // rounded differently from the rotated offsets
+    const T tolerance = std::numeric_limits< T >::epsilon() * 1024;
+    const vmml::vector< 3, T > extents = box.getExtents() +
+                                         vmml::vector< 3, T >( tolerance );
+    const vmml::OBB< T > tolerant( box.getCenter(), box.getAxes(), extents );
+    for( size_t i = 0; i < points.size(); ++i )
+        if( !tolerant.isIn( points[i] ))
+            return false;
+    return true;
+}
+
+// reference separating axis test on the projected corners
+template< typename T >
+bool _intersects( const vmml::OBB< T >& a, const vmml::OBB< T >& b )
+{
+    std::vector< vmml::vector< 3, T > > axes;
+    for( size_t i = 0; i < 3; ++i )
+    {
+        axes.push_back( a.getAxes().getColumn( i ));
+        axes.push_back( b.getAxes().getColumn( i ));
+        for( size_t j = 0; j < 3; ++j )
+            axes.push_back( vmml::cross( a.getAxes().getColumn( i ),
+                                         b.getAxes().getColumn( j )));
+    }
+
+    for( size_t i = 0; i < axes.size(); ++i )
+    {
+        if( axes[i].squared_length() < T( 1e-6 ))
+            continue;
+        T minA = std::numeric_limits< T >::max(), maxA = -minA;
+        T minB = minA, maxB = maxA;
+        for( size_t j = 0; j < 8; ++j )
+        {
+            const T pa = axes[i].dot( a.getCorner( j ));
+            const T pb = axes[i].dot( b.getCorner( j ));
+            minA = std::min( minA, pa );
+            maxA = std::max( maxA, pa );
+            minB = std::min( minB, pb );
+            maxB = std::max( maxB, pb );
+        }
+        if( maxA < minB || maxB < minA )
+            return false;
+    }
+    return true;
+}
+
+template< typename T > void _testConstruction()
+{
+    typedef vmml::vector< 3, T > vec3;
+
+    const vmml::OBB< T > empty;
+    BOOST_CHECK_EQUAL( empty.getCenter(), vec3( T( 0 )));
+    BOOST_CHECK_EQUAL( empty.getExtents(), vec3( T( 0 )));
+    BOOST_CHECK_EQUAL( empty.getAxes(), ( vmml::Matrix< 3, 3, T >( )));
+
+    const vmml::AABB< T > aabb( vec3( -1, 2, 3 ), vec3( 3, 4, 9 ));
+    const vmml::OBB< T > box( aabb );
+    BOOST_CHECK_EQUAL( box.getCenter(), aabb.getCenter( ));
+    BOOST_CHECK_EQUAL( box.getSize(), aabb.getSize( ));
+    BOOST_CHECK_EQUAL( box.getVolume(), 48 );
+    BOOST_CHECK_EQUAL( box.getAABB(), aabb );
+    BOOST_CHECK_EQUAL( box.getCorner( 0 ), aabb.getMin( ));
+    BOOST_CHECK_EQUAL( box.getCorner( 7 ), aabb.getMax( ));
+    BOOST_CHECK_EQUAL( box.getCorner( 5 ), vec3( 3, 2, 9 ));
+    BOOST_CHECK( box.isIn( vec3( 0, 3, 4 )));
+    BOOST_CHECK( !box.isIn( vec3( 0, 5, 4 )));
+    BOOST_CHECK( box == vmml::OBB< T >( aabb ));
+    BOOST_CHECK( box != empty );
+
+    // the corners of a rotated box
+    srand( 42 );
+    const vmml::OBB< T > rotated( vec3( 1, 2, 3 ), _randomRotation< T >(),
+                                  vec3( 1, 2, 3 ));
+    const vmml::AABB< T > bounds = rotated.getAABB();
+    for( size_t i = 0; i < 8; ++i )
+    {
+        const vec3 corner = rotated.getCorner( i );
+        BOOST_CHECK_CLOSE(( corner - rotated.getCenter( )).length(),
+                          std::sqrt( T( 14 )), 1e-3 );
+        BOOST_CHECK( bounds.isIn( corner - vec3( T( 1e-3 )) *
+                                  vmml::normalize( corner - bounds.getCenter( ))
+                                 ));
+        BOOST_CHECK( !rotated.isIn( corner * T( 1.01 ) -
+                                    rotated.getCenter() * T( .01 )));
+    }
+}
+
+template< typename T > void _testFit()
+{
+    typedef vmml::vector< 3, T > vec3;
+    srand( 42 );
+    for( size_t i = 0; i < 20; ++i )
+    {
+        const vmml::OBB< T > box( vec3( _random< T >( -10, 10 ),
+                                        _random< T >( -10, 10 ),
+                                        _random< T >( -10, 10 )),
+                                  _randomRotation< T >(),
+                                  vec3( 10, 2, T( .5 )));
+        const std::vector< vec3 > points = _points( box, 1000 );
+
+        const vmml::OBB< T > pca =
+            vmml::OBB< T >::fromPointsPCA( points.data(), points.size( ));
+        const vmml::OBB< T > dito =
+            vmml::OBB< T >::fromPointsDiTO( points.data(), points.size( ));
+        BOOST_CHECK( _contains( pca, points ));
+        BOOST_CHECK( _contains( dito, points ));
+
+        // much tighter than the axis-aligned box of the points
+        vmml::AABB< T > aabb;
+        for( size_t j = 0; j < points.size(); ++j )
+            aabb.merge( points[j] );
+        const T aabbVolume = aabb.getSize().x() * aabb.getSize().y() *
+                             aabb.getSize().z();
+        BOOST_CHECK_LE( pca.getVolume(), box.getVolume() * T( 1.2 ));
+        BOOST_CHECK_LE( dito.getVolume(), box.getVolume() * T( 2 ));
+        BOOST_CHECK_LE( dito.getVolume(), aabbVolume );
+
+        // the axes are rotations
+        BOOST_CHECK_CLOSE( computeDeterminant( pca.getAxes( )), 1, 1e-3 );
+        BOOST_CHECK_CLOSE( computeDeterminant( dito.getAxes( )), 1, 1e-3 );
+    }
+}
+
+template< typename T > void _testDegenerate()
+{
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::OBB< T > OBB;
+
+    BOOST_CHECK( OBB::fromPointsPCA( 0, 0 ) == OBB( ));
+    BOOST_CHECK( OBB::fromPointsDiTO( 0, 0 ) == OBB( ));
+
+    // a single point, repeated
+    const std::vector< vec3 > point( 5, vec3( 1, 2, 3 ));
+    BOOST_CHECK_SMALL( OBB::fromPointsDiTO( point.data(), point.size( ))
+                           .getVolume(), T( 1e-6 ));
+    BOOST_CHECK_SMALL( OBB::fromPointsPCA( point.data(), point.size( ))
+                           .getVolume(), T( 1e-6 ));
+    BOOST_CHECK( OBB::fromPointsDiTO( point.data(), point.size( ))
+                     .isIn( point[0] ));
+
+    // points on a line and in a plane
+    srand( 42 );
+    std::vector< vec3 > line, plane;
+    const vec3 direction = vmml::normalize( vec3( 1, -2, 3 ));
+    const vec3 other = vmml::normalize( vmml::cross( direction,
+                                                     vec3( 0, 0, 1 )));
+    for( size_t i = 0; i < 100; ++i )
+    {
+        const T t = _random< T >( -5, 5 );
+        line.push_back( vec3( 1, 2, 3 ) + direction * t );
+        plane.push_back( line.back() + other * _random< T >( -1, 1 ));
+    }
+
+    const OBB lineDiTO = OBB::fromPointsDiTO( line.data(), line.size( ));
+    const OBB linePCA = OBB::fromPointsPCA( line.data(), line.size( ));
+    BOOST_CHECK( _contains( lineDiTO, line ));
+    BOOST_CHECK( _contains( linePCA, line ));
+    BOOST_CHECK_SMALL( lineDiTO.getVolume(), T( 1e-3 ));
+    BOOST_CHECK_SMALL( linePCA.getVolume(), T( 1e-3 ));
+
+    const OBB planeDiTO = OBB::fromPointsDiTO( plane.data(), plane.size( ));
+    const OBB planePCA = OBB::fromPointsPCA( plane.data(), plane.size( ));
+    BOOST_CHECK( _contains( planeDiTO, plane ));
+    BOOST_CHECK( _contains( planePCA, plane ));
+    BOOST_CHECK_SMALL( planeDiTO.getVolume(), T( 1e-3 ));
+    BOOST_CHECK_SMALL( planePCA.getVolume(), T( 1e-3 ));
+}
+
+template< typename T > void _testBatch()
+{
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::OBB< T > OBB;
+
+    // several chunks of points, including duplicates of the extremal points
+    srand( 42 );
+    const OBB box( vec3( 1, 2, 3 ), _randomRotation< T >(), vec3( 3, 2, 1 ));
+    std::vector< vec3 > points = _points( box, 50001 );
+    for( size_t i = 0; i < 1000; ++i )
+        points[ 20000 + i * 17 ] = points[ i * 13 ];
+
+    // the results of the SIMD levels are compared in dispatch.cpp
+    const OBB dito = OBB::fromPointsDiTO( points.data(), points.size( ));
+    const OBB pca = OBB::fromPointsPCA( points.data(), points.size( ));
+    BOOST_CHECK( _contains( dito, points ));
+    BOOST_CHECK( _contains( pca, points ));
+}
+
+template< typename T > void _testIntersects()
+{
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::OBB< T > OBB;
+
+    // separated only by the cross product of two edges
+    const T sqrt2 = std::sqrt( T( 2 ));
+    const vec3 z( 0, 0, 1 );
+    const vec3 y( 0, 1, 0 );
+    const OBB a( vec3( T( 0 )), vmml::Quaternion< T >(
+                     T( M_PI / 4 ), z ).getRotationMatrix(), vec3( 1, 1, 1 ));
+    const OBB b( vec3( 2 * sqrt2 + T( .1 ), 0, 0 ), vmml::Quaternion< T >(
+                     T( M_PI / 4 ), y ).getRotationMatrix(), vec3( 1, 1, 1 ));
+    const OBB c( vec3( 2 * sqrt2 - T( .1 ), 0, 0 ), b.getAxes(),
+                 b.getExtents( ));
+    BOOST_CHECK( !a.intersects( b ));
+    BOOST_CHECK( !b.intersects( a ));
+    BOOST_CHECK( a.intersects( c ));
+    BOOST_CHECK( c.intersects( a ));
+    BOOST_CHECK( a.intersects( a ));
+
+    // parallel boxes
+    const OBB d( vec3( 2.1f, 0, 0 ), a.getAxes(), a.getExtents( ));
+    BOOST_CHECK( !a.intersects( OBB( vec3( 2 * sqrt2 + T( .1 ), 0, 0 ),
+                                     a.getAxes(), a.getExtents( ))));
+    BOOST_CHECK( a.intersects( d ));
+
+    srand( 42 );
+    size_t nIntersections = 0;
+    for( size_t i = 0; i < 1000; ++i )
+    {
+        const OBB first( vec3( _random< T >( -3, 3 ), _random< T >( -3, 3 ),
+                               _random< T >( -3, 3 )),
+                         _randomRotation< T >(),
+                         vec3( _random< T >( 0, 2 ), _random< T >( 0, 2 ),
+                               _random< T >( 0, 2 )));
+        const OBB second( vec3( _random< T >( -3, 3 ), _random< T >( -3, 3 ),
+                                _random< T >( -3, 3 )),
+                          _randomRotation< T >(),
+                          vec3( _random< T >( 0, 2 ), _random< T >( 0, 2 ),
+                                _random< T >( 0, 2 )));
+        const bool intersects = first.intersects( second );
+        BOOST_CHECK_EQUAL( intersects, second.intersects( first ));
+        BOOST_CHECK_EQUAL( intersects, _intersects( first, second ));
+        if( intersects )
+            ++nIntersections;
+        if( first.isIn( second.getCenter( )))
+            BOOST_CHECK( intersects );
+    }
+    BOOST_CHECK_GT( nIntersections, 0 );
+    BOOST_CHECK_LT( nIntersections, 1000 );
+}
+
+template< typename T > void _testTransform()
+{
+    typedef vmml::vector< 3, T > vec3;
+    srand( 42 );
+    for( size_t i = 0; i < 100; ++i )
+    {
+        const vmml::OBB< T > box( vec3( _random< T >( -3, 3 ),
+                                        _random< T >( -3, 3 ),
+                                        _random< T >( -3, 3 )),
+                                  _randomRotation< T >(),
+                                  vec3( _random< T >( 0, 2 ),
+                                        _random< T >( 0, 2 ),
+                                        _random< T >( 0, 2 )));
+        const vmml::Matrix< 3, 3, T > rotation = _randomRotation< T >();
+        const T scale = _random< T >( T( .5 ), 2 );
+        vmml::Matrix< 4, 4, T > transform;
+        for( size_t j = 0; j < 3; ++j )
+            for( size_t k = 0; k < 3; ++k )
+                transform.array[ 4 * j + k ] = rotation.array[ 3 * j + k ] *
+                                               scale;
+        transform.setTranslation( vec3( _random< T >( -3, 3 ),
+                                        _random< T >( -3, 3 ),
+                                        _random< T >( -3, 3 )));
+
+        // the bounding box of the transformed corners
+        vmml::AABB< T > expected;
+        for( size_t j = 0; j < 8; ++j )
+        {
+            const vmml::vector< 4, T > corner( box.getCorner( j ), 1 );
+            expected.merge( vec3( transform * corner ));
+        }
+        const vmml::AABB< T > aabb = box.getAABB( transform );
+        const T tolerance = std::numeric_limits< T >::epsilon() * 64;
+        BOOST_CHECK( aabb.getMin().equals( expected.getMin(), tolerance ));
+        BOOST_CHECK( aabb.getMax().equals( expected.getMax(), tolerance ));
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE( construction )
+{
+    _testConstruction< float >();
+    _testConstruction< double >();
+}
+
+BOOST_AUTO_TEST_CASE( fit )
+{
+    _testFit< float >();
+    _testFit< double >();
+}
+
+BOOST_AUTO_TEST_CASE( degenerate )
+{
+    _testDegenerate< float >();
+    _testDegenerate< double >();
+}
+
+BOOST_AUTO_TEST_CASE( batch )
+{
+    _testBatch< float >();
+    _testBatch< double >();
+}
+
+BOOST_AUTO_TEST_CASE( intersects )
+{
+    _testIntersects< float >();
+    _testIntersects< double >();
+}
+
+BOOST_AUTO_TEST_CASE( transform )
+{
+    _testTransform< float >();
+    _testTransform< double >();
+}
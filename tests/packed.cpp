@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/packed.hpp>
+#include <vmmlib/types.hpp>
+
+#define BOOST_TEST_MODULE packed
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+#include <cstdlib>
+#include <limits>
+
+namespace
+{
+// odd size to exercise the scalar tails, and more than one parallel chunk
+const size_t size = 20001;
+
+template< typename T > std::vector< vmml::Quaternion< T > > _rotations()
+{
+    std::vector< vmml::Quaternion< T > > rotations( size );
+    for( size_t i = 0; i < size; ++i )
+    {
+        rotations[i] = vmml::Quaternion< T >( _random< T >( -1, 1 ),
+                                              _random< T >( -1, 1 ),
+                                              _random< T >( -1, 1 ),
+                                              _random< T >( -1, 1 ));
+        rotations[i].normalize();
+    }
+    return rotations;
+}
+
+// q and -q are the same rotation
+template< typename T > bool _equals( const vmml::Quaternion< T >& a,
+                                     const vmml::Quaternion< T >& b,
+                                     const T tolerance )
+{
+    return a.equals( vmml::dot( a, b ) < 0 ? -b : b, tolerance );
+}
+
+template< typename T, class Packed > void _testQuaternions( const T bound )
+{
+    const std::vector< vmml::Quaternion< T > > rotations = _rotations< T >();
+    std::vector< Packed > packed( size );
+    std::vector< vmml::Quaternion< T > > decoded( size );
+    vmml::encode( rotations.data(), packed.data(), size );
+    vmml::decode( packed.data(), decoded.data(), size );
+
+    for( size_t i = 0; i < size; ++i )
+    {
+        BOOST_CHECK_SMALL( decoded[i].abs() - T( 1 ),
+                           std::numeric_limits< T >::epsilon() * 4 );
+        BOOST_CHECK( _equals( decoded[i], rotations[i], bound ));
+        BOOST_CHECK( _equals( Packed( rotations[i] ).template get< T >(),
+                              decoded[i], bound ));
+        BOOST_CHECK( packed[i].template get< T >().equals(
+                         decoded[i], std::numeric_limits< T >::epsilon() * 4 ));
+    }
+
+    // exact zero components, and a positive largest one
+    const vmml::Quaternion< T > identity;
+    BOOST_CHECK( Packed() == Packed( identity ));
+    BOOST_CHECK_EQUAL( Packed().template get< T >(), identity );
+    BOOST_CHECK_EQUAL( Packed( -identity ).template get< T >(), identity );
+    const vmml::Quaternion< T > halfTurn( 0, -1, 0, 0 );
+    BOOST_CHECK_EQUAL( Packed( halfTurn ).template get< T >(), -halfTurn );
+}
+
+template< typename T > std::vector< vmml::vector< 3, T > > _normals()
+{
+    std::vector< vmml::vector< 3, T > > normals( size );
+    for( size_t i = 0; i < size; ++i )
+        normals[i] = vmml::normalize( vmml::vector< 3, T >(
+            _random< T >( -1, 1 ), _random< T >( -1, 1 ),
+            _random< T >( -1, 1 )));
+    return normals;
+}
+
+template< typename T, class Packed > void _testNormals( const T bound )
+{
+    typedef vmml::vector< 3, T > vec3;
+    const std::vector< vec3 > normals = _normals< T >();
+    std::vector< Packed > packed( size );
+    std::vector< vec3 > decoded( size );
+    vmml::encode( normals.data(), packed.data(), size );
+    vmml::decode( packed.data(), decoded.data(), size );
+
+    for( size_t i = 0; i < size; ++i )
+    {
+        BOOST_CHECK_SMALL( decoded[i].length() - T( 1 ),
+                           std::numeric_limits< T >::epsilon() * 4 );
+        BOOST_CHECK( decoded[i].equals( normals[i], bound ));
+        BOOST_CHECK( Packed( normals[i] ).template get< T >().equals(
+                         decoded[i], bound ));
+        BOOST_CHECK( packed[i].template get< T >().equals(
+                         decoded[i], std::numeric_limits< T >::epsilon() * 4 ));
+    }
+
+    // exact axes
+    BOOST_CHECK_EQUAL( Packed().template get< T >(), vec3( 0, 0, 1 ));
+    for( size_t i = 0; i < 3; ++i )
+    {
+        vec3 axis( 0, 0, 0 );
+        axis[i] = 1;
+        BOOST_CHECK_EQUAL( Packed( axis ).template get< T >(), axis );
+        BOOST_CHECK_EQUAL( Packed( -axis ).template get< T >(), -axis );
+    }
+}
+
+template< typename T > void _testHalves()
+{
+    std::vector< T > values( size );
+    for( size_t i = 0; i < size; ++i )
+        values[i] = _random< T >( -70000, 70000 ) *
+                    std::pow( T( 2 ), -_random< T >( 0, 30 ));
+    std::vector< vmml::Half > halves( size );
+    std::vector< T > decoded( size );
+    vmml::encode( values.data(), halves.data(), size );
+    vmml::decode( halves.data(), decoded.data(), size );
+
+    for( size_t i = 0; i < size; ++i )
+    {
+        BOOST_CHECK( halves[i] == vmml::Half( values[i] ));
+        BOOST_CHECK_EQUAL( decoded[i], halves[i].template get< T >( ));
+        const T magnitude = std::abs( values[i] );
+        if( magnitude > T( 65520 ))
+            BOOST_CHECK_EQUAL( decoded[i], values[i] < 0 ?
+                                   -std::numeric_limits< T >::infinity() :
+                                   std::numeric_limits< T >::infinity( ));
+        else if( magnitude >= std::pow( T( 2 ), T( -14 )))
+            BOOST_CHECK_LE( std::abs( decoded[i] - values[i] ),
+                            magnitude * std::pow( T( 2 ), T( -11 )));
+        else
+            BOOST_CHECK_LE( std::abs( decoded[i] - values[i] ),
+                            std::pow( T( 2 ), T( -25 )));
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE( quaternions )
+{
+    BOOST_CHECK_EQUAL( sizeof( vmml::PackedQuaternion32 ), 4 );
+    BOOST_CHECK_EQUAL( sizeof( vmml::PackedQuaternion48 ), 6 );
+    _testQuaternions< float, vmml::PackedQuaternion32 >( 2e-3f );
+    _testQuaternions< double, vmml::PackedQuaternion32 >( 2e-3 );
+    _testQuaternions< float, vmml::PackedQuaternion48 >( 6e-5f );
+    _testQuaternions< double, vmml::PackedQuaternion48 >( 6e-5 );
+}
+
+BOOST_AUTO_TEST_CASE( normals )
+{
+    BOOST_CHECK_EQUAL( sizeof( vmml::PackedNormal16 ), 2 );
+    BOOST_CHECK_EQUAL( sizeof( vmml::PackedNormal32 ), 4 );
+    _testNormals< float, vmml::PackedNormal16 >( 1.6e-2f );
+    _testNormals< double, vmml::PackedNormal16 >( 1.6e-2 );
+    _testNormals< float, vmml::PackedNormal32 >( 6e-5f );
+    _testNormals< double, vmml::PackedNormal32 >( 6e-5 );
+}
+
+BOOST_AUTO_TEST_CASE( halves )
+{
+    BOOST_CHECK_EQUAL( sizeof( vmml::Half ), 2 );
+    _testHalves< float >();
+    _testHalves< double >();
+
+    // every half round-trips, NaNs remain NaN
+    for( uint32_t i = 0; i <= 0xffff; ++i )
+    {
+        const vmml::Half half = vmml::Half::fromBits( uint16_t( i ));
+        const float value = half.get< float >();
+        if( value != value )
+            BOOST_CHECK_NE( vmml::Half( value ).get< float >(),
+                            vmml::Half( value ).get< float >( ));
+        else
+            BOOST_CHECK_EQUAL( vmml::Half( value ).getBits(), i );
+    }
+
+    // ties round to even
+    BOOST_CHECK_EQUAL( vmml::Half( 1.f + std::pow( 2.f, -11.f )).get< float >(),
+                       1.f );
+    BOOST_CHECK_EQUAL( vmml::Half( 1.f + 3.f * std::pow( 2.f, -11.f ))
+                           .get< float >(), 1.f + std::pow( 2.f, -9.f ));
+    BOOST_CHECK_EQUAL( vmml::Half( 65504.f ).get< float >(), 65504.f );
+    BOOST_CHECK_EQUAL( vmml::Half( 65519.f ).get< float >(), 65504.f );
+    BOOST_CHECK_EQUAL( vmml::Half( 65520.f ).get< float >(),
+                       std::numeric_limits< float >::infinity( ));
+    BOOST_CHECK_EQUAL( vmml::Half( -0.f ).getBits(), 0x8000 );
+    BOOST_CHECK_EQUAL( vmml::Half( std::pow( 2.f, -24.f )).getBits(), 1 );
+    BOOST_CHECK_EQUAL( vmml::Half( std::pow( 2.f, -26.f )).getBits(), 0 );
+
+    // vectors as streams of components
+    const vmml::Vector3f vectors[2] = { vmml::Vector3f( 1, 2, 3 ),
+                                        vmml::Vector3f( -.5f, 1024, 0 ) };
+    vmml::Half encoded[6];
+    vmml::encode( vectors, encoded, 2 );
+    BOOST_CHECK_EQUAL( encoded[4].get< float >(), 1024.f );
+    vmml::Vector3f decoded[2];
+    vmml::decode( encoded, decoded, 2 );
+    BOOST_CHECK_EQUAL( decoded[0], vectors[0] );
+    BOOST_CHECK_EQUAL( decoded[1], vectors[1] );
+}
@@ -53,3 +53,109 @@ BOOST_AUTO_TEST_CASE( rotate )
                 vmml::Quaternionf( 0.6f, vmml::Vector3f( .5f, .5f, 1.f )), 0.00001f ),
                          vmml::Quaternionf( 0.6f, vmml::Vector3f( .5f, .5f, 1.f )));
 }
+
+namespace
+{
+// evaluated by the compiler with C++14, at static initialization otherwise
+VMMLIB_CONSTEXPR_OR_CONST vmml::Quaternionf rotateZ( 0, 0, 1, 0 );
+VMMLIB_CONSTEXPR_OR_CONST vmml::Matrix3f rotation =
+    ( rotateZ * rotateZ.inverse( )).getRotationMatrix();
+
+#ifdef VMMLIB_HAS_CONSTEXPR
+static_assert( rotation == vmml::Matrix3f(), "constexpr quaternion" );
+#endif
+}
+
+BOOST_AUTO_TEST_CASE( constantExpression )
+{
+    BOOST_CHECK_EQUAL( rotation, vmml::Matrix3f( ));
+    BOOST_CHECK_EQUAL( rotateZ.getRotationMatrix()( 0, 0 ), -1 );
+}
+
+BOOST_AUTO_TEST_CASE( interpolation )
+{
+    const vmml::Vector3d axis( 1, 2, 3 );
+    const vmml::Quaterniond a( .2, axis );
+    const vmml::Quaterniond b( 1.4, axis );
+
+    // constant angular velocity along the rotation from a to b
+    for( size_t i = 0; i <= 10; ++i )
+    {
+        const double t = double( i ) / 10.;
+        const vmml::Quaterniond expected( .2 + 1.2 * t, axis );
+        BOOST_CHECK_MESSAGE( vmml::slerp( a, b, t ).equals( expected, 1e-12 ),
+                             vmml::slerp( a, b, t ) << " != " << expected );
+        // the same path, but not at the same speed
+        const vmml::Quaterniond lerped = vmml::nlerp( a, b, t );
+        BOOST_CHECK_CLOSE( lerped.abs(), 1., 1e-10 );
+        BOOST_CHECK_SMALL( vmml::cross( lerped, expected ).length(), 1e-12 );
+    }
+    BOOST_CHECK( vmml::nlerp( a, b, .5 ).equals( vmml::slerp( a, b, .5 ),
+                                                 1e-12 ));
+
+    // the shorter arc of -b, the same rotation as b
+    BOOST_CHECK( vmml::slerp( a, -b, .5 ).equals( vmml::slerp( a, b, .5 ),
+                                                  1e-12 ));
+    BOOST_CHECK( vmml::nlerp( a, -b, .5 ).equals( vmml::nlerp( a, b, .5 ),
+                                                  1e-12 ));
+
+    // identical quaternions
+    BOOST_CHECK( vmml::slerp( a, a, .3 ).equals( a, 1e-12 ));
+    BOOST_CHECK( vmml::slerp( vmml::Quaternionf(), vmml::Quaternionf(),
+                              .3f ) == vmml::Quaternionf( ));
+}
+
+BOOST_AUTO_TEST_CASE( squad )
+{
+    const vmml::Quaterniond q( .7, vmml::Vector3d( 0, 1, 1 ));
+    BOOST_CHECK( vmml::exp( vmml::log( q )).equals( q, 1e-12 ));
+    BOOST_CHECK( vmml::log( vmml::Quaterniond( )) ==
+                 vmml::Quaterniond( 0, 0, 0, 0 ));
+
+    const vmml::Quaterniond keys[4] = {
+        vmml::Quaterniond( .1, vmml::Vector3d( 1, 0, 0 )),
+        vmml::Quaterniond( .9, vmml::Vector3d( 1, 1, 0 )),
+        vmml::Quaterniond( 1.2, vmml::Vector3d( 0, 1, 1 )),
+        vmml::Quaterniond( 2., vmml::Vector3d( 0, 0, 1 )) };
+    const vmml::Quaterniond controls[2] = {
+        vmml::squadControlPoint( keys[0], keys[1], keys[2] ),
+        vmml::squadControlPoint( keys[1], keys[2], keys[3] ) };
+
+    // interpolates the keys
+    BOOST_CHECK( vmml::squad( keys[1], keys[2], controls[0], controls[1],
+                              0. ).equals( keys[1], 1e-12 ));
+    BOOST_CHECK( vmml::squad( keys[1], keys[2], controls[0], controls[1],
+                              1. ).equals( keys[2], 1e-12 ));
+
+    // the control point of collinear keys is the key itself, for which squad
+    // falls back to slerp
+    const vmml::Vector3d axis( 1, 2, 3 );
+    const vmml::Quaterniond a( .2, axis ), b( .5, axis ), c( .8, axis );
+    BOOST_CHECK( vmml::squadControlPoint( a, b, c ).equals( b, 1e-12 ));
+    BOOST_CHECK( vmml::squad( a, b, a, b, .3 ).equals( vmml::slerp( a, b, .3 ),
+                                                       1e-12 ));
+
+    // control points in the hemispheres opposite to the keys, where the
+    // interpolated keys and control points become orthogonal midway
+    const vmml::Quaterniond start, end( .5, vmml::Vector3d( 0, 0, 1 ));
+    const vmml::Quaterniond startControl( 2.9, vmml::Vector3d( 1, 0, 0 ));
+    const vmml::Quaterniond endControl( 3.3, vmml::Vector3d( 1, 0, 0 ));
+    BOOST_CHECK_LT( vmml::dot( end, endControl ), 0. );
+
+    vmml::Quaterniond previous = start;
+    for( size_t i = 0; i <= 1000; ++i )
+    {
+        const vmml::Quaterniond current = vmml::squad( start, end, startControl,
+                                                       endControl, i / 1000. );
+        BOOST_CHECK_CLOSE( current.abs(), 1., 1e-10 );
+        BOOST_CHECK_MESSAGE( vmml::dot( previous, current ) > .999,
+                             "discontinuous at " << i / 1000. );
+        previous = current;
+    }
+    BOOST_CHECK( previous.equals( end, 1e-12 ));
+    BOOST_CHECK( vmml::squad( start, -end, startControl, -endControl,
+                              .4 ).equals( vmml::squad( start, end,
+                                                        startControl,
+                                                        endControl, .4 ),
+                                           1e-12 ));
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/quaternionArray.hpp>
+#include <vmmlib/types.hpp>
+
+#define BOOST_TEST_MODULE quaternionArray
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+#include <cstdlib>
+
+namespace
+{
+template< typename T > vmml::Quaternion< T > _randomRotation()
+{
+    return vmml::Quaternion< T >( _random< T >( -3, 3 ), vmml::vector< 3, T >(
+        _random< T >( -1, 1 ), _random< T >( -1, 1 ), 1 ));
+}
+
+// odd size to exercise the scalar tails, and more than one parallel chunk
+const size_t size = 20001;
+
+template< typename T > void _testInterpolation()
+{
+    const T epsilon = std::numeric_limits< T >::epsilon() * 16;
+    vmml::QuaternionArray< T > a( size ), b( size );
+    std::vector< T > t( size );
+    for( size_t i = 0; i < size; ++i )
+    {
+        a.set( i, _randomRotation< T >( ));
+        b.set( i, _randomRotation< T >( ));
+        t[i] = _random< T >( 0, 1 );
+    }
+    b.set( 0, a.get( 0 ));
+    b.set( 1, -a.get( 1 ));
+
+    vmml::QuaternionArray< T > nlerped, slerped, fast, uniform;
+    vmml::nlerp( a, b, t.data(), nlerped );
+    vmml::slerp( a, b, t.data(), slerped );
+    vmml::slerp( a, b, t.data(), fast, vmml::SLERP_FAST );
+    vmml::slerp( a, b, T( .3 ), uniform );
+    BOOST_CHECK_EQUAL( nlerped.getSize(), size );
+    BOOST_CHECK_EQUAL( slerped.getSize(), size );
+
+    for( size_t i = 0; i < size; ++i )
+    {
+        const vmml::Quaternion< T >& start = a.get( i );
+        const vmml::Quaternion< T >& end = b.get( i );
+        BOOST_CHECK( nlerped.get( i ).equals(
+                         vmml::nlerp( start, end, t[i] ), epsilon ));
+        BOOST_CHECK( slerped.get( i ).equals(
+                         vmml::slerp( start, end, t[i] ), epsilon ));
+        BOOST_CHECK( uniform.get( i ).equals(
+                         vmml::slerp( start, end, T( .3 )), epsilon ));
+        // documented error bound of the weights, for two unit quaternions
+        BOOST_CHECK( fast.get( i ).equals( slerped.get( i ),
+                                           T( 4e-5 ) + epsilon ));
+    }
+
+    // in place
+    vmml::slerp( a, b, t.data(), a );
+    for( size_t i = 0; i < size; ++i )
+        BOOST_CHECK( a.get( i ) == slerped.get( i ));
+}
+
+template< typename T > void _testRotationMatrices()
+{
+    const T epsilon = std::numeric_limits< T >::epsilon() * 16;
+    vmml::QuaternionArray< T > quaternions( size );
+    for( size_t i = 0; i < size; ++i )
+        quaternions.set( i, _randomRotation< T >( ));
+
+    std::vector< vmml::Matrix< 3, 3, T > > matrices( size );
+    quaternions.getRotationMatrices( matrices.data( ));
+    for( size_t i = 0; i < size; ++i )
+        BOOST_CHECK( matrices[i].equals(
+                         quaternions.get( i ).getRotationMatrix(), epsilon ));
+}
+}
+
+BOOST_AUTO_TEST_CASE( base )
+{
+    const vmml::Quaternionf rotations[2] = {
+        vmml::Quaternionf( .3f, vmml::Vector3f( 1, 0, 0 )),
+        vmml::Quaternionf( .4f, vmml::Vector3f( 0, 1, 0 )) };
+    vmml::QuaternionArray< float > quaternions( rotations, 2 );
+    BOOST_CHECK_EQUAL( quaternions.getSize(), 2 );
+    BOOST_CHECK_EQUAL( quaternions.get( 0 ), rotations[0] );
+    BOOST_CHECK_EQUAL( quaternions.get( 1 ), rotations[1] );
+    BOOST_CHECK_EQUAL( quaternions.getY()[1], rotations[1].y( ));
+
+    quaternions.resize( 3 );
+    BOOST_CHECK_EQUAL( quaternions.get( 2 ), vmml::Quaternionf( ));
+    quaternions.set( 2, rotations[0] );
+    BOOST_CHECK_EQUAL( quaternions.get( 2 ), rotations[0] );
+
+    BOOST_CHECK_EQUAL( vmml::QuaternionArray< float >( 5 ).get( 4 ),
+                       vmml::Quaternionf( ));
+    BOOST_CHECK_EQUAL( vmml::QuaternionArray< float >().getSize(), 0 );
+
+    vmml::QuaternionArray< float > result;
+    BOOST_CHECK_THROW( vmml::nlerp( quaternions,
+                                    vmml::QuaternionArray< float >( 2 ), .5f,
+                                    result ), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( interpolation )
+{
+    _testInterpolation< float >();
+    _testInterpolation< double >();
+}
+
+BOOST_AUTO_TEST_CASE( rotationMatrices )
+{
+    _testRotationMatrices< float >();
+    _testRotationMatrices< double >();
+}
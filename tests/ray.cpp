@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/aabb.hpp>
+#include <vmmlib/obb.hpp>
+#include <vmmlib/quaternion.hpp>
+#include <vmmlib/ray.hpp>
+#include <vmmlib/rayPacket.hpp>
+#include <vmmlib/types.hpp>
+
+#define BOOST_TEST_MODULE ray
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+#include <cstdlib>
+
+namespace
+{
+// reference slab test of one ray against a box
+template< typename T >
+T _testBox( const vmml::Ray< T >& ray, const vmml::AABB< T >& aabb )
+{
+    T entry = -std::numeric_limits< T >::max();
+    T exit = std::numeric_limits< T >::max();
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const T origin = ray.getOrigin()[i];
+        const T direction = ray.getDirection()[i];
+        if( direction == 0 )
+        {
+            if( origin < aabb.getMin()[i] || origin > aabb.getMax()[i] )
+                return -1;
+            continue;
+        }
+        T t0 = ( aabb.getMin()[i] - origin ) / direction;
+        T t1 = ( aabb.getMax()[i] - origin ) / direction;
+        if( t0 > t1 )
+            std::swap( t0, t1 );
+        entry = std::max( entry, t0 );
+        exit = std::min( exit, t1 );
+    }
+    if( entry > exit || exit < 0 )
+        return -1;
+    return entry >= 0 ? entry : exit;
+}
+
+template< typename T, size_t N > void _testPacket()
+{
+    typedef vmml::vector< 3, T > vec3;
+    typedef vmml::vector< 4, T > vec4;
+    const T epsilon = std::numeric_limits< T >::epsilon() * 1000;
+
+    srand( 42 );
+    std::vector< vmml::Ray< T > > rays;
+    rays.push_back( vmml::Ray< T >( vec3::ZERO, -vec3::UNIT_Z )); // inside
+    rays.push_back( vmml::Ray< T >( vec3( 0, 0, 10 ), vec3::UNIT_Z )); // behind
+    rays.push_back( vmml::Ray< T >( vec3( .5f, 0, 10 ), -vec3::UNIT_Z ));
+    while( rays.size() < N )
+        rays.push_back( vmml::Ray< T >(
+            vec3( _random< T >( -1, 1 ), _random< T >( -1, 1 ), 10 ),
+            vec3( _random< T >( -.2f, .2f ), _random< T >( -.2f, .2f ), -1 )));
+
+    const vmml::RayPacket< T, N > packet( rays.data( ));
+    BOOST_CHECK_EQUAL( packet.get( 2 ).getOrigin(), rays[2].getOrigin( ));
+    BOOST_CHECK_EQUAL( packet.get( 2 ).getDirection(),
+                       rays[2].getDirection( ));
+
+    size_t nHits = 0;
+    for( size_t i = 0; i < 100; ++i )
+    {
+        const vec4 sphere( _random< T >( -1, 1 ), _random< T >( -1, 1 ),
+                           _random< T >( -1, 1 ), _random< T >( .1f, 1 ));
+        const vec3 center( sphere.x(), sphere.y(), sphere.z( ));
+        const vmml::AABB< T > box( center - sphere.w(), center + sphere.w( ));
+
+        T sphereDistances[ N ];
+        T boxDistances[ N ];
+        const unsigned sphereHits = packet.test( sphere, sphereDistances );
+        const unsigned boxHits = packet.test( box, boxDistances );
+
+        for( size_t j = 0; j < N; ++j )
+        {
+            const T sphereDistance = rays[j].test( sphere );
+            const T boxDistance = _testBox( rays[j], box );
+            BOOST_CHECK_EQUAL( bool( sphereHits & ( 1u << j )),
+                               sphereDistance >= 0 );
+            BOOST_CHECK_EQUAL( bool( boxHits & ( 1u << j )),
+                               boxDistance >= 0 );
+            BOOST_CHECK_SMALL( sphereDistances[j] - sphereDistance, epsilon );
+            BOOST_CHECK_SMALL( boxDistances[j] - boxDistance, epsilon );
+            if( sphereDistance >= 0 )
+                ++nHits;
+        }
+    }
+    BOOST_CHECK_GT( nHits, 0 );
+    BOOST_CHECK_LT( nHits, 100 * N );
+}
+
+// Rays in the planes of the slabs of a box, with a zero direction component
+// for which the slab distances are NaN, at every SIMD level
+template< typename T, size_t N > void _testPacketSlabs()
+{
+    typedef vmml::vector< 3, T > vec3;
+    const vmml::AABB< T > box( vec3::ZERO, vec3( 1, 1, 1 ));
+
+    const vmml::Ray< T > slabRays[] = {
+        vmml::Ray< T >( vec3( 0, 0, -1 ), vec3::UNIT_Z ),
+        vmml::Ray< T >( vec3( 1, T( .5 ), -1 ), vec3::UNIT_Z ),
+        vmml::Ray< T >( vec3( T( .5 ), 0, 2 ), -vec3::UNIT_Z ),
+        vmml::Ray< T >( vec3::ZERO, vec3::UNIT_Z ), // default, inside
+        vmml::Ray< T >( vec3( 0, 2, -1 ), vec3::UNIT_Z ), // miss
+        vmml::Ray< T >( vec3( 0, 1, 5 ), vec3::UNIT_Z ) // behind
+    };
+    const size_t nSlabRays = sizeof( slabRays ) / sizeof( slabRays[0] );
+    BOOST_CHECK_EQUAL( slabRays[0].test( box ), 1 );
+
+    std::vector< vmml::Ray< T > > rays;
+    for( size_t i = 0; i < N; ++i )
+        rays.push_back( slabRays[ i % nSlabRays ] );
+    const vmml::RayPacket< T, N > packet( rays.data( ));
+
+    for( int i = vmml::SIMD_SCALAR; i <= vmml::getSupportedSIMDLevel(); ++i )
+    {
+        const vmml::SIMDLevel level = vmml::SIMDLevel( i );
+        vmml::setSIMDLevel( level );
+        T distances[ N ];
+        const unsigned hits = packet.test( box, distances );
+        for( size_t j = 0; j < N; ++j )
+        {
+            const T distance = rays[j].test( box );
+            BOOST_CHECK_MESSAGE( bool( hits & ( 1u << j )) == ( distance >= 0 ),
+                                 level << " ray " << j );
+            BOOST_CHECK_MESSAGE( distances[j] == distance,
+                                 level << " ray " << j );
+        }
+    }
+    vmml::setSIMDLevel( vmml::getSupportedSIMDLevel( ));
+}
+}
+
+template< typename T > void _testAABB()
+{
+    typedef vmml::vector< 3, T > vec3;
+    const vmml::AABB< T > box( vec3( -1, -1, -1 ), vec3( 1, 1, 1 ));
+
+    // along an axis, from outside, inside and behind
+    BOOST_CHECK_EQUAL( vmml::Ray< T >( vec3( 0, 0, 5 ),
+                                       -vec3::UNIT_Z ).test( box ), 4 );
+    BOOST_CHECK_EQUAL( vmml::Ray< T >( vec3::ZERO, vec3::UNIT_X ).test( box ),
+                       1 );
+    BOOST_CHECK_LT( vmml::Ray< T >( vec3( 0, 0, 5 ),
+                                    vec3::UNIT_Z ).test( box ), 0 );
+    BOOST_CHECK_LT( vmml::Ray< T >( vec3( 2, 0, 5 ),
+                                    -vec3::UNIT_Z ).test( box ), 0 );
+
+    srand( 42 );
+    size_t nHits = 0;
+    for( size_t i = 0; i < 1000; ++i )
+    {
+        const vmml::Ray< T > ray(
+            vec3( _random< T >( -3, 3 ), _random< T >( -3, 3 ),
+                  _random< T >( -3, 3 )),
+            vec3( _random< T >( -1, 1 ), _random< T >( -1, 1 ),
+                  _random< T >( -1, 1 )));
+        const T distance = ray.test( box );
+        BOOST_CHECK_CLOSE( distance, _testBox( ray, box ), 1e-3 );
+        if( distance >= 0 )
+            ++nHits;
+    }
+    BOOST_CHECK_GT( nHits, 0 );
+    BOOST_CHECK_LT( nHits, 1000 );
+}
+
+template< typename T > void _testOBB()
+{
+    typedef vmml::vector< 3, T > vec3;
+    const vec3 center( 1, 2, 3 );
+    const vec3 extents( 2, T( .5 ), 1 );
+    const vmml::Matrix< 3, 3, T > axes = vmml::Quaternion< T >(
+        T( .7 ), vmml::normalize( vec3( 1, 2, -1 ))).getRotationMatrix();
+    const vmml::OBB< T > obb( center, axes, extents );
+    const vmml::AABB< T > local( -extents, extents );
+
+    // an axis-aligned oriented box gives the results of the box test
+    const vmml::AABB< T > box( vec3( -1, -1, -1 ), vec3( 1, 1, 1 ));
+    const vmml::OBB< T > aligned( box );
+    BOOST_CHECK_EQUAL( vmml::Ray< T >( vec3( 0, 0, 5 ),
+                                       -vec3::UNIT_Z ).test( aligned ), 4 );
+    BOOST_CHECK_LT( vmml::Ray< T >( vec3( 2, 0, 5 ),
+                                    -vec3::UNIT_Z ).test( aligned ), 0 );
+
+    srand( 42 );
+    size_t nHits = 0;
+    for( size_t i = 0; i < 1000; ++i )
+    {
+        const vmml::Ray< T > ray(
+            vec3( _random< T >( -3, 5 ), _random< T >( -2, 6 ),
+                  _random< T >( -1, 7 )),
+            vec3( _random< T >( -1, 1 ), _random< T >( -1, 1 ),
+                  _random< T >( -1, 1 )));
+        BOOST_CHECK_CLOSE( ray.test( aligned ), ray.test( box ), 1e-3 );
+
+        // the reference test in the frame of the box
+        const vmml::Matrix< 3, 3, T > inverse = transpose( axes );
+        const vmml::Ray< T > localRay(
+            inverse * ( ray.getOrigin() - center ),
+            inverse * ray.getDirection( ));
+        const T distance = ray.test( obb );
+        BOOST_CHECK_CLOSE( distance, _testBox( localRay, local ), 1e-3 );
+        if( distance >= 0 )
+            ++nHits;
+    }
+    BOOST_CHECK_GT( nHits, 0 );
+    BOOST_CHECK_LT( nHits, 1000 );
+}
+
+template< typename T > void _testTriangle()
+{
+    typedef vmml::vector< 3, T > vec3;
+    const vec3 a( 0, 0, 0 );
+    const vec3 b( 1, 0, 0 );
+    const vec3 c( 0, 1, 0 );
+
+    vec3 barycentric;
+    const vmml::Ray< T > ray( vec3( .25f, .5f, 2 ), -vec3::UNIT_Z );
+    BOOST_CHECK_CLOSE( ray.test( a, b, c, barycentric ), T( 2 ), 1e-4 );
+    BOOST_CHECK_CLOSE( barycentric.x(), T( .25 ), 1e-4 );
+    BOOST_CHECK_CLOSE( barycentric.y(), T( .25 ), 1e-4 );
+    BOOST_CHECK_CLOSE( barycentric.z(), T( .5 ), 1e-4 );
+
+    // back face, behind the origin, outside
+    BOOST_CHECK_CLOSE( vmml::Ray< T >( vec3( .25f, .25f, -3 ), vec3::UNIT_Z )
+                           .test( a, b, c ), T( 3 ), 1e-4 );
+    BOOST_CHECK_LT( vmml::Ray< T >( vec3( .25f, .25f, -3 ), -vec3::UNIT_Z )
+                        .test( a, b, c ), 0 );
+    BOOST_CHECK_LT( vmml::Ray< T >( vec3( .75f, .75f, 2 ), -vec3::UNIT_Z )
+                        .test( a, b, c ), 0 );
+
+    // watertight: rays through the shared edge of a quad hit at least one of
+    // its triangles
+    const vec3 d( 1, 1, 0 );
+    srand( 42 );
+    for( size_t i = 0; i < 1000; ++i )
+    {
+        const T s = _random< T >( 0, 1 );
+        const vec3 target = b * s + c * ( 1 - s );
+        const vec3 origin( _random< T >( -2, 2 ), _random< T >( -2, 2 ),
+                           _random< T >( 1, 3 ));
+        const vmml::Ray< T > edgeRay( origin, target - origin );
+        const bool first = edgeRay.test( a, b, c ) >= 0;
+        const bool second = edgeRay.test( b, d, c ) >= 0;
+        BOOST_CHECK( first || second );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( aabb )
+{
+    _testAABB< float >();
+    _testAABB< double >();
+}
+
+BOOST_AUTO_TEST_CASE( obb )
+{
+    _testOBB< float >();
+    _testOBB< double >();
+}
+
+BOOST_AUTO_TEST_CASE( triangle )
+{
+    _testTriangle< float >();
+    _testTriangle< double >();
+}
+
+BOOST_AUTO_TEST_CASE( packet )
+{
+    _testPacket< float, 4 >();
+    _testPacket< float, 8 >();
+    _testPacket< float, 16 >();
+    _testPacket< double, 4 >();
+    _testPacket< double, 8 >();
+    _testPacket< double, 16 >();
+}
+
+BOOST_AUTO_TEST_CASE( packetSlabs )
+{
+    _testPacketSlabs< float, 9 >();
+    _testPacketSlabs< float, 16 >();
+    _testPacketSlabs< double, 9 >();
+    _testPacketSlabs< double, 16 >();
+}
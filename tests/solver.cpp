@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/solver.hpp>
+#include <vmmlib/types.hpp>
+
+#define BOOST_TEST_MODULE solver
+#include <boost/test/unit_test.hpp>
+
+#include "random.hpp"
+
+#include <cstdlib>
+#include <limits>
+
+namespace
+{
+template< size_t R, size_t C, typename T > vmml::Matrix< R, C, T > _random()
+{
+    vmml::Matrix< R, C, T > matrix;
+    for( size_t i = 0; i < R * C; ++i )
+        matrix.array[i] = _random< T >( -1, 1 );
+    return matrix;
+}
+
+// well-conditioned: diagonally dominant
+template< size_t N, typename T > vmml::Matrix< N, N, T > _regular()
+{
+    vmml::Matrix< N, N, T > matrix = _random< N, N, T >();
+    for( size_t i = 0; i < N; ++i )
+        matrix( i, i ) += T( N ) * ( i % 2 ? -1 : 1 );
+    return matrix;
+}
+
+// symmetric positive definite
+template< size_t N, typename T > vmml::Matrix< N, N, T > _spd()
+{
+    const vmml::Matrix< N, N, T > matrix = _random< N, N, T >();
+    vmml::Matrix< N, N, T > spd = vmml::transpose( matrix ) * matrix;
+    for( size_t i = 0; i < N; ++i )
+        spd( i, i ) += T( 1 );
+    return spd;
+}
+
+template< size_t N, typename T > bool _equals( const vmml::vector< N, T >& a,
+                                               const vmml::vector< N, T >& b,
+                                               const T tolerance )
+{
+    for( size_t i = 0; i < N; ++i )
+        if( !( std::abs( a[i] - b[i] ) <= tolerance ))
+            return false;
+    return true;
+}
+
+template< size_t N, typename T > bool _isNaN( const vmml::vector< N, T >& v )
+{
+    for( size_t i = 0; i < N; ++i )
+        if( !std::isnan( v[i] ))
+            return false;
+    return true;
+}
+
+template< class Solver, size_t N, typename T >
+void _testSquare( const Solver& solver, const vmml::Matrix< N, N, T >& matrix )
+{
+    const T tolerance = std::numeric_limits< T >::epsilon() * N * 32;
+    const vmml::vector< N, T > x = _random< N, 1, T >().getColumn( 0 );
+    const vmml::vector< N, T > b = matrix * x;
+    BOOST_CHECK( _equals( solver.solve( b ), x, tolerance ));
+
+    const vmml::Matrix< N, N, T > identity;
+    BOOST_CHECK( ( solver.inverse() * matrix ).equals( identity, tolerance ));
+
+    const vmml::Matrix< N, 3, T > xs = _random< N, 3, T >();
+    BOOST_CHECK( solver.solve( matrix * xs ).equals( xs, tolerance ));
+}
+
+template< size_t N, typename T > void _testLU()
+{
+    const vmml::Matrix< N, N, T > matrix = _regular< N, T >();
+    const vmml::LU< N, T > lu( matrix );
+    BOOST_CHECK( !lu.isSingular( ));
+    _testSquare( lu, matrix );
+
+    const T determinant = vmml::QR< N, N, T >( matrix ).determinant();
+    BOOST_CHECK_CLOSE( lu.determinant(), determinant,
+                       std::numeric_limits< T >::epsilon() * N * 1000 );
+
+    vmml::Matrix< N, N, T > singular = matrix;
+    singular.setRow( N - 1, singular.getRow( 0 ) * T( 2 ));
+    const vmml::LU< N, T > singularLU( singular );
+    BOOST_CHECK( singularLU.isSingular( ));
+    BOOST_CHECK( _isNaN( singularLU.solve( vmml::vector< N, T >( T( 1 )))));
+    BOOST_CHECK( std::isnan( singularLU.inverse()( 0, 0 )));
+}
+
+template< size_t N, typename T > void _testCholesky()
+{
+    const vmml::Matrix< N, N, T > matrix = _spd< N, T >();
+    const vmml::Cholesky< N, T > cholesky( matrix );
+    BOOST_CHECK( cholesky.isPositiveDefinite( ));
+    _testSquare( cholesky, matrix );
+    const T determinant = vmml::LU< N, T >( matrix ).determinant();
+    BOOST_CHECK_CLOSE( cholesky.determinant(), determinant,
+                       std::numeric_limits< T >::epsilon() * N * 1000 );
+
+    vmml::Matrix< N, N, T > indefinite = matrix;
+    indefinite( N / 2, N / 2 ) = -1;
+    const vmml::Cholesky< N, T > failed( indefinite );
+    BOOST_CHECK( !failed.isPositiveDefinite( ));
+    BOOST_CHECK( _isNaN( failed.solve( vmml::vector< N, T >( T( 1 )))));
+    BOOST_CHECK( std::isnan( failed.determinant( )));
+}
+
+template< size_t N, typename T > void _testQR()
+{
+    const vmml::Matrix< N, N, T > matrix = _regular< N, T >();
+    const vmml::QR< N, N, T > qr( matrix );
+    BOOST_CHECK( qr.isFullRank( ));
+    _testSquare( qr, matrix );
+
+    // least squares: the residual is orthogonal to the columns
+    const T tolerance = std::numeric_limits< T >::epsilon() * N * 32;
+    const vmml::Matrix< 2 * N, N, T > tall = _random< 2 * N, N, T >();
+    const vmml::vector< 2 * N, T > b = _random< 2 * N, 1, T >().getColumn( 0 );
+    const vmml::QR< 2 * N, N, T > leastSquares( tall );
+    BOOST_CHECK( leastSquares.isFullRank( ));
+    const vmml::vector< N, T > x = leastSquares.solve( b );
+    BOOST_CHECK( _equals( vmml::transpose( tall ) * ( tall * x - b ),
+                          vmml::vector< N, T >( T( 0 )), tolerance ));
+
+    // consistent overdetermined systems are solved exactly
+    BOOST_CHECK( _equals( leastSquares.solve( tall * x ), x, tolerance ));
+
+    const vmml::Matrix< N, N, T > identity;
+    BOOST_CHECK( ( leastSquares.inverse() * tall ).equals( identity,
+                                                           tolerance ));
+    const T volume = std::sqrt( vmml::LU< N, T >(
+        vmml::transpose( tall ) * tall ).determinant( ));
+    BOOST_CHECK_CLOSE( std::abs( leastSquares.determinant( )), volume,
+                       std::numeric_limits< T >::epsilon() * N * 1000 );
+
+    vmml::Matrix< 2 * N, N, T > deficient = tall;
+    deficient.setColumn( N - 1, deficient.getColumn( 0 ) * T( 2 ));
+    const vmml::QR< 2 * N, N, T > failed( deficient );
+    BOOST_CHECK( !failed.isFullRank( ));
+    BOOST_CHECK( _isNaN( failed.solve( b )));
+}
+}
+
+BOOST_AUTO_TEST_CASE( lu )
+{
+    srand( 42 );
+    _testLU< 2, float >();
+    _testLU< 4, float >();
+    _testLU< 6, float >();
+    _testLU< 6, double >();
+    _testLU< 12, double >();
+    _testLU< 32, double >();
+
+    // the closed forms up to 4x4 agree with LU
+    const vmml::Matrix4d matrix = _regular< 4, double >();
+    const vmml::LU< 4, double > decomposition( matrix );
+    BOOST_CHECK( matrix.inverse().equals( decomposition.inverse(), 1e-14 ));
+    BOOST_CHECK_CLOSE( vmml::computeDeterminant( matrix ),
+                       decomposition.determinant(), 1e-10 );
+
+    // permutation: zero leading pivot
+    vmml::Matrix3d permutation( std::vector< double >( 9, 0. ));
+    permutation( 0, 1 ) = 1;
+    permutation( 1, 2 ) = 1;
+    permutation( 2, 0 ) = 1;
+    const vmml::LU< 3, double > permutationLU( permutation );
+    BOOST_CHECK( !permutationLU.isSingular( ));
+    BOOST_CHECK_EQUAL( permutationLU.determinant(), 1. );
+    BOOST_CHECK( permutationLU.inverse() == vmml::transpose( permutation ));
+
+    // and replace the fallback of larger matrices
+    vmml::Matrix< 6, 6, double > matrix6 = _regular< 6, double >();
+    const vmml::LU< 6, double > lu6( matrix6 );
+    BOOST_CHECK( matrix6.inverse() == lu6.inverse( ));
+    BOOST_CHECK_EQUAL( vmml::computeDeterminant( matrix6 ), lu6.determinant( ));
+    matrix6.setRow( 5, matrix6.getRow( 2 ));
+    BOOST_CHECK( std::isnan( matrix6.inverse()( 0, 0 )));
+
+    const vmml::Matrix< 3, 4, double > nonSquare;
+    BOOST_CHECK_THROW( nonSquare.inverse(), std::runtime_error );
+}
+
+BOOST_AUTO_TEST_CASE( cholesky )
+{
+    srand( 42 );
+    _testCholesky< 2, float >();
+    _testCholesky< 4, float >();
+    _testCholesky< 6, float >();
+    _testCholesky< 6, double >();
+    _testCholesky< 12, double >();
+    _testCholesky< 32, double >();
+}
+
+BOOST_AUTO_TEST_CASE( qr )
+{
+    srand( 42 );
+    _testQR< 2, float >();
+    _testQR< 4, float >();
+    _testQR< 6, float >();
+    _testQR< 6, double >();
+    _testQR< 12, double >();
+    _testQR< 32, double >();
+}
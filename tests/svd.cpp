@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/matrix.hpp>
+#include <vmmlib/quaternion.hpp>
+#include <vmmlib/svd.hpp>
+#include <vmmlib/types.hpp>
+#include <vmmlib/vector.hpp>
+
+#define BOOST_TEST_MODULE svd
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+// the documented errors relative to the largest element
+template< typename T > T _tolerance();
+template<> float _tolerance< float >() { return 2e-5f; }
+template<> double _tolerance< double >() { return 1e-13; }
+
+template< typename T > vmml::Matrix< 3, 3, T > _random( const T scale )
+{
+    vmml::Matrix< 3, 3, T > matrix;
+    for( size_t i = 0; i < 9; ++i )
+        matrix.array[i] = scale * ( T( 2 ) * T( rand( )) / T( RAND_MAX ) -
+                                    T( 1 ));
+    return matrix;
+}
+
+template< typename T >
+vmml::Matrix< 3, 3, T > _diagonal( const vmml::vector< 3, T >& values )
+{
+    vmml::Matrix< 3, 3, T > matrix( std::vector< T >( 9, 0 ));
+    for( size_t i = 0; i < 3; ++i )
+        matrix( i, i ) = values[i];
+    return matrix;
+}
+
+template< typename T > T _largest( const vmml::Matrix< 3, 3, T >& matrix )
+{
+    T largest = 0;
+    for( size_t i = 0; i < 9; ++i )
+        largest = std::max( largest, std::abs( matrix.array[i] ));
+    return largest > 0 ? largest : 1;
+}
+
+template< typename T > bool _isRotation( const vmml::Matrix< 3, 3, T >& matrix )
+{
+    const vmml::Matrix< 3, 3, T > identity;
+    return ( matrix * vmml::transpose( matrix )).equals( identity,
+                                                         _tolerance< T >( )) &&
+           std::abs( vmml::computeDeterminant( matrix ) - 1 ) <=
+               _tolerance< T >();
+}
+
+template< typename T >
+void _checkEigen( const vmml::Matrix< 3, 3, T >& symmetric,
+                  const vmml::vector< 3, T >& values,
+                  const vmml::Matrix< 3, 3, T >& vectors )
+{
+    // sorted up to rounding, e.g. for repeated eigenvalues
+    const T tolerance = _tolerance< T >() * _largest( symmetric );
+    BOOST_CHECK( _isRotation( vectors ));
+    BOOST_CHECK( values[0] >= values[1] - tolerance &&
+                 values[1] >= values[2] - tolerance );
+    const vmml::Matrix< 3, 3, T > product =
+        vectors * _diagonal( values ) * vmml::transpose( vectors );
+    BOOST_CHECK( product.equals( symmetric, tolerance ));
+}
+
+template< typename T >
+void _checkSVD( const vmml::Matrix< 3, 3, T >& a,
+                const vmml::Matrix< 3, 3, T >& u,
+                const vmml::vector< 3, T >& sigma,
+                const vmml::Matrix< 3, 3, T >& v )
+{
+    const T tolerance = _tolerance< T >() * _largest( a );
+    BOOST_CHECK( _isRotation( u ));
+    BOOST_CHECK( _isRotation( v ));
+    BOOST_CHECK( sigma[0] >= sigma[1] - tolerance &&
+                 sigma[1] >= std::abs( sigma[2] ) - tolerance );
+    const vmml::Matrix< 3, 3, T > product =
+        u * _diagonal( sigma ) * vmml::transpose( v );
+    BOOST_CHECK( product.equals( a, tolerance ));
+}
+
+template< typename T > void _testEigen()
+{
+    vmml::vector< 3, T > values;
+    vmml::Matrix< 3, 3, T > vectors;
+    for( size_t i = 0; i < 100; ++i )
+    {
+        const vmml::Matrix< 3, 3, T > matrix = _random< T >( 1 );
+        const vmml::Matrix< 3, 3, T > symmetric =
+            matrix + vmml::transpose( matrix );
+        vmml::computeEigen( symmetric, values, vectors );
+        _checkEigen( symmetric, values, vectors );
+    }
+
+    // known eigenvalues in a rotated frame, only the lower triangle is used
+    const vmml::Matrix< 3, 3, T > rotation = vmml::Quaternion< T >(
+        T( 0.7 ), vmml::normalize( vmml::vector< 3, T >( 1, 2, 3 )))
+        .getRotationMatrix();
+    vmml::Matrix< 3, 3, T > symmetric = rotation *
+        _diagonal( vmml::vector< 3, T >( 2, -5, 3 )) *
+        vmml::transpose( rotation );
+    const vmml::Matrix< 3, 3, T > lower = symmetric;
+    symmetric( 0, 2 ) = 42;
+    vmml::computeEigen( symmetric, values, vectors );
+    _checkEigen( lower, values, vectors );
+    BOOST_CHECK( values.equals( vmml::vector< 3, T >( 3, 2, -5 ),
+                                _tolerance< T >() * 5 ));
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const vmml::vector< 3, T > column = vectors.getColumn( i );
+        BOOST_CHECK( ( lower * column ).equals( column * values[i],
+                                                _tolerance< T >() * 5 ));
+    }
+
+    // repeated and zero eigenvalues
+    const vmml::Matrix< 3, 3, T > identity;
+    vmml::computeEigen( identity, values, vectors );
+    _checkEigen( identity, values, vectors );
+    BOOST_CHECK( values.equals( vmml::vector< 3, T >( 1, 1, 1 ),
+                                _tolerance< T >( )));
+
+    const vmml::Matrix< 3, 3, T > zero( std::vector< T >( 9, 0 ));
+    vmml::computeEigen( zero, values, vectors );
+    _checkEigen( zero, values, vectors );
+    BOOST_CHECK( values.equals( vmml::vector< 3, T >( T( 0 )),
+                                _tolerance< T >( )));
+}
+
+template< typename T > void _testSVD()
+{
+    vmml::Matrix< 3, 3, T > u, v;
+    vmml::vector< 3, T > sigma;
+    for( size_t i = 0; i < 100; ++i )
+    {
+        const vmml::Matrix< 3, 3, T > a = _random< T >( 1 );
+        vmml::computeSVD( a, u, sigma, v );
+        _checkSVD( a, u, sigma, v );
+        BOOST_CHECK( sigma[1] >= 0 );
+        BOOST_CHECK( ( sigma[2] < 0 ) == ( vmml::computeDeterminant( a ) < 0 ));
+    }
+
+    // rank-deficient
+    vmml::Matrix< 3, 3, T > deficient = _random< T >( 1 );
+    deficient.setColumn( 2, deficient.getColumn( 0 ) * T( 2 ));
+    vmml::computeSVD( deficient, u, sigma, v );
+    _checkSVD( deficient, u, sigma, v );
+    BOOST_CHECK_SMALL( sigma[2], T( 10 ) * _tolerance< T >( ));
+
+    // polar decomposition of a rotation
+    const vmml::Matrix< 3, 3, T > rotation = vmml::Quaternion< T >(
+        T( 2 ), vmml::normalize( vmml::vector< 3, T >( -1, 0, 1 )))
+        .getRotationMatrix();
+    vmml::computeSVD( rotation, u, sigma, v );
+    _checkSVD( rotation, u, sigma, v );
+    BOOST_CHECK( sigma.equals( vmml::vector< 3, T >( 1, 1, 1 ),
+                               _tolerance< T >( )));
+    BOOST_CHECK( ( u * vmml::transpose( v )).equals( rotation,
+                                                     _tolerance< T >( )));
+
+    // reflection: the last singular value is negative
+    const vmml::Matrix< 3, 3, T > reflection =
+        _diagonal( vmml::vector< 3, T >( 3, -1, 2 ));
+    vmml::computeSVD( reflection, u, sigma, v );
+    _checkSVD( reflection, u, sigma, v );
+    BOOST_CHECK( sigma.equals( vmml::vector< 3, T >( 3, 2, -1 ),
+                               _tolerance< T >() * 3 ));
+
+    // the results scale with the matrix
+    const T scales[] = { T( 1e-30 ), T( 1e30 ) };
+    for( size_t i = 0; i < 2; ++i )
+    {
+        const vmml::Matrix< 3, 3, T > a = _random< T >( scales[i] );
+        vmml::computeSVD( a, u, sigma, v );
+        _checkSVD( a, u, sigma, v );
+    }
+
+    const vmml::Matrix< 3, 3, T > zero( std::vector< T >( 9, 0 ));
+    vmml::computeSVD( zero, u, sigma, v );
+    _checkSVD( zero, u, sigma, v );
+}
+
+template< typename T > void _testBatch()
+{
+    // not a multiple of any SIMD width
+    const size_t n = 1003;
+    std::vector< vmml::Matrix< 3, 3, T > > matrices( n ), symmetric( n );
+    for( size_t i = 0; i < n; ++i )
+    {
+        matrices[i] = _random< T >( 1 );
+        symmetric[i] = matrices[i] + vmml::transpose( matrices[i] );
+    }
+
+    std::vector< vmml::vector< 3, T > > values( n ), sigma( n );
+    std::vector< vmml::Matrix< 3, 3, T > > vectors( n ), u( n ), v( n );
+    vmml::computeEigen( &symmetric[0], &values[0], &vectors[0], n );
+    vmml::computeSVD( &matrices[0], &u[0], &sigma[0], &v[0], n );
+
+    // the same results as one by one, up to rounding differences with FMA
+    for( size_t i = 0; i < n; ++i )
+    {
+        _checkEigen( symmetric[i], values[i], vectors[i] );
+        _checkSVD( matrices[i], u[i], sigma[i], v[i] );
+
+        vmml::vector< 3, T > value, singular;
+        vmml::Matrix< 3, 3, T > vector, left, right;
+        vmml::computeEigen( symmetric[i], value, vector );
+        vmml::computeSVD( matrices[i], left, singular, right );
+        BOOST_CHECK( values[i].equals( value, _tolerance< T >() * 2 ));
+        BOOST_CHECK( sigma[i].equals( singular, _tolerance< T >() * 2 ));
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE( eigen )
+{
+    srand( 42 );
+    _testEigen< float >();
+    _testEigen< double >();
+}
+
+BOOST_AUTO_TEST_CASE( svd )
+{
+    srand( 42 );
+    _testSVD< float >();
+    _testSVD< double >();
+}
+
+BOOST_AUTO_TEST_CASE( batch )
+{
+    srand( 42 );
+    _testBatch< float >();
+    _testBatch< double >();
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vmmlib/transform.hpp>
+#include <vmmlib/types.hpp>
+
+#define BOOST_TEST_MODULE transform
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE( classify )
+{
+    vmml::Matrix4f matrix;
+    BOOST_CHECK_EQUAL( vmml::Transformf::classify( matrix ),
+                       vmml::Transformf::RIGID );
+
+    matrix.rotate_y( .4f );
+    matrix.setTranslation( vmml::Vector3f( 1, 2, 3 ));
+    BOOST_CHECK_EQUAL( vmml::Transformf::classify( matrix ),
+                       vmml::Transformf::RIGID );
+
+    matrix.scale( vmml::Vector3f( 1, 2, 1 ));
+    BOOST_CHECK_EQUAL( vmml::Transformf::classify( matrix ),
+                       vmml::Transformf::AFFINE );
+
+    matrix( 3, 2 ) = -1.f;
+    BOOST_CHECK_EQUAL( vmml::Transformf::classify( matrix ),
+                       vmml::Transformf::PROJECTIVE );
+}
+
+BOOST_AUTO_TEST_CASE( inverse )
+{
+    const vmml::Quaterniond rotation( .3, vmml::Vector3d( .6, .8, 0 ));
+    const vmml::Transformd rigid( rotation, vmml::Vector3d( 1, 2, 3 ));
+    BOOST_CHECK( rigid.isRigid( ));
+
+    vmml::Matrix4d scale;
+    scale.scale( vmml::Vector3d( 2, 3, 4 ));
+    const vmml::Transformd affine = rigid * vmml::Transformd( scale );
+    BOOST_CHECK_EQUAL( affine.getType(), vmml::Transformd::AFFINE );
+    BOOST_CHECK( affine.isAffine( ));
+
+    vmml::Matrix4d perspective;
+    perspective( 3, 2 ) = -1.;
+    perspective( 3, 3 ) = 0.;
+    perspective( 2, 3 ) = -2.;
+    const vmml::Transformd projective = vmml::Transformd( perspective ) *
+                                        affine;
+    BOOST_CHECK_EQUAL( projective.getType(), vmml::Transformd::PROJECTIVE );
+
+    const vmml::Vector3d point( 1, -2, -5 );
+    const vmml::Transformd transforms[] = { rigid, affine, projective };
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const vmml::Transformd& transform = transforms[i];
+        const vmml::Transformd inverted = transform.inverse();
+        BOOST_CHECK_EQUAL( inverted.getType(), transform.getType( ));
+        BOOST_CHECK( ( inverted * transform ).getMatrix().equals(
+                         vmml::Matrix4d(), 1e-12 ));
+
+        const vmml::Vector3d transformed = transform * point;
+        BOOST_CHECK( ( inverted * transformed ).equals( point, 1e-12 ));
+    }
+
+    vmml::Transformd composed = rigid;
+    composed *= vmml::Transformd( scale );
+    BOOST_CHECK( composed.getMatrix().equals( affine.getMatrix( )));
+    BOOST_CHECK_EQUAL( composed.getType(), vmml::Transformd::AFFINE );
+}
@@ -26,6 +26,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <vmmlib/expression.hpp>
 #include <vmmlib/vector.hpp>
 #include <vmmlib/types.hpp>
 
@@ -59,6 +60,11 @@ BOOST_AUTO_TEST_CASE(base)
     {
         BOOST_CHECK(v.at( index ) == tmp);
     }
+
+    // unchecked and checked access refer to the same element
+    for( size_t index = 0; index < 4; ++index )
+        BOOST_CHECK_EQUAL( &v( index ), &v.at( index ));
+    BOOST_CHECK_THROW( v.at( 4 ), std::runtime_error );
 }
 
 BOOST_AUTO_TEST_CASE(plus)
@@ -452,3 +458,64 @@ BOOST_AUTO_TEST_CASE(rotateVec)
                          vmml::rotate( vector, float( M_PI ),
                                        vmml::Vector3f::LEFT ));
 }
+
+BOOST_AUTO_TEST_CASE(lazyExpression)
+{
+    vmml::vector< 17, float > a, b, c;
+    for( size_t i = 0; i < 17; ++i )
+    {
+        a[i] = float( i );
+        b[i] = float( i * i ) - 3.f;
+        c[i] = 1.f / float( i + 1 );
+    }
+
+    // lazy evaluation gives the same result as the eager operators
+    const vmml::vector< 17, float > lazy = vmml::lazy( a ) * 2.f + b * 3.f - c;
+    BOOST_CHECK_EQUAL( lazy, a * 2.f + b * 3.f - c );
+
+    // two lazily scaled operands, without an eager temporary
+    const vmml::vector< 17, float > scaled =
+        vmml::lazy( a ) * 2.f + vmml::lazy( b ) * 3.f - c;
+    BOOST_CHECK_EQUAL( scaled, a * 2.f + b * 3.f - c );
+
+    vmml::vector< 17, float > result;
+    result = -( vmml::lazy( a ) * b ) / 4.f + 0.5f * ( c - vmml::lazy( a ));
+    BOOST_CHECK_EQUAL( result, -( a * b ) / 4.f + ( c - a ) * 0.5f );
+
+    result = b / vmml::lazy( c );
+    BOOST_CHECK_EQUAL( result, b / c );
+
+    // assignment to an operand
+    result = a;
+    result = vmml::lazy( result ) + result * 2.f;
+    BOOST_CHECK_EQUAL( result, a * 3.f );
+}
+
+namespace
+{
+// evaluated by the compiler with C++14, at static initialization otherwise
+VMMLIB_CONSTEXPR_OR_CONST vmml::Vector3f a( 1, 2, 3 );
+VMMLIB_CONSTEXPR_OR_CONST vmml::Vector3f b =
+    a * 2.f + vmml::Vector3f::UNIT_X - vmml::Vector3f( 1.f );
+VMMLIB_CONSTEXPR_OR_CONST vmml::Vector3f c = vmml::cross( a, b );
+VMMLIB_CONSTEXPR_OR_CONST vmml::Vector4f homogeneous( a );
+VMMLIB_CONSTEXPR_OR_CONST float dotAB = a.dot( b );
+
+#ifdef VMMLIB_HAS_CONSTEXPR
+static_assert( b == vmml::Vector3f( 2, 3, 5 ), "constexpr arithmetic" );
+static_assert( c == vmml::Vector3f( 1, 1, -1 ), "constexpr cross" );
+static_assert( homogeneous.w() == 1, "constexpr conversion" );
+static_assert( dotAB == 23, "constexpr dot" );
+static_assert( vmml::Vector3f::FORWARD.z() == -1, "constexpr statics" );
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(constantExpression)
+{
+    BOOST_CHECK_EQUAL( b, vmml::Vector3f( 2, 3, 5 ));
+    BOOST_CHECK_EQUAL( c, vmml::Vector3f( 1, 1, -1 ));
+    BOOST_CHECK_EQUAL( homogeneous, vmml::Vector4f( 1, 2, 3, 1 ));
+    BOOST_CHECK_EQUAL( dotAB, 23 );
+    BOOST_CHECK_EQUAL( vmml::Vector3f::FORWARD, vmml::Vector3f( 0, 0, -1 ));
+    BOOST_CHECK_EQUAL( vmml::Vector3f( homogeneous ), a );
+}
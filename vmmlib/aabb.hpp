@@ -32,8 +32,15 @@
 #ifndef __VMML__AXIS_ALIGNED_BOUNDING_BOX__HPP__
 #define __VMML__AXIS_ALIGNED_BOUNDING_BOX__HPP__
 
+#include <vmmlib/dispatch.hpp> // used inline
+#include <vmmlib/matrix.hpp> // inline parameter
+#include <vmmlib/simd.hpp> // used inline
 #include <vmmlib/vector.hpp>
+
+#include <algorithm>
+#include <cstddef>
 #include <limits>
+#include <vector>
 
 namespace lunchbox { template< class T > void byteswap( T& ); }
 
@@ -59,6 +66,27 @@ public:
     /** Create a new bounding box from a bounding sphere */
     AABB( const vector< 4, T >& sphere );
 
+    /**
+     * @return the bounding box of the points in [begin, end), empty for an
+     *         empty range.
+     *
+     * Equivalent to merging each point, using SIMD min and max reductions
+     * over the packed coordinates, see dispatch.hpp. When compiled with
+     * OpenMP, large arrays are reduced in parallel chunks which are merged in
+     * order, so the result does not depend on the number of threads. The
+     * result is undefined for NaN coordinates.
+     */
+    static AABB< T > fromPoints( const vector< 3, T >* begin,
+                                 const vector< 3, T >* end );
+
+    /**
+     * @return the union of the boxes in [begin, end), empty for an empty
+     *         range. Empty boxes in the range are ignored.
+     *
+     * Reduced like fromPoints().
+     */
+    static AABB< T > fromBoxes( const AABB< T >* begin, const AABB< T >* end );
+
     /** @return true if the given point is within this bounding box. */
     bool isIn( const vector< 3, T >& point ) const;
 
@@ -102,6 +130,16 @@ public:
     void computeNearFar( const vector< 4, T >& plane, vector< 3, T >& nearPoint,
                          vector< 3, T >& farPoint ) const;
 
+    /**
+     * @return the bounding box of this box transformed by an affine
+     *         transformation, empty if this box is empty.
+     *
+     * Transforms the center and the extent with the absolute values of the
+     * matrix (Arvo, "Transforming Axis-Aligned Bounding Boxes"), which gives
+     * the bounding box of the eight transformed corners up to rounding.
+     */
+    AABB< T > transform( const Matrix< 4, 4, T >& matrix ) const;
+
     /** @return a bouding box of size one with the minimum point at zero. */
     static AABB< T > makeUnitBox();
 
@@ -117,6 +155,256 @@ std::ostream& operator << ( std::ostream& os, const AABB< T >& aabb )
     return os << aabb.getMin() << " - " << aabb.getMax();
 }
 
+/**
+ * Transform n boxes by one affine transformation each.
+ *
+ * The boxes are transformed with the widest SIMD instructions of the CPU, see
+ * dispatch.hpp, with results equal to AABB::transform() up to rounding, since
+ * the wider levels use fused multiply-add. When compiled with OpenMP, large
+ * arrays are transformed in parallel chunks. Input and output may be the same
+ * array, but must not overlap otherwise.
+ *
+ * @param matrices the transformation of each box
+ * @param boxes the input boxes
+ * @param result the output boxes
+ * @param n the number of boxes
+ */
+template< typename T >
+void transform( const Matrix< 4, 4, T >* matrices, const AABB< T >* boxes,
+                AABB< T >* result, size_t n );
+
+/** Transform n boxes by the same affine transformation. */
+template< typename T >
+void transform( const Matrix< 4, 4, T >& matrix, const AABB< T >* boxes,
+                AABB< T >* result, size_t n );
+
+// - implementation -
+
+namespace detail
+{
+VMMLIB_SIMD_KERNELS_BEGIN
+/**
+ * The minimum and maximum of each of the Q components of n tightly packed
+ * elements, run by dispatch().
+ *
+ * The components are reduced in place: Q consecutive packs hold P::width
+ * elements, and each lane of them always sees the same component.
+ */
+template< typename T, size_t Q > class BoundsRange
+{
+public:
+    typedef void result_type;
+
+    BoundsRange( const T* values, const size_t n, T* lower, T* upper )
+        : _values( values ), _n( n ), _lower( lower ), _upper( upper )
+    {}
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        typedef typename P::type V;
+
+        V lower[ Q ], upper[ Q ];
+        for( size_t k = 0; k < Q; ++k )
+        {
+            lower[k] = P::set( std::numeric_limits< T >::max( ));
+            upper[k] = P::set( -std::numeric_limits< T >::max( ));
+        }
+        const size_t end = _n - _n % P::width;
+        for( size_t i = 0; i < end; i += P::width )
+        {
+            const T* block = _values + i * Q;
+            for( size_t k = 0; k < Q; ++k )
+            {
+                const V value = P::load( block + k * P::width );
+                lower[k] = P::min( value, lower[k] );
+                upper[k] = P::max( value, upper[k] );
+            }
+        }
+
+        // the lane j of the pack k holds the component ( k * width + j ) % Q
+        for( size_t c = 0; c < Q; ++c )
+        {
+            _lower[c] = std::numeric_limits< T >::max();
+            _upper[c] = -std::numeric_limits< T >::max();
+        }
+        for( size_t k = 0; k < Q; ++k )
+        {
+            T lowerLanes[ 16 ], upperLanes[ 16 ];
+            P::store( lowerLanes, lower[k] );
+            P::store( upperLanes, upper[k] );
+            for( size_t j = 0; j < P::width; ++j )
+                _merge(( k * P::width + j ) % Q, lowerLanes[j],
+                       upperLanes[j] );
+        }
+
+        for( size_t i = end; i < _n; ++i )
+            for( size_t c = 0; c < Q; ++c )
+                _merge( c, _values[ i * Q + c ], _values[ i * Q + c ] );
+    }
+
+private:
+    const T* const _values;
+    const size_t _n;
+    T* const _lower;
+    T* const _upper;
+
+    void _merge( const size_t component, const T lower, const T upper ) const
+    {
+        if( lower < _lower[ component ] )
+            _lower[ component ] = lower;
+        if( upper > _upper[ component ] )
+            _upper[ component ] = upper;
+    }
+};
+
+/**
+ * The transformation of a range of boxes, with one matrix per box or the same
+ * matrix for a matrix stride of zero, run by dispatch().
+ */
+template< typename T > class AABBTransformRange
+{
+public:
+    typedef void result_type;
+
+    AABBTransformRange( const T* matrices, const size_t matrixStride,
+                        const T* boxes, T* result, const size_t n )
+        : _matrices( matrices ), _matrixStride( matrixStride )
+        , _boxes( boxes ), _result( result ), _n( n )
+    {}
+
+    /** @return the kernel of a subrange, see dispatchChunks(). */
+    AABBTransformRange operator()( const size_t begin,
+                                   const size_t count ) const
+    {
+        return AABBTransformRange( _matrices + begin * _matrixStride,
+                                   _matrixStride, _boxes + begin * 6,
+                                   _result + begin * 6, count );
+    }
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        const size_t end = _n - _n % P::width;
+        for( size_t i = 0; i < end; i += P::width )
+            _transform< P >( i );
+        for( size_t i = end; i < _n; ++i )
+            _transform< simd::Scalar< T > >( i );
+    }
+
+private:
+    const T* const _matrices;
+    const size_t _matrixStride;
+    const T* const _boxes;
+    T* const _result;
+    const size_t _n;
+
+    template< class P >
+    VMMLIB_SIMD_INLINE void _transform( const size_t i ) const
+    {
+        typedef typename P::type V;
+        const T* box = _boxes + i * 6;
+        const T* matrix = _matrices + i * _matrixStride;
+        const V half = P::set( T( .5 ));
+        V lower[3], upper[3], center[3], extent[3];
+        for( size_t k = 0; k < 3; ++k )
+        {
+            lower[k] = P::gather( box + k, 6 );
+            upper[k] = P::gather( box + 3 + k, 6 );
+            center[k] = P::mul( P::add( lower[k], upper[k] ), half );
+            extent[k] = P::mul( P::sub( upper[k], lower[k] ), half );
+        }
+        const typename P::mask empty =
+            P::orMask( P::orMask( P::gt( lower[0], upper[0] ),
+                                  P::gt( lower[1], upper[1] )),
+                       P::gt( lower[2], upper[2] ));
+
+        for( size_t j = 0; j < 3; ++j )
+        {
+            V m[4];
+            for( size_t k = 0; k < 4; ++k )
+                m[k] = P::gather( matrix + 4 * k + j, _matrixStride );
+            const V c = P::madd( m[2], center[2],
+                                 P::madd( m[1], center[1],
+                                          P::madd( m[0], center[0], m[3] )));
+            const V e = P::madd( P::abs( m[2] ), extent[2],
+                                 P::madd( P::abs( m[1] ), extent[1],
+                                          P::mul( P::abs( m[0] ),
+                                                  extent[0] )));
+            P::scatter( _result + i * 6 + j, 6,
+                        P::select( empty, lower[j], P::sub( c, e )));
+            P::scatter( _result + i * 6 + 3 + j, 6,
+                        P::select( empty, upper[j], P::add( c, e )));
+        }
+    }
+};
+VMMLIB_SIMD_KERNELS_END
+
+template< typename T >
+void transformBoxes( const T* matrices, const size_t matrixStride,
+                     const T* boxes, T* result, const size_t n )
+{
+    dispatchChunks( n, AABBTransformRange< T >( matrices, matrixStride,
+                                                boxes, result, n ));
+}
+
+/**
+ * Creates the BoundsRange of a chunk, see dispatchChunks(), which writes the
+ * bounds of the chunk to its slot of the chunk results.
+ */
+template< typename T, size_t Q > class BoundsChunks
+{
+public:
+    BoundsChunks( const T* values, T* lower, T* upper )
+        : _values( values ), _lower( lower ), _upper( upper ) {}
+
+    BoundsRange< T, Q > operator()( const size_t begin,
+                                    const size_t count ) const
+    {
+        const size_t slot = begin / DISPATCH_CHUNK_SIZE * Q;
+        return BoundsRange< T, Q >( _values + begin * Q, count,
+                                    _lower + slot, _upper + slot );
+    }
+
+private:
+    const T* const _values;
+    T* const _lower;
+    T* const _upper;
+};
+
+/**
+ * Compute the minimum and maximum of each component of n elements of Q
+ * values, in parallel chunks with OpenMP which are merged in order.
+ */
+template< typename T, size_t Q >
+void computeBounds( const T* values, const size_t n, T* lower, T* upper )
+{
+    if( n <= DISPATCH_CHUNK_SIZE )
+    {
+        dispatch( BoundsRange< T, Q >( values, n, lower, upper ));
+        return;
+    }
+
+    const size_t nChunks = getNumDispatchChunks( n );
+    std::vector< T > lowers( nChunks * Q ), uppers( nChunks * Q );
+    dispatchChunks( n, BoundsChunks< T, Q >( values, &lowers[0],
+                                             &uppers[0] ));
+
+    for( size_t c = 0; c < Q; ++c )
+    {
+        lower[c] = std::numeric_limits< T >::max();
+        upper[c] = -std::numeric_limits< T >::max();
+        for( size_t i = 0; i < nChunks; ++i )
+        {
+            if( lowers[ i * Q + c ] < lower[c] )
+                lower[c] = lowers[ i * Q + c ];
+            if( uppers[ i * Q + c ] > upper[c] )
+                upper[c] = uppers[ i * Q + c ];
+        }
+    }
+}
+} // namespace detail
+
 template< typename T > AABB< T >::AABB()
     : _min( std::numeric_limits< T >::max( ))
     , _max( std::numeric_limits< T >::min( ))
@@ -149,6 +437,32 @@ template< typename T > AABB< T >::AABB( const vector< 4, T >& sphere )
     _min -= sphere.getRadius();
 }
 
+template< typename T >
+AABB< T > AABB< T >::fromPoints( const vector< 3, T >* begin,
+                                 const vector< 3, T >* end )
+{
+    AABB< T > aabb;
+    T lower[3], upper[3];
+    detail::computeBounds< T, 3 >( reinterpret_cast< const T* >( begin ),
+                                   size_t( end - begin ), lower, upper );
+    aabb._min = vector< 3, T >( lower );
+    aabb._max = vector< 3, T >( upper );
+    return aabb;
+}
+
+template< typename T >
+AABB< T > AABB< T >::fromBoxes( const AABB< T >* begin, const AABB< T >* end )
+{
+    // minimum and maximum corners are six consecutive values
+    AABB< T > aabb;
+    T lower[6], upper[6];
+    detail::computeBounds< T, 6 >( reinterpret_cast< const T* >( begin ),
+                                   size_t( end - begin ), lower, upper );
+    aabb._min = vector< 3, T >( lower );
+    aabb._max = vector< 3, T >( upper + 3 );
+    return aabb;
+}
+
 template< typename T > inline bool AABB< T >::isIn( const vector< 3, T >& pos ) const
 {
     if ( pos.x() > _max.x() || pos.y() > _max.y() || pos.z() > _max.z() ||
@@ -273,11 +587,39 @@ AABB< T >::computeNearFar( const vector< 4, T >& plane, vector< 3, T >& nearPoin
     }
 }
 
+template< typename T >
+AABB< T > AABB< T >::transform( const Matrix< 4, 4, T >& matrix ) const
+{
+    AABB< T > aabb;
+    detail::AABBTransformRange< T >( matrix.array, 0, _min.array,
+                                     aabb._min.array, 1 )
+        .template run< SIMD_SCALAR >();
+    return aabb;
+}
+
 template< typename T > AABB< T > AABB< T >::makeUnitBox()
 {
     return AABB( vector< 3, T >::ZERO, vector< 3, T >::ONE );
 }
 
+template< typename T >
+void transform( const Matrix< 4, 4, T >* matrices, const AABB< T >* boxes,
+                AABB< T >* result, const size_t n )
+{
+    detail::transformBoxes( reinterpret_cast< const T* >( matrices ), 16,
+                            reinterpret_cast< const T* >( boxes ),
+                            reinterpret_cast< T* >( result ), n );
+}
+
+template< typename T >
+void transform( const Matrix< 4, 4, T >& matrix, const AABB< T >* boxes,
+                AABB< T >* result, const size_t n )
+{
+    detail::transformBoxes( matrix.array, 0,
+                            reinterpret_cast< const T* >( boxes ),
+                            reinterpret_cast< T* >( result ), n );
+}
+
 }
 
 #endif
@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__AABB4F__HPP__
+#define __VMML__AABB4F__HPP__
+
+#include <vmmlib/aabb.hpp> // used inline
+#include <vmmlib/simd.hpp> // used inline
+#include <vmmlib/vector.hpp> // inline parameter
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+namespace vmml
+{
+/**
+ * An axis-aligned bounding box of floats padded to SSE registers.
+ *
+ * The corners are stored as four aligned floats each, with a fourth component
+ * of zero, so that each operation is a few SIMD instructions without branches.
+ * Meant for the inner loops of bounding volume hierarchy builds and
+ * broad-phase collision detection; AABB< float > remains the interface type.
+ * Without SSE2 the same operations are implemented with scalar code.
+ *
+ * Arrays of boxes need 16-byte aligned storage, which the default allocators
+ * provide on 64-bit platforms.
+ */
+class VMMLIB_ALIGN( 16 ) AABB4f
+{
+public:
+    typedef vector< 3, float > vec3;
+
+    /** Create an empty bounding box. */
+    AABB4f() { reset(); }
+
+    /** Create a new bounding box from two corner points */
+    AABB4f( const vec3& pMin, const vec3& pMax );
+
+    /** Create a new bounding box from an AABB, empty for an empty AABB. */
+    explicit AABB4f( const AABB< float >& aabb );
+
+    /** @return this box as an AABB, empty if this box is empty. */
+    AABB< float > getAABB() const;
+
+    /** @return the minimum corner point */
+    vec3 getMin() const { return vec3( _min ); }
+
+    /** @return the maximum corner point */
+    vec3 getMax() const { return vec3( _max ); }
+
+    /** @return the center of this bounding box */
+    vec3 getCenter() const;
+
+    /** @return the size of this bounding box */
+    vec3 getSize() const;
+
+    /** @return the surface area of this bounding box, zero if empty. */
+    float getSurfaceArea() const;
+
+    /** @return true if the given point is within this bounding box. */
+    bool isIn( const vec3& point ) const;
+
+    /** @return true if this and the other bounding box overlap. */
+    bool intersects( const AABB4f& other ) const;
+
+    /** @return true if this bounding box has not been set */
+    bool isEmpty() const;
+
+    /** Create the union of this and the given bounding box */
+    void merge( const AABB4f& other );
+
+    /** Create the union of this and the given point */
+    void merge( const vec3& point );
+
+    /** Clear this bounding box */
+    void reset();
+
+    /** @return true if this and the other bounding box are identical */
+    bool operator==( const AABB4f& other ) const;
+
+    /** @return true if this and the other bounding box are not identical */
+    bool operator!=( const AABB4f& other ) const
+        { return !( *this == other ); }
+
+private:
+    float _min[4];
+    float _max[4];
+};
+
+inline std::ostream& operator << ( std::ostream& os, const AABB4f& aabb )
+{
+    return os << aabb.getMin() << " - " << aabb.getMax();
+}
+
+// - implementation -
+
+inline AABB4f::AABB4f( const vec3& pMin, const vec3& pMax )
+{
+    for( size_t i = 0; i < 3; ++i )
+    {
+        _min[i] = std::min( pMin[i], pMax[i] );
+        _max[i] = std::max( pMin[i], pMax[i] );
+    }
+    _min[3] = _max[3] = 0.f;
+}
+
+inline AABB4f::AABB4f( const AABB< float >& aabb )
+{
+    for( size_t i = 0; i < 3; ++i )
+    {
+        _min[i] = aabb.getMin()[i];
+        _max[i] = aabb.getMax()[i];
+    }
+    _min[3] = _max[3] = 0.f;
+}
+
+inline AABB< float > AABB4f::getAABB() const
+{
+    // the constructor of AABB would swap the corners of an empty box
+    return isEmpty() ? AABB< float >() : AABB< float >( getMin(), getMax( ));
+}
+
+inline void AABB4f::reset()
+{
+    for( size_t i = 0; i < 3; ++i )
+    {
+        _min[i] = std::numeric_limits< float >::max();
+        _max[i] = -std::numeric_limits< float >::max();
+    }
+    _min[3] = _max[3] = 0.f;
+}
+
+#ifdef VMMLIB_SSE2
+inline AABB4f::vec3 AABB4f::getCenter() const
+{
+    float center[4];
+    _mm_storeu_ps( center, _mm_mul_ps( _mm_add_ps( _mm_load_ps( _min ),
+                                                   _mm_load_ps( _max )),
+                                       _mm_set1_ps( .5f )));
+    return vec3( center );
+}
+
+inline AABB4f::vec3 AABB4f::getSize() const
+{
+    float size[4];
+    _mm_storeu_ps( size, _mm_sub_ps( _mm_load_ps( _max ),
+                                     _mm_load_ps( _min )));
+    return vec3( size );
+}
+
+inline float AABB4f::getSurfaceArea() const
+{
+    // sx * sy + sy * sz + sz * sx from the size and its rotation to yzxw
+    const __m128 size = _mm_max_ps( _mm_sub_ps( _mm_load_ps( _max ),
+                                                _mm_load_ps( _min )),
+                                    _mm_setzero_ps( ));
+    const __m128 products = _mm_mul_ps( size, _mm_shuffle_ps(
+                                            size, size,
+                                            _MM_SHUFFLE( 3, 0, 2, 1 )));
+    float terms[4];
+    _mm_storeu_ps( terms, products );
+    return 2.f * ( terms[0] + terms[1] + terms[2] );
+}
+
+inline bool AABB4f::isIn( const vec3& point ) const
+{
+    const __m128 p = _mm_setr_ps( point.x(), point.y(), point.z(), 0.f );
+    const __m128 inside = _mm_and_ps( _mm_cmpge_ps( p, _mm_load_ps( _min )),
+                                      _mm_cmple_ps( p, _mm_load_ps( _max )));
+    return _mm_movemask_ps( inside ) == 0xf;
+}
+
+inline bool AABB4f::intersects( const AABB4f& other ) const
+{
+    const __m128 overlap =
+        _mm_and_ps( _mm_cmple_ps( _mm_load_ps( _min ),
+                                  _mm_load_ps( other._max )),
+                    _mm_cmple_ps( _mm_load_ps( other._min ),
+                                  _mm_load_ps( _max )));
+    return _mm_movemask_ps( overlap ) == 0xf;
+}
+
+inline bool AABB4f::isEmpty() const
+{
+    return _mm_movemask_ps( _mm_cmpgt_ps( _mm_load_ps( _min ),
+                                          _mm_load_ps( _max ))) != 0;
+}
+
+inline void AABB4f::merge( const AABB4f& other )
+{
+    _mm_store_ps( _min, _mm_min_ps( _mm_load_ps( _min ),
+                                    _mm_load_ps( other._min )));
+    _mm_store_ps( _max, _mm_max_ps( _mm_load_ps( _max ),
+                                    _mm_load_ps( other._max )));
+}
+
+inline void AABB4f::merge( const vec3& point )
+{
+    const __m128 p = _mm_setr_ps( point.x(), point.y(), point.z(), 0.f );
+    _mm_store_ps( _min, _mm_min_ps( _mm_load_ps( _min ), p ));
+    _mm_store_ps( _max, _mm_max_ps( _mm_load_ps( _max ), p ));
+}
+
+inline bool AABB4f::operator==( const AABB4f& other ) const
+{
+    const __m128 equal =
+        _mm_and_ps( _mm_cmpeq_ps( _mm_load_ps( _min ),
+                                  _mm_load_ps( other._min )),
+                    _mm_cmpeq_ps( _mm_load_ps( _max ),
+                                  _mm_load_ps( other._max )));
+    return _mm_movemask_ps( equal ) == 0xf;
+}
+#else
+inline AABB4f::vec3 AABB4f::getCenter() const
+{
+    return vec3(( _min[0] + _max[0] ) * .5f, ( _min[1] + _max[1] ) * .5f,
+                ( _min[2] + _max[2] ) * .5f );
+}
+
+inline AABB4f::vec3 AABB4f::getSize() const
+{
+    return vec3( _max[0] - _min[0], _max[1] - _min[1], _max[2] - _min[2] );
+}
+
+inline float AABB4f::getSurfaceArea() const
+{
+    float size[3];
+    for( size_t i = 0; i < 3; ++i )
+        size[i] = std::max( _max[i] - _min[i], 0.f );
+    return 2.f * ( size[0] * size[1] + size[1] * size[2] +
+                   size[2] * size[0] );
+}
+
+inline bool AABB4f::isIn( const vec3& point ) const
+{
+    bool inside = true;
+    for( size_t i = 0; i < 3; ++i )
+        inside &= point[i] >= _min[i] && point[i] <= _max[i];
+    return inside;
+}
+
+inline bool AABB4f::intersects( const AABB4f& other ) const
+{
+    bool overlap = true;
+    for( size_t i = 0; i < 3; ++i )
+        overlap &= _min[i] <= other._max[i] && other._min[i] <= _max[i];
+    return overlap;
+}
+
+inline bool AABB4f::isEmpty() const
+{
+    return _min[0] > _max[0] || _min[1] > _max[1] || _min[2] > _max[2];
+}
+
+inline void AABB4f::merge( const AABB4f& other )
+{
+    for( size_t i = 0; i < 3; ++i )
+    {
+        _min[i] = std::min( _min[i], other._min[i] );
+        _max[i] = std::max( _max[i], other._max[i] );
+    }
+}
+
+inline void AABB4f::merge( const vec3& point )
+{
+    for( size_t i = 0; i < 3; ++i )
+    {
+        _min[i] = std::min( _min[i], point[i] );
+        _max[i] = std::max( _max[i], point[i] );
+    }
+}
+
+inline bool AABB4f::operator==( const AABB4f& other ) const
+{
+    return std::equal( _min, _min + 3, other._min ) &&
+           std::equal( _max, _max + 3, other._max );
+}
+#endif
+
+} // namespace vmml
+
+#endif
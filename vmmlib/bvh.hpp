@@ -0,0 +1,732 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__BVH__HPP__
+#define __VMML__BVH__HPP__
+
+#include <vmmlib/aabb.hpp> // inline parameter
+#include <vmmlib/frustumCuller.hpp> // inline parameter
+#include <vmmlib/ray.hpp> // inline parameter
+#include <vmmlib/types.hpp> // uint32_t
+#include <vmmlib/vector.hpp> // member
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace vmml
+{
+/**
+ * A bounding volume hierarchy over axis-aligned bounding boxes.
+ *
+ * The hierarchy only references primitives by their index in the array of
+ * bounding boxes passed to the builders. The nodes are stored in a flat array
+ * in depth-first order: the left child of an inner node directly follows its
+ * parent, and the primitives of each subtree are contiguous in getIndices().
+ *
+ * Two builders are provided: buildSAH() uses the binned surface area heuristic
+ * and produces the best trees for ray queries, buildLBVH() sorts the
+ * primitives along a Morton curve and is several times faster to build.
+ * refit() updates the bounds of an existing tree after the primitives moved.
+ */
+template< typename T > class BVH
+{
+public:
+    typedef vector< 3, T > vec3;
+
+    /** A node of the hierarchy, 32 bytes for float. */
+    struct Node
+    {
+        vec3 min;
+        uint32_t offset; //!< leaf: first index in getIndices(), or right child
+        vec3 max;
+        uint32_t count; //!< number of primitives of a leaf, 0 for inner nodes
+
+        /** @return true if this node is a leaf. */
+        bool isLeaf() const { return count > 0; }
+
+        /** @return the bounding box of this node. */
+        AABB< T > getBounds() const { return AABB< T >( min, max ); }
+    };
+
+    /** The primitive index returned if a ray query did not hit anything. */
+    static const uint32_t INVALID = 0xffffffffu;
+
+    /** Construct an empty hierarchy. */
+    BVH() {}
+
+    /**
+     * Build the hierarchy using the binned surface area heuristic.
+     *
+     * @param boxes the bounding boxes of the primitives
+     * @param n the number of primitives
+     * @param leafSize the maximum number of primitives per leaf
+     */
+    void buildSAH( const AABB< T >* boxes, size_t n, size_t leafSize = 4 );
+
+    /**
+     * Build the hierarchy by sorting the primitives along a 30 bit Morton
+     * curve through their centers (linear BVH).
+     *
+     * @param boxes the bounding boxes of the primitives
+     * @param n the number of primitives
+     * @param leafSize the maximum number of primitives per leaf
+     */
+    void buildLBVH( const AABB< T >* boxes, size_t n, size_t leafSize = 4 );
+
+    /**
+     * Recompute the node bounds from updated primitive bounds.
+     *
+     * The topology of the tree is kept, which degrades query performance if
+     * the primitives moved a lot relative to each other.
+     *
+     * @param boxes the new bounding boxes, in the order used to build the tree
+     */
+    void refit( const AABB< T >* boxes );
+
+    /** Clear the hierarchy. */
+    void clear();
+
+    /** @return true if the hierarchy contains no primitives. */
+    bool isEmpty() const { return _nodes.empty(); }
+
+    /** @return the nodes in depth-first order, the root is the first node. */
+    const std::vector< Node >& getNodes() const { return _nodes; }
+
+    /** @return the primitive indices referenced by the leaves. */
+    const std::vector< uint32_t >& getIndices() const { return _indices; }
+
+    /** @return the bounds of all primitives. */
+    AABB< T > getBounds() const;
+
+    /**
+     * Collect the primitives of all leaves which intersect the frustum.
+     *
+     * The result is conservative on leaf granularity: all primitives of a
+     * partially visible leaf are returned. Uses the hierarchical plane masks of
+     * the frustum culler.
+     *
+     * @param culler the frustum culler
+     * @param visible the vector the visible primitive indices are appended to
+     * @return the number of appended primitives
+     */
+    size_t cull( const FrustumCuller< T >& culler,
+                 std::vector< uint32_t >& visible ) const;
+
+    /**
+     * Find the closest intersection of a ray with the primitives.
+     *
+     * The nodes are visited front to back, and nodes further away than the
+     * closest intersection found so far are skipped.
+     *
+     * @param ray the ray
+     * @param intersector a functor T( const Ray< T >&, uint32_t primitive )
+     *                    returning the distance from the ray origin to the
+     *                    intersection with the primitive, or a negative value
+     *                    if the ray misses it.
+     * @param distance the distance to the closest intersection, unchanged if
+     *                 no primitive was hit
+     * @return the index of the closest primitive, or INVALID
+     */
+    template< class Intersector >
+    uint32_t intersect( const Ray< T >& ray, Intersector& intersector,
+                        T& distance ) const;
+
+private:
+    std::vector< Node > _nodes;
+    std::vector< uint32_t > _indices;
+
+    // fixed traversal stack, sufficient for the depths the builders produce
+    static const size_t _stackSize = 128;
+    static const size_t _maxSAHDepth = 64;
+    static const size_t _nBins = 16;
+
+
+    // build data of the SAH builder, partitioned in place for locality
+    struct Primitive
+    {
+        vec3 min;
+        vec3 max;
+        vec3 center;
+        uint32_t index;
+    };
+
+    static size_t _getBin( const Primitive& primitive, const size_t axis,
+                           const T minCenter, const T scale )
+    {
+        return std::min( _nBins - 1, size_t(
+            ( primitive.center.array[ axis ] - minCenter ) * scale ));
+    }
+
+    struct BinLess
+    {
+        BinLess( const size_t axis, const T minCenter, const T scale,
+                 const size_t split )
+            : _axis( axis ), _minCenter( minCenter ), _scale( scale )
+            , _split( split ) {}
+        bool operator()( const Primitive& primitive ) const
+        {
+            return _getBin( primitive, _axis, _minCenter, _scale ) <= _split;
+        }
+        size_t _axis;
+        T _minCenter;
+        T _scale;
+        size_t _split;
+    };
+
+    struct CenterLess
+    {
+        explicit CenterLess( const size_t axis ) : _axis( axis ) {}
+        bool operator()( const Primitive& a, const Primitive& b ) const
+            { return a.center.array[ _axis ] < b.center.array[ _axis ]; }
+        size_t _axis;
+    };
+
+    void _reset( size_t n, size_t leafSize );
+    uint32_t _addNode();
+    uint32_t _buildSAH( Primitive* primitives, size_t begin, size_t end,
+                        size_t leafSize, size_t depth );
+    uint32_t _buildLBVH( const uint32_t* codes, size_t begin, size_t end,
+                         size_t leafSize );
+    void _setLeaf( uint32_t node, size_t begin, size_t end );
+    static void _merge( vec3& min, vec3& max, const vec3& otherMin,
+                        const vec3& otherMax );
+    static void _clear( vec3& min, vec3& max );
+    static T _getArea( const vec3& min, const vec3& max );
+    void _getRange( uint32_t node, uint32_t& begin, uint32_t& end ) const;
+    static uint32_t _expandBits( uint32_t value );
+    static bool _intersect( const Node& node, const vec3& origin,
+                            const vec3& invDirection, T maxDistance,
+                            T& distance );
+};
+
+// - implementation -
+
+template< typename T > const uint32_t BVH< T >::INVALID;
+
+template< typename T >
+void BVH< T >::buildSAH( const AABB< T >* boxes, const size_t n,
+                         const size_t leafSize )
+{
+    _reset( n, leafSize );
+    if( n == 0 )
+        return;
+
+    std::vector< Primitive > primitives( n );
+    for( size_t i = 0; i < n; ++i )
+    {
+        primitives[i].min = boxes[i].getMin();
+        primitives[i].max = boxes[i].getMax();
+        primitives[i].center = boxes[i].getCenter();
+        primitives[i].index = uint32_t( i );
+    }
+
+    _buildSAH( &primitives[0], 0, n, leafSize, 0 );
+    for( size_t i = 0; i < n; ++i )
+        _indices[i] = primitives[i].index;
+}
+
+template< typename T >
+void BVH< T >::buildLBVH( const AABB< T >* boxes, const size_t n,
+                          const size_t leafSize )
+{
+    _reset( n, leafSize );
+    if( n == 0 )
+        return;
+
+    AABB< T > bounds;
+    for( size_t i = 0; i < n; ++i )
+        bounds.merge( boxes[i].getCenter( ));
+    const vec3& origin = bounds.getMin();
+    vec3 scale = bounds.getSize();
+    for( size_t i = 0; i < 3; ++i )
+        scale[i] = scale[i] > 0 ? T( 1023.99 ) / scale[i] : 0;
+
+    // keys are the 30 bit Morton code in the upper half and the primitive
+    // index in the lower half, LSD radix sort over the Morton code bits
+    std::vector< uint64_t > keys( n ), sorted( n );
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vec3 position = ( boxes[i].getCenter() - origin ) * scale;
+        const uint32_t code = ( _expandBits( uint32_t( position.x( ))) << 2 ) |
+                              ( _expandBits( uint32_t( position.y( ))) << 1 ) |
+                                _expandBits( uint32_t( position.z( )));
+        keys[i] = ( uint64_t( code ) << 32 ) | i;
+    }
+
+    for( size_t shift = 32; shift < 62; shift += 10 )
+    {
+        size_t offsets[ 1024 ] = { 0 };
+        for( size_t i = 0; i < n; ++i )
+            ++offsets[ ( keys[i] >> shift ) & 1023 ];
+        size_t sum = 0;
+        for( size_t i = 0; i < 1024; ++i )
+        {
+            const size_t count = offsets[i];
+            offsets[i] = sum;
+            sum += count;
+        }
+        for( size_t i = 0; i < n; ++i )
+            sorted[ offsets[ ( keys[i] >> shift ) & 1023 ]++ ] = keys[i];
+        keys.swap( sorted );
+    }
+
+    std::vector< uint32_t > mortonCodes( n );
+    for( size_t i = 0; i < n; ++i )
+    {
+        mortonCodes[i] = uint32_t( keys[i] >> 32 );
+        _indices[i] = uint32_t( keys[i] );
+    }
+    std::vector< uint64_t >().swap( keys );
+    std::vector< uint64_t >().swap( sorted );
+
+    _buildLBVH( &mortonCodes[0], 0, n, leafSize );
+    refit( boxes );
+}
+
+template< typename T > void BVH< T >::refit( const AABB< T >* boxes )
+{
+    // children always follow their parent in the node array
+    for( size_t i = _nodes.size(); i > 0; --i )
+    {
+        Node& node = _nodes[ i - 1 ];
+        if( node.isLeaf( ))
+        {
+            const AABB< T >& first = boxes[ _indices[ node.offset ]];
+            node.min = first.getMin();
+            node.max = first.getMax();
+            for( size_t j = 1; j < node.count; ++j )
+            {
+                const AABB< T >& box = boxes[ _indices[ node.offset + j ]];
+                _merge( node.min, node.max, box.getMin(), box.getMax( ));
+            }
+        }
+        else
+        {
+            const Node& left = _nodes[ i ];
+            node.min = left.min;
+            node.max = left.max;
+            const Node& right = _nodes[ node.offset ];
+            _merge( node.min, node.max, right.min, right.max );
+        }
+    }
+}
+
+template< typename T > void BVH< T >::clear()
+{
+    _nodes.clear();
+    _indices.clear();
+}
+
+template< typename T > AABB< T > BVH< T >::getBounds() const
+{
+    return _nodes.empty() ? AABB< T >() : _nodes.front().getBounds();
+}
+
+template< typename T >
+size_t BVH< T >::cull( const FrustumCuller< T >& culler,
+                       std::vector< uint32_t >& visible ) const
+{
+    if( _nodes.empty( ))
+        return 0;
+
+    const size_t size = visible.size();
+    uint32_t stack[ _stackSize ];
+    unsigned planeStack[ _stackSize ];
+    size_t top = 0;
+    size_t lastPlane = 0;
+    stack[ 0 ] = 0;
+    planeStack[ 0 ] = FrustumCuller< T >::PLANES_ALL;
+    ++top;
+
+    while( top > 0 )
+    {
+        --top;
+        const uint32_t index = stack[ top ];
+        unsigned planes = planeStack[ top ];
+        const Node& node = _nodes[ index ];
+
+        switch( culler.test( node.getBounds(), planes, lastPlane ))
+        {
+        case VISIBILITY_NONE:
+            break;
+
+        case VISIBILITY_FULL:
+        {
+            uint32_t begin, end;
+            _getRange( index, begin, end );
+            visible.insert( visible.end(), _indices.begin() + begin,
+                            _indices.begin() + end );
+            break;
+        }
+
+        case VISIBILITY_PARTIAL:
+            if( node.isLeaf( ))
+            {
+                visible.insert( visible.end(),
+                                _indices.begin() + node.offset,
+                                _indices.begin() + node.offset + node.count );
+                break;
+            }
+            stack[ top ] = node.offset;
+            planeStack[ top++ ] = planes;
+            stack[ top ] = index + 1;
+            planeStack[ top++ ] = planes;
+            break;
+        }
+    }
+    return visible.size() - size;
+}
+
+template< typename T > template< class Intersector >
+uint32_t BVH< T >::intersect( const Ray< T >& ray, Intersector& intersector,
+                              T& distance ) const
+{
+    if( _nodes.empty( ))
+        return INVALID;
+
+    const vec3& origin = ray.getOrigin();
+    const vec3& direction = ray.getDirection();
+    const vec3 invDirection( T( 1 ) / direction.x(), T( 1 ) / direction.y(),
+                             T( 1 ) / direction.z( ));
+
+    T closest = std::numeric_limits< T >::max();
+    uint32_t hit = INVALID;
+    T entry;
+    if( !_intersect( _nodes[0], origin, invDirection, closest, entry ))
+        return INVALID;
+
+    uint32_t stack[ _stackSize ];
+    T entryStack[ _stackSize ];
+    size_t top = 0;
+    stack[ top ] = 0;
+    entryStack[ top++ ] = entry;
+
+    while( top > 0 )
+    {
+        --top;
+        if( entryStack[ top ] > closest )
+            continue;
+
+        const Node& node = _nodes[ stack[ top ]];
+        if( node.isLeaf( ))
+        {
+            for( size_t i = 0; i < node.count; ++i )
+            {
+                const uint32_t primitive = _indices[ node.offset + i ];
+                const T t = intersector( ray, primitive );
+                if( t >= 0 && t < closest )
+                {
+                    closest = t;
+                    hit = primitive;
+                }
+            }
+            continue;
+        }
+
+        // push the farther child first to visit the nearer one next
+        const uint32_t left = stack[ top ] + 1;
+        const uint32_t right = node.offset;
+        T leftEntry, rightEntry;
+        const bool hitLeft = _intersect( _nodes[ left ], origin, invDirection,
+                                         closest, leftEntry );
+        const bool hitRight = _intersect( _nodes[ right ], origin,
+                                          invDirection, closest, rightEntry );
+        if( hitLeft && hitRight )
+        {
+            const bool leftFirst = leftEntry <= rightEntry;
+            stack[ top ] = leftFirst ? right : left;
+            entryStack[ top++ ] = leftFirst ? rightEntry : leftEntry;
+            stack[ top ] = leftFirst ? left : right;
+            entryStack[ top++ ] = leftFirst ? leftEntry : rightEntry;
+        }
+        else if( hitLeft )
+        {
+            stack[ top ] = left;
+            entryStack[ top++ ] = leftEntry;
+        }
+        else if( hitRight )
+        {
+            stack[ top ] = right;
+            entryStack[ top++ ] = rightEntry;
+        }
+    }
+
+    if( hit != INVALID )
+        distance = closest;
+    return hit;
+}
+
+template< typename T >
+void BVH< T >::_reset( const size_t n, const size_t leafSize )
+{
+    if( n >= size_t( INVALID ))
+        throw std::runtime_error( "Too many primitives for BVH" );
+    if( leafSize == 0 )
+        throw std::runtime_error( "BVH leaf size must not be zero" );
+
+    _nodes.clear();
+    _nodes.reserve( 2 * ( n / leafSize ) + 1 );
+    _indices.resize( n );
+    for( size_t i = 0; i < n; ++i )
+        _indices[i] = uint32_t( i );
+}
+
+template< typename T > uint32_t BVH< T >::_addNode()
+{
+    _nodes.push_back( Node( ));
+    return uint32_t( _nodes.size() - 1 );
+}
+
+template< typename T >
+uint32_t BVH< T >::_buildSAH( Primitive* primitives, const size_t begin,
+                              const size_t end, const size_t leafSize,
+                              const size_t depth )
+{
+    const uint32_t index = _addNode();
+    Node& node = _nodes[ index ];
+    vec3 centerMin, centerMax;
+    _clear( node.min, node.max );
+    _clear( centerMin, centerMax );
+    for( size_t i = begin; i < end; ++i )
+    {
+        const Primitive& primitive = primitives[i];
+        _merge( node.min, node.max, primitive.min, primitive.max );
+        _merge( centerMin, centerMax, primitive.center, primitive.center );
+    }
+
+    const size_t n = end - begin;
+    if( n <= leafSize )
+    {
+        _setLeaf( index, begin, end );
+        return index;
+    }
+
+    const vec3 extent = centerMax - centerMin;
+    const size_t axis = extent.x() > extent.y() ?
+                        ( extent.x() > extent.z() ? 0 : 2 ) :
+                        ( extent.y() > extent.z() ? 1 : 2 );
+    const T minCenter = centerMin.array[ axis ];
+    size_t middle = begin;
+
+    if( extent.array[ axis ] > 0 && depth < _maxSAHDepth )
+    {
+        // bin the primitive centers, evaluate the SAH cost of all bin
+        // boundaries and partition at the cheapest one
+        const T scale = T( _nBins ) * ( T( 1 ) - T( 1e-4 )) /
+                        extent.array[ axis ];
+        vec3 binMin[ _nBins ], binMax[ _nBins ];
+        size_t binCounts[ _nBins ] = { 0 };
+        for( size_t i = 0; i < _nBins; ++i )
+            _clear( binMin[i], binMax[i] );
+        for( size_t i = begin; i < end; ++i )
+        {
+            const Primitive& primitive = primitives[i];
+            const size_t bin = _getBin( primitive, axis, minCenter, scale );
+            ++binCounts[ bin ];
+            _merge( binMin[ bin ], binMax[ bin ], primitive.min,
+                    primitive.max );
+        }
+
+        T rightCosts[ _nBins ];
+        vec3 rightMin, rightMax;
+        _clear( rightMin, rightMax );
+        size_t rightCount = 0;
+        for( size_t i = _nBins - 1; i > 0; --i )
+        {
+            _merge( rightMin, rightMax, binMin[i], binMax[i] );
+            rightCount += binCounts[i];
+            rightCosts[ i - 1 ] = rightCount ?
+                _getArea( rightMin, rightMax ) * T( rightCount ) : 0;
+        }
+
+        vec3 leftMin, leftMax;
+        _clear( leftMin, leftMax );
+        size_t leftCount = 0;
+        size_t bestSplit = _nBins;
+        T bestCost = std::numeric_limits< T >::max();
+        for( size_t i = 0; i < _nBins - 1; ++i )
+        {
+            _merge( leftMin, leftMax, binMin[i], binMax[i] );
+            leftCount += binCounts[i];
+            if( leftCount == 0 || leftCount == n )
+                continue;
+            const T cost = _getArea( leftMin, leftMax ) * T( leftCount ) +
+                           rightCosts[i];
+            if( cost < bestCost )
+            {
+                bestCost = cost;
+                bestSplit = i;
+            }
+        }
+
+        if( bestSplit < _nBins )
+        {
+            const BinLess binLess( axis, minCenter, scale, bestSplit );
+            middle = size_t( std::partition( primitives + begin,
+                                             primitives + end, binLess ) -
+                             primitives );
+        }
+    }
+
+    if( middle == begin || middle == end )
+    {
+        // coincident centers or too deep: median split
+        middle = begin + n / 2;
+        if( extent.array[ axis ] > 0 )
+            std::nth_element( primitives + begin, primitives + middle,
+                              primitives + end, CenterLess( axis ));
+    }
+
+    _buildSAH( primitives, begin, middle, leafSize, depth + 1 );
+    const uint32_t right = _buildSAH( primitives, middle, end, leafSize,
+                                      depth + 1 );
+    _nodes[ index ].offset = right;
+    return index;
+}
+
+template< typename T >
+uint32_t BVH< T >::_buildLBVH( const uint32_t* codes, const size_t begin,
+                               const size_t end, const size_t leafSize )
+{
+    const uint32_t index = _addNode();
+    const size_t n = end - begin;
+    if( n <= leafSize )
+    {
+        _setLeaf( index, begin, end );
+        return index;
+    }
+
+    // split where the highest bit differing within the range flips, or in the
+    // middle for identical codes
+    size_t middle = begin + n / 2;
+    const uint32_t first = codes[ begin ];
+    const uint32_t difference = first ^ codes[ end - 1 ];
+    if( difference != 0 )
+    {
+        uint32_t bit = 1u << 31;
+        while( !( difference & bit ))
+            bit >>= 1;
+        const uint32_t splitCode = ( first & ~( bit | ( bit - 1 ))) | bit;
+        middle = size_t( std::lower_bound( codes + begin, codes + end,
+                                           splitCode ) - codes );
+    }
+
+    _buildLBVH( codes, begin, middle, leafSize );
+    const uint32_t right = _buildLBVH( codes, middle, end, leafSize );
+    _nodes[ index ].offset = right;
+    return index;
+}
+
+template< typename T >
+void BVH< T >::_setLeaf( const uint32_t node, const size_t begin,
+                         const size_t end )
+{
+    _nodes[ node ].offset = uint32_t( begin );
+    _nodes[ node ].count = uint32_t( end - begin );
+}
+
+template< typename T >
+void BVH< T >::_merge( vec3& min, vec3& max, const vec3& otherMin,
+                       const vec3& otherMax )
+{
+    // branch-free min/max, unlike AABB::merge()
+    for( size_t i = 0; i < 3; ++i )
+    {
+        min.array[i] = std::min( min.array[i], otherMin.array[i] );
+        max.array[i] = std::max( max.array[i], otherMax.array[i] );
+    }
+}
+
+template< typename T > void BVH< T >::_clear( vec3& min, vec3& max )
+{
+    min = std::numeric_limits< T >::max();
+    max = -std::numeric_limits< T >::max();
+}
+
+template< typename T >
+T BVH< T >::_getArea( const vec3& min, const vec3& max )
+{
+    const vec3 size = max - min;
+    return size.x() * size.y() + size.y() * size.z() + size.z() * size.x();
+}
+
+template< typename T >
+void BVH< T >::_getRange( uint32_t node, uint32_t& begin,
+                          uint32_t& end ) const
+{
+    uint32_t first = node;
+    while( !_nodes[ first ].isLeaf( ))
+        ++first;
+    while( !_nodes[ node ].isLeaf( ))
+        node = _nodes[ node ].offset;
+    begin = _nodes[ first ].offset;
+    end = _nodes[ node ].offset + _nodes[ node ].count;
+}
+
+template< typename T > uint32_t BVH< T >::_expandBits( uint32_t value )
+{
+    // insert two zero bits after each of the lower 10 bits
+    value = ( value * 0x00010001u ) & 0xFF0000FFu;
+    value = ( value * 0x00000101u ) & 0x0F00F00Fu;
+    value = ( value * 0x00000011u ) & 0xC30C30C3u;
+    value = ( value * 0x00000005u ) & 0x49249249u;
+    return value;
+}
+
+template< typename T >
+bool BVH< T >::_intersect( const Node& node, const vec3& origin,
+                           const vec3& invDirection, const T maxDistance,
+                           T& distance )
+{
+    // slab test, NaNs from 0 * inf never update the interval
+    T entry = 0;
+    T exit = maxDistance;
+    for( size_t i = 0; i < 3; ++i )
+    {
+        T t0 = ( node.min.array[i] - origin.array[i] ) *
+               invDirection.array[i];
+        T t1 = ( node.max.array[i] - origin.array[i] ) *
+               invDirection.array[i];
+        if( t0 > t1 )
+            std::swap( t0, t1 );
+        entry = t0 > entry ? t0 : entry;
+        exit = t1 < exit ? t1 : exit;
+    }
+    distance = entry;
+    return entry <= exit;
+}
+
+} // namespace vmml
+
+#endif
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __VMML__DISPATCH__HPP__
+#define __VMML__DISPATCH__HPP__
+
+/**
+ * @file dispatch.hpp
+ *
+ * Runtime selection of the SIMD level of the batch kernels.
+ *
+ * With VMMLIB_SIMD_DISPATCH, binaries compiled for a baseline instruction set
+ * detect the instruction sets of the CPU once with cpuid, and run each batch
+ * kernel with the widest packs available. Otherwise the kernels use the
+ * instruction sets targeted by the compiler.
+ *
+ * The level can be lowered for testing and benchmarking with setSIMDLevel(),
+ * or with the VMMLIB_SIMD_LEVEL environment variable set to scalar, sse2,
+ * sse4.1, avx, avx2 or avx512 before the first kernel runs.
+ */
+
+#include <vmmlib/simd.hpp> // used inline
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined( VMMLIB_SIMD_DISPATCH ) && defined( _MSC_VER )
+#  include <intrin.h>
+#elif defined( VMMLIB_SIMD_DISPATCH )
+#  include <cpuid.h>
+#endif
+
+namespace vmml
+{
+/**
+ * @return the highest SIMD level supported by the CPU and by this build, i.e.
+ *         NATIVE_LEVEL without VMMLIB_SIMD_DISPATCH.
+ */
+inline SIMDLevel getSupportedSIMDLevel();
+
+/** @return the SIMD level used by the batch kernels. */
+inline SIMDLevel getSIMDLevel();
+
+/**
+ * Set the SIMD level used by the batch kernels.
+ *
+ * Meant for testing and benchmarking; not thread safe with respect to
+ * kernels running concurrently.
+ *
+ * @param level the requested level, lowered to getSupportedSIMDLevel().
+ * @return the new level.
+ */
+inline SIMDLevel setSIMDLevel( SIMDLevel level );
+
+/** @return the name of the SIMD level, as used in VMMLIB_SIMD_LEVEL. */
+inline const char* getName( SIMDLevel level );
+
+inline std::ostream& operator << ( std::ostream& os, const SIMDLevel level )
+{
+    return os << getName( level );
+}
+
+/**
+ * Run a batch kernel at the current SIMD level.
+ *
+ * The kernel is a function object with a result_type and a const member
+ * function template< SIMDLevel L > result_type run(). run() and all functions
+ * it calls with SIMD registers must be VMMLIB_SIMD_INLINE, so that they are
+ * compiled for the instruction set of L.
+ */
+template< class K > typename K::result_type dispatch( const K& kernel );
+
+/** The number of elements per chunk of dispatchChunks(). */
+const size_t DISPATCH_CHUNK_SIZE = 16384;
+
+/** @return the number of chunks dispatchChunks() splits n elements into. */
+inline size_t getNumDispatchChunks( size_t n );
+
+/**
+ * Run a batch kernel over n elements in chunks, in parallel with OpenMP.
+ *
+ * makeKernel is a function object, called as makeKernel( begin, count ) to
+ * create the kernel for the elements [begin, begin + count). Kernels over
+ * plain arrays implement this operator() themselves, returning the kernel of
+ * a subrange of their own range.
+ *
+ * Chunks are large enough to amortize the thread overhead and a multiple of
+ * every SIMD width, so only the last chunk has a scalar tail. Each chunk is
+ * dispatched on its own, since the OpenMP threads run code compiled for the
+ * default target.
+ */
+template< class F > void dispatchChunks( size_t n, const F& makeKernel );
+
+// - implementation -
+
+namespace detail
+{
+#ifdef VMMLIB_SIMD_DISPATCH
+inline void cpuid( const unsigned leaf, unsigned registers[4] )
+{
+#  ifdef _MSC_VER
+    int values[4];
+    __cpuidex( values, int( leaf ), 0 );
+    for( size_t i = 0; i < 4; ++i )
+        registers[i] = unsigned( values[i] );
+#  else
+    __cpuid_count( leaf, 0, registers[0], registers[1], registers[2],
+                   registers[3] );
+#  endif
+}
+
+// The register state enabled by the operating system
+inline unsigned long long xgetbv()
+{
+#  ifdef _MSC_VER
+    return _xgetbv( 0 );
+#  else
+    unsigned low, high;
+    __asm__( "xgetbv" : "=a"( low ), "=d"( high ) : "c"( 0 ));
+    return ( (unsigned long long)( high ) << 32 ) | low;
+#  endif
+}
+
+inline SIMDLevel detectSIMDLevel()
+{
+    unsigned registers[4]; // eax, ebx, ecx, edx
+    cpuid( 0, registers );
+    const unsigned maxLeaf = registers[0];
+
+    cpuid( 1, registers );
+    if( !( registers[3] & ( 1u << 26 )))
+        return SIMD_SCALAR;
+    if( !( registers[2] & ( 1u << 19 )))
+        return SIMD_SSE2;
+
+    // AVX needs the OS to save the ymm registers (XSAVE enabled, XCR0 bits 1
+    // and 2), AVX-512 additionally the opmask and zmm registers (bits 5-7).
+    const bool osxsave = registers[2] & ( 1u << 27 );
+    const bool avx = registers[2] & ( 1u << 28 );
+    const bool fma = registers[2] & ( 1u << 12 );
+    const unsigned long long xcr0 = osxsave ? xgetbv() : 0;
+    if( !avx || ( xcr0 & 0x6 ) != 0x6 )
+        return SIMD_SSE41;
+    if( maxLeaf < 7 )
+        return SIMD_AVX;
+
+    cpuid( 7, registers );
+    const bool avx2 = registers[1] & ( 1u << 5 );
+    const bool avx512 = registers[1] & ( 1u << 16 );
+    if( !avx2 || !fma )
+        return SIMD_AVX;
+    if( !avx512 || ( xcr0 & 0xe6 ) != 0xe6 )
+        return SIMD_AVX2;
+    return SIMD_AVX512;
+}
+#else
+inline SIMDLevel detectSIMDLevel() { return simd::NATIVE_LEVEL; }
+#endif
+
+inline SIMDLevel initSIMDLevel()
+{
+    const SIMDLevel supported = getSupportedSIMDLevel();
+    const char* env = ::getenv( "VMMLIB_SIMD_LEVEL" );
+    if( !env )
+        return supported;
+
+    for( int i = SIMD_SCALAR; i <= supported; ++i )
+        if( ::strcmp( env, getName( SIMDLevel( i ))) == 0 )
+            return SIMDLevel( i );
+    return supported;
+}
+
+inline SIMDLevel& simdLevel()
+{
+    static SIMDLevel level = initSIMDLevel();
+    return level;
+}
+
+// One function per instruction set, which the kernel is inlined into
+template< class K >
+typename K::result_type runScalar( const K& kernel )
+{
+    return kernel.template run< SIMD_SCALAR >();
+}
+
+#ifdef VMMLIB_SSE2
+template< class K >
+typename K::result_type runSSE2( const K& kernel )
+{
+    return kernel.template run< SIMD_SSE2 >();
+}
+#endif
+
+#ifdef VMMLIB_SIMD_DISPATCH
+template< class K > VMMLIB_TARGET_SSE41
+typename K::result_type runSSE41( const K& kernel )
+{
+    return kernel.template run< SIMD_SSE41 >();
+}
+
+template< class K > VMMLIB_TARGET_AVX
+typename K::result_type runAVX( const K& kernel )
+{
+    return kernel.template run< SIMD_AVX >();
+}
+
+template< class K > VMMLIB_TARGET_AVX2
+typename K::result_type runAVX2( const K& kernel )
+{
+    return kernel.template run< SIMD_AVX2 >();
+}
+
+template< class K > VMMLIB_TARGET_AVX512
+typename K::result_type runAVX512( const K& kernel )
+{
+    return kernel.template run< SIMD_AVX512 >();
+}
+#endif
+} // namespace detail
+
+inline SIMDLevel getSupportedSIMDLevel()
+{
+    static const SIMDLevel level = detail::detectSIMDLevel();
+    return level;
+}
+
+inline SIMDLevel getSIMDLevel()
+{
+    return detail::simdLevel();
+}
+
+inline SIMDLevel setSIMDLevel( const SIMDLevel level )
+{
+    const SIMDLevel supported = getSupportedSIMDLevel();
+    detail::simdLevel() = level < supported ? level : supported;
+    return detail::simdLevel();
+}
+
+inline const char* getName( const SIMDLevel level )
+{
+    switch( level )
+    {
+    case SIMD_SCALAR: return "scalar";
+    case SIMD_SSE2:   return "sse2";
+    case SIMD_SSE41:  return "sse4.1";
+    case SIMD_AVX:    return "avx";
+    case SIMD_AVX2:   return "avx2";
+    case SIMD_AVX512: return "avx512";
+    }
+    return "ERROR";
+}
+
+template< class K > typename K::result_type dispatch( const K& kernel )
+{
+#ifdef VMMLIB_SIMD_DISPATCH
+    switch( getSIMDLevel( ))
+    {
+    case SIMD_SCALAR: return detail::runScalar( kernel );
+    case SIMD_SSE2:   return detail::runSSE2( kernel );
+    case SIMD_SSE41:  return detail::runSSE41( kernel );
+    case SIMD_AVX:    return detail::runAVX( kernel );
+    case SIMD_AVX2:   return detail::runAVX2( kernel );
+    case SIMD_AVX512: return detail::runAVX512( kernel );
+    }
+    return detail::runScalar( kernel );
+#else
+    // Without dispatch only the scalar code and the packs targeted by the
+    // compiler exist; the levels in between run the SSE2 packs.
+    const SIMDLevel level = getSIMDLevel();
+    if( level == SIMD_SCALAR )
+        return detail::runScalar( kernel );
+#  ifdef VMMLIB_SSE2
+    if( level < simd::NATIVE_LEVEL )
+        return detail::runSSE2( kernel );
+#  endif
+    return kernel.template run< simd::NATIVE_LEVEL >();
+#endif
+}
+
+inline size_t getNumDispatchChunks( const size_t n )
+{
+    return ( n + DISPATCH_CHUNK_SIZE - 1 ) / DISPATCH_CHUNK_SIZE;
+}
+
+template< class F > void dispatchChunks( const size_t n, const F& makeKernel )
+{
+    const ptrdiff_t nChunks = ptrdiff_t( getNumDispatchChunks( n ));
+
+#ifdef _OPENMP
+#  pragma omp parallel for schedule( static ) if( nChunks > 1 )
+#endif
+    for( ptrdiff_t i = 0; i < nChunks; ++i )
+    {
+        const size_t begin = size_t( i ) * DISPATCH_CHUNK_SIZE;
+        dispatch( makeKernel( begin,
+                              std::min( DISPATCH_CHUNK_SIZE, n - begin )));
+    }
+}
+
+} // namespace vmml
+
+#endif
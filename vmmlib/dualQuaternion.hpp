@@ -0,0 +1,527 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __VMML__DUAL_QUATERNION__HPP__
+#define __VMML__DUAL_QUATERNION__HPP__
+
+#include <vmmlib/dispatch.hpp> // used inline
+#include <vmmlib/matrix.hpp> // used inline
+#include <vmmlib/quaternion.hpp> // member
+#include <vmmlib/types.hpp>
+#include <vmmlib/vector.hpp> // used inline
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+
+namespace vmml
+{
+/**
+ * A dual quaternion, representing a rigid transformation when normalized.
+ *
+ * The real part is the rotation r, the dual part is t r / 2 for the
+ * translation t as pure quaternion. The composition a * b applies b first,
+ * like for matrices. Unlike matrices, unit dual quaternions blend into rigid
+ * transformations, see sclerp() and skin().
+ */
+template< typename T > class DualQuaternion
+{
+public:
+    typedef vector< 3, T > vec3;
+
+    /** Construct the identity transformation. */
+    VMMLIB_CONSTEXPR DualQuaternion() : _real(), _dual( 0, 0, 0, 0 ) {}
+
+    /** Construct a dual quaternion from its real and dual part. */
+    VMMLIB_CONSTEXPR DualQuaternion( const Quaternion< T >& real,
+                                     const Quaternion< T >& dual )
+        : _real( real ), _dual( dual ) {}
+
+    /** Construct a rigid transformation from a rotation and a translation. */
+    VMMLIB_CONSTEXPR DualQuaternion( const Quaternion< T >& rotation,
+                                     const vec3& translation );
+
+    /** Construct a rigid transformation from a rigid 4x4 matrix. */
+    explicit DualQuaternion( const Matrix< 4, 4, T >& matrix );
+
+    /** @name Data Access */
+    //@{
+    /** @return true if the two dual quaternions are similar. */
+    bool equals( const DualQuaternion& other,
+                 T tolerance = std::numeric_limits< T >::epsilon( )) const;
+
+    /** @return true if both dual quaternions are equal. */
+    VMMLIB_CONSTEXPR bool operator==( const DualQuaternion& other ) const
+        { return _real == other._real && _dual == other._dual; }
+
+    /** @return true if both dual quaternions are not equal. */
+    VMMLIB_CONSTEXPR bool operator!=( const DualQuaternion& other ) const
+        { return !( *this == other ); }
+
+    VMMLIB_CONSTEXPR const Quaternion< T >& getReal() const { return _real; }
+    VMMLIB_CONSTEXPR const Quaternion< T >& getDual() const { return _dual; }
+
+    /** @return the rotation of a unit dual quaternion. */
+    VMMLIB_CONSTEXPR const Quaternion< T >& getRotation() const
+        { return _real; }
+
+    /** @return the translation of a unit dual quaternion. */
+    VMMLIB_CONSTEXPR vec3 getTranslation() const;
+
+    /** @return the 4x4 transformation matrix of a unit dual quaternion. */
+    Matrix< 4, 4, T > getMatrix() const
+        { return Matrix< 4, 4, T >( _real, getTranslation( )); }
+    //@}
+
+    /** @name Operations */
+    //@{
+    /** @return the composition applying the other transformation first. */
+    VMMLIB_CONSTEXPR DualQuaternion operator*( const DualQuaternion& other )
+        const;
+
+    /** Append the other transformation, which is applied first. */
+    VMMLIB_CONSTEXPR DualQuaternion& operator*=( const DualQuaternion& other )
+        { return *this = *this * other; }
+
+    VMMLIB_CONSTEXPR DualQuaternion operator+( const DualQuaternion& other )
+        const
+        { return DualQuaternion( _real + other._real, _dual + other._dual ); }
+
+    VMMLIB_CONSTEXPR DualQuaternion operator*( const T scale ) const
+        { return DualQuaternion( _real * scale, _dual * scale ); }
+
+    VMMLIB_CONSTEXPR DualQuaternion operator-() const
+        { return DualQuaternion( -_real, -_dual ); }
+
+    /** @return the point transformed by the unit dual quaternion. */
+    VMMLIB_CONSTEXPR vec3 operator*( const vec3& point ) const
+        { return rotate( point ) + getTranslation(); }
+
+    /** @return the direction rotated by the unit dual quaternion. */
+    VMMLIB_CONSTEXPR vec3 rotate( const vec3& direction ) const;
+
+    /**
+     * @return the quaternion conjugate of both parts, the inverse of a unit
+     *         dual quaternion.
+     */
+    VMMLIB_CONSTEXPR DualQuaternion getConjugate() const
+        { return DualQuaternion( _real.getConjugate(),
+                                 _dual.getConjugate( )); }
+
+    /** @return the multiplicative inverse, for a non-zero real part. */
+    VMMLIB_CONSTEXPR DualQuaternion inverse() const;
+
+    /**
+     * Normalize to a rigid transformation: scale to a unit real part, and
+     * remove the component of the dual part along the real part.
+     */
+    void normalize();
+    //@}
+
+    friend std::ostream& operator<< ( std::ostream& os,
+                                      const DualQuaternion& dq )
+    {
+        return os << "[ " << dq._real << " " << dq._dual << " ]";
+    }
+
+private:
+    Quaternion< T > _real;
+    Quaternion< T > _dual;
+};
+
+/** @name Free dual quaternion functions */
+//@{
+/**
+ * @return the screw linear interpolation of two unit dual quaternions.
+ *
+ * Interpolates rotation and translation along the screw motion from a to b
+ * with constant speed, a for t = 0 and b for t = 1, taking the shorter
+ * rotation.
+ */
+template< typename T >
+DualQuaternion< T > sclerp( const DualQuaternion< T >& a,
+                            const DualQuaternion< T >& b, T t );
+
+/**
+ * Skin n vertices by dual quaternion linear blending of up to four bones.
+ *
+ * Each vertex blends the unit dual quaternions of the bones indices[i] with
+ * the weights weights[i], which should sum up to one. All four indices have to
+ * be valid; unused influences have a weight of zero. Bones in the opposite
+ * hemisphere of the first bone of a vertex are negated, so that the shorter
+ * rotation is blended. The blend is normalized before transforming the
+ * position, which avoids the volume loss of linear blend skinning.
+ *
+ * A bone takes eight values instead of the twelve of a 3x4 skinning matrix.
+ * The vertices are skinned with the widest SIMD instructions of the CPU, see
+ * dispatch.hpp. When compiled with OpenMP, large arrays are skinned in
+ * parallel chunks.
+ *
+ * @param bones the bone transformations
+ * @param indices the four bone indices per vertex
+ * @param weights the four bone weights per vertex
+ * @param positions the rest pose positions
+ * @param result the skinned positions, may be the positions
+ * @param n the number of vertices
+ */
+template< typename T >
+void skin( const DualQuaternion< T >* bones, const Vector4ui* indices,
+           const vector< 4, T >* weights, const vector< 3, T >* positions,
+           vector< 3, T >* result, size_t n );
+
+/** Skin n vertices with their normals, which are rotated only. */
+template< typename T >
+void skin( const DualQuaternion< T >* bones, const Vector4ui* indices,
+           const vector< 4, T >* weights, const vector< 3, T >* positions,
+           const vector< 3, T >* normals, vector< 3, T >* resultPositions,
+           vector< 3, T >* resultNormals, size_t n );
+//@}
+
+// - implementation -
+
+template< typename T > VMMLIB_CONSTEXPR
+DualQuaternion< T >::DualQuaternion( const Quaternion< T >& rotation,
+                                     const vec3& translation )
+    : _real( rotation )
+    , _dual( Quaternion< T >( translation.x(), translation.y(),
+                              translation.z(), 0 ) * rotation * T( .5 ))
+{}
+
+template< typename T >
+DualQuaternion< T >::DualQuaternion( const Matrix< 4, 4, T >& matrix )
+    : _real( matrix )
+    , _dual( Quaternion< T >( matrix( 0, 3 ), matrix( 1, 3 ), matrix( 2, 3 ),
+                              0 ) * _real * T( .5 ))
+{}
+
+template< typename T >
+bool DualQuaternion< T >::equals( const DualQuaternion& other,
+                                  const T tolerance ) const
+{
+    return _real.equals( other._real, tolerance ) &&
+           _dual.equals( other._dual, tolerance );
+}
+
+template< typename T > VMMLIB_CONSTEXPR
+vector< 3, T > DualQuaternion< T >::getTranslation() const
+{
+    const Quaternion< T > t = _dual * _real.getConjugate();
+    return vec3( t.x(), t.y(), t.z( )) * T( 2 );
+}
+
+template< typename T > VMMLIB_CONSTEXPR
+DualQuaternion< T > DualQuaternion< T >::operator*(
+    const DualQuaternion& other ) const
+{
+    return DualQuaternion( _real * other._real,
+                           _real * other._dual + _dual * other._real );
+}
+
+template< typename T > VMMLIB_CONSTEXPR
+vector< 3, T > DualQuaternion< T >::rotate( const vec3& direction ) const
+{
+    // v + 2 r x ( r x v + w v ) for the unit rotation ( r, w )
+    const vec3 r( _real.x(), _real.y(), _real.z( ));
+    return direction + vmml::cross( r, vmml::cross( r, direction ) +
+                                       direction * _real.w( )) * T( 2 );
+}
+
+template< typename T > VMMLIB_CONSTEXPR
+DualQuaternion< T > DualQuaternion< T >::inverse() const
+{
+    const Quaternion< T > real = _real.inverse();
+    return DualQuaternion( real, -( real * _dual * real ));
+}
+
+template< typename T > void DualQuaternion< T >::normalize()
+{
+    const T length = _real.abs();
+    if( length == T( 0 ))
+        return;
+
+    _real /= length;
+    _dual /= length;
+    _dual -= _real * dot( _real, _dual );
+}
+
+template< typename T >
+DualQuaternion< T > sclerp( const DualQuaternion< T >& a,
+                            const DualQuaternion< T >& b, const T t )
+{
+    // a (a^-1 b)^t, with the difference a^-1 b on the shorter rotation
+    const DualQuaternion< T > diff = a.getConjugate() *
+        ( dot( a.getReal(), b.getReal( )) < 0 ? -b : b );
+    const Quaternion< T >& real = diff.getReal();
+    const Quaternion< T >& dual = diff.getDual();
+
+    // The power of the screw motion scales its angle and its translation
+    // along the axis s, keeping the axis line with moment m.
+    const T halfAngle = std::acos( std::min( std::max( real.w(), T( -1 )),
+                                             T( 1 )));
+    const T sinHalfAngle = std::sin( halfAngle );
+    if( sinHalfAngle <= std::numeric_limits< T >::epsilon( ))
+    {
+        // pure translation, interpolated linearly
+        return a * DualQuaternion< T >( Quaternion< T >(), dual * t );
+    }
+
+    const vector< 3, T > s = vector< 3, T >( real.x(), real.y(), real.z( )) /
+                             sinHalfAngle;
+    const T pitch = T( -2 ) * dual.w() / sinHalfAngle;
+    const vector< 3, T > m =
+        ( vector< 3, T >( dual.x(), dual.y(), dual.z( )) -
+          s * ( pitch * T( .5 ) * real.w( ))) / sinHalfAngle;
+
+    const T newAngle = halfAngle * t;
+    const T newPitch = pitch * t;
+    const T sinAngle = std::sin( newAngle );
+    const T cosAngle = std::cos( newAngle );
+    const vector< 3, T > realPart = s * sinAngle;
+    const vector< 3, T > dualPart = m * sinAngle +
+                                    s * ( newPitch * T( .5 ) * cosAngle );
+    return a * DualQuaternion< T >(
+        Quaternion< T >( realPart.x(), realPart.y(), realPart.z(), cosAngle ),
+        Quaternion< T >( dualPart.x(), dualPart.y(), dualPart.z(),
+                         -newPitch * T( .5 ) * sinAngle ));
+}
+
+namespace detail
+{
+VMMLIB_SIMD_KERNELS_BEGIN
+/** Skins a range of vertices, run by dispatch(). */
+template< typename T, bool withNormals > class SkinRange
+{
+public:
+    typedef void result_type;
+
+    SkinRange( const T* bones, const unsigned* indices, const T* weights,
+               const T* positions, const T* normals, T* resultPositions,
+               T* resultNormals, const size_t n )
+        : _bones( bones ), _indices( indices ), _weights( weights )
+        , _positions( positions ), _normals( normals )
+        , _resultPositions( resultPositions ), _resultNormals( resultNormals )
+        , _n( n )
+    {}
+
+    /** @return the kernel of a subrange, see dispatchChunks(). */
+    SkinRange operator()( const size_t begin, const size_t count ) const
+    {
+        return SkinRange( _bones, _indices + 4 * begin, _weights + 4 * begin,
+                          _positions + 3 * begin,
+                          withNormals ? _normals + 3 * begin : 0,
+                          _resultPositions + 3 * begin,
+                          withNormals ? _resultNormals + 3 * begin : 0,
+                          count );
+    }
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        typedef typename simd::Pack< T, L, 8 >::type B;
+        const size_t end = _n - _n % P::width;
+        for( size_t i = 0; i < end; i += P::width )
+            _skin< P, B >( i );
+        for( size_t i = end; i < _n; ++i )
+            _skin< simd::Scalar< T >, B >( i );
+    }
+
+private:
+    const T* const _bones;
+    const unsigned* const _indices;
+    const T* const _weights;
+    const T* const _positions;
+    const T* const _normals;
+    T* const _resultPositions;
+    T* const _resultNormals;
+    const size_t _n;
+
+    // Blend the dual quaternions of one vertex, with packs of B::width of
+    // their eight values.
+    template< class B >
+    VMMLIB_SIMD_INLINE void _blend( const size_t vertex, T* result ) const
+    {
+        typedef typename B::type V;
+        enum { packs = 8 / B::width };
+        const unsigned* index = _indices + 4 * vertex;
+        const T* weight = _weights + 4 * vertex;
+        const T* first = _bones + 8 * index[0];
+
+        V sum[ packs ];
+        for( size_t j = 0; j < packs; ++j )
+            sum[ j ] = B::mul( B::load( first + j * B::width ),
+                               B::set( weight[0] ));
+        for( size_t k = 1; k < 4; ++k )
+        {
+            const T* bone = _bones + 8 * index[k];
+            const T dot = first[0] * bone[0] + first[1] * bone[1] +
+                          first[2] * bone[2] + first[3] * bone[3];
+            // branchless, the hemispheres of the bones are unpredictable
+            const V w = B::set( weight[k] * ( T( 1 ) - T( 2 ) * T( dot < 0 )));
+            for( size_t j = 0; j < packs; ++j )
+                sum[ j ] = B::madd( B::load( bone + j * B::width ), w,
+                                    sum[ j ] );
+        }
+        for( size_t j = 0; j < packs; ++j )
+            B::store( result + j * B::width, sum[ j ] );
+    }
+
+    // out = v + 2 r x ( r x v + w v )
+    template< class P >
+    VMMLIB_SIMD_INLINE static void _rotate( const typename P::type* r,
+                                            const typename P::type* v,
+                                            typename P::type* out )
+    {
+        typedef typename P::type V;
+        const V ux = P::madd( r[3], v[0], P::sub( P::mul( r[1], v[2] ),
+                                                  P::mul( r[2], v[1] )));
+        const V uy = P::madd( r[3], v[1], P::sub( P::mul( r[2], v[0] ),
+                                                  P::mul( r[0], v[2] )));
+        const V uz = P::madd( r[3], v[2], P::sub( P::mul( r[0], v[1] ),
+                                                  P::mul( r[1], v[0] )));
+        const V two = P::set( 2 );
+        out[0] = P::madd( two, P::sub( P::mul( r[1], uz ), P::mul( r[2], uy )),
+                          v[0] );
+        out[1] = P::madd( two, P::sub( P::mul( r[2], ux ), P::mul( r[0], uz )),
+                          v[1] );
+        out[2] = P::madd( two, P::sub( P::mul( r[0], uy ), P::mul( r[1], ux )),
+                          v[2] );
+    }
+
+    // Skin P::width vertices starting at i: blend each vertex, then transpose
+    // the blends to transform the vertices in structure-of-arrays form.
+    template< class P, class B >
+    VMMLIB_SIMD_INLINE void _skin( const size_t i ) const
+    {
+        typedef typename P::type V;
+        T blends[ 8 * P::width ];
+        for( size_t j = 0; j < P::width; ++j )
+            _blend< B >( i + j, blends + 8 * j );
+
+        V r[4], d[4];
+        for( size_t j = 0; j < 4; ++j )
+        {
+            r[j] = P::gather( blends + j, 8 );
+            d[j] = P::gather( blends + 4 + j, 8 );
+        }
+
+        // normalize, the dual part stays orthogonal for unit bones
+        const V length = P::sqrt( P::madd( r[0], r[0], P::madd( r[1], r[1],
+                                  P::madd( r[2], r[2], P::mul( r[3], r[3] )))));
+        const V invLength = P::div( P::set( 1 ), length );
+        for( size_t j = 0; j < 4; ++j )
+        {
+            r[j] = P::mul( r[j], invLength );
+            d[j] = P::mul( d[j], invLength );
+        }
+
+        // translation 2 d r*: 2 ( w_r d - w_d r + r x d )
+        const V two = P::set( 2 );
+        V t[3];
+        t[0] = P::mul( two, P::add( P::sub( P::mul( r[3], d[0] ),
+                                            P::mul( d[3], r[0] )),
+                                    P::sub( P::mul( r[1], d[2] ),
+                                            P::mul( r[2], d[1] ))));
+        t[1] = P::mul( two, P::add( P::sub( P::mul( r[3], d[1] ),
+                                            P::mul( d[3], r[1] )),
+                                    P::sub( P::mul( r[2], d[0] ),
+                                            P::mul( r[0], d[2] ))));
+        t[2] = P::mul( two, P::add( P::sub( P::mul( r[3], d[2] ),
+                                            P::mul( d[3], r[2] )),
+                                    P::sub( P::mul( r[0], d[1] ),
+                                            P::mul( r[1], d[0] ))));
+
+        V v[3], out[3];
+        for( size_t j = 0; j < 3; ++j )
+            v[j] = P::gather( _positions + 3 * i + j, 3 );
+        _rotate< P >( r, v, out );
+        for( size_t j = 0; j < 3; ++j )
+            P::scatter( _resultPositions + 3 * i + j, 3,
+                        P::add( out[j], t[j] ));
+
+        if( !withNormals )
+            return;
+        for( size_t j = 0; j < 3; ++j )
+            v[j] = P::gather( _normals + 3 * i + j, 3 );
+        _rotate< P >( r, v, out );
+        for( size_t j = 0; j < 3; ++j )
+            P::scatter( _resultNormals + 3 * i + j, 3, out[j] );
+    }
+};
+VMMLIB_SIMD_KERNELS_END
+
+template< bool withNormals, typename T >
+void skin( const DualQuaternion< T >* bones, const Vector4ui* indices,
+           const vector< 4, T >* weights, const vector< 3, T >* positions,
+           const vector< 3, T >* normals, vector< 3, T >* resultPositions,
+           vector< 3, T >* resultNormals, const size_t n )
+{
+    // The kernels address the packed values of the arrays
+    const T* bonesValues = reinterpret_cast< const T* >( bones );
+    const unsigned* indexValues =
+        reinterpret_cast< const unsigned* >( indices );
+    const T* weightValues = reinterpret_cast< const T* >( weights );
+    const T* positionValues = reinterpret_cast< const T* >( positions );
+    const T* normalValues = reinterpret_cast< const T* >( normals );
+    T* resultPositionValues = reinterpret_cast< T* >( resultPositions );
+    T* resultNormalValues = reinterpret_cast< T* >( resultNormals );
+
+    dispatchChunks( n, SkinRange< T, withNormals >(
+                           bonesValues, indexValues, weightValues,
+                           positionValues, normalValues, resultPositionValues,
+                           resultNormalValues, n ));
+}
+} // namespace detail
+
+template< typename T >
+void skin( const DualQuaternion< T >* bones, const Vector4ui* indices,
+           const vector< 4, T >* weights, const vector< 3, T >* positions,
+           vector< 3, T >* result, const size_t n )
+{
+    detail::skin< false >( bones, indices, weights, positions,
+                           static_cast< const vector< 3, T >* >( 0 ), result,
+                           static_cast< vector< 3, T >* >( 0 ), n );
+}
+
+template< typename T >
+void skin( const DualQuaternion< T >* bones, const Vector4ui* indices,
+           const vector< 4, T >* weights, const vector< 3, T >* positions,
+           const vector< 3, T >* normals, vector< 3, T >* resultPositions,
+           vector< 3, T >* resultNormals, const size_t n )
+{
+    detail::skin< true >( bones, indices, weights, positions, normals,
+                          resultPositions, resultNormals, n );
+}
+
+} // namespace vmml
+
+#endif
@@ -46,6 +46,9 @@ struct enable_if { typedef T type; };
 
 template< typename T > struct enable_if< false, T > {};
 
+template< typename T, typename U > struct is_same { enum { value = false }; };
+template< typename T > struct is_same< T, T > { enum { value = true }; };
+
 } // namespace vmml
 
 
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__EXPONENTIAL_FILTER__HPP__
+#define __VMML__EXPONENTIAL_FILTER__HPP__
+
+#include <vmmlib/simd.hpp> // used inline
+#include <vmmlib/types.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace vmml
+{
+namespace detail
+{
+/** The scalar type of the values filtered by an ExponentialFilter. */
+template< typename T > struct FilterScalar { typedef T type; };
+template< size_t M, typename T > struct FilterScalar< vector< M, T > >
+    { typedef T type; };
+template< typename T > struct FilterScalar< Quaternion< T > >
+    { typedef T type; };
+}
+
+/**
+ * Exponential moving average filter with constant update cost.
+ *
+ * Each added value updates the output to value * (1 - F) + output * F, where
+ * the smooth factor F in [0, 1) is the weight of the history. This is not the
+ * smoothing of a LowpassFilter with the same factor, which reweights its last
+ * M values on each update. The first value initializes the output.
+ */
+template< typename T > class ExponentialFilter
+{
+public:
+    typedef typename detail::FilterScalar< T >::type scalar_type;
+
+    /** Construct a new exponential filter with the given smoothing. */
+    ExponentialFilter( const scalar_type F )
+        : _smoothFactor( F ), _empty( true ) {}
+    ~ExponentialFilter() {}
+
+    /** @return The current filtered output value */
+    const T& get() const { return _value; }
+
+    /** Access the filtered value. */
+    const T* operator->() const { return &_value; }
+
+    /** Access the filtered value. */
+    const T& operator*() const { return _value; }
+
+    /** Add a value and return the filtered output */
+    const T& add( const T& value )
+    {
+        if( _empty )
+        {
+            _value = value;
+            _empty = false;
+        }
+        else
+            _value = value * ( 1 - _smoothFactor ) + _value * _smoothFactor;
+        return _value;
+    }
+
+    /** Restart filtering with the next added value. */
+    void reset() { _empty = true; }
+
+private:
+    scalar_type _smoothFactor;
+    bool _empty;
+    T _value;
+};
+
+/**
+ * Exponential moving average filters for many independent float or double
+ * channels.
+ *
+ * All channels are updated in one call from a structure-of-arrays input,
+ * using the widest available SIMD instructions. Memory is only allocated at
+ * construction.
+ */
+template< typename T > class ExponentialFilterArray
+{
+public:
+    /** Construct n channels with the given smoothing. */
+    ExponentialFilterArray( const size_t n, const T F )
+        : _values( n ), _smoothFactor( F ), _empty( true ) {}
+    ~ExponentialFilterArray() {}
+
+    /** @return the number of channels. */
+    size_t getSize() const { return _values.size(); }
+
+    /** @return the filtered output value of all channels. */
+    const T* get() const { return _values.empty() ? 0 : &_values[0]; }
+
+    /** @return the filtered output value of the given channel. */
+    const T& operator[]( const size_t i ) const { return _values[i]; }
+
+    /**
+     * Add one value to each channel.
+     *
+     * @param values getSize() values, one per channel
+     * @return the filtered output value of all channels
+     */
+    const T* add( const T* values );
+
+    /** Restart filtering with the next added values. */
+    void reset() { _empty = true; }
+
+private:
+    std::vector< T > _values;
+    T _smoothFactor;
+    bool _empty;
+
+    template< class P > void _add( const T* values, size_t i );
+};
+
+template< typename T >
+const T* ExponentialFilterArray< T >::add( const T* values )
+{
+    const size_t n = _values.size();
+    if( _empty )
+    {
+        std::copy( values, values + n, _values.begin( ));
+        _empty = false;
+        return get();
+    }
+
+    typedef typename simd::Native< T >::type Pack;
+    const size_t end = n - n % Pack::width;
+    for( size_t i = 0; i < end; i += Pack::width )
+        _add< Pack >( values, i );
+    for( size_t i = end; i < n; ++i )
+        _add< simd::Scalar< T > >( values, i );
+    return get();
+}
+
+template< typename T > template< class P >
+void ExponentialFilterArray< T >::_add( const T* values, const size_t i )
+{
+    // value + ( output - value ) * F, one multiply-add per channel
+    const typename P::type value = P::load( values + i );
+    const typename P::type output = P::load( &_values[i] );
+    P::store( &_values[i], P::madd( P::sub( output, value ),
+                                    P::set( _smoothFactor ), value ));
+}
+
+} // namespace vmml
+
+#endif
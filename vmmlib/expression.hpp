@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__EXPRESSION__HPP__
+#define __VMML__EXPRESSION__HPP__
+
+#include <vmmlib/enable_if.hpp>
+#include <vmmlib/types.hpp>
+
+namespace vmml
+{
+/**
+ * @file expression.hpp
+ *
+ * Opt-in expression templates for element-wise vector and matrix arithmetic.
+ *
+ * The regular vector and Matrix operators return a new object for each
+ * operation. Wrapping the operands in lazy() instead builds an expression,
+ * which is evaluated in a single loop when it is assigned to a vector or
+ * Matrix, without intermediate objects:
+ * @code
+ * result = vmml::lazy( a ) * s + vmml::lazy( b ) * t - c;
+ * @endcode
+ * An operand combined with an expression is referenced, but the regular
+ * operators bind first: in lazy( a ) * s + b * t, b * t is an eager
+ * temporary vector.
+ *
+ * Vectors support element-wise +, -, * and /, matrices + and -, and both
+ * multiplication and division by a scalar. The operands are referenced, so
+ * an expression must be assigned before its operands go out of scope.
+ * Assigning an expression to one of its operands is safe, since each element
+ * only depends on the same element of the operands.
+ */
+
+/** CRTP base class of all lazily evaluated expressions. */
+template< class E > class Expression
+{
+public:
+    /** @return the concrete expression. */
+    const E& get() const { return static_cast< const E& >( *this ); }
+};
+
+namespace expression
+{
+/** The element type and supported operations of vector and matrix types. */
+template< class V > struct Traits {};
+
+template< size_t M, typename T > struct Traits< vector< M, T > >
+{
+    typedef T value_type;
+    enum { additive = true, multiplicative = true };
+};
+
+template< size_t R, size_t C, typename T > struct Traits< Matrix< R, C, T > >
+{
+    typedef T value_type;
+    enum { additive = true, multiplicative = false };
+};
+
+struct Add
+{
+    template< typename T > static T apply( T a, T b ) { return a + b; }
+};
+struct Sub
+{
+    template< typename T > static T apply( T a, T b ) { return a - b; }
+};
+struct Mul
+{
+    template< typename T > static T apply( T a, T b ) { return a * b; }
+};
+struct Div
+{
+    template< typename T > static T apply( T a, T b ) { return a / b; }
+};
+struct Neg
+{
+    template< typename T > static T apply( T a ) { return -a; }
+};
+
+/** A referenced vector or matrix operand. */
+template< class V > class Operand : public Expression< Operand< V > >
+{
+public:
+    typedef V result_type;
+    typedef typename Traits< V >::value_type value_type;
+
+    explicit Operand( const V& value ) : _value( value ) {}
+    value_type operator[]( const size_t i ) const { return _value.array[i]; }
+
+private:
+    const V& _value;
+};
+
+/** A scalar operand, the same value for all elements. */
+template< class V > class Scalar : public Expression< Scalar< V > >
+{
+public:
+    typedef V result_type;
+    typedef typename Traits< V >::value_type value_type;
+
+    explicit Scalar( const value_type value ) : _value( value ) {}
+    value_type operator[]( size_t ) const { return _value; }
+
+private:
+    const value_type _value;
+};
+
+/** An element-wise binary operation. */
+template< class Op, class L, class R >
+class Binary : public Expression< Binary< Op, L, R > >
+{
+public:
+    typedef typename L::result_type result_type;
+    typedef typename L::value_type value_type;
+
+    Binary( const L& left, const R& right ) : _left( left ), _right( right ) {}
+    value_type operator[]( const size_t i ) const
+        { return Op::apply( _left[i], _right[i] ); }
+
+private:
+    const L _left;
+    const R _right;
+};
+
+/** An element-wise unary operation. */
+template< class Op, class E > class Unary : public Expression< Unary< Op, E > >
+{
+public:
+    typedef typename E::result_type result_type;
+    typedef typename E::value_type value_type;
+
+    explicit Unary( const E& expression_ ) : _expression( expression_ ) {}
+    value_type operator[]( const size_t i ) const
+        { return Op::apply( _expression[i] ); }
+
+private:
+    const E _expression;
+};
+
+/** The result of an operation on two expressions of the same type. */
+template< class Op, class L, class R, bool condition = true >
+struct Result
+    : public enable_if< condition &&
+                        is_same< typename L::result_type,
+                                 typename R::result_type >::value,
+                        Binary< Op, L, R > >
+{};
+} // namespace expression
+
+/** @return an expression referencing the given vector. */
+template< size_t M, typename T >
+expression::Operand< vector< M, T > > lazy( const vector< M, T >& value )
+{
+    return expression::Operand< vector< M, T > >( value );
+}
+
+/** @return an expression referencing the given matrix. */
+template< size_t R, size_t C, typename T >
+expression::Operand< Matrix< R, C, T > > lazy( const Matrix< R, C, T >& value )
+{
+    return expression::Operand< Matrix< R, C, T > >( value );
+}
+
+/** @name Expression operators */
+//@{
+#define VMMLIB_EXPRESSION_OPERATOR( op, Op, condition )                 \
+    template< class L, class R >                                        \
+    typename expression::Result< expression::Op, L, R,                  \
+        expression::Traits< typename L::result_type >::condition >::type \
+    operator op( const Expression< L >& left, const Expression< R >& right ) \
+    {                                                                   \
+        return expression::Binary< expression::Op, L, R >( left.get(),  \
+                                                           right.get( )); \
+    }                                                                   \
+                                                                        \
+    template< class L, class V >                                        \
+    typename expression::Result< expression::Op, L,                    \
+                                 expression::Operand< V >,              \
+        expression::Traits< V >::condition >::type                      \
+    operator op( const Expression< L >& left, const V& right )          \
+    {                                                                   \
+        return expression::Binary< expression::Op, L,                   \
+                                   expression::Operand< V > >(          \
+            left.get(), expression::Operand< V >( right ));             \
+    }                                                                   \
+                                                                        \
+    template< class V, class R >                                        \
+    typename expression::Result< expression::Op,                        \
+                                 expression::Operand< V >, R,           \
+        expression::Traits< V >::condition >::type                      \
+    operator op( const V& left, const Expression< R >& right )          \
+    {                                                                   \
+        return expression::Binary< expression::Op,                      \
+                                   expression::Operand< V >, R >(       \
+            expression::Operand< V >( left ), right.get( ));            \
+    }
+
+VMMLIB_EXPRESSION_OPERATOR( +, Add, additive )
+VMMLIB_EXPRESSION_OPERATOR( -, Sub, additive )
+VMMLIB_EXPRESSION_OPERATOR( *, Mul, multiplicative )
+VMMLIB_EXPRESSION_OPERATOR( /, Div, multiplicative )
+#undef VMMLIB_EXPRESSION_OPERATOR
+
+template< class L >
+expression::Binary< expression::Mul, L,
+                    expression::Scalar< typename L::result_type > >
+operator*( const Expression< L >& left, const typename L::value_type right )
+{
+    typedef expression::Scalar< typename L::result_type > Scalar;
+    return expression::Binary< expression::Mul, L, Scalar >( left.get(),
+                                                            Scalar( right ));
+}
+
+template< class R >
+expression::Binary< expression::Mul,
+                    expression::Scalar< typename R::result_type >, R >
+operator*( const typename R::value_type left, const Expression< R >& right )
+{
+    typedef expression::Scalar< typename R::result_type > Scalar;
+    return expression::Binary< expression::Mul, Scalar, R >( Scalar( left ),
+                                                            right.get( ));
+}
+
+template< class L >
+expression::Binary< expression::Div, L,
+                    expression::Scalar< typename L::result_type > >
+operator/( const Expression< L >& left, const typename L::value_type right )
+{
+    typedef expression::Scalar< typename L::result_type > Scalar;
+    return expression::Binary< expression::Div, L, Scalar >( left.get(),
+                                                            Scalar( right ));
+}
+
+template< class E > expression::Unary< expression::Neg, E >
+operator-( const Expression< E >& expression_ )
+{
+    return expression::Unary< expression::Neg, E >( expression_.get( ));
+}
+//@}
+
+} // namespace vmml
+
+#endif
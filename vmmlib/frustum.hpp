@@ -43,10 +43,11 @@ template< typename T > class Frustum
 {
 public:
     /** Construct a default frustum (-1, 1, -1, 1, 0.1, 100). */
-    Frustum();
+    VMMLIB_CONSTEXPR Frustum();
 
     /** Construct a frustum with default values */
-    Frustum( T left, T right, T bottom, T top, T nearPlane, T farPlane );
+    VMMLIB_CONSTEXPR Frustum( T left, T right, T bottom, T top, T nearPlane,
+                              T farPlane );
 
     /** Construct a frustum using gluPerspective semantics */
     Frustum( T field_of_view_y, T aspect_ratio, T nearPlane_, T farPlane );
@@ -54,9 +55,6 @@ public:
     /** Construct a frustum from a projection matrix */
     Frustum( const Matrix< 4, 4, T >& projection );
 
-    /** Destruct this frustum */
-    ~Frustum() {}
-
     /** @return true if this and the other frustum are identical */
     bool operator==( const Frustum< T >& other ) const;
 
@@ -68,10 +66,10 @@ public:
                  T tolerance = std::numeric_limits< T >::epsilon( )) const;
 
     /** @return the perspective matrix for the given frustum. */
-    Matrix< 4, 4, T > computePerspectiveMatrix() const;
+    VMMLIB_CONSTEXPR Matrix< 4, 4, T > computePerspectiveMatrix() const;
 
     /** @return the orthographic matrix for the given frustum. */
-    Matrix< 4, 4, T > computeOrthoMatrix() const;
+    VMMLIB_CONSTEXPR Matrix< 4, 4, T > computeOrthoMatrix() const;
 
     /** Move the frustum near plane by the given offset "sideways" */
     void jitter( const vector< 2, T >& jitter_ );
@@ -86,23 +84,23 @@ public:
 
     /** @name Access to frustum corners */
     //@{
-    T& left() { return _array[0]; }
-    T left() const { return _array[0]; }
+    VMMLIB_CONSTEXPR T& left() { return _array[0]; }
+    VMMLIB_CONSTEXPR T left() const { return _array[0]; }
 
-    T& right() { return _array[1]; }
-    T right() const { return _array[1]; }
+    VMMLIB_CONSTEXPR T& right() { return _array[1]; }
+    VMMLIB_CONSTEXPR T right() const { return _array[1]; }
 
-    T& bottom() { return _array[2]; }
-    T bottom() const { return _array[2]; }
+    VMMLIB_CONSTEXPR T& bottom() { return _array[2]; }
+    VMMLIB_CONSTEXPR T bottom() const { return _array[2]; }
 
-    T& top() { return _array[3]; }
-    T top() const { return _array[3]; }
+    VMMLIB_CONSTEXPR T& top() { return _array[3]; }
+    VMMLIB_CONSTEXPR T top() const { return _array[3]; }
 
-    T& nearPlane() { return _array[4]; }
-    T nearPlane() const { return _array[4]; }
+    VMMLIB_CONSTEXPR T& nearPlane() { return _array[4]; }
+    VMMLIB_CONSTEXPR T nearPlane() const { return _array[4]; }
 
-    T& farPlane() { return _array[5]; }
-    T farPlane() const { return _array[5]; }
+    VMMLIB_CONSTEXPR T& farPlane() { return _array[5]; }
+    VMMLIB_CONSTEXPR T farPlane() const { return _array[5]; }
     //@}
 
     /** @return the width of this frustum at the near plane */
@@ -139,7 +137,8 @@ private:
 namespace vmml
 {
 
-template< typename T > Frustum< T >::Frustum()
+template< typename T > VMMLIB_CONSTEXPR Frustum< T >::Frustum()
+    : _array()
 {
     _array[0] = -1;
     _array[1] = 1;
@@ -149,9 +148,10 @@ template< typename T > Frustum< T >::Frustum()
     _array[5] = 100;
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 Frustum<T>::Frustum( const T _left, const T _right, const T _bottom,
                      const T _top, const T _near, const T _far )
+    : _array()
 {
     _array[0] = _left;
     _array[1] = _right;
@@ -208,7 +208,7 @@ bool Frustum<T>::equals( const Frustum< T >& other, const T tolerance ) const
            std::abs( _array[5] - other._array[5] ) <= tolerance;
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 Matrix< 4, 4, T > Frustum<T>::computePerspectiveMatrix() const
 {
     Matrix< 4, 4, T > M;
@@ -237,7 +237,7 @@ Matrix< 4, 4, T > Frustum<T>::computePerspectiveMatrix() const
     return M;
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 Matrix< 4, 4, T > Frustum< T >::computeOrthoMatrix() const
 {
     Matrix< 4, 4, T > M;
@@ -34,7 +34,10 @@
 #define __VMML__FRUSTUMCULLER__HPP__
 
 #include <vmmlib/aabb.hpp> // inline parameter
+#include <vmmlib/dispatch.hpp> // used inline
 #include <vmmlib/matrix.hpp> // inline parameter
+#include <vmmlib/obb.hpp> // inline parameter
+#include <vmmlib/simd.hpp> // used inline
 #include <vmmlib/vector.hpp> // member
 #include <vmmlib/visibility.hpp> // return value
 
@@ -42,6 +45,21 @@
 
 namespace vmml
 {
+namespace detail
+{
+/** Structure-of-arrays spheres of the batch culling tests. */
+template< typename T > struct CullSpheres
+{
+    const T* x; const T* y; const T* z; const T* radius;
+};
+
+/** Structure-of-arrays axis-aligned boxes of the batch culling tests. */
+template< typename T > struct CullBoxes
+{
+    const T* minX; const T* minY; const T* minZ;
+    const T* maxX; const T* maxY; const T* maxZ;
+};
+} // namespace detail
 
 /** Helper class to perform OpenGL view frustum culling. */
 template< typename T > class FrustumCuller
@@ -51,6 +69,18 @@ public:
     typedef vector< 3, T > vec3;
     typedef vector< 4, T > vec4;
 
+    /** Bit masks of the frustum planes for the hierarchical tests. */
+    enum PlaneMask
+    {
+        PLANE_LEFT   = 1u << 0,
+        PLANE_RIGHT  = 1u << 1,
+        PLANE_BOTTOM = 1u << 2,
+        PLANE_TOP    = 1u << 3,
+        PLANE_NEAR   = 1u << 4,
+        PLANE_FAR    = 1u << 5,
+        PLANES_ALL   = ( 1u << 6 ) - 1
+    };
+
     /** Construct a new frustum culler */
     FrustumCuller() {}
 
@@ -75,30 +105,192 @@ public:
     /** @return the visibility of the axis-aligned bounding box */
     Visibility test( const AABB< T >& aabb ) const;
 
+    /** @return the visibility of the oriented bounding box */
+    Visibility test( const OBB< T >& obb ) const;
+
+    /** @name Hierarchical tests */
+    //@{
+    /**
+     * Test the visibility of a sphere against a subset of the planes.
+     *
+     * Used for the traversal of bounding volume hierarchies: a child volume
+     * does not need to be tested against the planes its parent is fully in
+     * front of. Start with PLANES_ALL at the root, and pass the mask returned
+     * for a node to its children.
+     *
+     * @param sphere the bounding sphere, center xyz and radius w
+     * @param planes in: the PlaneMask bits of the planes to test. out: the
+     *               planes intersecting the sphere. Undefined if the sphere is
+     *               not visible.
+     * @return the visibility of the sphere. VISIBILITY_FULL if no plane is
+     *         left in the mask.
+     */
+    Visibility test( const vec4& sphere, unsigned& planes ) const;
+
+    /**
+     * Test the visibility of a sphere using a plane mask and plane coherency.
+     *
+     * The plane which rejected the sphere in a previous test is tested first,
+     * since an invisible object often stays invisible for the same reason.
+     *
+     * @param sphere the bounding sphere, center xyz and radius w
+     * @param planes the plane mask, see above
+     * @param lastPlane in: the index [0..5] of the plane to test first. out:
+     *                  the index of the rejecting plane if the sphere is not
+     *                  visible, unchanged otherwise. Initialize with 0.
+     * @return the visibility of the sphere.
+     */
+    Visibility test( const vec4& sphere, unsigned& planes,
+                     size_t& lastPlane ) const;
+
+    /** Test the visibility of a box against a subset of the planes. */
+    Visibility test( const AABB< T >& aabb, unsigned& planes ) const;
+
+    /** Test the visibility of a box using a plane mask and plane coherency. */
+    Visibility test( const AABB< T >& aabb, unsigned& planes,
+                     size_t& lastPlane ) const;
+
+    /** Test the visibility of an oriented box against a subset of the planes */
+    Visibility test( const OBB< T >& obb, unsigned& planes ) const;
+
+    /**
+     * Test the visibility of an oriented box using a plane mask and plane
+     * coherency.
+     */
+    Visibility test( const OBB< T >& obb, unsigned& planes,
+                     size_t& lastPlane ) const;
+    //@}
+
+    /** @name Batch tests on structure-of-arrays data */
+    //@{
+    /**
+     * Compute the visibility of n spheres.
+     *
+     * The spheres are evaluated without per-object branches, using the widest
+     * SIMD registers of the CPU, see dispatch.hpp. The results are identical
+     * to test( const vec4& ) for each sphere.
+     *
+     * @param x, y, z the sphere centers
+     * @param radius the sphere radii
+     * @param n the number of spheres
+     * @param visibility the output visibility of each sphere
+     */
+    void test( const T* x, const T* y, const T* z, const T* radius, size_t n,
+               Visibility* visibility ) const;
+
+    /**
+     * Compute the visibility of n axis-aligned bounding boxes.
+     *
+     * The results are identical to test( const AABB< T >& ) for each box.
+     *
+     * @param minX, minY, minZ the minimum corners of the boxes
+     * @param maxX, maxY, maxZ the maximum corners of the boxes
+     * @param n the number of boxes
+     * @param visibility the output visibility of each box
+     */
+    void test( const T* minX, const T* minY, const T* minZ,
+               const T* maxX, const T* maxY, const T* maxZ, size_t n,
+               Visibility* visibility ) const;
+
+    /**
+     * Compute the visibility of n oriented bounding boxes.
+     *
+     * The boxes are read directly from the array, without conversion to
+     * structure-of-arrays data. The results are identical to
+     * test( const OBB< T >& ) for each box.
+     *
+     * @param obbs the boxes
+     * @param n the number of boxes
+     * @param visibility the output visibility of each box
+     */
+    void test( const OBB< T >* obbs, size_t n, Visibility* visibility ) const;
+
+    /**
+     * Collect the indices of the fully or partially visible spheres.
+     *
+     * @param x, y, z the sphere centers
+     * @param radius the sphere radii
+     * @param n the number of spheres
+     * @param indices the output indices, with room for n entries
+     * @return the number of visible spheres written to indices
+     */
+    size_t cull( const T* x, const T* y, const T* z, const T* radius, size_t n,
+                 uint32_t* indices ) const;
+
+    /**
+     * Collect the indices of the fully or partially visible boxes.
+     *
+     * @param minX, minY, minZ the minimum corners of the boxes
+     * @param maxX, maxY, maxZ the maximum corners of the boxes
+     * @param n the number of boxes
+     * @param indices the output indices, with room for n entries
+     * @return the number of visible boxes written to indices
+     */
+    size_t cull( const T* minX, const T* minY, const T* minZ,
+                 const T* maxX, const T* maxY, const T* maxZ, size_t n,
+                 uint32_t* indices ) const;
+
+    /**
+     * Collect the indices of the fully or partially visible oriented boxes.
+     *
+     * @param obbs the boxes
+     * @param n the number of boxes
+     * @param indices the output indices, with room for n entries
+     * @return the number of visible boxes written to indices
+     */
+    size_t cull( const OBB< T >* obbs, size_t n, uint32_t* indices ) const;
+    //@}
+
     /** @return the plane equation of the current near plane. */
-    const vec4& getNearPlane() const { return _nearPlane; }
+    const vec4& getNearPlane() const { return _planes[4]; }
+
+    /** @return the plane equation of the given plane, in PlaneMask order. */
+    const vec4& getPlane( const size_t index ) const
+        { return _planes[ index ]; }
 
     friend std::ostream& operator << (std::ostream& os, const FrustumCuller& f)
     {
         return os << "Frustum cull planes: " << std::endl
-                  << "    left   " << f._leftPlane << std::endl
-                  << "    right  " << f._rightPlane << std::endl
-                  << "    top    " << f._topPlane << std::endl
-                  << "    bottom " << f._bottomPlane << std::endl
-                  << "    near   " << f._nearPlane << std::endl
-                  << "    far    " << f._farPlane << std::endl;
+                  << "    left   " << f._planes[0] << std::endl
+                  << "    right  " << f._planes[1] << std::endl
+                  << "    top    " << f._planes[3] << std::endl
+                  << "    bottom " << f._planes[2] << std::endl
+                  << "    near   " << f._planes[4] << std::endl
+                  << "    far    " << f._planes[5] << std::endl;
     }
 
 private:
     inline void _normalizePlane( vec4& plane ) const;
+    inline Visibility _test( const vec4& plane, const vec4& sphere ) const;
     inline Visibility _test( const vec4& plane, const vec3& middle,
                              const vec3& size_2 ) const;
-    vec4    _leftPlane;
-    vec4    _rightPlane;
-    vec4    _bottomPlane;
-    vec4    _topPlane;
-    vec4    _nearPlane;
-    vec4    _farPlane;
+    inline Visibility _test( const vec4& plane, const OBB< T >& obb ) const;
+
+    // The structure-of-arrays objects and the outputs of the batch tests
+    typedef detail::CullSpheres< T > _Spheres;
+    typedef detail::CullBoxes< T > _Boxes;
+    struct _OBBs { const T* data; }; // center, axes and extents of each box
+    struct _Visibilities;
+    struct _Indices;
+
+    // The loop over a batch of objects, run by dispatch()
+    template< class O, class R > class _Batch;
+
+    // Batch kernels: test the P::width objects starting at index i. Return the
+    // invisible and the fully visible objects as bit masks.
+    template< class P >
+    VMMLIB_SIMD_INLINE void _test( const _Spheres& spheres, size_t i,
+                                   unsigned& none, unsigned& full ) const;
+    template< class P >
+    VMMLIB_SIMD_INLINE void _test( const _Boxes& boxes, size_t i,
+                                   unsigned& none, unsigned& full ) const;
+    template< class P >
+    VMMLIB_SIMD_INLINE void _test( const _OBBs& obbs, size_t i,
+                                   unsigned& none, unsigned& full ) const;
+    static inline size_t _appendVisible( unsigned none, size_t width,
+                                         size_t index, uint32_t* indices,
+                                         size_t count );
+    vec4    _planes[6]; //!< left, right, bottom, top, near, far
 
 }; // class FrustumCuller
 } // namespace vmml
@@ -122,19 +314,15 @@ FrustumCuller< T >::FrustumCuller( const Matrix< 4, 4, T >& projModelView )
     const vec4& row2 = projModelView.getRow( 2 );
     const vec4& row3 = projModelView.getRow( 3 );
 
-    _leftPlane   = row3 + row0;
-    _rightPlane  = row3 - row0;
-    _bottomPlane = row3 + row1;
-    _topPlane    = row3 - row1;
-    _nearPlane   = row3 + row2;
-    _farPlane    = row3 - row2;
-
-    _normalizePlane( _leftPlane );
-    _normalizePlane( _rightPlane );
-    _normalizePlane( _bottomPlane );
-    _normalizePlane( _topPlane );
-    _normalizePlane( _nearPlane );
-    _normalizePlane( _farPlane );
+    _planes[0] = row3 + row0; // left
+    _planes[1] = row3 - row0; // right
+    _planes[2] = row3 + row1; // bottom
+    _planes[3] = row3 - row1; // top
+    _planes[4] = row3 + row2; // near
+    _planes[5] = row3 - row2; // far
+
+    for( size_t i = 0; i < 6; ++i )
+        _normalizePlane( _planes[i] );
 }
 
 template < typename T >
@@ -149,12 +337,12 @@ FrustumCuller< T >::FrustumCuller( const vec3& a, const vec3& b,
     // | c d |/h
     //  -----
     // CCW winding
-    _leftPlane   = compute_plane( c, a, e );
-    _rightPlane  = compute_plane( f, b, d );
-    _bottomPlane = compute_plane( h, d, c );
-    _topPlane    = compute_plane( a, b, f );
-    _nearPlane   = compute_plane( b, a, c );
-    _farPlane    = compute_plane( g, e, f );
+    _planes[0] = compute_plane( c, a, e ); // left
+    _planes[1] = compute_plane( f, b, d ); // right
+    _planes[2] = compute_plane( h, d, c ); // bottom
+    _planes[3] = compute_plane( a, b, f ); // top
+    _planes[4] = compute_plane( b, a, c ); // near
+    _planes[5] = compute_plane( g, e, f ); // far
 }
 
 template < typename T >
@@ -174,58 +362,34 @@ template < typename T > Visibility
 FrustumCuller< T >::test( const vector< 4, T >& sphere ) const
 {
     Visibility visibility = VISIBILITY_FULL;
+    for( size_t i = 0; i < 6; ++i )
+    {
+        switch( _test( _planes[i], sphere ))
+        {
+            case VISIBILITY_FULL: break;
+            case VISIBILITY_PARTIAL: visibility = VISIBILITY_PARTIAL; break;
+            case VISIBILITY_NONE: return VISIBILITY_NONE;
+        }
+    }
+    return visibility;
+}
 
+template < typename T >
+Visibility FrustumCuller< T >::_test( const vec4& plane,
+                                      const vec4& sphere ) const
+{
     // see http://www.flipcode.com/articles/article_frustumculling.shtml
     // distance = plane.normal . sphere.center + plane.distance
-    // Test all planes:
     // - if sphere behind plane: not visible
-    // - if sphere intersects one plane: partially visible
+    // - if sphere intersects plane: partially visible
     // - else: fully visible
-
-    T distance = _leftPlane.x() * sphere.x() + _leftPlane.y() * sphere.y() +
-                 _leftPlane.z() * sphere.z() + _leftPlane.w();
+    const T distance = plane.x() * sphere.x() + plane.y() * sphere.y() +
+                       plane.z() * sphere.z() + plane.w();
     if( distance <= -sphere.w() )
         return VISIBILITY_NONE;
     if( distance < sphere.w() )
-        visibility = VISIBILITY_PARTIAL;
-
-    distance = _rightPlane.x() * sphere.x() + _rightPlane.y() * sphere.y() +
-               _rightPlane.z() * sphere.z() + _rightPlane.w();
-    if( distance <= -sphere.w() )
-        return VISIBILITY_NONE;
-    if( distance < sphere.w() )
-        visibility = VISIBILITY_PARTIAL;
-
-    distance = _bottomPlane.x() * sphere.x() + _bottomPlane.y() * sphere.y() +
-               _bottomPlane.z() * sphere.z() + _bottomPlane.w();
-    if( distance <= -sphere.w() )
-        return VISIBILITY_NONE;
-    if( distance < sphere.w() )
-        visibility = VISIBILITY_PARTIAL;
-
-    distance = _topPlane.x() * sphere.x() + _topPlane.y() * sphere.y() +
-               _topPlane.z() * sphere.z() + _topPlane.w();
-    if( distance <= -sphere.w() )
-        return VISIBILITY_NONE;
-    if( distance < sphere.w() )
-        visibility = VISIBILITY_PARTIAL;
-
-    distance = _nearPlane.x() * sphere.x() + _nearPlane.y() * sphere.y() +
-               _nearPlane.z() * sphere.z() + _nearPlane.w();
-
-    if( distance <= -sphere.w() )
-        return VISIBILITY_NONE;
-    if( distance < sphere.w() )
-        visibility = VISIBILITY_PARTIAL;
-
-    distance = _farPlane.x() * sphere.x() + _farPlane.y() * sphere.y() +
-               _farPlane.z() * sphere.z() + _farPlane.w();
-    if( distance <= -sphere.w() )
-        return VISIBILITY_NONE;
-    if( distance < sphere.w() )
-        visibility = VISIBILITY_PARTIAL;
-
-    return visibility;
+        return VISIBILITY_PARTIAL;
+    return VISIBILITY_FULL;
 }
 
 template < typename T >
@@ -251,49 +415,477 @@ Visibility FrustumCuller< T >::test( const AABB< T >& aabb ) const
     Visibility result = VISIBILITY_FULL;
     const vec3& middle = aabb.getCenter();
     const vec3& extent = aabb.getSize() * 0.5f;
-    switch( _test( _leftPlane, middle, extent ))
+    for( size_t i = 0; i < 6; ++i )
+    {
+        switch( _test( _planes[i], middle, extent ))
+        {
+            case VISIBILITY_FULL: break;
+            case VISIBILITY_PARTIAL: result = VISIBILITY_PARTIAL; break;
+            case VISIBILITY_NONE: return VISIBILITY_NONE;
+        }
+    }
+    return result;
+}
+
+template < typename T >
+Visibility FrustumCuller< T >::_test( const vec4& plane,
+                                      const OBB< T >& obb ) const
+{
+    // The extent of the box along the plane normal is the sum of its
+    // projected half axes; same evaluation order as the batch test
+    const vec3& center = obb.getCenter();
+    const vec3& extents = obb.getExtents();
+    const T* axes = obb.getAxes().array;
+    const T d = plane.x() * center.x() + plane.y() * center.y() +
+                plane.z() * center.z() + plane.w();
+    T n = 0;
+    for( size_t i = 0; i < 3; ++i )
+        n += extents[i] * std::abs( plane.x() * axes[ 3 * i ] +
+                                    plane.y() * axes[ 3 * i + 1 ] +
+                                    plane.z() * axes[ 3 * i + 2 ] );
+
+    if( d - n >= 0 )
+        return VISIBILITY_FULL;
+    if( d + n > 0 )
+        return VISIBILITY_PARTIAL;
+    return VISIBILITY_NONE;
+}
+
+template < typename T >
+Visibility FrustumCuller< T >::test( const OBB< T >& obb ) const
+{
+    Visibility result = VISIBILITY_FULL;
+    for( size_t i = 0; i < 6; ++i )
+    {
+        switch( _test( _planes[i], obb ))
+        {
+            case VISIBILITY_FULL: break;
+            case VISIBILITY_PARTIAL: result = VISIBILITY_PARTIAL; break;
+            case VISIBILITY_NONE: return VISIBILITY_NONE;
+        }
+    }
+    return result;
+}
+
+template < typename T >
+Visibility FrustumCuller< T >::test( const vec4& sphere,
+                                     unsigned& planes ) const
+{
+    size_t lastPlane = 0;
+    return test( sphere, planes, lastPlane );
+}
+
+template < typename T >
+Visibility FrustumCuller< T >::test( const vec4& sphere, unsigned& planes,
+                                     size_t& lastPlane ) const
+{
+    for( size_t i = 0; i < 6; ++i )
+    {
+        // lastPlane first, followed by all other planes in order
+        const size_t index = i == 0 ? lastPlane :
+                                      i <= lastPlane ? i - 1 : i;
+        const unsigned mask = 1u << index;
+        if( !( planes & mask ))
+            continue;
+
+        switch( _test( _planes[index], sphere ))
+        {
+            case VISIBILITY_FULL: planes &= ~mask; break;
+            case VISIBILITY_PARTIAL: break;
+            case VISIBILITY_NONE: lastPlane = index; return VISIBILITY_NONE;
+        }
+    }
+    return planes ? VISIBILITY_PARTIAL : VISIBILITY_FULL;
+}
+
+template < typename T >
+Visibility FrustumCuller< T >::test( const AABB< T >& aabb,
+                                     unsigned& planes ) const
+{
+    size_t lastPlane = 0;
+    return test( aabb, planes, lastPlane );
+}
+
+template < typename T >
+Visibility FrustumCuller< T >::test( const AABB< T >& aabb, unsigned& planes,
+                                     size_t& lastPlane ) const
+{
+    const vec3& middle = aabb.getCenter();
+    const vec3& extent = aabb.getSize() * 0.5f;
+    for( size_t i = 0; i < 6; ++i )
     {
-        case VISIBILITY_FULL: break;
-        case VISIBILITY_PARTIAL: result = VISIBILITY_PARTIAL; break;
-        case VISIBILITY_NONE: return VISIBILITY_NONE;
+        const size_t index = i == 0 ? lastPlane :
+                                      i <= lastPlane ? i - 1 : i;
+        const unsigned mask = 1u << index;
+        if( !( planes & mask ))
+            continue;
+
+        switch( _test( _planes[index], middle, extent ))
+        {
+            case VISIBILITY_FULL: planes &= ~mask; break;
+            case VISIBILITY_PARTIAL: break;
+            case VISIBILITY_NONE: lastPlane = index; return VISIBILITY_NONE;
+        }
     }
+    return planes ? VISIBILITY_PARTIAL : VISIBILITY_FULL;
+}
+
+template < typename T >
+Visibility FrustumCuller< T >::test( const OBB< T >& obb,
+                                     unsigned& planes ) const
+{
+    size_t lastPlane = 0;
+    return test( obb, planes, lastPlane );
+}
 
-    switch( _test( _rightPlane, middle, extent ))
+template < typename T >
+Visibility FrustumCuller< T >::test( const OBB< T >& obb, unsigned& planes,
+                                     size_t& lastPlane ) const
+{
+    for( size_t i = 0; i < 6; ++i )
     {
-        case VISIBILITY_FULL: break;
-        case VISIBILITY_PARTIAL: result = VISIBILITY_PARTIAL; break;
-        case VISIBILITY_NONE: return VISIBILITY_NONE;
+        const size_t index = i == 0 ? lastPlane :
+                                      i <= lastPlane ? i - 1 : i;
+        const unsigned mask = 1u << index;
+        if( !( planes & mask ))
+            continue;
+
+        switch( _test( _planes[index], obb ))
+        {
+            case VISIBILITY_FULL: planes &= ~mask; break;
+            case VISIBILITY_PARTIAL: break;
+            case VISIBILITY_NONE: lastPlane = index; return VISIBILITY_NONE;
+        }
     }
+    return planes ? VISIBILITY_PARTIAL : VISIBILITY_FULL;
+}
 
-    switch( _test( _bottomPlane, middle, extent ))
+namespace detail
+{
+// Expand the bit masks of a batch kernel into width visibility values, also
+// used by LODSelector.
+inline void setVisibility( const unsigned none, const unsigned full,
+                           const size_t width, Visibility* visibility )
+{
+    for( size_t i = 0; i < width; ++i )
+        visibility[ i ] = Visibility( (( ~none >> i ) & 1u ) *
+                                      ( 1u + (( full >> i ) & 1u )));
+}
+} // namespace detail
+
+// Branch-free append of the indices of the visible objects of a batch.
+template < typename T >
+inline size_t FrustumCuller< T >::_appendVisible( const unsigned none,
+                                                  const size_t width,
+                                                  const size_t index,
+                                                  uint32_t* indices,
+                                                  size_t count )
+{
+    for( size_t i = 0; i < width; ++i )
     {
-        case VISIBILITY_FULL: break;
-        case VISIBILITY_PARTIAL: result = VISIBILITY_PARTIAL; break;
-        case VISIBILITY_NONE: return VISIBILITY_NONE;
+        indices[ count ] = uint32_t( index + i );
+        count += ( ~none >> i ) & 1u;
     }
+    return count;
+}
+
+template < typename T > struct FrustumCuller< T >::_Visibilities
+{
+    Visibility* visibility;
 
-    switch( _test( _topPlane, middle, extent ))
+    size_t operator()( const unsigned none, const unsigned full,
+                       const size_t width, const size_t index,
+                       const size_t count ) const
     {
-        case VISIBILITY_FULL: break;
-        case VISIBILITY_PARTIAL: result = VISIBILITY_PARTIAL; break;
-        case VISIBILITY_NONE: return VISIBILITY_NONE;
+        detail::setVisibility( none, full, width, visibility + index );
+        return count + width;
     }
+};
 
-    switch( _test( _nearPlane, middle, extent ))
+template < typename T > struct FrustumCuller< T >::_Indices
+{
+    uint32_t* indices;
+
+    size_t operator()( const unsigned none, const unsigned,
+                       const size_t width, const size_t index,
+                       const size_t count ) const
     {
-        case VISIBILITY_FULL: break;
-        case VISIBILITY_PARTIAL: result = VISIBILITY_PARTIAL; break;
-        case VISIBILITY_NONE: return VISIBILITY_NONE;
+        return _appendVisible( none, width, index, indices, count );
     }
+};
+
+template < typename T > template< class O, class R >
+class FrustumCuller< T >::_Batch
+{
+public:
+    typedef size_t result_type;
+
+    _Batch( const FrustumCuller& culler, const O& objects, const size_t n,
+            const R& results )
+        : _culler( culler ), _objects( objects ), _n( n ), _results( results )
+    {}
 
-    switch( _test( _farPlane, middle, extent ))
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE size_t run() const
     {
-        case VISIBILITY_FULL: break;
-        case VISIBILITY_PARTIAL: result = VISIBILITY_PARTIAL; break;
-        case VISIBILITY_NONE: return VISIBILITY_NONE;
+        typedef typename simd::Pack< T, L >::type P;
+        unsigned none, full;
+        size_t count = 0;
+        const size_t end = _n - _n % P::width;
+        size_t i = 0;
+        for( ; i < end; i += P::width )
+        {
+            _culler.template _test< P >( _objects, i, none, full );
+            count = _results( none, full, P::width, i, count );
+        }
+        for( ; i < _n; ++i )
+        {
+            _culler.template _test< simd::Scalar< T > >( _objects, i, none,
+                                                         full );
+            count = _results( none, full, 1, i, count );
+        }
+        return count;
     }
 
-    return result;
+private:
+    const FrustumCuller& _culler;
+    const O _objects;
+    const size_t _n;
+    const R _results;
+};
+
+VMMLIB_SIMD_KERNELS_BEGIN
+namespace detail
+{
+// The steps of the batch kernels shared by FrustumCuller, MultiFrustumCuller
+// and LODSelector
+
+// The signed distances of the points x, y, z to a plane, in the same
+// evaluation order as the scalar tests
+template< class P, typename T > VMMLIB_SIMD_INLINE
+void computePlaneDistance( const vector< 4, T >& plane,
+                           const typename P::type& x,
+                           const typename P::type& y,
+                           const typename P::type& z,
+                           typename P::type& distance )
+{
+    distance = P::add( P::add( P::add( P::mul( P::set( plane.x( )), x ),
+                                       P::mul( P::set( plane.y( )), y )),
+                               P::mul( P::set( plane.z( )), z )),
+                       P::set( plane.w( )));
+}
+
+// The minimum distances of the points to the six planes of a frustum
+template< class P, typename T > VMMLIB_SIMD_INLINE
+void computeMinPlaneDistance( const vector< 4, T >* planes,
+                              const typename P::type& x,
+                              const typename P::type& y,
+                              const typename P::type& z,
+                              typename P::type& distance )
+{
+    computePlaneDistance< P >( planes[0], x, y, z, distance );
+    for( size_t i = 1; i < 6; ++i )
+    {
+        typename P::type planeDistance;
+        computePlaneDistance< P >( planes[i], x, y, z, planeDistance );
+        distance = P::min( distance, planeDistance );
+    }
+}
+
+// The centers and half extents of the P::width boxes starting at index i
+template< class P, typename T > VMMLIB_SIMD_INLINE
+void loadBoxes( const CullBoxes< T >& boxes, const size_t i,
+                typename P::type center[3], typename P::type extent[3] )
+{
+    typedef typename P::type V;
+    const V half = P::set( T( .5 ));
+    const V loX = P::load( boxes.minX + i );
+    const V loY = P::load( boxes.minY + i );
+    const V loZ = P::load( boxes.minZ + i );
+    const V hiX = P::load( boxes.maxX + i );
+    const V hiY = P::load( boxes.maxY + i );
+    const V hiZ = P::load( boxes.maxZ + i );
+    center[0] = P::mul( P::add( loX, hiX ), half );
+    center[1] = P::mul( P::add( loY, hiY ), half );
+    center[2] = P::mul( P::add( loZ, hiZ ), half );
+    extent[0] = P::mul( P::sub( hiX, loX ), half );
+    extent[1] = P::mul( P::sub( hiY, loY ), half );
+    extent[2] = P::mul( P::sub( hiZ, loZ ), half );
+}
+
+// The extents of boxes along a plane normal, given by the absolute values of
+// its components
+template< class P, typename T > VMMLIB_SIMD_INLINE
+void computeBoxExtent( const vector< 3, T >& absNormal,
+                       const typename P::type extent[3],
+                       typename P::type& result )
+{
+    result = P::add( P::add( P::mul( extent[0], P::set( absNormal.x( ))),
+                             P::mul( extent[1], P::set( absNormal.y( )))),
+                     P::mul( extent[2], P::set( absNormal.z( ))));
+}
+
+// The minimum distances of the nearest and the farthest corners of boxes to
+// the six planes of a frustum
+template< class P, typename T > VMMLIB_SIMD_INLINE
+void computeBoxPlaneDistances( const vector< 4, T >* planes,
+                               const typename P::type center[3],
+                               const typename P::type extent[3],
+                               typename P::type& minNear,
+                               typename P::type& minFar )
+{
+    typedef typename P::type V;
+    minNear = P::set( std::numeric_limits< T >::max( ));
+    minFar = minNear;
+    for( size_t i = 0; i < 6; ++i )
+    {
+        const vector< 4, T >& plane = planes[i];
+        V d, n;
+        computePlaneDistance< P >( plane, center[0], center[1], center[2], d );
+        computeBoxExtent< P >( vector< 3, T >( std::abs( plane.x( )),
+                                               std::abs( plane.y( )),
+                                               std::abs( plane.z( ))),
+                               extent, n );
+        minNear = P::min( minNear, P::sub( d, n ));
+        minFar = P::min( minFar, P::add( d, n ));
+    }
+}
+} // namespace detail
+
+template < typename T > template< class P > inline
+void FrustumCuller< T >::_test( const _Spheres& spheres, const size_t i,
+                                unsigned& none, unsigned& full ) const
+{
+    typedef typename P::type V;
+    const V cx = P::load( spheres.x + i );
+    const V cy = P::load( spheres.y + i );
+    const V cz = P::load( spheres.z + i );
+    const V r = P::load( spheres.radius + i );
+
+    // The sphere is invisible if it is behind any plane, and fully visible if
+    // it is in front of all planes: only the minimum distance matters.
+    V distance;
+    detail::computeMinPlaneDistance< P >( _planes, cx, cy, cz, distance );
+
+    none = P::bits( P::le( distance, P::sub( P::set( 0 ), r )));
+    full = P::bits( P::ge( distance, r ));
+}
+
+template < typename T > template< class P > inline
+void FrustumCuller< T >::_test( const _Boxes& boxes, const size_t i,
+                                unsigned& none, unsigned& full ) const
+{
+    typedef typename P::type V;
+    V center[3], extent[3];
+    detail::loadBoxes< P >( boxes, i, center, extent );
+
+    V minNear, minFar;
+    detail::computeBoxPlaneDistances< P >( _planes, center, extent, minNear,
+                                           minFar );
+    none = P::bits( P::le( minFar, P::set( 0 )));
+    full = P::bits( P::ge( minNear, P::set( 0 )));
+}
+
+template < typename T > template< class P > inline
+void FrustumCuller< T >::_test( const _OBBs& obbs, const size_t i,
+                                unsigned& none, unsigned& full ) const
+{
+    typedef typename P::type V;
+    const size_t stride = sizeof( OBB< T >) / sizeof( T );
+    const T* data = obbs.data + i * stride;
+    const V cx = P::gather( data, stride );
+    const V cy = P::gather( data + 1, stride );
+    const V cz = P::gather( data + 2, stride );
+    V axes[9];
+    for( size_t j = 0; j < 9; ++j )
+        axes[j] = P::gather( data + 3 + j, stride );
+    V extents[3];
+    for( size_t j = 0; j < 3; ++j )
+        extents[j] = P::gather( data + 12 + j, stride );
+
+    V minNear = P::set( std::numeric_limits< T >::max( ));
+    V minFar = minNear;
+    for( size_t j = 0; j < 6; ++j )
+    {
+        const vec4& plane = _planes[ j ];
+        const V px = P::set( plane.x( ));
+        const V py = P::set( plane.y( ));
+        const V pz = P::set( plane.z( ));
+        V d;
+        detail::computePlaneDistance< P >( plane, cx, cy, cz, d );
+        V n = P::set( 0 );
+        for( size_t k = 0; k < 3; ++k )
+        {
+            const V projection = P::add( P::add( P::mul( px, axes[ 3 * k ] ),
+                                         P::mul( py, axes[ 3 * k + 1 ] )),
+                                         P::mul( pz, axes[ 3 * k + 2 ] ));
+            n = P::add( n, P::mul( extents[k], P::abs( projection )));
+        }
+        minNear = P::min( minNear, P::sub( d, n ));
+        minFar = P::min( minFar, P::add( d, n ));
+    }
+
+    none = P::bits( P::le( minFar, P::set( 0 )));
+    full = P::bits( P::ge( minNear, P::set( 0 )));
+}
+VMMLIB_SIMD_KERNELS_END
+
+template < typename T >
+void FrustumCuller< T >::test( const T* x, const T* y, const T* z,
+                               const T* radius, const size_t n,
+                               Visibility* visibility ) const
+{
+    const _Spheres spheres = { x, y, z, radius };
+    const _Visibilities results = { visibility };
+    dispatch( _Batch< _Spheres, _Visibilities >( *this, spheres, n, results ));
+}
+
+template < typename T >
+void FrustumCuller< T >::test( const T* minX, const T* minY, const T* minZ,
+                               const T* maxX, const T* maxY, const T* maxZ,
+                               const size_t n, Visibility* visibility ) const
+{
+    const _Boxes boxes = { minX, minY, minZ, maxX, maxY, maxZ };
+    const _Visibilities results = { visibility };
+    dispatch( _Batch< _Boxes, _Visibilities >( *this, boxes, n, results ));
+}
+
+template < typename T >
+void FrustumCuller< T >::test( const OBB< T >* obbs, const size_t n,
+                               Visibility* visibility ) const
+{
+    const _OBBs boxes = { reinterpret_cast< const T* >( obbs ) };
+    const _Visibilities results = { visibility };
+    dispatch( _Batch< _OBBs, _Visibilities >( *this, boxes, n, results ));
+}
+
+template < typename T >
+size_t FrustumCuller< T >::cull( const T* x, const T* y, const T* z,
+                                 const T* radius, const size_t n,
+                                 uint32_t* indices ) const
+{
+    const _Spheres spheres = { x, y, z, radius };
+    const _Indices results = { indices };
+    return dispatch( _Batch< _Spheres, _Indices >( *this, spheres, n,
+                                                   results ));
+}
+
+template < typename T >
+size_t FrustumCuller< T >::cull( const T* minX, const T* minY, const T* minZ,
+                                 const T* maxX, const T* maxY, const T* maxZ,
+                                 const size_t n, uint32_t* indices ) const
+{
+    const _Boxes boxes = { minX, minY, minZ, maxX, maxY, maxZ };
+    const _Indices results = { indices };
+    return dispatch( _Batch< _Boxes, _Indices >( *this, boxes, n, results ));
+}
+
+template < typename T >
+size_t FrustumCuller< T >::cull( const OBB< T >* obbs, const size_t n,
+                                 uint32_t* indices ) const
+{
+    const _OBBs boxes = { reinterpret_cast< const T* >( obbs ) };
+    const _Indices results = { indices };
+    return dispatch( _Batch< _OBBs, _Indices >( *this, boxes, n, results ));
 }
 
 } // namespace vmml
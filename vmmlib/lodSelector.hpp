@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__LOD_SELECTOR__HPP__
+#define __VMML__LOD_SELECTOR__HPP__
+
+#include <vmmlib/aabb.hpp> // inline parameter
+#include <vmmlib/dispatch.hpp> // used inline
+#include <vmmlib/frustumCuller.hpp> // member
+#include <vmmlib/matrix.hpp> // inline parameter
+#include <vmmlib/simd.hpp> // used inline
+#include <vmmlib/vector.hpp> // member
+#include <vmmlib/visibility.hpp> // return value
+
+#include <limits>
+#include <vector>
+
+namespace vmml
+{
+/**
+ * View frustum culling with level of detail selection in one pass.
+ *
+ * Computes the visibility of each object as FrustumCuller does, and from the
+ * same projection its projected radius in pixels, which selects the level of
+ * detail and culls objects too small to contribute to the image.
+ *
+ * Boxes use the radius of their bounding sphere rather than their exact
+ * extent on screen, which would need the eight projected corners. This
+ * overestimates the size of flat or elongated boxes, which get a finer level
+ * and are culled later than their screen extent would allow.
+ *
+ * The level of an object is the number of thresholds larger than its
+ * projected radius, i.e. level 0 for objects at least as large as the first
+ * threshold. The projected radius is r * s / w, where w is the homogeneous
+ * coordinate of the center and s the vertical scale of the projection in
+ * pixels. It is compared without division, so objects at or behind the eye
+ * get level 0.
+ */
+template< typename T > class LODSelector
+{
+public:
+    typedef vector< 3, T > vec3;
+    typedef vector< 4, T > vec4;
+
+    /** Construct a new, uninitialized level of detail selector. */
+    LODSelector() {}
+
+    /**
+     * Construct a level of detail selector.
+     *
+     * @param projection the projection matrix
+     * @param modelView the model*view matrix of the objects
+     * @param viewportHeight the height of the viewport in pixels
+     * @param thresholds the projected radius in pixels at which each level
+     *                   but the last ends, in decreasing order
+     * @param nThresholds the number of thresholds, i.e. levels - 1
+     * @param minRadius the projected radius in pixels below which objects are
+     *                  not visible, 0 to disable contribution culling
+     */
+    LODSelector( const Matrix< 4, 4, T >& projection,
+                 const Matrix< 4, 4, T >& modelView, T viewportHeight,
+                 const T* thresholds, size_t nThresholds, T minRadius = 0 );
+
+    /** @return the projected radius of the sphere in pixels. */
+    T getProjectedRadius( const vec4& sphere ) const;
+
+    /**
+     * Compute the visibility and the level of detail of a sphere.
+     *
+     * @param sphere the bounding sphere, center xyz and radius w
+     * @param lod the output level of detail, also set for invisible spheres
+     * @return the visibility of the sphere, VISIBILITY_NONE if it is outside
+     *         of the frustum or smaller than the minimum radius.
+     */
+    Visibility test( const vec4& sphere, uint32_t& lod ) const;
+
+    /** Compute the visibility and the level of detail of a box. */
+    Visibility test( const AABB< T >& aabb, uint32_t& lod ) const;
+
+    /** @name Batch tests on structure-of-arrays data */
+    //@{
+    /**
+     * Compute the visibility and the level of detail of n spheres.
+     *
+     * The spheres are evaluated with the widest SIMD registers of the CPU, see
+     * dispatch.hpp. Apart from contribution culling, the visibility is
+     * identical to the batch tests of FrustumCuller.
+     *
+     * @param x, y, z the sphere centers
+     * @param radius the sphere radii
+     * @param n the number of spheres
+     * @param visibility the output visibility of each sphere
+     * @param lods the output level of detail of each sphere
+     */
+    void test( const T* x, const T* y, const T* z, const T* radius, size_t n,
+               Visibility* visibility, uint32_t* lods ) const;
+
+    /**
+     * Compute the visibility and the level of detail of n axis-aligned
+     * bounding boxes.
+     *
+     * @param minX, minY, minZ the minimum corners of the boxes
+     * @param maxX, maxY, maxZ the maximum corners of the boxes
+     * @param n the number of boxes
+     * @param visibility the output visibility of each box
+     * @param lods the output level of detail of each box
+     */
+    void test( const T* minX, const T* minY, const T* minZ,
+               const T* maxX, const T* maxY, const T* maxZ, size_t n,
+               Visibility* visibility, uint32_t* lods ) const;
+    //@}
+
+    /** @return the frustum culler of the projection. */
+    const FrustumCuller< T >& getFrustumCuller() const { return _culler; }
+
+private:
+    FrustumCuller< T > _culler;
+    vec4 _w; //!< the last row of the projection*model*view matrix
+    T _scale; //!< the vertical scale of the projection in pixels
+    T _minRadius;
+    std::vector< T > _thresholds;
+
+    typedef detail::CullSpheres< T > _Spheres;
+    typedef detail::CullBoxes< T > _Boxes;
+
+    // The loop over a batch of objects, run by dispatch()
+    template< class O > class _Batch;
+
+    // Batch kernels: test the P::width objects starting at index i. Return the
+    // invisible and the fully visible objects as bit masks, and the levels.
+    template< class P > VMMLIB_SIMD_INLINE
+    void _test( const _Spheres& spheres, size_t i, unsigned& none,
+                unsigned& full, typename P::type& lods ) const;
+    template< class P > VMMLIB_SIMD_INLINE
+    void _test( const _Boxes& boxes, size_t i, unsigned& none,
+                unsigned& full, typename P::type& lods ) const;
+    template< class P > VMMLIB_SIMD_INLINE
+    void _select( const typename P::type& x, const typename P::type& y,
+                  const typename P::type& z, const typename P::type& radius,
+                  unsigned& none, typename P::type& lods ) const;
+};
+
+// - implementation -
+
+template< typename T >
+LODSelector< T >::LODSelector( const Matrix< 4, 4, T >& projection,
+                               const Matrix< 4, 4, T >& modelView,
+                               const T viewportHeight, const T* thresholds,
+                               const size_t nThresholds, const T minRadius )
+    : _culler( projection * modelView )
+    , _w(( projection * modelView ).getRow( 3 ))
+    , _scale( projection( 1, 1 ) * viewportHeight * T( .5 ))
+    , _minRadius( minRadius )
+    , _thresholds( thresholds, thresholds + nThresholds )
+{}
+
+template< typename T >
+T LODSelector< T >::getProjectedRadius( const vec4& sphere ) const
+{
+    const T w = _w.x() * sphere.x() + _w.y() * sphere.y() +
+                _w.z() * sphere.z() + _w.w();
+    if( w <= 0 )
+        return std::numeric_limits< T >::infinity();
+    return sphere.w() * _scale / w;
+}
+
+template< typename T > template< class O > class LODSelector< T >::_Batch
+{
+public:
+    typedef void result_type;
+
+    _Batch( const LODSelector& selector, const O& objects, const size_t n,
+            Visibility* visibility, uint32_t* lods )
+        : _selector( selector ), _objects( objects ), _n( n )
+        , _visibility( visibility ), _lods( lods )
+    {}
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        typedef simd::Scalar< T > S;
+
+        // uint32_t and int32_t may alias
+        int32_t* lods = reinterpret_cast< int32_t* >( _lods );
+        unsigned none, full;
+        const size_t end = _n - _n % P::width;
+        size_t i = 0;
+        for( ; i < end; i += P::width )
+        {
+            typename P::type levels;
+            _selector.template _test< P >( _objects, i, none, full, levels );
+            P::storeInt( lods + i, levels );
+            detail::setVisibility( none, full, P::width, _visibility + i );
+        }
+        for( ; i < _n; ++i )
+        {
+            T levels;
+            _selector.template _test< S >( _objects, i, none, full, levels );
+            S::storeInt( lods + i, levels );
+            detail::setVisibility( none, full, 1, _visibility + i );
+        }
+    }
+
+private:
+    const LODSelector& _selector;
+    const O _objects;
+    const size_t _n;
+    Visibility* const _visibility;
+    uint32_t* const _lods;
+};
+
+VMMLIB_SIMD_KERNELS_BEGIN
+template< typename T > template< class P > inline
+void LODSelector< T >::_select( const typename P::type& x,
+                                const typename P::type& y,
+                                const typename P::type& z,
+                                const typename P::type& radius,
+                                unsigned& none,
+                                typename P::type& lods ) const
+{
+    // r * s / w < t as r * s < t * w, which also holds for w <= 0
+    typedef typename P::type V;
+    V w;
+    detail::computePlaneDistance< P >( _w, x, y, z, w );
+    const V size = P::mul( radius, P::set( _scale ));
+    none |= P::bits( P::lt( size, P::mul( P::set( _minRadius ), w )));
+
+    const V zero = P::set( 0 );
+    const V one = P::set( 1 );
+    lods = zero;
+    for( size_t i = 0; i < _thresholds.size(); ++i )
+        lods = P::add( lods, P::select(
+                           P::lt( size, P::mul( P::set( _thresholds[i] ), w )),
+                           one, zero ));
+}
+
+template< typename T > template< class P > inline
+void LODSelector< T >::_test( const _Spheres& spheres, const size_t i,
+                              unsigned& none, unsigned& full,
+                              typename P::type& lods ) const
+{
+    typedef typename P::type V;
+    const V cx = P::load( spheres.x + i );
+    const V cy = P::load( spheres.y + i );
+    const V cz = P::load( spheres.z + i );
+    const V r = P::load( spheres.radius + i );
+
+    // only the minimum distance to the planes matters, see FrustumCuller
+    V distance;
+    detail::computeMinPlaneDistance< P >( &_culler.getPlane( 0 ), cx, cy, cz,
+                                          distance );
+
+    none = P::bits( P::le( distance, P::sub( P::set( 0 ), r )));
+    full = P::bits( P::ge( distance, r ));
+    _select< P >( cx, cy, cz, r, none, lods );
+}
+
+template< typename T > template< class P > inline
+void LODSelector< T >::_test( const _Boxes& boxes, const size_t i,
+                              unsigned& none, unsigned& full,
+                              typename P::type& lods ) const
+{
+    typedef typename P::type V;
+    V center[3], extent[3];
+    detail::loadBoxes< P >( boxes, i, center, extent );
+
+    V minNear, minFar;
+    detail::computeBoxPlaneDistances< P >( &_culler.getPlane( 0 ), center,
+                                           extent, minNear, minFar );
+    none = P::bits( P::le( minFar, P::set( 0 )));
+    full = P::bits( P::ge( minNear, P::set( 0 )));
+
+    // the radius of the bounding sphere of the box
+    const V radius = P::sqrt( P::add( P::add( P::mul( extent[0], extent[0] ),
+                                              P::mul( extent[1], extent[1] )),
+                                      P::mul( extent[2], extent[2] )));
+    _select< P >( center[0], center[1], center[2], radius, none, lods );
+}
+VMMLIB_SIMD_KERNELS_END
+
+template< typename T >
+Visibility LODSelector< T >::test( const vec4& sphere, uint32_t& lod ) const
+{
+    const _Spheres spheres = { &sphere.array[0], &sphere.array[1],
+                               &sphere.array[2], &sphere.array[3] };
+    Visibility visibility;
+    _Batch< _Spheres >( *this, spheres, 1, &visibility, &lod )
+        .template run< SIMD_SCALAR >();
+    return visibility;
+}
+
+template< typename T >
+Visibility LODSelector< T >::test( const AABB< T >& aabb, uint32_t& lod ) const
+{
+    const T* min = aabb.getMin().array;
+    const T* max = aabb.getMax().array;
+    const _Boxes boxes = { &min[0], &min[1], &min[2],
+                           &max[0], &max[1], &max[2] };
+    Visibility visibility;
+    _Batch< _Boxes >( *this, boxes, 1, &visibility, &lod )
+        .template run< SIMD_SCALAR >();
+    return visibility;
+}
+
+template< typename T >
+void LODSelector< T >::test( const T* x, const T* y, const T* z,
+                             const T* radius, const size_t n,
+                             Visibility* visibility, uint32_t* lods ) const
+{
+    const _Spheres spheres = { x, y, z, radius };
+    dispatch( _Batch< _Spheres >( *this, spheres, n, visibility, lods ));
+}
+
+template< typename T >
+void LODSelector< T >::test( const T* minX, const T* minY, const T* minZ,
+                             const T* maxX, const T* maxY, const T* maxZ,
+                             const size_t n, Visibility* visibility,
+                             uint32_t* lods ) const
+{
+    const _Boxes boxes = { minX, minY, minZ, maxX, maxY, maxZ };
+    dispatch( _Batch< _Boxes >( *this, boxes, n, visibility, lods ));
+}
+
+} // namespace vmml
+
+#endif // include protection
@@ -39,15 +39,22 @@
 #ifndef __VMML__LOWPASS_FILTER__HPP__
 #define __VMML__LOWPASS_FILTER__HPP__
 
-#include <deque>
+#include <cstddef>
 
 namespace vmml
 {
+/**
+ * Low pass filter over the last M values.
+ *
+ * The values are kept in a fixed ring buffer, adding a value does not
+ * allocate. See ExponentialFilter for a filter with constant update cost.
+ */
 template< size_t M, typename T > class LowpassFilter
 {
 public:
     /** Construct a new lowpass filter with the given smoothing. */
-    LowpassFilter( const float F ) : _smoothFactor( F ) {}
+    LowpassFilter( const float F )
+        : _size( 0 ), _head( 0 ), _smoothFactor( F ) {}
     ~LowpassFilter() {}
 
     /** @return The current filtered output value */
@@ -63,7 +70,9 @@ public:
     const T& add( const T& value );
 
 private:
-    std::deque< T > _data;
+    T _data[ M ]; //!< ring buffer, _head is the newest value
+    size_t _size;
+    size_t _head;
     float _smoothFactor;
     T _value;
 };
@@ -72,19 +81,20 @@ private:
 template< size_t M, typename T >
 const T& LowpassFilter< M, T >::add( const T& value )
 {
-    _data.push_front( value );
-
-    while( _data.size() > M )
-        _data.pop_back();
+    _head = _head == 0 ? M - 1 : _head - 1;
+    _data[ _head ] = value;
+    if( _size < M )
+        ++_size;
 
-    // update
-    typename std::deque< T >::const_iterator i = _data.begin();
-    _value = *i;
+    // update, from the newest to the oldest value
+    _value = value;
     double weight = _smoothFactor;
 
-    for( ++i ; i != _data.end(); ++i )
+    for( size_t i = 1, j = _head + 1; i < _size; ++i, ++j )
     {
-        _value = _value * (1 - weight) + (*i) * weight;
+        if( j == M )
+            j = 0;
+        _value = _value * (1 - weight) + _data[ j ] * weight;
         weight *= _smoothFactor;
     }
 
@@ -34,6 +34,7 @@
 #define __VMML__MATRIX__HPP__
 
 #include <vmmlib/enable_if.hpp>
+#include <vmmlib/simd.hpp>
 #include <vmmlib/types.hpp>
 
 #include <algorithm>
@@ -55,13 +56,13 @@ public:
      * Construct a zero-initialized matrix.
      * Square matrices are initialized as identity.
      */
-    Matrix();
+    VMMLIB_CONSTEXPR Matrix();
 
     /**
      * Construct a matrix with default values.
      * Missing data is zero-initialized. Additional data is ignored.
      */
-    Matrix( const T* begin, const T* end );
+    VMMLIB_CONSTEXPR Matrix( const T* begin, const T* end );
 
     /**
      * Construct a matrix with default values.
@@ -73,7 +74,14 @@ public:
      * Copy-construct a matrix.
      * Missing data is zero-initialized. Additional data is ignored.
      */
-    template< size_t P, size_t Q > Matrix( const Matrix< P, Q, T >& source );
+    template< size_t P, size_t Q >
+    VMMLIB_CONSTEXPR Matrix( const Matrix< P, Q, T >& source );
+
+    /** Construct from a lazily evaluated expression, see expression.hpp. */
+    template< class E >
+    Matrix( const Expression< E >& expression,
+            typename enable_if< is_same< typename E::result_type,
+                                         Matrix >::value >::type* = 0 );
 
     /**
      * Construct a new 4x4 transformation matrix from a rotation quaternion and
@@ -95,22 +103,22 @@ public:
     /** @name matrix-matrix operations */
     //@{
     /** @return true if both matrices are equal. */
-    bool operator==( const Matrix& other ) const;
+    VMMLIB_CONSTEXPR bool operator==( const Matrix& other ) const;
 
     /** @return true if both matrices are not equal. */
-    bool operator!=( const Matrix& other ) const;
+    VMMLIB_CONSTEXPR bool operator!=( const Matrix& other ) const;
 
     /** @return true if both matrices are equal within the given tolerance. */
     bool equals( const Matrix& other,
                  T tolerance = std::numeric_limits< T >::epsilon( )) const;
 
     /** Set this to the product of the two matrices (left_RxP * right_PxC) */
-    template< size_t P >
+    template< size_t P > VMMLIB_CONSTEXPR
     Matrix< R, C, T >& multiply( const Matrix< R, P, T >& left,
                                  const Matrix< P, C, T >& right );
 
     /** @return matrix_RxP = (this) matrix * other matrix_CxP; */
-    template< size_t P >
+    template< size_t P > VMMLIB_CONSTEXPR
     Matrix< R, P, T > operator*( const Matrix< C, P, T >& other ) const;
 
     /** Multiply two square matrices */
@@ -120,60 +128,60 @@ public:
 #else
     template< size_t O, size_t P,
               typename = typename enable_if< R == C && O == P && R == O >::type >
-    Matrix< R, C, T >&
+    VMMLIB_CONSTEXPR Matrix< R, C, T >&
 #endif
     operator*=( const Matrix< O, P, T >& right );
 
     /** Element-wise addition of two matrices */
-    Matrix operator+( const Matrix& other ) const;
+    VMMLIB_CONSTEXPR Matrix operator+( const Matrix& other ) const;
 
     /** Element-wise substraction of two matrices */
-    Matrix operator-( const Matrix& other ) const;
+    VMMLIB_CONSTEXPR Matrix operator-( const Matrix& other ) const;
 
     /** Element-wise addition of two matrices */
-    void operator+=( const Matrix& other );
+    VMMLIB_CONSTEXPR void operator+=( const Matrix& other );
 
     /** Element-wise substraction of two matrices */
-    void operator-=( const Matrix& other );
+    VMMLIB_CONSTEXPR void operator-=( const Matrix& other );
     //@}
 
     /** @name matrix-vector operations */
     //@{
     /** Transform column vector by matrix ( res = matrix * vec ) */
-    vector< R, T > operator*( const vector< C, T >& other ) const;
+    VMMLIB_CONSTEXPR vector< R, T > operator*( const vector< C, T >& other )
+        const;
     //@}
 
     /** @name Data access */
     //@{
     /** @return the element at the given row and column. */
-    T& operator()( size_t rowIndex, size_t colIndex );
+    VMMLIB_CONSTEXPR T& operator()( size_t rowIndex, size_t colIndex );
 
     /** @return the element at the given row and column. */
-    T operator()( size_t rowIndex, size_t colIndex ) const;
+    VMMLIB_CONSTEXPR T operator()( size_t rowIndex, size_t colIndex ) const;
 
     /** @return the pointer to the data storage in column-major order. */
-    const T* data() const { return array; }
+    VMMLIB_CONSTEXPR const T* data() const { return array; }
 
     /** @return the sub matrix of size OxP at the given start indices. */
-    template< size_t O, size_t P >
+    template< size_t O, size_t P > VMMLIB_CONSTEXPR
     Matrix< O, P, T > getSubMatrix( size_t rowOffset, size_t colOffset,
                       typename enable_if< O <= R && P <= C >::type* = 0 ) const;
 
     /** Set the sub matrix of size OxP at the given start indices. */
-    template< size_t O, size_t P > typename enable_if< O <= R && P <= C >::type*
+    template< size_t O, size_t P >
+    VMMLIB_CONSTEXPR typename enable_if< O <= R && P <= C >::type*
     setSubMatrix( const Matrix< O, P, T >& sub_matrix, size_t rowOffset,
                   size_t colOffset );
 
-    /** Assign the given matrix. */
-    const Matrix& operator=( const Matrix< R, C, T >& source_ );
-
     /**
      * Assign the given matrix.
      *
      * Remaining data is zero-filled. Additional data is ignored.
      */
     template< size_t P, size_t Q >
-    const Matrix& operator=( const Matrix< P, Q, T >& source_ );
+    VMMLIB_CONSTEXPR const Matrix& operator=(
+        const Matrix< P, Q, T >& source_ );
 
     /**
      * Assign the given data.
@@ -182,26 +190,34 @@ public:
      */
     void operator=( const std::vector< T >& data );
 
+    /** Evaluate an expression in a single loop, see expression.hpp. */
+    template< class E >
+    typename enable_if< is_same< typename E::result_type, Matrix >::value,
+                        Matrix& >::type
+        operator=( const Expression< E >& expression );
+
     /** @return the negated matrix of this matrix. */
-    Matrix< R, C, T > operator-() const;
+    VMMLIB_CONSTEXPR Matrix< R, C, T > operator-() const;
 
     /** @return a vector of the given column. */
-    vector< R, T > getColumn( size_t columnIndex ) const;
+    VMMLIB_CONSTEXPR vector< R, T > getColumn( size_t columnIndex ) const;
 
     /** Set the given column. */
-    void setColumn( size_t index, const vector< R, T >& column );
+    VMMLIB_CONSTEXPR void setColumn( size_t index,
+                                     const vector< R, T >& column );
 
     /** @return a vector of the given row. */
-    vector< C, T > getRow( size_t index ) const;
+    VMMLIB_CONSTEXPR vector< C, T > getRow( size_t index ) const;
 
     /** Set the given row. */
-    void setRow( size_t index,  const vector< C, T >& row );
+    VMMLIB_CONSTEXPR void setRow( size_t index,  const vector< C, T >& row );
 
     /** @return the translation vector (of a 3x3 or 4x4 matrix) */
-    vector< C-1, T > getTranslation() const;
+    VMMLIB_CONSTEXPR vector< C-1, T > getTranslation() const;
 
     /** Set the translation vector (of a 3x3 or 4x4 matrix) */
-    Matrix< R, C, T >& setTranslation( const vector< C-1, T >& t );
+    VMMLIB_CONSTEXPR Matrix< R, C, T >& setTranslation(
+        const vector< C-1, T >& t );
 
     /**
      * Decompose a 4x4 transformation matrix to eye position, lookAt position
@@ -216,10 +232,25 @@ public:
     /**
      * Compute and return the inverted matrix of this matrix.
      *
-     * Sets values to quiet_NaN if not invertible.
+     * Matrices larger than 4x4 are inverted with an LU decomposition, see
+     * solver.hpp. Sets values to quiet_NaN if not invertible.
      */
     Matrix< R, C, T > inverse() const;
 
+    /**
+     * Compute and return the inverted matrix of this affine 4x4 matrix.
+     *
+     * Cheaper than inverse(), see computeInverseAffine().
+     */
+    Matrix< R, C, T > inverseAffine() const;
+
+    /**
+     * Compute and return the inverted matrix of this rigid 4x4 matrix.
+     *
+     * Cheaper than inverseAffine(), see computeInverseRigid().
+     */
+    Matrix< R, C, T > inverseRigid() const;
+
     template< size_t O, size_t P >
     typename enable_if< O == P && R == C && O == R && R >= 2 >::type*
     getAdjugate( Matrix< O, P, T >& adjugate ) const;
@@ -297,25 +328,26 @@ public:
 
 #include <vmmlib/quaternion.hpp>
 #include <vmmlib/vector.hpp>
+#include <vmmlib/solver.hpp>
 
 namespace vmml
 {
 /** @name Free matrix functions */
 //@{
 template< typename T >
-inline T computeDeterminant( const Matrix< 1, 1, T >& matrix_ )
+VMMLIB_CONSTEXPR T computeDeterminant( const Matrix< 1, 1, T >& matrix_ )
 {
     return matrix_.array[ 0 ];
 }
 
 template< typename T >
-inline T computeDeterminant( const Matrix< 2, 2, T >& matrix_ )
+VMMLIB_CONSTEXPR T computeDeterminant( const Matrix< 2, 2, T >& matrix_ )
 {
     return matrix_( 0, 0 ) * matrix_( 1, 1 ) - matrix_( 0, 1 ) * matrix_( 1, 0);
 }
 
 template< typename T >
-inline T computeDeterminant( const Matrix< 3, 3, T >& m_ )
+VMMLIB_CONSTEXPR T computeDeterminant( const Matrix< 3, 3, T >& m_ )
 {
     return m_( 0,0 ) * ( m_( 1,1 ) * m_( 2,2 ) - m_( 1,2 ) * m_( 2,1 )) +
            m_( 0,1 ) * ( m_( 1,2 ) * m_( 2,0 ) - m_( 1,0 ) * m_( 2,2 )) +
@@ -323,7 +355,7 @@ inline T computeDeterminant( const Matrix< 3, 3, T >& m_ )
 }
 
 template< typename T >
-inline T computeDeterminant( const Matrix< 4, 4, T >& m )
+VMMLIB_CONSTEXPR T computeDeterminant( const Matrix< 4, 4, T >& m )
 {
     return    m( 0, 3 ) * m( 1, 2 ) * m( 2, 1 ) * m( 3, 0 )
             - m( 0, 2 ) * m( 1, 3 ) * m( 2, 1 ) * m( 3, 0 )
@@ -351,6 +383,13 @@ inline T computeDeterminant( const Matrix< 4, 4, T >& m )
             + m( 0, 0 ) * m( 1, 1 ) * m( 2, 2 ) * m( 3, 3 );
 }
 
+// LU decomposition for the sizes without a closed form
+template< size_t N, typename T >
+T computeDeterminant( const Matrix< N, N, T >& matrix_ )
+{
+    return LU< N, T >( matrix_ ).determinant();
+}
+
 template< typename T >
 Matrix< 1, 1, T > computeInverse( const Matrix< 1, 1, T >& m_ )
 {
@@ -397,7 +436,7 @@ Matrix< 3, 3, T > computeInverse( const Matrix< 3, 3, T >& m_ )
 
     if ( std::abs( determinant ) <= std::numeric_limits< T >::epsilon( ))
         return Matrix< 3, 3, T >(
-            std::vector< T >( std::numeric_limits< T >::quiet_NaN(), 9 ));
+            std::vector< T >( 9, std::numeric_limits< T >::quiet_NaN( )));
 
     const T detinv = static_cast< T >( 1.0 ) / determinant;
 
@@ -471,14 +510,192 @@ Matrix< 4, 4, T > computeInverse( const Matrix< 4, 4, T >& m_ )
     return inv;
 }
 
+// LU decomposition for the sizes without a closed form
+template< size_t N, typename T >
+Matrix< N, N, T > computeInverse( const Matrix< N, N, T >& m_ )
+{
+    return LU< N, T >( m_ ).inverse();
+}
+
 template< size_t R, size_t C, typename T >
 Matrix< R, C, T > computeInverse( const Matrix< R, C, T >& )
 {
-    throw std::runtime_error( "Can't compute inverse of this matrix" );
+    throw std::runtime_error( "Can't compute inverse of a non-square matrix" );
+}
+
+#ifdef VMMLIB_SSE2
+// Cramer's rule on SSE registers, after Intel's "Streaming SIMD Extensions -
+// Inverse of 4x4 Matrix" (AP-928). The algorithm works on a row-major matrix;
+// loading the column-major storage as rows inverts the transposed matrix,
+// and the inverse of the transposed is the transposed of the inverse, which
+// is stored back in column-major order. The reciprocal of the determinant is
+// computed with a full-precision division.
+template<> inline
+Matrix< 4, 4, float > computeInverse( const Matrix< 4, 4, float >& m_ )
+{
+    const float* src = m_.array;
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128 tmp1 = _mm_loadh_pi( _mm_loadl_pi( zero, (const __m64*)( src )),
+                                (const __m64*)( src + 4 ));
+    __m128 row1 = _mm_loadh_pi( _mm_loadl_pi( zero, (const __m64*)( src + 8 )),
+                                (const __m64*)( src + 12 ));
+    const __m128 row0 = _mm_shuffle_ps( tmp1, row1, 0x88 );
+    row1 = _mm_shuffle_ps( row1, tmp1, 0xDD );
+    tmp1 = _mm_loadh_pi( _mm_loadl_pi( zero, (const __m64*)( src + 2 )),
+                         (const __m64*)( src + 6 ));
+    __m128 row3 = _mm_loadh_pi( _mm_loadl_pi( zero, (const __m64*)( src + 10 )),
+                                (const __m64*)( src + 14 ));
+    __m128 row2 = _mm_shuffle_ps( tmp1, row3, 0x88 );
+    row3 = _mm_shuffle_ps( row3, tmp1, 0xDD );
+
+    tmp1 = _mm_mul_ps( row2, row3 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0xB1 );
+    __m128 minor0 = _mm_mul_ps( row1, tmp1 );
+    __m128 minor1 = _mm_mul_ps( row0, tmp1 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0x4E );
+    minor0 = _mm_sub_ps( _mm_mul_ps( row1, tmp1 ), minor0 );
+    minor1 = _mm_sub_ps( _mm_mul_ps( row0, tmp1 ), minor1 );
+    minor1 = _mm_shuffle_ps( minor1, minor1, 0x4E );
+
+    tmp1 = _mm_mul_ps( row1, row2 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0xB1 );
+    minor0 = _mm_add_ps( _mm_mul_ps( row3, tmp1 ), minor0 );
+    __m128 minor3 = _mm_mul_ps( row0, tmp1 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0x4E );
+    minor0 = _mm_sub_ps( minor0, _mm_mul_ps( row3, tmp1 ));
+    minor3 = _mm_sub_ps( _mm_mul_ps( row0, tmp1 ), minor3 );
+    minor3 = _mm_shuffle_ps( minor3, minor3, 0x4E );
+
+    tmp1 = _mm_mul_ps( _mm_shuffle_ps( row1, row1, 0x4E ), row3 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0xB1 );
+    row2 = _mm_shuffle_ps( row2, row2, 0x4E );
+    minor0 = _mm_add_ps( _mm_mul_ps( row2, tmp1 ), minor0 );
+    __m128 minor2 = _mm_mul_ps( row0, tmp1 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0x4E );
+    minor0 = _mm_sub_ps( minor0, _mm_mul_ps( row2, tmp1 ));
+    minor2 = _mm_sub_ps( _mm_mul_ps( row0, tmp1 ), minor2 );
+    minor2 = _mm_shuffle_ps( minor2, minor2, 0x4E );
+
+    tmp1 = _mm_mul_ps( row0, row1 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0xB1 );
+    minor2 = _mm_add_ps( _mm_mul_ps( row3, tmp1 ), minor2 );
+    minor3 = _mm_sub_ps( _mm_mul_ps( row2, tmp1 ), minor3 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0x4E );
+    minor2 = _mm_sub_ps( _mm_mul_ps( row3, tmp1 ), minor2 );
+    minor3 = _mm_sub_ps( minor3, _mm_mul_ps( row2, tmp1 ));
+
+    tmp1 = _mm_mul_ps( row0, row3 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0xB1 );
+    minor1 = _mm_sub_ps( minor1, _mm_mul_ps( row2, tmp1 ));
+    minor2 = _mm_add_ps( _mm_mul_ps( row1, tmp1 ), minor2 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0x4E );
+    minor1 = _mm_add_ps( _mm_mul_ps( row2, tmp1 ), minor1 );
+    minor2 = _mm_sub_ps( minor2, _mm_mul_ps( row1, tmp1 ));
+
+    tmp1 = _mm_mul_ps( row0, row2 );
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0xB1 );
+    minor1 = _mm_add_ps( _mm_mul_ps( row3, tmp1 ), minor1 );
+    minor3 = _mm_sub_ps( minor3, _mm_mul_ps( row1, tmp1 ));
+    tmp1 = _mm_shuffle_ps( tmp1, tmp1, 0x4E );
+    minor1 = _mm_sub_ps( minor1, _mm_mul_ps( row3, tmp1 ));
+    minor3 = _mm_add_ps( _mm_mul_ps( row1, tmp1 ), minor3 );
+
+    __m128 det = _mm_mul_ps( row0, minor0 );
+    det = _mm_add_ps( _mm_shuffle_ps( det, det, 0x4E ), det );
+    det = _mm_add_ss( _mm_shuffle_ps( det, det, 0xB1 ), det );
+
+    const float determinant = _mm_cvtss_f32( det );
+    if( std::abs( determinant ) <= std::numeric_limits< float >::epsilon( ))
+        return Matrix< 4, 4, float >( std::vector< float >( 16,
+                                std::numeric_limits< float >::quiet_NaN( )));
+
+    const __m128 detinv = _mm_set1_ps( 1.f / determinant );
+    Matrix< 4, 4, float > inv;
+    _mm_storeu_ps( inv.array, _mm_mul_ps( detinv, minor0 ));
+    _mm_storeu_ps( inv.array + 4, _mm_mul_ps( detinv, minor1 ));
+    _mm_storeu_ps( inv.array + 8, _mm_mul_ps( detinv, minor2 ));
+    _mm_storeu_ps( inv.array + 12, _mm_mul_ps( detinv, minor3 ));
+    return inv;
+}
+#endif
+
+/**
+ * @return the inverse of an affine 4x4 matrix with a last row of 0 0 0 1.
+ *
+ * Only the upper 3x3 matrix is inverted, the inverse translation is the
+ * negated, inversely transformed translation. Sets values to quiet_NaN if not
+ * invertible.
+ */
+template< typename T >
+Matrix< 4, 4, T > computeInverseAffine( const Matrix< 4, 4, T >& m_ )
+{
+    const T* a = m_.array;
+    Matrix< 4, 4, T > inv;
+    inv.array[0] = a[5] * a[10] - a[9] * a[6];
+    inv.array[1] = a[9] * a[2] - a[1] * a[10];
+    inv.array[2] = a[1] * a[6] - a[5] * a[2];
+    inv.array[4] = a[8] * a[6] - a[4] * a[10];
+    inv.array[5] = a[0] * a[10] - a[8] * a[2];
+    inv.array[6] = a[4] * a[2] - a[0] * a[6];
+    inv.array[8] = a[4] * a[9] - a[8] * a[5];
+    inv.array[9] = a[8] * a[1] - a[0] * a[9];
+    inv.array[10] = a[0] * a[5] - a[4] * a[1];
+
+    const T determinant = a[0] * inv.array[0] + a[4] * inv.array[1] +
+                          a[8] * inv.array[2];
+    if( std::abs( determinant ) <= std::numeric_limits< T >::epsilon( ))
+        return Matrix< 4, 4, T >(
+            std::vector< T >( 16, std::numeric_limits< T >::quiet_NaN( )));
+
+    const T detinv = T( 1 ) / determinant;
+    for( size_t i = 0; i < 12; ++i )
+        inv.array[i] *= detinv;
+
+    for( size_t i = 0; i < 3; ++i )
+        inv.array[ 12 + i ] = -( inv.array[i] * a[12] +
+                                 inv.array[ 4 + i ] * a[13] +
+                                 inv.array[ 8 + i ] * a[14] );
+    return inv;
+}
+
+/**
+ * @return the inverse of a rigid 4x4 transformation, consisting only of a
+ *         rotation and a translation.
+ *
+ * The inverse rotation is the transposed rotation. The result is undefined
+ * for matrices with scaling, shearing or projection.
+ */
+template< typename T >
+Matrix< 4, 4, T > computeInverseRigid( const Matrix< 4, 4, T >& m_ )
+{
+    const T* a = m_.array;
+    Matrix< 4, 4, T > inv;
+    for( size_t row = 0; row < 3; ++row )
+        for( size_t col = 0; col < 3; ++col )
+            inv.array[ col * 4 + row ] = a[ row * 4 + col ];
+
+    for( size_t i = 0; i < 3; ++i )
+        inv.array[ 12 + i ] = -( inv.array[i] * a[12] +
+                                 inv.array[ 4 + i ] * a[13] +
+                                 inv.array[ 8 + i ] * a[14] );
+    return inv;
+}
+
+template< size_t R, size_t C, typename T >
+Matrix< R, C, T > computeInverseAffine( const Matrix< R, C, T >& )
+{
+    throw std::runtime_error( "Can't compute affine inverse of this matrix" );
+}
+
+template< size_t R, size_t C, typename T >
+Matrix< R, C, T > computeInverseRigid( const Matrix< R, C, T >& )
+{
+    throw std::runtime_error( "Can't compute rigid inverse of this matrix" );
 }
 
 /** @return the transposed of a matrix */
-template< size_t R, size_t C, typename T > inline
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 Matrix< C, R, T > transpose( const Matrix< R, C, T >& matrix )
 {
     Matrix< C, R, T > transposed;
@@ -490,7 +707,7 @@ Matrix< C, R, T > transpose( const Matrix< R, C, T >& matrix )
 //@}
 
 template< size_t R, size_t C, typename T >
-Matrix< R, C, T >::Matrix()
+VMMLIB_CONSTEXPR Matrix< R, C, T >::Matrix()
     : array() // http://stackoverflow.com/questions/5602030
 {
     if( R == C )
@@ -499,11 +716,11 @@ Matrix< R, C, T >::Matrix()
 }
 
 template< size_t R, size_t C, typename T >
-Matrix< R, C, T >::Matrix( const T* begin_, const T* end_ )
+VMMLIB_CONSTEXPR Matrix< R, C, T >::Matrix( const T* begin_, const T* end_ )
     : array() // http://stackoverflow.com/questions/5602030
 {
-    const T* to = std::min( end_, begin_ + R * C );
-    ::memcpy( array, begin_, (to - begin_) * sizeof( T ));
+    for( size_t i = 0; i < R * C && begin_ + i < end_; ++i )
+        array[ i ] = begin_[ i ];
 }
 
 template< size_t R, size_t C, typename T >
@@ -514,11 +731,20 @@ Matrix< R, C, T >::Matrix( const std::vector< T >& values )
 
 template< size_t R, size_t C, typename T >
 template< size_t P, size_t Q >
-Matrix< R, C, T >::Matrix( const Matrix< P, Q, T >& source )
+VMMLIB_CONSTEXPR Matrix< R, C, T >::Matrix( const Matrix< P, Q, T >& source )
+    : array()
 {
     *this = source;
 }
 
+template< size_t R, size_t C, typename T > template< class E >
+Matrix< R, C, T >::Matrix( const Expression< E >& expression,
+                           typename enable_if< is_same< typename E::result_type,
+                                                      Matrix >::value >::type* )
+{
+    *this = expression;
+}
+
 template< size_t R, size_t C, typename T > template< size_t O >
 Matrix< R, C, T >::Matrix( const Quaternion< T >& rotation,
                            const vector< O, T >& translation,
@@ -558,7 +784,7 @@ Matrix< R, C, T >::Matrix( const vector< S, T >& eye,
     (*this)( 3, 3 ) = 1;
 }
 
-template< size_t R, size_t C, typename T > inline
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 T& Matrix< R, C, T >::operator()( size_t rowIndex, size_t colIndex )
 {
     if ( rowIndex >= R || colIndex >= C )
@@ -566,7 +792,7 @@ T& Matrix< R, C, T >::operator()( size_t rowIndex, size_t colIndex )
     return array[ colIndex * R + rowIndex ];
 }
 
-template< size_t R, size_t C, typename T > inline
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 T Matrix< R, C, T >::operator()( size_t rowIndex, size_t colIndex ) const
 {
     if ( rowIndex >= R || colIndex >= C )
@@ -574,7 +800,7 @@ T Matrix< R, C, T >::operator()( size_t rowIndex, size_t colIndex ) const
     return array[ colIndex * R + rowIndex ];
 }
 
-template< size_t R, size_t C, typename T >
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 bool Matrix< R, C, T >::operator==( const Matrix< R, C, T >& other ) const
 {
     for( size_t i = 0; i < R * C; ++i )
@@ -583,7 +809,7 @@ bool Matrix< R, C, T >::operator==( const Matrix< R, C, T >& other ) const
     return true;
 }
 
-template< size_t R, size_t C, typename T >
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 bool Matrix< R, C, T >::operator!=( const Matrix< R, C, T >& other ) const
 {
     return ! operator==( other );
@@ -599,19 +825,12 @@ bool Matrix< R, C, T >::equals( const Matrix< R, C, T >& other,
     return true;
 }
 
-template< size_t R, size_t C, typename T > const Matrix< R, C, T >&
-Matrix< R, C, T >::operator=( const Matrix< R, C, T >& source )
-{
-    ::memcpy( array, source.array, R * C * sizeof( T ));
-    return *this;
-}
-
 template< size_t R, size_t C, typename T > template< size_t P, size_t Q >
-const Matrix< R, C, T >&
+VMMLIB_CONSTEXPR const Matrix< R, C, T >&
 Matrix< R, C, T >::operator=( const Matrix< P, Q, T >& source )
 {
-    const size_t minL = std::min( P, R );
-    const size_t minC = std::min( Q, C );
+    const size_t minL = P < R ? P : R;
+    const size_t minC = Q < C ? Q : C;
 
     for ( size_t i = 0 ; i < minL ; ++i )
         for ( size_t j = 0 ; j < minC ; ++j )
@@ -637,32 +856,158 @@ void Matrix< R, C, T >::operator=( const std::vector< T >& values )
     }
 }
 
+template< size_t R, size_t C, typename T > template< class E >
+typename enable_if< is_same< typename E::result_type,
+                             Matrix< R, C, T > >::value,
+                    Matrix< R, C, T >& >::type
+Matrix< R, C, T >::operator=( const Expression< E >& expression )
+{
+    const E& elements = expression.get();
+    for( size_t i = 0; i < R * C; ++i )
+        array[ i ] = elements[ i ];
+    return *this;
+}
+
+namespace detail
+{
+/** Multiply with a SIMD kernel if there is one for the matrix type. */
+template< size_t R, size_t P, size_t C, typename T >
+inline bool multiply( Matrix< R, C, T >&, const Matrix< R, P, T >&,
+                      const Matrix< P, C, T >& )
+{
+    return false;
+}
+
+#ifdef VMMLIB_SSE2
+// The SIMD 4x4 products compute each result column as the sum of the columns
+// of left scaled by the elements of the matching column of right, in the same
+// order as the scalar loop. Without FMA the results are bit-identical to the
+// scalar code. With FMA each product is fused into the accumulation, which
+// saves one rounding per term: the difference to the scalar result is then
+// bounded by 4 * epsilon * sum_k |left(i,k) * right(k,j)|.
+//
+// All columns of left are loaded before any result column is written, and
+// each column of right is consumed before the same result column is stored,
+// which makes both kernels safe for left == this and right == this.
+// Matrix::multiply() uses them unless evaluated in a constant expression.
+inline bool multiply( Matrix< 4, 4, float >& result,
+                      const Matrix< 4, 4, float >& left,
+                      const Matrix< 4, 4, float >& right )
+{
+    float* array = result.array;
+    const __m128 a0 = _mm_loadu_ps( left.array );
+    const __m128 a1 = _mm_loadu_ps( left.array + 4 );
+    const __m128 a2 = _mm_loadu_ps( left.array + 8 );
+    const __m128 a3 = _mm_loadu_ps( left.array + 12 );
+
+    for( size_t i = 0; i < 16; i += 4 )
+    {
+        const float* b = right.array + i;
+        __m128 c = _mm_mul_ps( a0, _mm_set1_ps( b[0] ));
+#  ifdef VMMLIB_FMA
+        c = _mm_fmadd_ps( a1, _mm_set1_ps( b[1] ), c );
+        c = _mm_fmadd_ps( a2, _mm_set1_ps( b[2] ), c );
+        c = _mm_fmadd_ps( a3, _mm_set1_ps( b[3] ), c );
+#  else
+        c = _mm_add_ps( c, _mm_mul_ps( a1, _mm_set1_ps( b[1] )));
+        c = _mm_add_ps( c, _mm_mul_ps( a2, _mm_set1_ps( b[2] )));
+        c = _mm_add_ps( c, _mm_mul_ps( a3, _mm_set1_ps( b[3] )));
+#  endif
+        _mm_storeu_ps( array + i, c );
+    }
+    return true;
+}
+
+inline bool multiply( Matrix< 4, 4, double >& result,
+                      const Matrix< 4, 4, double >& left,
+                      const Matrix< 4, 4, double >& right )
+{
+    double* array = result.array;
+#  ifdef VMMLIB_AVX
+    const __m256d a0 = _mm256_loadu_pd( left.array );
+    const __m256d a1 = _mm256_loadu_pd( left.array + 4 );
+    const __m256d a2 = _mm256_loadu_pd( left.array + 8 );
+    const __m256d a3 = _mm256_loadu_pd( left.array + 12 );
+
+    for( size_t i = 0; i < 16; i += 4 )
+    {
+        const double* b = right.array + i;
+        __m256d c = _mm256_mul_pd( a0, _mm256_set1_pd( b[0] ));
+#    ifdef VMMLIB_FMA
+        c = _mm256_fmadd_pd( a1, _mm256_set1_pd( b[1] ), c );
+        c = _mm256_fmadd_pd( a2, _mm256_set1_pd( b[2] ), c );
+        c = _mm256_fmadd_pd( a3, _mm256_set1_pd( b[3] ), c );
+#    else
+        c = _mm256_add_pd( c, _mm256_mul_pd( a1, _mm256_set1_pd( b[1] )));
+        c = _mm256_add_pd( c, _mm256_mul_pd( a2, _mm256_set1_pd( b[2] )));
+        c = _mm256_add_pd( c, _mm256_mul_pd( a3, _mm256_set1_pd( b[3] )));
+#    endif
+        _mm256_storeu_pd( array + i, c );
+    }
+#  else
+    // upper (rows 0, 1) and lower (rows 2, 3) halves of the columns of left
+    __m128d a[8];
+    for( size_t i = 0; i < 8; ++i )
+        a[i] = _mm_loadu_pd( left.array + i * 2 );
+
+    for( size_t i = 0; i < 16; i += 4 )
+    {
+        const double* b = right.array + i;
+        const __m128d b0 = _mm_set1_pd( b[0] );
+        const __m128d b1 = _mm_set1_pd( b[1] );
+        const __m128d b2 = _mm_set1_pd( b[2] );
+        const __m128d b3 = _mm_set1_pd( b[3] );
+
+        __m128d upper = _mm_mul_pd( a[0], b0 );
+        __m128d lower = _mm_mul_pd( a[1], b0 );
+        upper = _mm_add_pd( upper, _mm_mul_pd( a[2], b1 ));
+        lower = _mm_add_pd( lower, _mm_mul_pd( a[3], b1 ));
+        upper = _mm_add_pd( upper, _mm_mul_pd( a[4], b2 ));
+        lower = _mm_add_pd( lower, _mm_mul_pd( a[5], b2 ));
+        upper = _mm_add_pd( upper, _mm_mul_pd( a[6], b3 ));
+        lower = _mm_add_pd( lower, _mm_mul_pd( a[7], b3 ));
+        _mm_storeu_pd( array + i, upper );
+        _mm_storeu_pd( array + i + 2, lower );
+    }
+#  endif
+    return true;
+}
+#endif
+}
+
 template< size_t R, size_t C, typename T > template< size_t P >
-Matrix< R, C, T >& Matrix< R, C, T >::multiply( const Matrix< R, P, T >& left,
-                                                const Matrix< P, C, T >& right )
+VMMLIB_CONSTEXPR Matrix< R, C, T >& Matrix< R, C, T >::multiply(
+    const Matrix< R, P, T >& left, const Matrix< P, C, T >& right )
 {
+    if( !VMMLIB_IS_CONSTANT_EVALUATED() &&
+        detail::multiply( *this, left, right ))
+    {
+        return *this;
+    }
+
     // Create copy for multiplication with self
-    if( &left == this )
+    if( static_cast< const void* >( &left ) == this )
         return multiply( Matrix< R, P, T >( left ), right );
-    if( &right == this )
-        return multiply( left, Matrix< R, P, T >( right ));
+    if( static_cast< const void* >( &right ) == this )
+        return multiply( left, Matrix< P, C, T >( right ));
 
     for( size_t rowIndex = 0; rowIndex< R; ++rowIndex )
     {
         for( size_t colIndex = 0; colIndex < C; ++colIndex )
         {
-            T& component = (*this)( rowIndex, colIndex );
+            T& component = array[ colIndex * R + rowIndex ];
             component = static_cast< T >( 0.0 );
             for( size_t p = 0; p < P; p++)
-                component += left( rowIndex, p ) * right( p, colIndex );
+                component += left.array[ p * R + rowIndex ] *
+                             right.array[ colIndex * P + p ];
         }
     }
     return *this;
 }
 
 template< size_t R, size_t C, typename T > template< size_t P >
-Matrix< R, P, T > Matrix< R, C, T >::operator*( const Matrix< C, P, T >& other )
-    const
+VMMLIB_CONSTEXPR Matrix< R, P, T >
+Matrix< R, C, T >::operator*( const Matrix< C, P, T >& other ) const
 {
     Matrix< R, P, T > result;
     return result.multiply( *this, other );
@@ -673,7 +1018,7 @@ template< size_t R, size_t C, typename T > template< size_t O, size_t P >
 typename enable_if< R == C && O == P && R == O >::type*
 #else
 template< size_t R, size_t C, typename T > template< size_t O, size_t P, typename >
-Matrix< R, C, T >&
+VMMLIB_CONSTEXPR Matrix< R, C, T >&
 #endif
 Matrix< R, C, T >::operator*=( const Matrix< O, P, T >& right )
 {
@@ -686,23 +1031,22 @@ Matrix< R, C, T >::operator*=( const Matrix< O, P, T >& right )
 #endif
 }
 
-template< size_t R, size_t C, typename T >
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 vector< R, T > Matrix< R, C, T >::operator*( const vector< C, T >& vec ) const
 {
     vector< R, T > result;
 
-    // this < R, 1 > = < R, P > * < P, 1 >
-    for( size_t i = 0; i< R; ++i )
-    {
-        T tmp( 0 );
-        for( size_t j = 0; j < C; ++j )
-            tmp += (*this)( i, j ) * vec( j );
-        result( i ) = tmp;
-    }
+    // this < R, 1 > = < R, P > * < P, 1 >, accumulated column by column to
+    // vectorize over the column-major storage. Same summation order per row.
+    for( size_t i = 0; i < R; ++i )
+        result.array[ i ] = 0;
+    for( size_t j = 0; j < C; ++j )
+        for( size_t i = 0; i < R; ++i )
+            result.array[ i ] += array[ j * R + i ] * vec.array[ j ];
     return result;
 }
 
-template< size_t R, size_t C, typename T > inline
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 Matrix< R, C, T > Matrix< R, C, T >::operator-() const
 {
     Matrix< R, C, T > result;
@@ -711,25 +1055,24 @@ Matrix< R, C, T > Matrix< R, C, T >::operator-() const
     return result;
 }
 
-template< size_t R, size_t C, typename T >
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 vector< R, T > Matrix< R, C, T >::getColumn( const size_t index ) const
 {
     if ( index >= C )
         throw std::runtime_error( "getColumn() - index out of bounds." );
-    vector< R, T > column;
-    ::memcpy( &column.array[0], &array[ R * index ], R * sizeof( T ));
-    return column;
+    return vector< R, T >( array + R * index );
 }
 
-template< size_t R, size_t C, typename T >
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 void Matrix< R, C, T >::setColumn( size_t index, const vector< R, T >& column )
 {
     if ( index >= C )
         throw std::runtime_error( "setColumn() - index out of bounds." );
-    memcpy( array + R * index, column.array, R * sizeof( T ) );
+    for( size_t i = 0; i < R; ++i )
+        array[ R * index + i ] = column.array[ i ];
 }
 
-template< size_t R, size_t C, typename T >
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 vector< C, T > Matrix< R, C, T >::getRow( size_t index ) const
 {
     if ( index >= R )
@@ -741,7 +1084,7 @@ vector< C, T > Matrix< R, C, T >::getRow( size_t index ) const
     return row;
 }
 
-template< size_t R, size_t C, typename T >
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 void Matrix< R, C, T >::setRow( size_t rowIndex, const vector< C, T >& row )
 {
     if ( rowIndex >= R )
@@ -751,7 +1094,7 @@ void Matrix< R, C, T >::setRow( size_t rowIndex, const vector< C, T >& row )
         (*this)( rowIndex, colIndex ) = row( colIndex );
 }
 
-template< size_t R, size_t C, typename T > inline
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 Matrix< R, C, T > Matrix< R, C, T >::operator+( const Matrix< R, C, T >& other )
     const
 {
@@ -760,14 +1103,14 @@ Matrix< R, C, T > Matrix< R, C, T >::operator+( const Matrix< R, C, T >& other )
     return result;
 }
 
-template< size_t R, size_t C, typename T >
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 void Matrix< R, C, T >::operator+=( const Matrix< R, C, T >& other )
 {
     for( size_t i = 0; i < R * C; ++i )
         array[i] += other.array[i];
 }
 
-template< size_t R, size_t C, typename T > inline
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 Matrix< R, C, T > Matrix< R, C, T >::operator-( const Matrix< R, C, T >& other )
     const
 {
@@ -776,7 +1119,7 @@ Matrix< R, C, T > Matrix< R, C, T >::operator-( const Matrix< R, C, T >& other )
     return result;
 }
 
-template< size_t R, size_t C, typename T >
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 void Matrix< R, C, T >::operator-=( const Matrix< R, C, T >& other )
 {
     for( size_t i = 0; i < R * C; ++i )
@@ -784,9 +1127,9 @@ void Matrix< R, C, T >::operator-=( const Matrix< R, C, T >& other )
 }
 
 template< size_t R, size_t C, typename T > template< size_t O, size_t P >
-Matrix< O, P, T > Matrix< R, C, T >::getSubMatrix( size_t rowOffset,
-                                                   size_t colOffset,
-                           typename enable_if< O <= R && P <= C >::type* ) const
+VMMLIB_CONSTEXPR Matrix< O, P, T > Matrix< R, C, T >::getSubMatrix(
+    size_t rowOffset, size_t colOffset,
+    typename enable_if< O <= R && P <= C >::type* ) const
 {
     Matrix< O, P, T > result;
     if ( O + rowOffset > R || P + colOffset > C )
@@ -800,7 +1143,7 @@ Matrix< O, P, T > Matrix< R, C, T >::getSubMatrix( size_t rowOffset,
 }
 
 template< size_t R, size_t C, typename T > template< size_t O, size_t P >
-typename enable_if< O <= R && P <= C >::type*
+VMMLIB_CONSTEXPR typename enable_if< O <= R && P <= C >::type*
 Matrix< R, C, T >::setSubMatrix( const Matrix< O, P, T >& sub_matrix,
                                  size_t rowOffset, size_t colOffset )
 {
@@ -816,6 +1159,18 @@ Matrix< R, C, T > Matrix< R, C, T >::inverse() const
     return computeInverse( *this );
 }
 
+template< size_t R, size_t C, typename T >
+Matrix< R, C, T > Matrix< R, C, T >::inverseAffine() const
+{
+    return computeInverseAffine( *this );
+}
+
+template< size_t R, size_t C, typename T >
+Matrix< R, C, T > Matrix< R, C, T >::inverseRigid() const
+{
+    return computeInverseRigid( *this );
+}
+
 template< size_t R, size_t C, typename T > template< size_t O, size_t P >
 typename enable_if< O == P && R == C && O == R && R >= 2 >::type*
 Matrix< R, C, T >::getAdjugate( Matrix< O, P, T >& adjugate ) const
@@ -1075,7 +1430,8 @@ Matrix< R, C, T >& Matrix< R, C, T >::scaleTranslation(
 }
 
 
-template< size_t R, size_t C, typename T > inline Matrix< R, C, T >&
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
+Matrix< R, C, T >&
 Matrix< R, C, T >::setTranslation( const vector< C-1, T >& trans )
 {
     for( size_t i = 0; i < C-1; ++i )
@@ -1083,7 +1439,7 @@ Matrix< R, C, T >::setTranslation( const vector< C-1, T >& trans )
     return *this;
 }
 
-template< size_t R, size_t C, typename T > inline
+template< size_t R, size_t C, typename T > VMMLIB_CONSTEXPR
 vector< C-1, T > Matrix< R, C, T >::getTranslation() const
 {
     vector< C-1, T > result;
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__MULTI_FRUSTUM_CULLER__HPP__
+#define __VMML__MULTI_FRUSTUM_CULLER__HPP__
+
+#include <vmmlib/aabb.hpp> // inline parameter
+#include <vmmlib/dispatch.hpp> // used inline
+#include <vmmlib/frustumCuller.hpp> // inline parameter
+#include <vmmlib/matrix.hpp> // inline parameter
+#include <vmmlib/simd.hpp> // used inline
+#include <vmmlib/vector.hpp> // member
+
+#include <limits>
+
+namespace vmml
+{
+/**
+ * View frustum culling against N frusta in one pass.
+ *
+ * Tests each object against the frusta of several views at once, e.g. the two
+ * eyes of a stereo view, the cascades of a shadow map or the six faces of a
+ * cube map. The object data is loaded once for all views, and the N * 6
+ * planes are evaluated with the widest SIMD instructions of the CPU, see
+ * dispatch.hpp. N is at most 16.
+ *
+ * The result of each test is a bit mask of the views, bit i is set if the
+ * object is fully or partially visible in view i, i.e. if
+ * FrustumCuller::test() does not return VISIBILITY_NONE for this view.
+ */
+template< typename T, size_t N > class MultiFrustumCuller
+{
+public:
+    typedef vector< 3, T > vec3;
+    typedef vector< 4, T > vec4;
+
+    static const size_t SIZE = N; //!< the number of views
+
+    /** Construct a new, uninitialized multi frustum culler. */
+    MultiFrustumCuller() {}
+
+    /** Construct a culler from N projection*model*view matrices. */
+    explicit MultiFrustumCuller( const Matrix< 4, 4, T >* projModelViews );
+
+    /** Construct a culler from the planes of N frustum cullers. */
+    explicit MultiFrustumCuller( const FrustumCuller< T >* cullers );
+
+    /** Set the planes of the given view from a frustum culler. */
+    void set( size_t view, const FrustumCuller< T >& culler );
+
+    /** @return the bit mask of the views the sphere is visible in. */
+    uint32_t test( const vec4& sphere ) const;
+
+    /** @return the bit mask of the views the box is visible in. */
+    uint32_t test( const AABB< T >& aabb ) const;
+
+    /** @name Batch tests on structure-of-arrays data */
+    //@{
+    /**
+     * Compute the visible views of n spheres.
+     *
+     * @param x, y, z the sphere centers
+     * @param radius the sphere radii
+     * @param n the number of spheres
+     * @param views the output bit mask of the visible views of each sphere
+     */
+    void test( const T* x, const T* y, const T* z, const T* radius, size_t n,
+               uint32_t* views ) const;
+
+    /**
+     * Compute the visible views of n axis-aligned bounding boxes.
+     *
+     * @param minX, minY, minZ the minimum corners of the boxes
+     * @param maxX, maxY, maxZ the maximum corners of the boxes
+     * @param n the number of boxes
+     * @param views the output bit mask of the visible views of each box
+     */
+    void test( const T* minX, const T* minY, const T* minZ,
+               const T* maxX, const T* maxY, const T* maxZ, size_t n,
+               uint32_t* views ) const;
+    //@}
+
+private:
+    static_assert( N > 0 && N <= 16, "MultiFrustumCuller has 1 to 16 views, "
+                   "the view masks are exact in a float and fit in 16 bits" );
+
+    vec4 _planes[ N * 6 ]; //!< the six planes of each view, see FrustumCuller
+    vec3 _absNormals[ N * 6 ]; //!< the absolute plane normals for the boxes
+
+    typedef detail::CullSpheres< T > _Spheres;
+    typedef detail::CullBoxes< T > _Boxes;
+
+    // The loop over a batch of objects, run by dispatch()
+    template< class O > class _Batch;
+
+    // Batch kernels: the bit masks of the visible views of the P::width
+    // objects starting at index i, as exact sums of powers of two
+    template< class P > VMMLIB_SIMD_INLINE
+    void _test( const _Spheres& spheres, size_t i,
+                typename P::type& views ) const;
+    template< class P > VMMLIB_SIMD_INLINE
+    void _test( const _Boxes& boxes, size_t i,
+                typename P::type& views ) const;
+};
+
+// - implementation -
+
+template< typename T, size_t N > const size_t MultiFrustumCuller< T, N >::SIZE;
+
+template< typename T, size_t N > MultiFrustumCuller< T, N >::MultiFrustumCuller(
+    const Matrix< 4, 4, T >* projModelViews )
+{
+    for( size_t i = 0; i < N; ++i )
+        set( i, FrustumCuller< T >( projModelViews[i] ));
+}
+
+template< typename T, size_t N > MultiFrustumCuller< T, N >::MultiFrustumCuller(
+    const FrustumCuller< T >* cullers )
+{
+    for( size_t i = 0; i < N; ++i )
+        set( i, cullers[i] );
+}
+
+template< typename T, size_t N >
+void MultiFrustumCuller< T, N >::set( const size_t view,
+                                      const FrustumCuller< T >& culler )
+{
+    for( size_t i = 0; i < 6; ++i )
+    {
+        const vec4& plane = culler.getPlane( i );
+        _planes[ view * 6 + i ] = plane;
+        _absNormals[ view * 6 + i ] = vec3( std::abs( plane.x( )),
+                                            std::abs( plane.y( )),
+                                            std::abs( plane.z( )));
+    }
+}
+
+template< typename T, size_t N > template< class O >
+class MultiFrustumCuller< T, N >::_Batch
+{
+public:
+    typedef void result_type;
+
+    _Batch( const MultiFrustumCuller& culler, const O& objects,
+            const size_t n, uint32_t* views )
+        : _culler( culler ), _objects( objects ), _n( n ), _views( views )
+    {}
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        typedef simd::Scalar< T > S;
+
+        // uint32_t and int32_t may alias, and the masks are below 2^16
+        int32_t* views = reinterpret_cast< int32_t* >( _views );
+        const size_t end = _n - _n % P::width;
+        size_t i = 0;
+        for( ; i < end; i += P::width )
+        {
+            typename P::type masks;
+            _culler.template _test< P >( _objects, i, masks );
+            P::storeInt( views + i, masks );
+        }
+        for( ; i < _n; ++i )
+        {
+            T masks;
+            _culler.template _test< S >( _objects, i, masks );
+            S::storeInt( views + i, masks );
+        }
+    }
+
+private:
+    const MultiFrustumCuller& _culler;
+    const O _objects;
+    const size_t _n;
+    uint32_t* const _views;
+};
+
+VMMLIB_SIMD_KERNELS_BEGIN
+template< typename T, size_t N > template< class P > inline
+void MultiFrustumCuller< T, N >::_test( const _Spheres& spheres, const size_t i,
+                                        typename P::type& views ) const
+{
+    typedef typename P::type V;
+    const V cx = P::load( spheres.x + i );
+    const V cy = P::load( spheres.y + i );
+    const V cz = P::load( spheres.z + i );
+    const V r = P::sub( P::set( 0 ), P::load( spheres.radius + i ));
+    const V zero = P::set( 0 );
+
+    views = zero;
+    for( size_t j = 0; j < N; ++j )
+    {
+        // visible unless behind any plane of the view
+        V distance;
+        detail::computeMinPlaneDistance< P >( _planes + j * 6, cx, cy, cz,
+                                              distance );
+        views = P::add( views, P::select( P::gt( distance, r ),
+                                          P::set( T( 1u << j )), zero ));
+    }
+}
+
+template< typename T, size_t N > template< class P > inline
+void MultiFrustumCuller< T, N >::_test( const _Boxes& boxes, const size_t i,
+                                        typename P::type& views ) const
+{
+    typedef typename P::type V;
+    V center[3], extent[3];
+    detail::loadBoxes< P >( boxes, i, center, extent );
+    const V zero = P::set( 0 );
+
+    views = zero;
+    for( size_t j = 0; j < N; ++j )
+    {
+        // visible unless the far corner is behind any plane of the view
+        V minFar = P::set( std::numeric_limits< T >::max( ));
+        for( size_t k = j * 6; k < j * 6 + 6; ++k )
+        {
+            V d, n;
+            detail::computePlaneDistance< P >( _planes[ k ], center[0],
+                                               center[1], center[2], d );
+            detail::computeBoxExtent< P >( _absNormals[ k ], extent, n );
+            minFar = P::min( minFar, P::add( d, n ));
+        }
+        views = P::add( views, P::select( P::gt( minFar, zero ),
+                                          P::set( T( 1u << j )), zero ));
+    }
+}
+VMMLIB_SIMD_KERNELS_END
+
+template< typename T, size_t N >
+uint32_t MultiFrustumCuller< T, N >::test( const vec4& sphere ) const
+{
+    const _Spheres spheres = { &sphere.array[0], &sphere.array[1],
+                               &sphere.array[2], &sphere.array[3] };
+    uint32_t views;
+    _Batch< _Spheres >( *this, spheres, 1, &views )
+        .template run< SIMD_SCALAR >();
+    return views;
+}
+
+template< typename T, size_t N >
+uint32_t MultiFrustumCuller< T, N >::test( const AABB< T >& aabb ) const
+{
+    const T* min = aabb.getMin().array;
+    const T* max = aabb.getMax().array;
+    const _Boxes boxes = { &min[0], &min[1], &min[2],
+                           &max[0], &max[1], &max[2] };
+    uint32_t views;
+    _Batch< _Boxes >( *this, boxes, 1, &views ).template run< SIMD_SCALAR >();
+    return views;
+}
+
+template< typename T, size_t N >
+void MultiFrustumCuller< T, N >::test( const T* x, const T* y, const T* z,
+                                       const T* radius, const size_t n,
+                                       uint32_t* views ) const
+{
+    const _Spheres spheres = { x, y, z, radius };
+    dispatch( _Batch< _Spheres >( *this, spheres, n, views ));
+}
+
+template< typename T, size_t N >
+void MultiFrustumCuller< T, N >::test( const T* minX, const T* minY,
+                                       const T* minZ, const T* maxX,
+                                       const T* maxY, const T* maxZ,
+                                       const size_t n, uint32_t* views ) const
+{
+    const _Boxes boxes = { minX, minY, minZ, maxX, maxY, maxZ };
+    dispatch( _Batch< _Boxes >( *this, boxes, n, views ));
+}
+
+} // namespace vmml
+
+#endif // include protection
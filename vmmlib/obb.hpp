@@ -0,0 +1,782 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__ORIENTED_BOUNDING_BOX__HPP__
+#define __VMML__ORIENTED_BOUNDING_BOX__HPP__
+
+#include <vmmlib/aabb.hpp> // return value
+#include <vmmlib/dispatch.hpp> // used inline
+#include <vmmlib/matrix.hpp> // member
+#include <vmmlib/ray.hpp> // used inline
+#include <vmmlib/simd.hpp> // used inline
+#include <vmmlib/svd.hpp> // used inline
+#include <vmmlib/vector.hpp> // member
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace vmml
+{
+/**
+ * An oriented bounding box.
+ *
+ * The box is stored as its center, a rotation matrix whose columns are the
+ * axes of the box, and the half sizes along the axes. Arrays of boxes are
+ * arrays of 15 values, which the batch tests of FrustumCuller read directly.
+ */
+template< typename T > class OBB
+{
+public:
+    typedef vector< 3, T > vec3;
+
+    /** Create a box of size zero at the origin. */
+    OBB();
+
+    /**
+     * Create a new box.
+     *
+     * @param center the center of the box
+     * @param axes a rotation matrix with the axes of the box as columns
+     * @param extents the half sizes of the box along its axes
+     */
+    OBB( const vec3& center, const Matrix< 3, 3, T >& axes,
+         const vec3& extents );
+
+    /** Create a new box from an axis-aligned bounding box */
+    explicit OBB( const AABB< T >& aabb );
+
+    /**
+     * Create the box aligned with the principal components of n points.
+     *
+     * The axes are the eigenvectors of the covariance of the points. The
+     * boxes are tight for elongated point sets, but may be loose for point
+     * clouds whose density differs from their extent, e.g. dense clusters on
+     * one end of a model.
+     */
+    static OBB< T > fromPointsPCA( const vec3* points, size_t n );
+
+    /**
+     * Create a box of n points with the DiTO-14 algorithm of Larsson and
+     * Kaellberg, "Fast Computation of Tight-Fitting Oriented Bounding Boxes".
+     *
+     * The axes are chosen from the edges of a large ditetrahedron spanned by
+     * the extremal points along seven directions, and only the box over all
+     * points is computed from the full input. Faster than fromPointsPCA();
+     * the axis-aligned box of the points is returned unless a candidate is
+     * smaller on the extremal points. The result does not depend on the SIMD
+     * level or the number of threads.
+     */
+    static OBB< T > fromPointsDiTO( const vec3* points, size_t n );
+
+    /** @return the center of this box */
+    const vec3& getCenter() const { return _center; }
+
+    /** @return the rotation matrix with the axes of this box as columns */
+    const Matrix< 3, 3, T >& getAxes() const { return _axes; }
+
+    /** @return the half sizes of this box along its axes */
+    const vec3& getExtents() const { return _extents; }
+
+    /** @return the size of this box along its axes */
+    vec3 getSize() const { return _extents * T( 2 ); }
+
+    /** @return the volume of this box */
+    T getVolume() const;
+
+    /**
+     * @return the corner of this box on the positive side of the axes i
+     *         with the bit i set in index, on the negative side otherwise.
+     */
+    vec3 getCorner( size_t index ) const;
+
+    /** @return true if the given point is within this box. */
+    bool isIn( const vec3& point ) const;
+
+    /**
+     * @return true if this and the other box overlap, using the separating
+     *         axis test of Gottschalk et al., "OBBTree".
+     */
+    bool intersects( const OBB< T >& other ) const;
+
+    /** @return the axis-aligned bounding box of this box. */
+    AABB< T > getAABB() const;
+
+    /**
+     * @return the axis-aligned bounding box of this box transformed by an
+     *         affine transformation. Exact, i.e. the bounding box of the
+     *         transformed corners.
+     */
+    AABB< T > getAABB( const Matrix< 4, 4, T >& transform ) const;
+
+    /** @return true if this and the other box are identical */
+    bool operator==( const OBB< T >& other ) const;
+
+    /** @return true if this and the other box are not identical */
+    bool operator!=( const OBB< T >& other ) const;
+
+private:
+    vec3 _center;
+    Matrix< 3, 3, T > _axes;
+    vec3 _extents;
+
+    static OBB< T > _fit( const vec3* points, size_t n,
+                          const Matrix< 3, 3, T >& axes );
+    static void _evaluate( const vec3* points, size_t n, const vec3& u,
+                           const vec3& w, Matrix< 3, 3, T >& bestAxes,
+                           T& bestArea );
+};
+
+template< typename T > inline
+std::ostream& operator << ( std::ostream& os, const OBB< T >& obb )
+{
+    return os << obb.getCenter() << " +- " << obb.getExtents() << " along "
+              << std::endl << obb.getAxes();
+}
+
+// - implementation -
+
+namespace detail
+{
+VMMLIB_SIMD_KERNELS_BEGIN
+/**
+ * The minimum and maximum projections of a range of points onto K
+ * directions, and the first points reaching them, run by dispatch().
+ */
+template< typename T, size_t K > class ExtremalPointsRange
+{
+public:
+    typedef void result_type;
+
+    ExtremalPointsRange( const vector< 3, T >* points, const size_t n,
+                         const vector< 3, T >* directions, T* minValues,
+                         T* maxValues, size_t* minIndices,
+                         size_t* maxIndices )
+        : _points( points->array )
+        , _n( n )
+        , _minValues( minValues )
+        , _maxValues( maxValues )
+        , _minIndices( minIndices )
+        , _maxIndices( maxIndices )
+    {
+        for( size_t k = 0; k < K; ++k )
+            for( size_t j = 0; j < 3; ++j )
+                _directions[ 3 * k + j ] = directions[k].array[j];
+    }
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        typedef simd::Scalar< T > S;
+        typedef typename P::type V;
+
+        // Indices are exact in T for the chunk sizes of computeExtremes()
+        static const T lanes[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                     12, 13, 14, 15 };
+        V minV[K], maxV[K], minI[K], maxI[K];
+        for( size_t k = 0; k < K; ++k )
+        {
+            minV[k] = P::set( std::numeric_limits< T >::max( ));
+            maxV[k] = P::set( -std::numeric_limits< T >::max( ));
+            minI[k] = maxI[k] = P::set( 0 );
+        }
+        const size_t end = _n - _n % P::width;
+        for( size_t i = 0; i < end; i += P::width )
+            _update< P >( i, P::add( P::set( T( i )), P::load( lanes )),
+                          minV, maxV, minI, maxI );
+
+        // reduce the lanes, keeping the first point of equal projections
+        T minS[K], maxS[K], minIS[K], maxIS[K];
+        for( size_t k = 0; k < K; ++k )
+        {
+            T values[ 16 ], indices[ 16 ];
+            P::store( values, minV[k] );
+            P::store( indices, minI[k] );
+            minS[k] = values[0];
+            minIS[k] = indices[0];
+            for( size_t j = 1; j < P::width; ++j )
+                if( values[j] < minS[k] ||
+                    ( values[j] == minS[k] && indices[j] < minIS[k] ))
+                {
+                    minS[k] = values[j];
+                    minIS[k] = indices[j];
+                }
+
+            P::store( values, maxV[k] );
+            P::store( indices, maxI[k] );
+            maxS[k] = values[0];
+            maxIS[k] = indices[0];
+            for( size_t j = 1; j < P::width; ++j )
+                if( values[j] > maxS[k] ||
+                    ( values[j] == maxS[k] && indices[j] < maxIS[k] ))
+                {
+                    maxS[k] = values[j];
+                    maxIS[k] = indices[j];
+                }
+        }
+
+        for( size_t i = end; i < _n; ++i )
+            _update< S >( i, T( i ), minS, maxS, minIS, maxIS );
+
+        for( size_t k = 0; k < K; ++k )
+        {
+            _minValues[k] = minS[k];
+            _maxValues[k] = maxS[k];
+            _minIndices[k] = size_t( minIS[k] );
+            _maxIndices[k] = size_t( maxIS[k] );
+        }
+    }
+
+private:
+    const T* const _points;
+    const size_t _n;
+    T _directions[ 3 * K ];
+    T* const _minValues;
+    T* const _maxValues;
+    size_t* const _minIndices;
+    size_t* const _maxIndices;
+
+    template< class P >
+    VMMLIB_SIMD_INLINE void _update( const size_t i,
+                                     const typename P::type& index,
+                                     typename P::type* minV,
+                                     typename P::type* maxV,
+                                     typename P::type* minI,
+                                     typename P::type* maxI ) const
+    {
+        typedef typename P::type V;
+        const V x = P::gather( _points + 3 * i, 3 );
+        const V y = P::gather( _points + 3 * i + 1, 3 );
+        const V z = P::gather( _points + 3 * i + 2, 3 );
+        for( size_t k = 0; k < K; ++k )
+        {
+            const T* direction = _directions + 3 * k;
+            // without fused multiply-add, for the same points at any level
+            const V d = P::add( P::add( P::mul( x, P::set( direction[0] )),
+                                        P::mul( y, P::set( direction[1] ))),
+                                P::mul( z, P::set( direction[2] )));
+            const typename P::mask less = P::lt( d, minV[k] );
+            minV[k] = P::select( less, d, minV[k] );
+            minI[k] = P::select( less, index, minI[k] );
+            const typename P::mask greater = P::gt( d, maxV[k] );
+            maxV[k] = P::select( greater, d, maxV[k] );
+            maxI[k] = P::select( greater, index, maxI[k] );
+        }
+    }
+};
+VMMLIB_SIMD_KERNELS_END
+
+/**
+ * Creates the ExtremalPointsRange of a chunk, see dispatchChunks(), which
+ * writes the K extremes of the chunk to its slot of the chunk results.
+ */
+template< typename T, size_t K > class ExtremalPointsChunks
+{
+public:
+    ExtremalPointsChunks( const vector< 3, T >* points,
+                          const vector< 3, T >* directions, T* minValues,
+                          T* maxValues, size_t* minIndices,
+                          size_t* maxIndices )
+        : _points( points ), _directions( directions )
+        , _minValues( minValues ), _maxValues( maxValues )
+        , _minIndices( minIndices ), _maxIndices( maxIndices )
+    {}
+
+    ExtremalPointsRange< T, K > operator()( const size_t begin,
+                                            const size_t count ) const
+    {
+        const size_t slot = begin / DISPATCH_CHUNK_SIZE * K;
+        return ExtremalPointsRange< T, K >(
+            _points + begin, count, _directions, _minValues + slot,
+            _maxValues + slot, _minIndices + slot, _maxIndices + slot );
+    }
+
+private:
+    const vector< 3, T >* const _points;
+    const vector< 3, T >* const _directions;
+    T* const _minValues;
+    T* const _maxValues;
+    size_t* const _minIndices;
+    size_t* const _maxIndices;
+};
+
+/**
+ * Compute the minimum and maximum projections of n > 0 points onto K
+ * directions, and the indices of the first points reaching them.
+ *
+ * The chunks run in parallel with OpenMP and are merged in order, which gives
+ * the same result for any number of threads.
+ */
+template< typename T, size_t K >
+void computeExtremes( const vector< 3, T >* points, const size_t n,
+                      const vector< 3, T >* directions, T* minValues,
+                      T* maxValues, size_t* minIndices, size_t* maxIndices )
+{
+    const size_t nChunks = getNumDispatchChunks( n );
+    std::vector< T > mins( nChunks * K ), maxs( nChunks * K );
+    std::vector< size_t > minIdx( nChunks * K ), maxIdx( nChunks * K );
+    dispatchChunks( n, ExtremalPointsChunks< T, K >(
+                           points, directions, &mins[0], &maxs[0],
+                           &minIdx[0], &maxIdx[0] ));
+
+    for( size_t k = 0; k < K; ++k )
+    {
+        minValues[k] = mins[k];
+        maxValues[k] = maxs[k];
+        minIndices[k] = minIdx[k];
+        maxIndices[k] = maxIdx[k];
+        for( size_t i = 1; i < nChunks; ++i )
+        {
+            const size_t begin = i * DISPATCH_CHUNK_SIZE;
+            if( mins[ i * K + k ] < minValues[k] )
+            {
+                minValues[k] = mins[ i * K + k ];
+                minIndices[k] = begin + minIdx[ i * K + k ];
+            }
+            if( maxs[ i * K + k ] > maxValues[k] )
+            {
+                maxValues[k] = maxs[ i * K + k ];
+                maxIndices[k] = begin + maxIdx[ i * K + k ];
+            }
+        }
+    }
+}
+} // namespace detail
+
+template< typename T >
+OBB< T >::OBB()
+    : _center( T( 0 ))
+    , _extents( T( 0 ))
+{}
+
+template< typename T >
+OBB< T >::OBB( const vec3& center, const Matrix< 3, 3, T >& axes,
+               const vec3& extents )
+    : _center( center )
+    , _axes( axes )
+    , _extents( extents )
+{}
+
+template< typename T >
+OBB< T >::OBB( const AABB< T >& aabb )
+    : _center( aabb.getCenter( ))
+    , _extents( aabb.getSize() * T( .5 ))
+{}
+
+template< typename T >
+OBB< T > OBB< T >::_fit( const vec3* points, const size_t n,
+                         const Matrix< 3, 3, T >& axes )
+{
+    vec3 directions[3];
+    for( size_t i = 0; i < 3; ++i )
+        directions[i] = axes.getColumn( i );
+
+    T minValues[3], maxValues[3];
+    size_t minIndices[3], maxIndices[3];
+    detail::computeExtremes< T, 3 >( points, n, directions, minValues,
+                                     maxValues, minIndices, maxIndices );
+
+    vec3 center( T( 0 ));
+    vec3 extents;
+    for( size_t i = 0; i < 3; ++i )
+    {
+        center += directions[i] * (( minValues[i] + maxValues[i] ) * T( .5 ));
+        extents[i] = ( maxValues[i] - minValues[i] ) * T( .5 );
+    }
+    return OBB< T >( center, axes, extents );
+}
+
+template< typename T >
+OBB< T > OBB< T >::fromPointsPCA( const vec3* points, const size_t n )
+{
+    if( n == 0 )
+        return OBB< T >();
+
+    vec3 mean( T( 0 ));
+    for( size_t i = 0; i < n; ++i )
+        mean += points[i];
+    mean /= T( n );
+
+    T xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0;
+    for( size_t i = 0; i < n; ++i )
+    {
+        const vec3 p = points[i] - mean;
+        xx += p.x() * p.x();
+        xy += p.x() * p.y();
+        xz += p.x() * p.z();
+        yy += p.y() * p.y();
+        yz += p.y() * p.z();
+        zz += p.z() * p.z();
+    }
+    const T values[] = { xx, xy, xz, xy, yy, yz, xz, yz, zz };
+    const Matrix< 3, 3, T > covariance( values, values + 9 );
+
+    vec3 variances;
+    Matrix< 3, 3, T > axes;
+    computeEigen( covariance, variances, axes );
+    return _fit( points, n, axes );
+}
+
+template< typename T >
+void OBB< T >::_evaluate( const vec3* points, const size_t n, const vec3& u,
+                          const vec3& w, Matrix< 3, 3, T >& bestAxes,
+                          T& bestArea )
+{
+    const vec3 v = cross( w, u );
+    T minU = std::numeric_limits< T >::max(), maxU = -minU;
+    T minV = minU, maxV = maxU, minW = minU, maxW = maxU;
+    for( size_t i = 0; i < n; ++i )
+    {
+        const T pu = points[i].dot( u );
+        const T pv = points[i].dot( v );
+        const T pw = points[i].dot( w );
+        minU = std::min( minU, pu );
+        maxU = std::max( maxU, pu );
+        minV = std::min( minV, pv );
+        maxV = std::max( maxV, pv );
+        minW = std::min( minW, pw );
+        maxW = std::max( maxW, pw );
+    }
+
+    // half the surface area
+    const T su = maxU - minU, sv = maxV - minV, sw = maxW - minW;
+    const T area = su * sv + sv * sw + sw * su;
+    if( area < bestArea )
+    {
+        bestArea = area;
+        bestAxes.setColumn( 0, u );
+        bestAxes.setColumn( 1, v );
+        bestAxes.setColumn( 2, w );
+    }
+}
+
+template< typename T >
+OBB< T > OBB< T >::fromPointsDiTO( const vec3* points, const size_t n )
+{
+    if( n == 0 )
+        return OBB< T >();
+
+    // The extremal points along the axes and the diagonals of the unit cube
+    const vec3 directions[7] = { vec3( 1, 0, 0 ), vec3( 0, 1, 0 ),
+                                 vec3( 0, 0, 1 ), vec3( 1, 1, 1 ),
+                                 vec3( 1, 1, -1 ), vec3( 1, -1, 1 ),
+                                 vec3( 1, -1, -1 ) };
+    T minValues[7], maxValues[7];
+    size_t minIndices[7], maxIndices[7];
+    detail::computeExtremes< T, 7 >( points, n, directions, minValues,
+                                     maxValues, minIndices, maxIndices );
+    vec3 selected[14];
+    for( size_t k = 0; k < 7; ++k )
+    {
+        selected[ 2 * k ] = points[ minIndices[k]];
+        selected[ 2 * k + 1 ] = points[ maxIndices[k]];
+    }
+
+    // The axis-aligned box is exact from the first three directions
+    Matrix< 3, 3, T > axes;
+    const T sx = maxValues[0] - minValues[0];
+    const T sy = maxValues[1] - minValues[1];
+    const T sz = maxValues[2] - minValues[2];
+    T area = sx * sy + sy * sz + sz * sx;
+
+    // The base triangle: the most distant pair of extremal points, and the
+    // extremal point most distant from the line through them
+    size_t longest = 0;
+    T longestLength = 0;
+    for( size_t k = 0; k < 7; ++k )
+    {
+        const T length = ( selected[ 2 * k + 1 ] - selected[ 2 * k ] )
+                             .squared_length();
+        if( length > longestLength )
+        {
+            longest = k;
+            longestLength = length;
+        }
+    }
+    if( longestLength == 0 ) // all points are equal
+        return OBB< T >( points[0], axes, vec3( T( 0 )));
+
+    const vec3 p0 = selected[ 2 * longest ];
+    const vec3 p1 = selected[ 2 * longest + 1 ];
+    const vec3 e0 = normalize( p1 - p0 );
+    vec3 p2 = p0;
+    T farthest = 0;
+    for( size_t i = 0; i < 14; ++i )
+    {
+        const vec3 offset = selected[i] - p0;
+        const T distance = ( offset - e0 * offset.dot( e0 )).squared_length();
+        if( distance > farthest )
+        {
+            farthest = distance;
+            p2 = selected[i];
+        }
+    }
+
+    const T epsilon = std::numeric_limits< T >::epsilon();
+    if( farthest <= epsilon * longestLength ) // collinear points
+    {
+        size_t smallest = 0;
+        for( size_t i = 1; i < 3; ++i )
+            if( std::abs( e0[i] ) < std::abs( e0[ smallest ] ))
+                smallest = i;
+        vec3 axis( T( 0 ));
+        axis[ smallest ] = 1;
+        _evaluate( selected, 14, e0, normalize( cross( e0, axis )), axes,
+                   area );
+        return _fit( points, n, axes );
+    }
+
+    const vec3 e1 = normalize( p2 - p1 );
+    const vec3 e2 = normalize( p0 - p2 );
+    const vec3 normal = normalize( cross( e0, e1 ));
+    _evaluate( selected, 14, e0, normal, axes, area );
+    _evaluate( selected, 14, e1, normal, axes, area );
+    _evaluate( selected, 14, e2, normal, axes, area );
+
+    // The ditetrahedron: the triangles to the extremal points along the
+    // normal of the base triangle on both of its sides
+    const T base = normal.dot( p0 );
+    T below = 0, above = 0;
+    vec3 q0 = p0, q1 = p0;
+    for( size_t i = 0; i < 14; ++i )
+    {
+        const T distance = normal.dot( selected[i] ) - base;
+        if( distance < below )
+        {
+            below = distance;
+            q0 = selected[i];
+        }
+        if( distance > above )
+        {
+            above = distance;
+            q1 = selected[i];
+        }
+    }
+
+    const T minDistance = epsilon * std::sqrt( longestLength );
+    const vec3 tips[2] = { q0, q1 };
+    const bool valid[2] = { -below > minDistance, above > minDistance };
+    const vec3 corners[3] = { p0, p1, p2 };
+    const vec3 edges[3] = { e0, e1, e2 };
+    for( size_t i = 0; i < 2; ++i )
+    {
+        if( !valid[i] )
+            continue;
+        for( size_t j = 0; j < 3; ++j )
+        {
+            const vec3 f0 = normalize( tips[i] - corners[j] );
+            const vec3 f1 = normalize( tips[i] - corners[( j + 1 ) % 3] );
+            const vec3 face = normalize( cross( edges[j], f0 ));
+            _evaluate( selected, 14, edges[j], face, axes, area );
+            _evaluate( selected, 14, f0, face, axes, area );
+            _evaluate( selected, 14, f1, face, axes, area );
+        }
+    }
+    return _fit( points, n, axes );
+}
+
+template< typename T > T OBB< T >::getVolume() const
+{
+    return _extents.x() * _extents.y() * _extents.z() * T( 8 );
+}
+
+template< typename T >
+vector< 3, T > OBB< T >::getCorner( const size_t index ) const
+{
+    vec3 corner = _center;
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const T extent = ( index >> i ) & 1u ? _extents[i] : -_extents[i];
+        for( size_t j = 0; j < 3; ++j )
+            corner[j] += _axes.array[ 3 * i + j ] * extent;
+    }
+    return corner;
+}
+
+template< typename T > bool OBB< T >::isIn( const vec3& point ) const
+{
+    const vec3 offset = point - _center;
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const T distance = offset.x() * _axes.array[ 3 * i ] +
+                           offset.y() * _axes.array[ 3 * i + 1 ] +
+                           offset.z() * _axes.array[ 3 * i + 2 ];
+        if( std::abs( distance ) > _extents[i] )
+            return false;
+    }
+    return true;
+}
+
+template< typename T >
+bool OBB< T >::intersects( const OBB< T >& other ) const
+{
+    // see Ericson, "Real-Time Collision Detection", 4.4.1: the other box in
+    // the frame of this box
+    const T* a = _axes.array;
+    const T* b = other._axes.array;
+    const vec3 offset = other._center - _center;
+    T r[3][3], absR[3][3];
+    T t[3];
+
+    // The epsilon counters the rounding of the cross products of parallel
+    // edges, which are near zero and would test arbitrary axes
+    const T epsilon = std::numeric_limits< T >::epsilon() * 16;
+    for( size_t i = 0; i < 3; ++i )
+    {
+        for( size_t j = 0; j < 3; ++j )
+        {
+            r[i][j] = a[ 3 * i ] * b[ 3 * j ] +
+                      a[ 3 * i + 1 ] * b[ 3 * j + 1 ] +
+                      a[ 3 * i + 2 ] * b[ 3 * j + 2 ];
+            absR[i][j] = std::abs( r[i][j] ) + epsilon;
+        }
+        t[i] = offset.x() * a[ 3 * i ] + offset.y() * a[ 3 * i + 1 ] +
+               offset.z() * a[ 3 * i + 2 ];
+    }
+
+    const T* ea = _extents.array;
+    const T* eb = other._extents.array;
+
+    // the axes of this box
+    for( size_t i = 0; i < 3; ++i )
+        if( std::abs( t[i] ) > ea[i] + eb[0] * absR[i][0] +
+                               eb[1] * absR[i][1] + eb[2] * absR[i][2] )
+        {
+            return false;
+        }
+
+    // the axes of the other box
+    for( size_t j = 0; j < 3; ++j )
+        if( std::abs( t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j] ) >
+            ea[0] * absR[0][j] + ea[1] * absR[1][j] + ea[2] * absR[2][j] +
+            eb[j] )
+        {
+            return false;
+        }
+
+    // the cross products of the axes a_i x b_j
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const size_t i1 = ( i + 1 ) % 3;
+        const size_t i2 = ( i + 2 ) % 3;
+        for( size_t j = 0; j < 3; ++j )
+        {
+            const size_t j1 = ( j + 1 ) % 3;
+            const size_t j2 = ( j + 2 ) % 3;
+            const T ra = ea[ i1 ] * absR[ i2 ][j] + ea[ i2 ] * absR[ i1 ][j];
+            const T rb = eb[ j1 ] * absR[i][ j2 ] + eb[ j2 ] * absR[i][ j1 ];
+            if( std::abs( t[ i2 ] * r[ i1 ][j] - t[ i1 ] * r[ i2 ][j] ) >
+                ra + rb )
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template< typename T > AABB< T > OBB< T >::getAABB() const
+{
+    vec3 extents;
+    for( size_t j = 0; j < 3; ++j )
+        extents[j] = std::abs( _axes.array[j] ) * _extents[0] +
+                     std::abs( _axes.array[ 3 + j ] ) * _extents[1] +
+                     std::abs( _axes.array[ 6 + j ] ) * _extents[2];
+    return AABB< T >( _center - extents, _center + extents );
+}
+
+template< typename T >
+AABB< T > OBB< T >::getAABB( const Matrix< 4, 4, T >& transform ) const
+{
+    // The axes scaled by the extents, transformed without translation: the
+    // extent along each world axis is the sum of their absolute components
+    const T* m = transform.array;
+    vec3 center, extents( T( 0 ));
+    for( size_t j = 0; j < 3; ++j )
+        center[j] = m[j] * _center[0] + m[ 4 + j ] * _center[1] +
+                    m[ 8 + j ] * _center[2] + m[ 12 + j ];
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const T* axis = _axes.array + 3 * i;
+        for( size_t j = 0; j < 3; ++j )
+            extents[j] += std::abs( m[j] * axis[0] + m[ 4 + j ] * axis[1] +
+                                    m[ 8 + j ] * axis[2] ) * _extents[i];
+    }
+    return AABB< T >( center - extents, center + extents );
+}
+
+template< typename T >
+bool OBB< T >::operator==( const OBB< T >& other ) const
+{
+    return _center == other._center && _axes == other._axes &&
+           _extents == other._extents;
+}
+
+template< typename T >
+bool OBB< T >::operator!=( const OBB< T >& other ) const
+{
+    return !( *this == other );
+}
+
+template< typename T >
+T Ray< T >::test( const OBB< T >& obb ) const
+{
+    const vec3 offset = _origin - obb.getCenter();
+    const T* axes = obb.getAxes().array;
+
+    T entry = -std::numeric_limits< T >::max();
+    T exit = std::numeric_limits< T >::max();
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const vec3 axis( axes + 3 * i );
+        const T origin = axis.dot( offset );
+        const T invDirection = T( 1 ) / axis.dot( _direction );
+        const T extent = obb.getExtents()[i];
+        T t0 = ( -extent - origin ) * invDirection;
+        T t1 = ( extent - origin ) * invDirection;
+        if( invDirection < 0 )
+            std::swap( t0, t1 );
+        // written to ignore the NaN of a ray in the plane of a slab
+        entry = t0 > entry ? t0 : entry;
+        exit = t1 < exit ? t1 : exit;
+    }
+
+    if( entry > exit || exit < 0 )
+        return -1.f;
+    return entry >= 0 ? entry : exit;
+}
+
+} // namespace vmml
+
+#endif
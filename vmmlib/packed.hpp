@@ -0,0 +1,988 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__PACKED__HPP__
+#define __VMML__PACKED__HPP__
+
+/**
+ * @file packed.hpp
+ *
+ * Compact storage formats of rotations, unit vectors and values, e.g. for
+ * streaming animations and poses. The batch encode() and decode() of arrays
+ * run with the widest SIMD instructions of the CPU, see dispatch.hpp, and in
+ * parallel chunks when compiled with OpenMP.
+ *
+ * The error bounds of the quaternions and unit vectors are the maximum
+ * absolute errors of the decoded components, measured for float over 10^6
+ * random values.
+ */
+
+#include <vmmlib/dispatch.hpp> // used inline
+#include <vmmlib/quaternion.hpp> // used inline
+#include <vmmlib/simd.hpp> // used inline
+#include <vmmlib/types.hpp>
+#include <vmmlib/vector.hpp> // used inline
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+
+namespace vmml
+{
+/**
+ * A unit quaternion in 32 bits, as the index of its largest component in two
+ * bits and its three other components in ten bits each.
+ *
+ * The largest component is recomputed from the others, which lie in
+ * [-1/sqrt(2), 1/sqrt(2)]. Decoded quaternions are unit length, with a
+ * positive largest component since q and -q are the same rotation. The
+ * error of the components is below 2e-3, and zero components are exact.
+ */
+class PackedQuaternion32
+{
+public:
+    /** Construct the identity rotation. */
+    PackedQuaternion32() : _bits( 0xdff7fdffu ) {}
+
+    /** Construct from the bits of an encoded quaternion. */
+    explicit PackedQuaternion32( const uint32_t bits ) : _bits( bits ) {}
+
+    /** Encode a unit quaternion. */
+    template< typename T >
+    explicit PackedQuaternion32( const Quaternion< T >& quaternion );
+
+    /** @return the decoded unit quaternion. */
+    template< typename T > Quaternion< T > get() const;
+
+    uint32_t getBits() const { return _bits; }
+
+    bool operator == ( const PackedQuaternion32& other ) const
+        { return _bits == other._bits; }
+    bool operator != ( const PackedQuaternion32& other ) const
+        { return _bits != other._bits; }
+
+private:
+    uint32_t _bits;
+};
+
+/**
+ * A unit quaternion in 48 bits, as the index of its largest component in two
+ * bits and its three other components in 15 bits each.
+ *
+ * Like PackedQuaternion32, with an error of the components below 6e-5.
+ */
+class PackedQuaternion48
+{
+public:
+    /** Construct the identity rotation. */
+    PackedQuaternion48();
+
+    /** Construct from the bits of an encoded quaternion. */
+    explicit PackedQuaternion48( const uint16_t bits[3] );
+
+    /** Encode a unit quaternion. */
+    template< typename T >
+    explicit PackedQuaternion48( const Quaternion< T >& quaternion );
+
+    /** @return the decoded unit quaternion. */
+    template< typename T > Quaternion< T > get() const;
+
+    const uint16_t* getBits() const { return _bits; }
+
+    bool operator == ( const PackedQuaternion48& other ) const;
+    bool operator != ( const PackedQuaternion48& other ) const
+        { return !( *this == other ); }
+
+private:
+    uint16_t _bits[3];
+};
+
+/**
+ * A unit vector in 16 bits, as its octahedral projection with eight bits per
+ * coordinate.
+ *
+ * The vector is projected onto the octahedron |x| + |y| + |z| = 1, whose
+ * lower half is folded over the upper half to map all directions to a
+ * square. Decoded vectors are unit length. The error of the components is
+ * below 1.6e-2, and the axes are exact.
+ */
+class PackedNormal16
+{
+public:
+    /** Construct the z axis. */
+    PackedNormal16() : _bits( 0x7f7f ) {}
+
+    /** Construct from the bits of an encoded vector. */
+    explicit PackedNormal16( const uint16_t bits ) : _bits( bits ) {}
+
+    /** Encode a unit vector. */
+    template< typename T >
+    explicit PackedNormal16( const vector< 3, T >& normal );
+
+    /** @return the decoded unit vector. */
+    template< typename T > vector< 3, T > get() const;
+
+    uint16_t getBits() const { return _bits; }
+
+    bool operator == ( const PackedNormal16& other ) const
+        { return _bits == other._bits; }
+    bool operator != ( const PackedNormal16& other ) const
+        { return _bits != other._bits; }
+
+private:
+    uint16_t _bits;
+};
+
+/**
+ * A unit vector in 32 bits, as its octahedral projection with 16 bits per
+ * coordinate.
+ *
+ * Like PackedNormal16, with an error of the components below 6e-5.
+ */
+class PackedNormal32
+{
+public:
+    /** Construct the z axis. */
+    PackedNormal32() : _bits( 0x7fff7fffu ) {}
+
+    /** Construct from the bits of an encoded vector. */
+    explicit PackedNormal32( const uint32_t bits ) : _bits( bits ) {}
+
+    /** Encode a unit vector. */
+    template< typename T >
+    explicit PackedNormal32( const vector< 3, T >& normal );
+
+    /** @return the decoded unit vector. */
+    template< typename T > vector< 3, T > get() const;
+
+    uint32_t getBits() const { return _bits; }
+
+    bool operator == ( const PackedNormal32& other ) const
+        { return _bits == other._bits; }
+    bool operator != ( const PackedNormal32& other ) const
+        { return _bits != other._bits; }
+
+private:
+    uint32_t _bits;
+};
+
+/**
+ * An IEEE 754 half-precision float.
+ *
+ * Values are rounded to the nearest half, ties to even, with a relative error
+ * of at most 2^-11 in the normal range up to 65504 and an absolute error of
+ * at most 2^-25 below 2^-14. Larger values become infinite; infinities and
+ * NaNs are preserved. Doubles are rounded to float first, which may differ
+ * from the exact rounding when the double lies within 2^-29 relative
+ * distance of a tie.
+ */
+class Half
+{
+public:
+    /** Construct a positive zero. */
+    Half() : _bits( 0 ) {}
+
+    /** Round a value to the nearest half. */
+    template< typename T > explicit Half( T value );
+
+    /** @return the half with the given bits. */
+    static Half fromBits( uint16_t bits );
+
+    /** @return the exact value of the half. */
+    template< typename T > T get() const;
+
+    uint16_t getBits() const { return _bits; }
+
+    /** @return true if both halves have the same bits. */
+    bool operator == ( const Half& other ) const
+        { return _bits == other._bits; }
+    bool operator != ( const Half& other ) const
+        { return _bits != other._bits; }
+
+private:
+    uint16_t _bits;
+};
+
+/** @name Batch encoding and decoding */
+//@{
+/** Encode n unit quaternions. */
+template< typename T >
+void encode( const Quaternion< T >* input, PackedQuaternion32* output,
+             size_t n );
+
+/** Encode n unit quaternions. */
+template< typename T >
+void encode( const Quaternion< T >* input, PackedQuaternion48* output,
+             size_t n );
+
+/** Encode n unit vectors. */
+template< typename T >
+void encode( const vector< 3, T >* input, PackedNormal16* output, size_t n );
+
+/** Encode n unit vectors. */
+template< typename T >
+void encode( const vector< 3, T >* input, PackedNormal32* output, size_t n );
+
+/** Round n values to halves. */
+template< typename T > void encode( const T* input, Half* output, size_t n );
+
+/** Round the components of n vectors to M * n halves. */
+template< size_t M, typename T >
+void encode( const vector< M, T >* input, Half* output, size_t n );
+
+/** Decode n quaternions. */
+template< typename T >
+void decode( const PackedQuaternion32* input, Quaternion< T >* output,
+             size_t n );
+
+/** Decode n quaternions. */
+template< typename T >
+void decode( const PackedQuaternion48* input, Quaternion< T >* output,
+             size_t n );
+
+/** Decode n unit vectors. */
+template< typename T >
+void decode( const PackedNormal16* input, vector< 3, T >* output, size_t n );
+
+/** Decode n unit vectors. */
+template< typename T >
+void decode( const PackedNormal32* input, vector< 3, T >* output, size_t n );
+
+/** Decode n halves. */
+template< typename T > void decode( const Half* input, T* output, size_t n );
+
+/** Decode M * n halves into n vectors. */
+template< size_t M, typename T >
+void decode( const Half* input, vector< M, T >* output, size_t n );
+//@}
+
+// - implementation -
+
+namespace detail
+{
+// The bit layouts of the packed formats. Each stores a number of quantized
+// values of the given bits, which are offset to be non-negative.
+struct Quaternion32Layout
+{
+    typedef uint32_t storage_type;
+    enum { BITS = 10, SIZE = 1 };
+
+    static void pack( const int32_t index, const int32_t* values,
+                      uint32_t* bits )
+    {
+        bits[0] = uint32_t( index ) << 30 | uint32_t( values[0] ) << 20 |
+                  uint32_t( values[1] ) << 10 | uint32_t( values[2] );
+    }
+
+    static void unpack( const uint32_t* bits, int32_t& index,
+                        int32_t* values )
+    {
+        index = int32_t( bits[0] >> 30 );
+        values[0] = int32_t( bits[0] >> 20 & 0x3ff );
+        values[1] = int32_t( bits[0] >> 10 & 0x3ff );
+        values[2] = int32_t( bits[0] & 0x3ff );
+    }
+};
+
+// The index bits are the top bits of the first two values
+struct Quaternion48Layout
+{
+    typedef uint16_t storage_type;
+    enum { BITS = 15, SIZE = 3 };
+
+    static void pack( const int32_t index, const int32_t* values,
+                      uint16_t* bits )
+    {
+        bits[0] = uint16_t( values[0] | ( index & 1 ) << 15 );
+        bits[1] = uint16_t( values[1] | ( index >> 1 ) << 15 );
+        bits[2] = uint16_t( values[2] );
+    }
+
+    static void unpack( const uint16_t* bits, int32_t& index,
+                        int32_t* values )
+    {
+        index = bits[0] >> 15 | ( bits[1] >> 15 ) << 1;
+        values[0] = bits[0] & 0x7fff;
+        values[1] = bits[1] & 0x7fff;
+        values[2] = bits[2];
+    }
+};
+
+struct Normal16Layout
+{
+    typedef uint16_t storage_type;
+    enum { BITS = 8 };
+
+    static void pack( const int32_t u, const int32_t v, uint16_t* bits )
+        { *bits = uint16_t( u << 8 | v ); }
+    static void unpack( const uint16_t* bits, int32_t& u, int32_t& v )
+        { u = *bits >> 8; v = *bits & 0xff; }
+};
+
+struct Normal32Layout
+{
+    typedef uint32_t storage_type;
+    enum { BITS = 16 };
+
+    static void pack( const int32_t u, const int32_t v, uint32_t* bits )
+        { *bits = uint32_t( u ) << 16 | uint32_t( v ); }
+    static void unpack( const uint32_t* bits, int32_t& u, int32_t& v )
+        { u = int32_t( *bits >> 16 ); v = int32_t( *bits & 0xffff ); }
+};
+
+// Quantize [-1, 1] to [0, 2 * offset] on a grid with an exact zero
+template< class Layout > struct Quantization
+{
+    enum { OFFSET = ( 1 << ( Layout::BITS - 1 )) - 1 };
+};
+
+// All bits of a if the condition holds, of b otherwise. The branchless
+// selects let the compiler vectorize the half conversion loops.
+inline uint32_t select( const bool condition, const uint32_t a,
+                        const uint32_t b )
+{
+    const uint32_t mask = 0u - uint32_t( condition );
+    return ( a & mask ) | ( b & ~mask );
+}
+
+inline uint32_t floatBits( const float value )
+{
+    uint32_t bits;
+    ::memcpy( &bits, &value, 4 );
+    return bits;
+}
+
+inline float bitsFloat( const uint32_t bits )
+{
+    float value;
+    ::memcpy( &value, &bits, 4 );
+    return value;
+}
+
+// The float rounded to the nearest half, ties to even, after F. Giesen
+inline uint16_t toHalf( const float value )
+{
+    const uint32_t sign = floatBits( value ) & 0x80000000u;
+    const uint32_t bits = floatBits( value ) ^ sign;
+
+    // infinite, NaN or overflowing to infinity
+    const uint32_t infinite = select( bits > 0x7f800000u, 0x7e00u, 0x7c00u );
+
+    // denormalized half: let the float addition align and round the mantissa
+    const uint32_t denormal = floatBits( bitsFloat( bits ) + 0.5f ) -
+                              0x3f000000u;
+
+    // normalized half: rebias the exponent, round the mantissa to even
+    const uint32_t normal =
+        ( bits + 0xc8000fffu + ( bits >> 13 & 1 )) >> 13;
+
+    const uint32_t half = select( bits >= 0x47800000u, infinite,
+                              select( bits < 0x38800000u, denormal, normal ));
+    return uint16_t( half | sign >> 16 );
+}
+
+// The exact float of a half, after F. Giesen
+inline float fromHalf( const uint16_t half )
+{
+    const uint32_t exponentMask = 0x0f800000u; // the half exponent, shifted
+    const uint32_t shifted = uint32_t( half & 0x7fff ) << 13;
+    const uint32_t exponent = shifted & exponentMask;
+    const uint32_t rebiased = shifted + 0x38000000u;
+
+    // denormalized half: renormalize with a float subtraction, 2^-14
+    const uint32_t denormal = floatBits( bitsFloat( rebiased + 0x00800000u ) -
+                                         6.10351562e-05f );
+
+    const uint32_t bits = select( exponent == exponentMask,
+                                  rebiased + 0x38000000u, // infinite or NaN
+                              select( exponent == 0, denormal, rebiased ));
+    return bitsFloat( bits | uint32_t( half & 0x8000 ) << 16 );
+}
+
+VMMLIB_SIMD_KERNELS_BEGIN
+/** Encodes a range of unit quaternions, run by dispatch(). */
+template< typename T, class Layout > class EncodeQuaternions
+{
+public:
+    typedef void result_type;
+    typedef typename Layout::storage_type storage_type;
+
+    EncodeQuaternions( const Quaternion< T >* input, void* output,
+                       const size_t n )
+        : _input( reinterpret_cast< const T* >( input ))
+        , _output( reinterpret_cast< storage_type* >( output ))
+        , _n( n )
+    {}
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        const size_t end = _n - _n % P::width;
+        for( size_t i = 0; i < end; i += P::width )
+            _encode< P >( i );
+        for( size_t i = end; i < _n; ++i )
+            _encode< simd::Scalar< T > >( i );
+    }
+
+private:
+    const T* const _input;
+    storage_type* const _output;
+    const size_t _n;
+
+    template< class P >
+    VMMLIB_SIMD_INLINE void _encode( const size_t i ) const
+    {
+        typedef typename P::type V;
+        V q[4];
+        for( size_t j = 0; j < 4; ++j )
+            q[j] = P::gather( _input + 4 * i + j, 4 );
+
+        // the largest component and its sign, which is made positive
+        V index = P::set( 0 );
+        V largest = q[0];
+        V largestAbs = P::abs( q[0] );
+        for( size_t j = 1; j < 4; ++j )
+        {
+            const typename P::mask larger = P::gt( P::abs( q[j] ),
+                                                   largestAbs );
+            index = P::select( larger, P::set( T( j )), index );
+            largest = P::select( larger, q[j], largest );
+            largestAbs = P::max( P::abs( q[j] ), largestAbs );
+        }
+
+        // normalize, and scale [-1/sqrt(2), 1/sqrt(2)] to the grid
+        const T offset = T( Quantization< Layout >::OFFSET );
+        const V length = P::sqrt( P::madd( q[0], q[0], P::madd( q[1], q[1],
+                                  P::madd( q[2], q[2], P::mul( q[3], q[3] )))));
+        V scale = P::div( P::set( offset * T( 1.41421356237309504880 )),
+                          length );
+        scale = P::select( P::lt( largest, P::set( 0 )),
+                           P::sub( P::set( 0 ), scale ), scale );
+
+        // the other components in order, skipping the largest
+        int32_t indices[ P::width ];
+        int32_t values[3][ P::width ];
+        P::storeInt( indices, index );
+        for( size_t j = 0; j < 3; ++j )
+        {
+            const V value = P::select( P::lt( P::set( T( j )), index ), q[j],
+                                       q[j + 1] );
+            const V scaled = P::min( P::max( P::mul( value, scale ),
+                                             P::set( -offset )),
+                                     P::set( offset ));
+            P::storeInt( values[j], P::add( scaled, P::set( offset )));
+        }
+
+        for( size_t j = 0; j < P::width; ++j )
+        {
+            const int32_t lane[3] = { values[0][j], values[1][j],
+                                      values[2][j] };
+            Layout::pack( indices[j], lane,
+                          _output + Layout::SIZE * ( i + j ));
+        }
+    }
+};
+
+/** Decodes a range of unit quaternions, run by dispatch(). */
+template< typename T, class Layout > class DecodeQuaternions
+{
+public:
+    typedef void result_type;
+    typedef typename Layout::storage_type storage_type;
+
+    DecodeQuaternions( const void* input, Quaternion< T >* output,
+                       const size_t n )
+        : _input( reinterpret_cast< const storage_type* >( input ))
+        , _output( reinterpret_cast< T* >( output ))
+        , _n( n )
+    {}
+
+    // Unpacks a block before decoding it, see DecodeNormals
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        for( size_t i = 0; i < _n; i += BLOCK_SIZE )
+        {
+            const size_t n = std::min( size_t( BLOCK_SIZE ), _n - i );
+            int32_t indices[ BLOCK_SIZE ];
+            int32_t values[3][ BLOCK_SIZE ];
+            for( size_t j = 0; j < n; ++j )
+            {
+                int32_t lane[3];
+                Layout::unpack( _input + Layout::SIZE * ( i + j ),
+                                indices[j], lane );
+                for( size_t k = 0; k < 3; ++k )
+                    values[k][j] = lane[k];
+            }
+
+            const size_t end = n - n % P::width;
+            for( size_t j = 0; j < end; j += P::width )
+                _decode< P >( i + j, indices, values, j );
+            for( size_t j = end; j < n; ++j )
+                _decode< simd::Scalar< T > >( i + j, indices, values, j );
+        }
+    }
+
+private:
+    enum { BLOCK_SIZE = 64 };
+
+    const storage_type* const _input;
+    T* const _output;
+    const size_t _n;
+
+    template< class P >
+    VMMLIB_SIMD_INLINE void _decode( const size_t i, const int32_t* indices,
+                                     const int32_t ( *values )[ BLOCK_SIZE ],
+                                     const size_t j ) const
+    {
+        typedef typename P::type V;
+        const T offset = T( Quantization< Layout >::OFFSET );
+        const V scale = P::set( T( 0.70710678118654752440 ) / offset );
+        const V index = P::loadInt( indices + j );
+        V c[3];
+        for( size_t k = 0; k < 3; ++k )
+            c[k] = P::mul( P::sub( P::loadInt( values[k] + j ),
+                                   P::set( offset )), scale );
+        const V square = P::madd( c[0], c[0], P::madd( c[1], c[1],
+                                                      P::mul( c[2], c[2] )));
+        const V largest = P::sqrt( P::max( P::sub( P::set( 1 ), square ),
+                                           P::set( 0 )));
+
+        for( size_t k = 0; k < 4; ++k )
+        {
+            const V position = P::set( T( k ));
+            V q = largest;
+            if( k < 3 )
+                q = P::select( P::gt( index, position ), c[k], q );
+            if( k > 0 )
+                q = P::select( P::lt( index, position ), c[k - 1], q );
+            P::scatter( _output + 4 * i + k, 4, q );
+        }
+    }
+};
+
+/** Encodes a range of unit vectors, run by dispatch(). */
+template< typename T, class Layout > class EncodeNormals
+{
+public:
+    typedef void result_type;
+    typedef typename Layout::storage_type storage_type;
+
+    EncodeNormals( const vector< 3, T >* input, void* output, const size_t n )
+        : _input( reinterpret_cast< const T* >( input ))
+        , _output( reinterpret_cast< storage_type* >( output ))
+        , _n( n )
+    {}
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        const size_t end = _n - _n % P::width;
+        for( size_t i = 0; i < end; i += P::width )
+            _encode< P >( i );
+        for( size_t i = end; i < _n; ++i )
+            _encode< simd::Scalar< T > >( i );
+    }
+
+private:
+    const T* const _input;
+    storage_type* const _output;
+    const size_t _n;
+
+    template< class P >
+    VMMLIB_SIMD_INLINE void _encode( const size_t i ) const
+    {
+        typedef typename P::type V;
+        const V x = P::gather( _input + 3 * i, 3 );
+        const V y = P::gather( _input + 3 * i + 1, 3 );
+        const V z = P::gather( _input + 3 * i + 2, 3 );
+
+        // project onto the octahedron, fold the lower half over the upper
+        const V zero = P::set( 0 );
+        const V one = P::set( 1 );
+        const V invNorm = P::div( one, P::add( P::add( P::abs( x ),
+                                                       P::abs( y )),
+                                               P::abs( z )));
+        V u = P::mul( x, invNorm );
+        V v = P::mul( y, invNorm );
+        const typename P::mask lower = P::lt( z, zero );
+        const V foldedU = P::sub( one, P::abs( v ));
+        const V foldedV = P::sub( one, P::abs( u ));
+        const V minusOne = P::set( -1 );
+        u = P::select( lower, P::mul( foldedU, P::select( P::lt( u, zero ),
+                                                          minusOne, one )),
+                       u );
+        v = P::select( lower, P::mul( foldedV, P::select( P::lt( v, zero ),
+                                                          minusOne, one )),
+                       v );
+
+        const T offset = T( Quantization< Layout >::OFFSET );
+        const V scale = P::set( offset );
+        int32_t us[ P::width ], vs[ P::width ];
+        P::storeInt( us, P::madd( P::min( P::max( u, minusOne ), one ), scale,
+                                  scale ));
+        P::storeInt( vs, P::madd( P::min( P::max( v, minusOne ), one ), scale,
+                                  scale ));
+        for( size_t j = 0; j < P::width; ++j )
+            Layout::pack( us[j], vs[j], _output + i + j );
+    }
+};
+
+/** Decodes a range of unit vectors, run by dispatch(). */
+template< typename T, class Layout > class DecodeNormals
+{
+public:
+    typedef void result_type;
+    typedef typename Layout::storage_type storage_type;
+
+    DecodeNormals( const void* input, vector< 3, T >* output, const size_t n )
+        : _input( reinterpret_cast< const storage_type* >( input ))
+        , _output( reinterpret_cast< T* >( output ))
+        , _n( n )
+    {}
+
+    // Unpacks a block before decoding it: loading the lanes right after
+    // storing them with narrower vectors stalls the store forwarding.
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        for( size_t i = 0; i < _n; i += BLOCK_SIZE )
+        {
+            const size_t n = std::min( size_t( BLOCK_SIZE ), _n - i );
+            int32_t us[ BLOCK_SIZE ], vs[ BLOCK_SIZE ];
+            for( size_t j = 0; j < n; ++j )
+                Layout::unpack( _input + i + j, us[j], vs[j] );
+
+            const size_t end = n - n % P::width;
+            for( size_t j = 0; j < end; j += P::width )
+                _decode< P >( i + j, us + j, vs + j );
+            for( size_t j = end; j < n; ++j )
+                _decode< simd::Scalar< T > >( i + j, us + j, vs + j );
+        }
+    }
+
+private:
+    enum { BLOCK_SIZE = 64 };
+
+    const storage_type* const _input;
+    T* const _output;
+    const size_t _n;
+
+    template< class P >
+    VMMLIB_SIMD_INLINE void _decode( const size_t i, const int32_t* us,
+                                     const int32_t* vs ) const
+    {
+        typedef typename P::type V;
+        const T offset = T( Quantization< Layout >::OFFSET );
+        const V invScale = P::set( T( 1 ) / offset );
+        const V zero = P::set( 0 );
+        const V one = P::set( 1 );
+        V x = P::mul( P::sub( P::loadInt( us ), P::set( offset )), invScale );
+        V y = P::mul( P::sub( P::loadInt( vs ), P::set( offset )), invScale );
+
+        // unfold the lower half of the octahedron, normalize
+        V z = P::sub( P::sub( one, P::abs( x )), P::abs( y ));
+        const V fold = P::max( P::sub( zero, z ), zero );
+        x = P::add( x, P::select( P::lt( x, zero ), fold,
+                                  P::sub( zero, fold )));
+        y = P::add( y, P::select( P::lt( y, zero ), fold,
+                                  P::sub( zero, fold )));
+        const V invLength = P::div( one, P::sqrt(
+            P::madd( x, x, P::madd( y, y, P::mul( z, z )))));
+
+        P::scatter( _output + 3 * i, 3, P::mul( x, invLength ));
+        P::scatter( _output + 3 * i + 1, 3, P::mul( y, invLength ));
+        P::scatter( _output + 3 * i + 2, 3, P::mul( z, invLength ));
+    }
+};
+
+/**
+ * Converts a range of values to or from halves, run by dispatch().
+ *
+ * The branchless conversions are vectorized by the compiler for the
+ * instruction set of each SIMD level, one block of lanes at a time.
+ */
+template< typename T, bool toHalves > class ConvertHalves
+{
+public:
+    typedef void result_type;
+
+    ConvertHalves( const void* input, void* output, const size_t n )
+        : _input( input ), _output( output ), _n( n ) {}
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        enum { width = simd::Pack< float, L >::type::width };
+        const size_t end = _n - _n % width;
+        for( size_t i = 0; i < end; i += width )
+            _convert< width >( i );
+        for( size_t i = end; i < _n; ++i )
+            _convert< 1 >( i );
+    }
+
+private:
+    const void* const _input;
+    void* const _output;
+    const size_t _n;
+
+    template< size_t width >
+    VMMLIB_SIMD_INLINE void _convert( const size_t i ) const
+    {
+        if( toHalves )
+        {
+            const T* input = static_cast< const T* >( _input ) + i;
+            uint16_t* output = static_cast< uint16_t* >( _output ) + i;
+            for( size_t j = 0; j < width; ++j )
+                output[j] = toHalf( float( input[j] ));
+        }
+        else
+        {
+            const uint16_t* input = static_cast< const uint16_t* >( _input ) +
+                                    i;
+            T* output = static_cast< T* >( _output ) + i;
+            for( size_t j = 0; j < width; ++j )
+                output[j] = T( fromHalf( input[j] ));
+        }
+    }
+};
+VMMLIB_SIMD_KERNELS_END
+
+/** Creates the conversion kernel K of a chunk, see dispatchChunks(). */
+template< class K, typename I, typename O > class ConvertChunks
+{
+public:
+    ConvertChunks( const I* input, O* output )
+        : _input( input ), _output( output ) {}
+
+    K operator()( const size_t begin, const size_t count ) const
+    {
+        return K( _input + begin, _output + begin, count );
+    }
+
+private:
+    const I* const _input;
+    O* const _output;
+};
+
+template< class K, typename I, typename O >
+void convert( const I* input, O* output, const size_t n )
+{
+    dispatchChunks( n, ConvertChunks< K, I, O >( input, output ));
+}
+} // namespace detail
+
+template< typename T >
+PackedQuaternion32::PackedQuaternion32( const Quaternion< T >& quaternion )
+{
+    detail::EncodeQuaternions< T, detail::Quaternion32Layout >(
+        &quaternion, this, 1 ).template run< SIMD_SCALAR >();
+}
+
+template< typename T > Quaternion< T > PackedQuaternion32::get() const
+{
+    Quaternion< T > quaternion;
+    detail::DecodeQuaternions< T, detail::Quaternion32Layout >(
+        this, &quaternion, 1 ).template run< SIMD_SCALAR >();
+    return quaternion;
+}
+
+inline PackedQuaternion48::PackedQuaternion48()
+{
+    // index 3, three zero components
+    _bits[0] = _bits[1] = 0xbfff;
+    _bits[2] = 0x3fff;
+}
+
+inline PackedQuaternion48::PackedQuaternion48( const uint16_t bits[3] )
+{
+    std::copy( bits, bits + 3, _bits );
+}
+
+template< typename T >
+PackedQuaternion48::PackedQuaternion48( const Quaternion< T >& quaternion )
+{
+    detail::EncodeQuaternions< T, detail::Quaternion48Layout >(
+        &quaternion, this, 1 ).template run< SIMD_SCALAR >();
+}
+
+template< typename T > Quaternion< T > PackedQuaternion48::get() const
+{
+    Quaternion< T > quaternion;
+    detail::DecodeQuaternions< T, detail::Quaternion48Layout >(
+        this, &quaternion, 1 ).template run< SIMD_SCALAR >();
+    return quaternion;
+}
+
+inline bool PackedQuaternion48::operator == (
+    const PackedQuaternion48& other ) const
+{
+    return std::equal( _bits, _bits + 3, other._bits );
+}
+
+template< typename T >
+PackedNormal16::PackedNormal16( const vector< 3, T >& normal )
+{
+    detail::EncodeNormals< T, detail::Normal16Layout >(
+        &normal, this, 1 ).template run< SIMD_SCALAR >();
+}
+
+template< typename T > vector< 3, T > PackedNormal16::get() const
+{
+    vector< 3, T > normal;
+    detail::DecodeNormals< T, detail::Normal16Layout >(
+        this, &normal, 1 ).template run< SIMD_SCALAR >();
+    return normal;
+}
+
+template< typename T >
+PackedNormal32::PackedNormal32( const vector< 3, T >& normal )
+{
+    detail::EncodeNormals< T, detail::Normal32Layout >(
+        &normal, this, 1 ).template run< SIMD_SCALAR >();
+}
+
+template< typename T > vector< 3, T > PackedNormal32::get() const
+{
+    vector< 3, T > normal;
+    detail::DecodeNormals< T, detail::Normal32Layout >(
+        this, &normal, 1 ).template run< SIMD_SCALAR >();
+    return normal;
+}
+
+template< typename T > Half::Half( const T value )
+    : _bits( detail::toHalf( float( value )))
+{}
+
+inline Half Half::fromBits( const uint16_t bits )
+{
+    Half half;
+    half._bits = bits;
+    return half;
+}
+
+template< typename T > T Half::get() const
+{
+    return T( detail::fromHalf( _bits ));
+}
+
+template< typename T >
+void encode( const Quaternion< T >* input, PackedQuaternion32* output,
+             const size_t n )
+{
+    detail::convert< detail::EncodeQuaternions<
+        T, detail::Quaternion32Layout > >( input, output, n );
+}
+
+template< typename T >
+void encode( const Quaternion< T >* input, PackedQuaternion48* output,
+             const size_t n )
+{
+    detail::convert< detail::EncodeQuaternions<
+        T, detail::Quaternion48Layout > >( input, output, n );
+}
+
+template< typename T >
+void encode( const vector< 3, T >* input, PackedNormal16* output,
+             const size_t n )
+{
+    detail::convert< detail::EncodeNormals< T, detail::Normal16Layout > >(
+        input, output, n );
+}
+
+template< typename T >
+void encode( const vector< 3, T >* input, PackedNormal32* output,
+             const size_t n )
+{
+    detail::convert< detail::EncodeNormals< T, detail::Normal32Layout > >(
+        input, output, n );
+}
+
+template< typename T >
+void encode( const T* input, Half* output, const size_t n )
+{
+    detail::convert< detail::ConvertHalves< T, true > >( input, output, n );
+}
+
+template< size_t M, typename T >
+void encode( const vector< M, T >* input, Half* output, const size_t n )
+{
+    encode( input->array, output, M * n );
+}
+
+template< typename T >
+void decode( const PackedQuaternion32* input, Quaternion< T >* output,
+             const size_t n )
+{
+    detail::convert< detail::DecodeQuaternions<
+        T, detail::Quaternion32Layout > >( input, output, n );
+}
+
+template< typename T >
+void decode( const PackedQuaternion48* input, Quaternion< T >* output,
+             const size_t n )
+{
+    detail::convert< detail::DecodeQuaternions<
+        T, detail::Quaternion48Layout > >( input, output, n );
+}
+
+template< typename T >
+void decode( const PackedNormal16* input, vector< 3, T >* output,
+             const size_t n )
+{
+    detail::convert< detail::DecodeNormals< T, detail::Normal16Layout > >(
+        input, output, n );
+}
+
+template< typename T >
+void decode( const PackedNormal32* input, vector< 3, T >* output,
+             const size_t n )
+{
+    detail::convert< detail::DecodeNormals< T, detail::Normal32Layout > >(
+        input, output, n );
+}
+
+template< typename T >
+void decode( const Half* input, T* output, const size_t n )
+{
+    detail::convert< detail::ConvertHalves< T, false > >( input, output, n );
+}
+
+template< size_t M, typename T >
+void decode( const Half* input, vector< M, T >* output, const size_t n )
+{
+    decode( input, output->array, M * n );
+}
+
+} // namespace vmml
+
+#endif
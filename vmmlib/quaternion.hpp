@@ -50,8 +50,8 @@ template < typename T > class Quaternion
 {
 public:
     /** Construct an identity quaternion */
-    Quaternion() : array() { array[3] = 1.; }
-    Quaternion( T x, T y, T z, T w );
+    VMMLIB_CONSTEXPR Quaternion() : array() { array[3] = 1.; }
+    VMMLIB_CONSTEXPR Quaternion( T x, T y, T z, T w );
 
     /** Construct a rotation quaternion */
     Quaternion( T angle, vector< 3, T > axis );
@@ -67,57 +67,55 @@ public:
     bool equals( const Quaternion& other,
                  T tolerance = std::numeric_limits< T >::epsilon( )) const;
 
-    T x() const { return array[0]; }
-    T y() const { return array[1]; }
-    T z() const { return array[2]; }
-    T w() const { return array[3]; }
+    VMMLIB_CONSTEXPR T x() const { return array[0]; }
+    VMMLIB_CONSTEXPR T y() const { return array[1]; }
+    VMMLIB_CONSTEXPR T z() const { return array[2]; }
+    VMMLIB_CONSTEXPR T w() const { return array[3]; }
 
     /** @return true if both quaternions are equal. */
-    bool operator==( const Quaternion& a ) const;
+    VMMLIB_CONSTEXPR bool operator==( const Quaternion& a ) const;
 
     /** @return true if both quaternions are not equal. */
-    bool operator!=( const Quaternion& a ) const;
+    VMMLIB_CONSTEXPR bool operator!=( const Quaternion& a ) const;
 
     /** @return the negated quaternion of this quaternion. */
-    Quaternion operator-() const;
+    VMMLIB_CONSTEXPR Quaternion operator-() const;
 
     /** @return multiplicative inverse quaternion */
-    Quaternion inverse() const;
+    VMMLIB_CONSTEXPR Quaternion inverse() const;
 
-    Quaternion getConjugate() const;
+    VMMLIB_CONSTEXPR Quaternion getConjugate() const;
 
     T abs() const;
-    T absSquare() const;
+    VMMLIB_CONSTEXPR T absSquare() const;
 
     /** @return the corresponding 3x3 rotation matrix. */
-    Matrix< 3, 3, T > getRotationMatrix() const;
+    VMMLIB_CONSTEXPR Matrix< 3, 3, T > getRotationMatrix() const;
     //@}
 
     void normalize();
 
-    Quaternion& operator=(const Quaternion& other);
-
     /** @name quaternion/quaternion operations */
     //@{
-    Quaternion operator+( const Quaternion< T >& a ) const;
-    Quaternion operator-( const Quaternion< T >& a ) const;
+    VMMLIB_CONSTEXPR Quaternion operator+( const Quaternion< T >& a ) const;
+    VMMLIB_CONSTEXPR Quaternion operator-( const Quaternion< T >& a ) const;
 
     // caution: a * q != q * a in general
-    Quaternion operator*( const Quaternion< T >& a ) const;
-    void operator+=( const Quaternion< T >& a );
-    void operator-=( const Quaternion< T >& a );
+    VMMLIB_CONSTEXPR Quaternion operator*( const Quaternion< T >& a ) const;
+    VMMLIB_CONSTEXPR void operator+=( const Quaternion< T >& a );
+    VMMLIB_CONSTEXPR void operator-=( const Quaternion< T >& a );
 
     // caution: a *= q != q *= a in general
-    void operator*=( const Quaternion< T >& a );
+    VMMLIB_CONSTEXPR void operator*=( const Quaternion< T >& a );
     //@}
 
     /** @name quaternion/scalar operations */
     //@{
-    Quaternion operator*( T a ) const;
-    Quaternion operator/( T a ) const;
+    VMMLIB_CONSTEXPR Quaternion operator*( T a ) const;
+    VMMLIB_CONSTEXPR Quaternion operator/( T a ) const;
 
-    void operator*=( T a );
-    void operator/=( T a );
+    VMMLIB_CONSTEXPR void operator*=( T a );
+    VMMLIB_CONSTEXPR void operator/=( T a );
     //@}
 
     friend std::ostream& operator<< ( std::ostream& os, const Quaternion& q )
@@ -151,23 +149,71 @@ namespace vmml
 {
 /** @name Free quaternion functions */
 //@{
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 T dot( const Quaternion< T >& p, const Quaternion< T >& q )
 {
-    return p.array[3] * q.array[3] + p.array[0] * q.array[0] +
-           p.array[1] * q.array[1] + p.array[2] * q.array[2];
+    return p.w() * q.w() + p.x() * q.x() + p.y() * q.y() + p.z() * q.z();
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 vector< 3, T > cross( const Quaternion< T >& p, const Quaternion< T >& q )
 {
-    return vector< 3, T >( p.array[1] * q.array[2] - p.array[2] * q.array[1],
-                           p.array[2] * q.array[0] - p.array[0] * q.array[2],
-                           p.array[0] * q.array[1] - p.array[1] * q.array[0] );
+    return vector< 3, T >( p.y() * q.z() - p.z() * q.y(),
+                           p.z() * q.x() - p.x() * q.z(),
+                           p.x() * q.y() - p.y() * q.x( ));
 }
+
+/**
+ * @return the logarithm (v, 0) of the unit quaternion q, where v is the
+ *         rotation axis scaled by half the rotation angle.
+ */
+template < typename T > Quaternion< T > log( const Quaternion< T >& q );
+
+/** @return the exponential of the pure quaternion (v, 0), see log(). */
+template < typename T > Quaternion< T > exp( const Quaternion< T >& q );
+
+/**
+ * Normalized linear interpolation between two unit quaternions along the
+ * shorter arc.
+ *
+ * Cheaper than slerp(), but with a non-constant angular velocity.
+ */
+template < typename T >
+Quaternion< T > nlerp( const Quaternion< T >& a, const Quaternion< T >& b,
+                       T t );
+
+/**
+ * Spherical linear interpolation between two unit quaternions along the
+ * shorter arc, with a constant angular velocity.
+ */
+template < typename T >
+Quaternion< T > slerp( const Quaternion< T >& a, const Quaternion< T >& b,
+                       T t );
+
+/**
+ * Spherical quadrangle interpolation between the unit quaternions a and b.
+ *
+ * Interpolates a sequence of rotations with a continuous angular velocity,
+ * using the control points of a and b from squadControlPoint().
+ */
+template < typename T >
+Quaternion< T > squad( const Quaternion< T >& a, const Quaternion< T >& b,
+                       const Quaternion< T >& controlA,
+                       const Quaternion< T >& controlB, T t );
+
+/**
+ * @return the squad() control point of the unit quaternion q, given its
+ *         predecessor and successor in the interpolated sequence.
+ */
+template < typename T >
+Quaternion< T > squadControlPoint( const Quaternion< T >& previous,
+                                   const Quaternion< T >& q,
+                                   const Quaternion< T >& next );
 //@}
 
-template < typename T > Quaternion< T >::Quaternion( T x_, T y_, T z_, T w_ )
+template < typename T >
+VMMLIB_CONSTEXPR Quaternion< T >::Quaternion( T x_, T y_, T z_, T w_ )
+    : array()
 {
     array[0] = x_;
     array[1] = y_;
@@ -277,20 +323,21 @@ bool Quaternion< T >::equals( const Quaternion& other, const T tolerance ) const
            std::abs( array[3] - other.array[3] ) <= tolerance;
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 bool Quaternion< T >::operator==( const Quaternion& rhs ) const
 {
     return array[0] == rhs.array[0] && array[1] == rhs.array[1] &&
            array[2] == rhs.array[2] && array[3] == rhs.array[3];
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 bool Quaternion< T >::operator!=( const Quaternion& a ) const
 {
     return ! this->operator==( a );
 }
 
-template < typename T > Quaternion< T > Quaternion< T >::getConjugate() const
+template < typename T > VMMLIB_CONSTEXPR
+Quaternion< T > Quaternion< T >::getConjugate() const
 {
     return Quaternion< T >( -array[0], -array[1], -array[2], array[3] );
 }
@@ -300,13 +347,15 @@ template < typename T > T Quaternion< T >::abs() const
     return std::sqrt( absSquare( ));
 }
 
-template < typename T >T Quaternion< T >::absSquare() const
+template < typename T > VMMLIB_CONSTEXPR
+T Quaternion< T >::absSquare() const
 {
     return array[0] * array[0] + array[1] * array[1] +
            array[2] * array[2] + array[3] * array[3];
 }
 
-template < typename T > Quaternion< T > Quaternion< T >::inverse() const
+template < typename T > VMMLIB_CONSTEXPR
+Quaternion< T > Quaternion< T >::inverse() const
 {
     const Quaternion< T >& q = getConjugate();
     const T tmp = T( 1 ) / absSquare();
@@ -326,14 +375,14 @@ template < typename T > void Quaternion< T >::normalize()
 // Quaternion/Quaternion operations
 //
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 Quaternion< T > Quaternion< T >::operator+( const Quaternion< T >& rhs ) const
 {
     return Quaternion( array[0] + rhs.array[0], array[1] + rhs.array[1],
                        array[2] + rhs.array[2], array[3] + rhs.array[3] );
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 Quaternion< T > Quaternion< T >::operator-( const Quaternion< T >& rhs ) const
 {
     return Quaternion( array[0] - rhs.array[0], array[1] - rhs.array[1],
@@ -341,7 +390,7 @@ Quaternion< T > Quaternion< T >::operator-( const Quaternion< T >& rhs ) const
 }
 
 // returns Grasssmann product
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 Quaternion< T > Quaternion< T >::operator*( const Quaternion< T >& rhs ) const
 {
     Quaternion< T > ret( *this );
@@ -350,7 +399,7 @@ Quaternion< T > Quaternion< T >::operator*( const Quaternion< T >& rhs ) const
 }
 
 // Grassmann product
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 void Quaternion< T >::operator*=( const Quaternion< T >& q )
 {
     // optimized version, 7 less mul, but 15 more add/subs
@@ -381,12 +430,13 @@ void Quaternion< T >::operator*=( const Quaternion< T >& q )
     array[ 3 ] = tmp_00 + tmp_09 - tmp_05;
 }
 
-template < typename T > Quaternion< T > Quaternion< T >::operator-() const
+template < typename T > VMMLIB_CONSTEXPR
+Quaternion< T > Quaternion< T >::operator-() const
 {
     return Quaternion( -array[0], -array[1], -array[2], -array[3] );
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 void Quaternion< T >::operator+=( const Quaternion< T >& q )
 {
     array[ 0 ] += q.array[ 0 ];
@@ -395,7 +445,7 @@ void Quaternion< T >::operator+=( const Quaternion< T >& q )
     array[ 3 ] += q.array[ 3 ];
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 void Quaternion< T >::operator-=( const Quaternion< T >& q )
 {
     array[ 0 ] -= q.array[ 0 ];
@@ -408,14 +458,14 @@ void Quaternion< T >::operator-=( const Quaternion< T >& q )
 // Quaternion/scalar operations
 //
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 Quaternion< T > Quaternion< T >::operator*( const T a_ ) const
 {
     return Quaternion( array[0] * a_, array[1] * a_,
                        array[2] * a_, array[3] * a_ );
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 Quaternion< T > Quaternion< T >::operator/( T a_ ) const
 {
     if ( a_ == T( 0 ))
@@ -426,7 +476,8 @@ Quaternion< T > Quaternion< T >::operator/( T a_ ) const
                        array[3] * a_ );
 }
 
-template < typename T > void Quaternion< T >::operator*=( T q )
+template < typename T > VMMLIB_CONSTEXPR
+void Quaternion< T >::operator*=( T q )
 {
     array[ 0 ] *= q;
     array[ 1 ] *= q;
@@ -434,7 +485,8 @@ template < typename T > void Quaternion< T >::operator*=( T q )
     array[ 3 ] *= q;
 }
 
-template < typename T > void Quaternion< T >::operator/=( T q )
+template < typename T > VMMLIB_CONSTEXPR
+void Quaternion< T >::operator/=( T q )
 {
     if ( q == T( 0 ))
         throw std::runtime_error( "Division by zero" );
@@ -443,7 +495,7 @@ template < typename T > void Quaternion< T >::operator/=( T q )
     this->operator*=( q );
 }
 
-template < typename T >
+template < typename T > VMMLIB_CONSTEXPR
 Matrix< 3, 3, T > Quaternion< T >::getRotationMatrix() const
 {
     const T w2 = array[3] * array[3];
@@ -470,11 +522,116 @@ Matrix< 3, 3, T > Quaternion< T >::getRotationMatrix() const
     return matrix;
 }
 
+//
+// Interpolation
+//
+
+namespace detail
+{
+/**
+ * Compute the slerp weights of the start and end quaternions, given the
+ * cosine of the angle between them in ]-1, 1].
+ */
+template < typename T >
+void getSlerpWeights( const T cosAngle, const T t, T& start, T& end )
+{
+    // sin( angle ) loses its precision for nearly identical quaternions,
+    // where the linear weights are exact enough
+    if( cosAngle > T( 1 ) - std::numeric_limits< T >::epsilon( ))
+    {
+        start = T( 1 ) - t;
+        end = t;
+        return;
+    }
+    const T angle = std::acos( cosAngle );
+    const T invSin = T( 1 ) / std::sin( angle );
+    start = std::sin(( T( 1 ) - t ) * angle ) * invSin;
+    end = std::sin( t * angle ) * invSin;
+}
+
+/**
+ * Spherical linear interpolation along the arc from a to b, which unlike
+ * slerp() is not the shorter arc of -b if a and b are in opposite
+ * hemispheres. Undefined for antipodal quaternions.
+ */
+template < typename T >
+Quaternion< T > slerpArc( const Quaternion< T >& a, const Quaternion< T >& b,
+                          const T t )
+{
+    T start, end;
+    getSlerpWeights( std::max( dot( a, b ), T( -1 )), t, start, end );
+    return a * start + b * end;
+}
+}
+
+template < typename T > Quaternion< T > log( const Quaternion< T >& q )
+{
+    const T w = std::min( std::max( q.w(), T( -1 )), T( 1 ));
+    const T angle = std::acos( w );
+    const T sinAngle = std::sin( angle );
+    const T scale = sinAngle > std::numeric_limits< T >::epsilon() ?
+                        angle / sinAngle : T( 1 );
+    return Quaternion< T >( q.x() * scale, q.y() * scale, q.z() * scale, 0 );
+}
+
+template < typename T > Quaternion< T > exp( const Quaternion< T >& q )
+{
+    const T angle = std::sqrt( q.x() * q.x() + q.y() * q.y() +
+                               q.z() * q.z( ));
+    const T scale = angle > std::numeric_limits< T >::epsilon() ?
+                        std::sin( angle ) / angle : T( 1 );
+    return Quaternion< T >( q.x() * scale, q.y() * scale, q.z() * scale,
+                            std::cos( angle ));
+}
+
+template < typename T >
+Quaternion< T > nlerp( const Quaternion< T >& a, const Quaternion< T >& b,
+                       const T t )
+{
+    const T end = dot( a, b ) < 0 ? -t : t;
+    Quaternion< T > result = a * ( T( 1 ) - t ) + b * end;
+    result.normalize();
+    return result;
+}
+
+template < typename T >
+Quaternion< T > slerp( const Quaternion< T >& a, const Quaternion< T >& b,
+                       const T t )
+{
+    const T cosAngle = dot( a, b );
+    T start, end;
+    detail::getSlerpWeights( std::abs( cosAngle ), t, start, end );
+    return a * start + b * ( cosAngle < 0 ? -end : end );
+}
+
+template < typename T >
+Quaternion< T > squad( const Quaternion< T >& a, const Quaternion< T >& b,
+                       const Quaternion< T >& controlA,
+                       const Quaternion< T >& controlB, const T t )
+{
+    // Shoemake's squad interpolates along the arcs between its arguments once
+    // b and its control point are on the hemisphere of a: the shorter arc of
+    // the outer slerp() would flip wherever the inner ones become orthogonal
+    const bool flip = dot( a, b ) < 0;
+    const Quaternion< T > end = flip ? -b : b;
+    const Quaternion< T > controlEnd = flip ? -controlB : controlB;
+    return detail::slerpArc( detail::slerpArc( a, end, t ),
+                             detail::slerpArc( controlA, controlEnd, t ),
+                             T( 2 ) * t * ( T( 1 ) - t ));
+}
+
 template < typename T >
-Quaternion< T >& Quaternion< T >::operator=(const Quaternion& other)
+Quaternion< T > squadControlPoint( const Quaternion< T >& previous,
+                                   const Quaternion< T >& q,
+                                   const Quaternion< T >& next )
 {
-    ::memcpy( array, other.array, 4 * sizeof( T ) );
-    return *this;
+    // the neighbors on the hemisphere of q, as interpolated by slerp()
+    const Quaternion< T > inverse = q.getConjugate();
+    const Quaternion< T > toPrevious =
+        inverse * ( dot( q, previous ) < 0 ? -previous : previous );
+    const Quaternion< T > toNext =
+        inverse * ( dot( q, next ) < 0 ? -next : next );
+    return q * exp(( log( toPrevious ) + log( toNext )) * T( -.25 ));
 }
 
 }
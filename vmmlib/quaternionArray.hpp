@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__QUATERNION_ARRAY__HPP__
+#define __VMML__QUATERNION_ARRAY__HPP__
+
+#include <vmmlib/dispatch.hpp> // used inline
+#include <vmmlib/matrix.hpp> // used inline
+#include <vmmlib/quaternion.hpp> // used inline
+#include <vmmlib/simd.hpp> // used inline
+#include <vmmlib/types.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace vmml
+{
+/** The accuracy of the batch slerp() of quaternion arrays. */
+enum SlerpMode
+{
+    SLERP_EXACT, //!< the weights of the scalar slerp()
+    SLERP_FAST //!< polynomial weights, with an absolute error below 2e-5
+};
+
+/**
+ * An array of quaternions stored as structure of arrays, one array per
+ * component.
+ *
+ * The batch interpolations and conversions process one quaternion per SIMD
+ * lane with the widest instructions of the CPU, see dispatch.hpp. When
+ * compiled with OpenMP, large arrays are processed in parallel chunks.
+ */
+template< typename T > class QuaternionArray
+{
+public:
+    /** Construct an empty array. */
+    QuaternionArray() {}
+
+    /** Construct an array of size identity quaternions. */
+    explicit QuaternionArray( size_t size );
+
+    /** Construct an array from size quaternions. */
+    QuaternionArray( const Quaternion< T >* quaternions, size_t size );
+
+    /** @name Data Access */
+    //@{
+    size_t getSize() const { return _w.size(); }
+
+    /** Resize the array, appending identity quaternions. */
+    void resize( size_t size );
+
+    /** @return the quaternion at the given index. */
+    Quaternion< T > get( const size_t i ) const
+        { return Quaternion< T >( _x[i], _y[i], _z[i], _w[i] ); }
+
+    /** Set the quaternion at the given index. */
+    void set( size_t i, const Quaternion< T >& quaternion );
+
+    /** @return the components of all quaternions. */
+    const T* getX() const { return _x.data(); }
+    const T* getY() const { return _y.data(); }
+    const T* getZ() const { return _z.data(); }
+    const T* getW() const { return _w.data(); }
+    T* getX() { return _x.data(); }
+    T* getY() { return _y.data(); }
+    T* getZ() { return _z.data(); }
+    T* getW() { return _w.data(); }
+
+    /**
+     * Compute the rotation matrices of all quaternions, like
+     * Quaternion::getRotationMatrix().
+     */
+    void getRotationMatrices( Matrix< 3, 3, T >* matrices ) const;
+    //@}
+
+private:
+    std::vector< T > _x;
+    std::vector< T > _y;
+    std::vector< T > _z;
+    std::vector< T > _w;
+};
+
+/**
+ * @name Batch quaternion interpolation
+ *
+ * Interpolate all quaternions of a and b element-wise, either with one
+ * interpolation parameter t for all quaternions or with one per quaternion.
+ * The result is resized to the size of a and may be a or b. Arrays of
+ * different sizes throw a std::runtime_error.
+ */
+//@{
+/** Normalized linear interpolation, see nlerp() of Quaternion. */
+template< typename T >
+void nlerp( const QuaternionArray< T >& a, const QuaternionArray< T >& b,
+            T t, QuaternionArray< T >& result );
+
+/** Normalized linear interpolation with one parameter per quaternion. */
+template< typename T >
+void nlerp( const QuaternionArray< T >& a, const QuaternionArray< T >& b,
+            const T* t, QuaternionArray< T >& result );
+
+/**
+ * Spherical linear interpolation, see slerp() of Quaternion.
+ *
+ * SLERP_FAST evaluates the weights of the quaternions with the polynomial of
+ * D. Eberly, "A Fast and Accurate Algorithm for Computing SLERP", without
+ * any trigonometric function. The error of the weights is below 2e-5 for
+ * quaternions up to 180 degrees of rotation apart, and below 1e-6 for up to
+ * 120 degrees, for float and double alike.
+ */
+template< typename T >
+void slerp( const QuaternionArray< T >& a, const QuaternionArray< T >& b,
+            T t, QuaternionArray< T >& result, SlerpMode mode = SLERP_EXACT );
+
+/** Spherical linear interpolation with one parameter per quaternion. */
+template< typename T >
+void slerp( const QuaternionArray< T >& a, const QuaternionArray< T >& b,
+            const T* t, QuaternionArray< T >& result,
+            SlerpMode mode = SLERP_EXACT );
+//@}
+
+// - implementation -
+
+template< typename T >
+QuaternionArray< T >::QuaternionArray( const size_t size )
+    : _x( size ), _y( size ), _z( size ), _w( size, T( 1 ))
+{}
+
+template< typename T >
+QuaternionArray< T >::QuaternionArray( const Quaternion< T >* quaternions,
+                                       const size_t size )
+    : _x( size ), _y( size ), _z( size ), _w( size )
+{
+    for( size_t i = 0; i < size; ++i )
+        set( i, quaternions[i] );
+}
+
+template< typename T > void QuaternionArray< T >::resize( const size_t size )
+{
+    _x.resize( size );
+    _y.resize( size );
+    _z.resize( size );
+    _w.resize( size, T( 1 ));
+}
+
+template< typename T >
+void QuaternionArray< T >::set( const size_t i,
+                                const Quaternion< T >& quaternion )
+{
+    _x[i] = quaternion.x();
+    _y[i] = quaternion.y();
+    _z[i] = quaternion.z();
+    _w[i] = quaternion.w();
+}
+
+namespace detail
+{
+enum Interpolation
+{
+    INTERPOLATE_NLERP,
+    INTERPOLATE_SLERP,
+    INTERPOLATE_FAST_SLERP
+};
+
+VMMLIB_SIMD_KERNELS_BEGIN
+/** Interpolates a range of quaternion arrays, run by dispatch(). */
+template< typename T, Interpolation method > class InterpolateRange
+{
+public:
+    typedef void result_type;
+
+    /** t is a single parameter for a tStride of 0, one per element for 1. */
+    InterpolateRange( const QuaternionArray< T >& a,
+                      const QuaternionArray< T >& b, const T* t,
+                      const size_t tStride, QuaternionArray< T >& result,
+                      const size_t begin, const size_t end )
+        : _t( t + tStride * begin ), _tStride( tStride ), _n( end - begin )
+    {
+        _a[0] = a.getX() + begin; _a[1] = a.getY() + begin;
+        _a[2] = a.getZ() + begin; _a[3] = a.getW() + begin;
+        _b[0] = b.getX() + begin; _b[1] = b.getY() + begin;
+        _b[2] = b.getZ() + begin; _b[3] = b.getW() + begin;
+        _result[0] = result.getX() + begin;
+        _result[1] = result.getY() + begin;
+        _result[2] = result.getZ() + begin;
+        _result[3] = result.getW() + begin;
+    }
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        const size_t end = _n - _n % P::width;
+        for( size_t i = 0; i < end; i += P::width )
+            _interpolate< P >( i );
+        for( size_t i = end; i < _n; ++i )
+            _interpolate< simd::Scalar< T > >( i );
+    }
+
+private:
+    const T* _a[4];
+    const T* _b[4];
+    T* _result[4];
+    const T* const _t;
+    const size_t _tStride;
+    const size_t _n;
+
+    // The weights of the start and end quaternions, for the cosine of the
+    // angle between them in [0, 1]
+    template< class P >
+    VMMLIB_SIMD_INLINE static void _getWeights( const typename P::type& cosine,
+                                                const typename P::type& t,
+                                                typename P::type& start,
+                                                typename P::type& end )
+    {
+        typedef typename P::type V;
+        const V one = P::set( 1 );
+        if( method == INTERPOLATE_NLERP )
+        {
+            start = P::sub( one, t );
+            end = t;
+        }
+        else if( method == INTERPOLATE_SLERP )
+        {
+            // no vectorized trigonometry, use the weights of the scalar slerp
+            T cosines[ P::width ], ts[ P::width ];
+            T starts[ P::width ], ends[ P::width ];
+            P::store( cosines, cosine );
+            P::store( ts, t );
+            for( size_t i = 0; i < P::width; ++i )
+                getSlerpWeights( cosines[i], ts[i], starts[i], ends[i] );
+            start = P::load( starts );
+            end = P::load( ends );
+        }
+        else
+        {
+            // sin( t angle ) / sin( angle ) as a nested series in cos - 1,
+            // with the last term scaled to correct the truncation
+            const V cosineMinusOne = P::sub( cosine, one );
+            const V s = P::sub( one, t );
+            const V tSquare = P::mul( t, t );
+            const V sSquare = P::mul( s, s );
+            V tSeries = P::set( 0 );
+            V sSeries = tSeries;
+            for( size_t i = 8; i > 0; --i )
+            {
+                const T scale = i == 8 ? T( 1.85298109240830 ) : T( 1 );
+                const V u = P::set( scale / T( i * ( 2 * i + 1 )));
+                const V v = P::set( scale * T( i ) / T( 2 * i + 1 ));
+                const V tTerm = P::mul( P::sub( P::mul( u, tSquare ), v ),
+                                        cosineMinusOne );
+                const V sTerm = P::mul( P::sub( P::mul( u, sSquare ), v ),
+                                        cosineMinusOne );
+                tSeries = P::madd( tTerm, tSeries, tTerm );
+                sSeries = P::madd( sTerm, sSeries, sTerm );
+            }
+            start = P::madd( s, sSeries, s );
+            end = P::madd( t, tSeries, t );
+        }
+    }
+
+    template< class P >
+    VMMLIB_SIMD_INLINE void _interpolate( const size_t i ) const
+    {
+        typedef typename P::type V;
+        V a[4], b[4];
+        for( size_t j = 0; j < 4; ++j )
+        {
+            a[j] = P::load( _a[j] + i );
+            b[j] = P::load( _b[j] + i );
+        }
+        const V t = _tStride ? P::load( _t + i ) : P::set( *_t );
+
+        // interpolate along the shorter arc
+        const V zero = P::set( 0 );
+        const V cosine = P::madd( a[0], b[0], P::madd( a[1], b[1],
+                                  P::madd( a[2], b[2], P::mul( a[3], b[3] ))));
+        V start, end;
+        _getWeights< P >( P::abs( cosine ), t, start, end );
+        end = P::select( P::lt( cosine, zero ), P::sub( zero, end ), end );
+
+        V result[4];
+        for( size_t j = 0; j < 4; ++j )
+            result[j] = P::madd( a[j], start, P::mul( b[j], end ));
+
+        if( method == INTERPOLATE_NLERP )
+        {
+            const V length = P::sqrt(
+                P::madd( result[0], result[0], P::madd( result[1], result[1],
+                P::madd( result[2], result[2],
+                         P::mul( result[3], result[3] )))));
+            const V invLength = P::div( P::set( 1 ), length );
+            for( size_t j = 0; j < 4; ++j )
+                result[j] = P::mul( result[j], invLength );
+        }
+
+        for( size_t j = 0; j < 4; ++j )
+            P::store( _result[j] + i, result[j] );
+    }
+};
+
+/** Converts a range of quaternions to rotation matrices, run by dispatch(). */
+template< typename T > class RotationMatrixRange
+{
+public:
+    typedef void result_type;
+
+    RotationMatrixRange( const QuaternionArray< T >& quaternions,
+                         Matrix< 3, 3, T >* matrices, const size_t begin,
+                         const size_t end )
+        : _x( quaternions.getX() + begin ), _y( quaternions.getY() + begin )
+        , _z( quaternions.getZ() + begin ), _w( quaternions.getW() + begin )
+        , _matrices( reinterpret_cast< T* >( matrices + begin ))
+        , _n( end - begin )
+    {}
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        const size_t end = _n - _n % P::width;
+        for( size_t i = 0; i < end; i += P::width )
+            _convert< P >( i );
+        for( size_t i = end; i < _n; ++i )
+            _convert< simd::Scalar< T > >( i );
+    }
+
+private:
+    const T* const _x;
+    const T* const _y;
+    const T* const _z;
+    const T* const _w;
+    T* const _matrices;
+    const size_t _n;
+
+    // Same terms as Quaternion::getRotationMatrix()
+    template< class P >
+    VMMLIB_SIMD_INLINE void _convert( const size_t i ) const
+    {
+        typedef typename P::type V;
+        const V x = P::load( _x + i );
+        const V y = P::load( _y + i );
+        const V z = P::load( _z + i );
+        const V w = P::load( _w + i );
+
+        const V w2 = P::mul( w, w );
+        const V x2 = P::mul( x, x );
+        const V y2 = P::mul( y, y );
+        const V z2 = P::mul( z, z );
+        const V wx = P::mul( w, x );
+        const V wy = P::mul( w, y );
+        const V wz = P::mul( w, z );
+        const V xy = P::mul( x, y );
+        const V xz = P::mul( x, z );
+        const V yz = P::mul( y, z );
+        const V two = P::set( 2 );
+
+        // column by column, like the storage of Matrix
+        T* matrix = _matrices + 9 * i;
+        P::scatter( matrix, 9, P::sub( P::sub( P::add( w2, x2 ), y2 ), z2 ));
+        P::scatter( matrix + 1, 9, P::mul( two, P::add( xy, wz )));
+        P::scatter( matrix + 2, 9, P::mul( two, P::sub( xz, wy )));
+        P::scatter( matrix + 3, 9, P::mul( two, P::sub( xy, wz )));
+        P::scatter( matrix + 4, 9, P::sub( P::add( P::sub( w2, x2 ), y2 ),
+                                           z2 ));
+        P::scatter( matrix + 5, 9, P::mul( two, P::add( yz, wx )));
+        P::scatter( matrix + 6, 9, P::mul( two, P::add( xz, wy )));
+        P::scatter( matrix + 7, 9, P::mul( two, P::sub( yz, wx )));
+        P::scatter( matrix + 8, 9, P::add( P::sub( P::sub( w2, x2 ), y2 ),
+                                           z2 ));
+    }
+};
+VMMLIB_SIMD_KERNELS_END
+
+/** Creates the InterpolateRange of a chunk, see dispatchChunks(). */
+template< typename T, Interpolation method > class InterpolateChunks
+{
+public:
+    InterpolateChunks( const QuaternionArray< T >& a,
+                       const QuaternionArray< T >& b, const T* t,
+                       const size_t tStride, QuaternionArray< T >& result )
+        : _a( a ), _b( b ), _t( t ), _tStride( tStride ), _result( result )
+    {}
+
+    InterpolateRange< T, method > operator()( const size_t begin,
+                                              const size_t count ) const
+    {
+        return InterpolateRange< T, method >( _a, _b, _t, _tStride, _result,
+                                              begin, begin + count );
+    }
+
+private:
+    const QuaternionArray< T >& _a;
+    const QuaternionArray< T >& _b;
+    const T* const _t;
+    const size_t _tStride;
+    QuaternionArray< T >& _result;
+};
+
+/** Creates the RotationMatrixRange of a chunk, see dispatchChunks(). */
+template< typename T > class RotationMatrixChunks
+{
+public:
+    RotationMatrixChunks( const QuaternionArray< T >& quaternions,
+                          Matrix< 3, 3, T >* matrices )
+        : _quaternions( quaternions ), _matrices( matrices )
+    {}
+
+    RotationMatrixRange< T > operator()( const size_t begin,
+                                         const size_t count ) const
+    {
+        return RotationMatrixRange< T >( _quaternions, _matrices, begin,
+                                         begin + count );
+    }
+
+private:
+    const QuaternionArray< T >& _quaternions;
+    Matrix< 3, 3, T >* const _matrices;
+};
+
+template< Interpolation method, typename T >
+void interpolate( const QuaternionArray< T >& a, const QuaternionArray< T >& b,
+                  const T* t, const size_t tStride,
+                  QuaternionArray< T >& result )
+{
+    const size_t n = a.getSize();
+    if( b.getSize() != n )
+        throw std::runtime_error( "Interpolation of quaternion arrays of "
+                                  "different sizes" );
+    result.resize( n );
+
+    dispatchChunks( n, InterpolateChunks< T, method >( a, b, t, tStride,
+                                                       result ));
+}
+} // namespace detail
+
+template< typename T > void QuaternionArray< T >::getRotationMatrices(
+    Matrix< 3, 3, T >* matrices ) const
+{
+    dispatchChunks( getSize(),
+                    detail::RotationMatrixChunks< T >( *this, matrices ));
+}
+
+template< typename T >
+void nlerp( const QuaternionArray< T >& a, const QuaternionArray< T >& b,
+            const T t, QuaternionArray< T >& result )
+{
+    detail::interpolate< detail::INTERPOLATE_NLERP >( a, b, &t, 0, result );
+}
+
+template< typename T >
+void nlerp( const QuaternionArray< T >& a, const QuaternionArray< T >& b,
+            const T* t, QuaternionArray< T >& result )
+{
+    detail::interpolate< detail::INTERPOLATE_NLERP >( a, b, t, 1, result );
+}
+
+template< typename T >
+void slerp( const QuaternionArray< T >& a, const QuaternionArray< T >& b,
+            const T t, QuaternionArray< T >& result, const SlerpMode mode )
+{
+    if( mode == SLERP_FAST )
+        detail::interpolate< detail::INTERPOLATE_FAST_SLERP >( a, b, &t, 0,
+                                                               result );
+    else
+        detail::interpolate< detail::INTERPOLATE_SLERP >( a, b, &t, 0,
+                                                          result );
+}
+
+template< typename T >
+void slerp( const QuaternionArray< T >& a, const QuaternionArray< T >& b,
+            const T* t, QuaternionArray< T >& result, const SlerpMode mode )
+{
+    if( mode == SLERP_FAST )
+        detail::interpolate< detail::INTERPOLATE_FAST_SLERP >( a, b, t, 1,
+                                                               result );
+    else
+        detail::interpolate< detail::INTERPOLATE_SLERP >( a, b, t, 1,
+                                                          result );
+}
+
+} // namespace vmml
+
+#endif
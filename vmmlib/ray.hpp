@@ -40,8 +40,14 @@
 #ifndef __VMML__RAY__HPP__
 #define __VMML__RAY__HPP__
 
+#include <vmmlib/aabb.hpp>
+#include <vmmlib/types.hpp>
 #include <vmmlib/vector.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace vmml
 {
 template< typename T > class Ray
@@ -59,9 +65,17 @@ public:
     Ray( const vec3& origin, const vec3& direction )
         : _origin ( origin )
         , _direction ( vmml::normalize( direction ))
-    {}
+    {
+        _init();
+    }
     ~Ray() {}
 
+    /** @return the origin of the ray */
+    const vec3& getOrigin() const { return _origin; }
+
+    /** @return the normalized direction of the ray */
+    const vec3& getDirection() const { return _direction; }
+
     /**
      * Ray-Sphere Intersection.
      * Optimized solution from "Real-time Rendering 3rd Edition"
@@ -75,12 +89,119 @@ public:
      */
     T test( const vec4& sphere ) const;
 
+    /**
+     * Ray-Box Intersection.
+     * Branchless slab test using the precomputed reciprocal direction and
+     * its sign bits, see "An Efficient and Robust Ray-Box Intersection
+     * Algorithm" by Williams et al.
+     *
+     * @param aabb the axis-aligned box
+     * @return The distance from the ray origin to the intersection, the exit
+     *         point if the origin is inside the box, or a negative value if
+     *         there is no intersection.
+     */
+    T test( const AABB< T >& aabb ) const;
+
+    /**
+     * Ray-Oriented Box Intersection.
+     * The slab test of test( const AABB< T >& ) in the frame of the box,
+     * defined in obb.hpp.
+     *
+     * @param obb the oriented box
+     * @return The distance from the ray origin to the intersection, the exit
+     *         point if the origin is inside the box, or a negative value if
+     *         there is no intersection.
+     */
+    T test( const OBB< T >& obb ) const;
+
+    /**
+     * Ray-Triangle Intersection.
+     * Watertight test from "Watertight Ray/Triangle Intersection" by Woop et
+     * al.: rays through a shared edge or vertex never miss both triangles.
+     * Both faces of the triangle are hit.
+     *
+     * @param a first triangle vertex
+     * @param b second triangle vertex
+     * @param c third triangle vertex
+     * @return The distance from the ray origin to the intersection, or a
+     *         negative value if there is no intersection.
+     */
+    T test( const vec3& a, const vec3& b, const vec3& c ) const;
+
+    /**
+     * Ray-Triangle Intersection with barycentric coordinates.
+     *
+     * @param a first triangle vertex
+     * @param b second triangle vertex
+     * @param c third triangle vertex
+     * @param barycentric the weights of a, b and c for the intersection
+     *                    point, unchanged if there is no intersection.
+     * @return The distance from the ray origin to the intersection, or a
+     *         negative value if there is no intersection.
+     */
+    T test( const vec3& a, const vec3& b, const vec3& c,
+            vec3& barycentric ) const;
+
 private:
-    const vec3 _origin;
-    const vec3 _direction;
+    vec3 _origin;
+    vec3 _direction;
 
+    vec3 _invDirection;
+    size_t _sign[ 3 ]; //!< 1 if the direction is negative on the axis
+
+    // permutation and shear of the ray space for the triangle test
+    size_t _kx, _ky, _kz;
+    vec3 _shear;
+
+    void _init();
+    template< typename F > static F _difference( F a, F b, F c, F d );
 };
 
+template< typename T >
+void Ray< T >::_init()
+{
+    for( size_t i = 0; i < 3; ++i )
+    {
+        _invDirection.array[ i ] = T( 1 ) / _direction.array[ i ];
+        _sign[ i ] = _invDirection.array[ i ] < 0 ? 1 : 0;
+    }
+
+    // the dimension where the direction is maximal becomes z
+    _kz = 0;
+    for( size_t i = 1; i < 3; ++i )
+        if( std::abs( _direction.array[ i ] ) >
+            std::abs( _direction.array[ _kz ] ))
+        {
+            _kz = i;
+        }
+    _kx = ( _kz + 1 ) % 3;
+    _ky = ( _kx + 1 ) % 3;
+    if( _direction.array[ _kz ] < 0 ) // preserve the winding
+        std::swap( _kx, _ky );
+
+    _shear.array[ 0 ] = _direction.array[ _kx ] / _direction.array[ _kz ];
+    _shear.array[ 1 ] = _direction.array[ _ky ] / _direction.array[ _kz ];
+    _shear.array[ 2 ] = T( 1 ) / _direction.array[ _kz ];
+}
+
+/**
+ * @return a * b - c * d with the correct sign. A compiler contracting the
+ * expression to an FMA would round the two products differently, so that
+ * the edge shared by two triangles could fail both tests. Kahan's algorithm
+ * has a relative error of at most two ulps, so its sign is always exact.
+ */
+template< typename T > template< typename F >
+inline F Ray< T >::_difference( const F a, const F b, const F c, const F d )
+{
+#ifdef FP_FAST_FMA
+    const F cd = c * d;
+    const F error = std::fma( -c, d, cd );
+    return std::fma( a, b, -cd ) + error;
+#else
+    return a * b - c * d;
+#endif
+}
+
 
 template< typename T >
 T Ray< T >::test( const vec4& sphere ) const
@@ -113,6 +234,84 @@ T Ray< T >::test( const vec4& sphere ) const
     return vecProjection + distSurface;
 }
 
+template< typename T >
+T Ray< T >::test( const AABB< T >& aabb ) const
+{
+    const vec3* const bounds[ 2 ] = { &aabb.getMin(), &aabb.getMax() };
+
+    T entry = -std::numeric_limits< T >::max();
+    T exit = std::numeric_limits< T >::max();
+    for( size_t i = 0; i < 3; ++i )
+    {
+        const T t0 = ( bounds[ _sign[ i ]]->array[ i ] - _origin.array[ i ] ) *
+                     _invDirection.array[ i ];
+        const T t1 = ( bounds[ 1 - _sign[ i ]]->array[ i ] -
+                       _origin.array[ i ] ) * _invDirection.array[ i ];
+        // written to ignore the NaN of a ray in the plane of a slab
+        entry = t0 > entry ? t0 : entry;
+        exit = t1 < exit ? t1 : exit;
+    }
+
+    if( entry > exit || exit < 0 )
+        return -1.f;
+    return entry >= 0 ? entry : exit;
+}
+
+template< typename T >
+T Ray< T >::test( const vec3& a, const vec3& b, const vec3& c ) const
+{
+    vec3 barycentric;
+    return test( a, b, c, barycentric );
+}
+
+template< typename T >
+T Ray< T >::test( const vec3& a, const vec3& b, const vec3& c,
+                  vec3& barycentric ) const
+{
+    // vertices relative to the origin
+    const vec3 A = a - _origin;
+    const vec3 B = b - _origin;
+    const vec3 C = c - _origin;
+
+    // shear and scale the vertices such that the ray is the unit z axis
+    const T Ax = A.array[ _kx ] - _shear.array[ 0 ] * A.array[ _kz ];
+    const T Ay = A.array[ _ky ] - _shear.array[ 1 ] * A.array[ _kz ];
+    const T Bx = B.array[ _kx ] - _shear.array[ 0 ] * B.array[ _kz ];
+    const T By = B.array[ _ky ] - _shear.array[ 1 ] * B.array[ _kz ];
+    const T Cx = C.array[ _kx ] - _shear.array[ 0 ] * C.array[ _kz ];
+    const T Cy = C.array[ _ky ] - _shear.array[ 1 ] * C.array[ _kz ];
+
+    // scaled barycentric coordinates, recomputed in double precision on an
+    // edge to be robust
+    T U = _difference( Cx, By, Cy, Bx );
+    T V = _difference( Ax, Cy, Ay, Cx );
+    T W = _difference( Bx, Ay, By, Ax );
+    if( U == 0 || V == 0 || W == 0 )
+    {
+        U = T( _difference< double >( Cx, By, Cy, Bx ));
+        V = T( _difference< double >( Ax, Cy, Ay, Cx ));
+        W = T( _difference< double >( Bx, Ay, By, Ax ));
+    }
+
+    if(( U < 0 || V < 0 || W < 0 ) && ( U > 0 || V > 0 || W > 0 ))
+        return -1.f;
+
+    const T det = U + V + W;
+    if( det == 0 )
+        return -1.f;
+
+    const T Az = _shear.array[ 2 ] * A.array[ _kz ];
+    const T Bz = _shear.array[ 2 ] * B.array[ _kz ];
+    const T Cz = _shear.array[ 2 ] * C.array[ _kz ];
+    const T distance = ( U * Az + V * Bz + W * Cz ) / det;
+    if( distance < 0 )
+        return -1.f;
+
+    const T invDet = T( 1 ) / det;
+    barycentric = vec3( U * invDet, V * invDet, W * invDet );
+    return distance;
+}
+
 } // namespace vmml
 
 #endif
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__RAY_PACKET__HPP__
+#define __VMML__RAY_PACKET__HPP__
+
+#include <vmmlib/aabb.hpp> // inline parameter
+#include <vmmlib/dispatch.hpp> // used inline
+#include <vmmlib/ray.hpp> // inline parameter
+#include <vmmlib/simd.hpp> // used inline
+#include <vmmlib/vector.hpp> // member
+
+#include <limits>
+
+namespace vmml
+{
+/**
+ * A packet of N rays, stored as a structure of arrays.
+ *
+ * Tests all rays of the packet against one object using SIMD instructions,
+ * which pays off for coherent rays such as the primary rays of a screen tile.
+ * N should be a multiple of four, typically 4, 8 or 16, and at most 32. The
+ * widest SIMD instructions of the CPU available for N rays are used, see
+ * dispatch.hpp.
+ */
+template< typename T, size_t N > class RayPacket
+{
+    static_assert( N > 0 && N <= 32, "RayPacket has 1 to 32 rays, the bits of "
+                                     "the hit mask" );
+
+public:
+    typedef vector< 3, T > vec3;
+    typedef vector< 4, T > vec4;
+
+    static const size_t SIZE = N; //!< the number of rays
+
+    /** Construct a packet of rays from the origin along the z axis. */
+    RayPacket();
+
+    /** Construct a packet from N rays. */
+    explicit RayPacket( const Ray< T >* rays );
+
+    /** Set the ray at the given index. */
+    void set( size_t index, const Ray< T >& ray );
+
+    /** Set the ray at the given index, normalizing the direction. */
+    void set( size_t index, const vec3& origin, const vec3& direction );
+
+    /** @return the ray at the given index. */
+    Ray< T > get( size_t index ) const;
+
+    /**
+     * Intersect all rays with a sphere.
+     *
+     * Same result per ray as Ray::test( sphere ): the distance to the entry
+     * point, or to the exit point if the ray starts inside the sphere.
+     *
+     * @param sphere the sphere, center xyz and radius w
+     * @param distances N distances, negative for the rays missing the sphere
+     * @return the hit mask, bit i is set if ray i intersects the sphere
+     */
+    unsigned test( const vec4& sphere, T* distances ) const;
+
+    /**
+     * Intersect all rays with an axis-aligned box using the slab method.
+     *
+     * Same result per ray as Ray::test( aabb ): the distance to the entry
+     * point, or to the exit point if the ray starts inside the box.
+     *
+     * @param aabb the box
+     * @param distances N distances, negative for the rays missing the box
+     * @return the hit mask, bit i is set if ray i intersects the box
+     */
+    unsigned test( const AABB< T >& aabb, T* distances ) const;
+
+private:
+    T _origin[ 3 ][ N ];
+    T _direction[ 3 ][ N ];
+    T _invDirection[ 3 ][ N ];
+
+    // The loop over the packs of rays, run by dispatch()
+    template< class O > class _Test;
+
+    template< class P > VMMLIB_SIMD_INLINE
+    unsigned _test( const vec4& sphere, T* distances, size_t i ) const;
+    template< class P > VMMLIB_SIMD_INLINE
+    unsigned _test( const AABB< T >& aabb, T* distances, size_t i ) const;
+};
+
+// - implementation -
+
+template< typename T, size_t N > const size_t RayPacket< T, N >::SIZE;
+
+template< typename T, size_t N > RayPacket< T, N >::RayPacket()
+{
+    for( size_t i = 0; i < N; ++i )
+        set( i, vec3::ZERO, vec3::UNIT_Z );
+}
+
+template< typename T, size_t N >
+RayPacket< T, N >::RayPacket( const Ray< T >* rays )
+{
+    for( size_t i = 0; i < N; ++i )
+        set( i, rays[i] );
+}
+
+template< typename T, size_t N >
+void RayPacket< T, N >::set( const size_t index, const Ray< T >& ray )
+{
+    // the direction of a Ray is already normalized
+    for( size_t i = 0; i < 3; ++i )
+    {
+        _origin[ i ][ index ] = ray.getOrigin().array[ i ];
+        _direction[ i ][ index ] = ray.getDirection().array[ i ];
+        _invDirection[ i ][ index ] = T( 1 ) / _direction[ i ][ index ];
+    }
+}
+
+template< typename T, size_t N >
+void RayPacket< T, N >::set( const size_t index, const vec3& origin,
+                             const vec3& direction )
+{
+    set( index, Ray< T >( origin, direction ));
+}
+
+template< typename T, size_t N >
+Ray< T > RayPacket< T, N >::get( const size_t index ) const
+{
+    return Ray< T >( vec3( _origin[ 0 ][ index ], _origin[ 1 ][ index ],
+                           _origin[ 2 ][ index ] ),
+                     vec3( _direction[ 0 ][ index ], _direction[ 1 ][ index ],
+                           _direction[ 2 ][ index ] ));
+}
+
+template< typename T, size_t N > template< class O >
+class RayPacket< T, N >::_Test
+{
+public:
+    typedef unsigned result_type;
+
+    _Test( const RayPacket& packet, const O& object, T* distances )
+        : _packet( packet ), _object( object ), _distances( distances )
+    {}
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE unsigned run() const
+    {
+        typedef typename simd::Pack< T, L, N >::type P;
+        const size_t end = N - N % P::width;
+        unsigned hits = 0;
+        size_t i = 0;
+        for( ; i < end; i += P::width )
+            hits |= _packet.template _test< P >( _object, _distances, i ) << i;
+        for( ; i < N; ++i )
+            hits |= _packet.template _test< simd::Scalar< T > >(
+                        _object, _distances, i ) << i;
+        return hits;
+    }
+
+private:
+    const RayPacket& _packet;
+    const O& _object;
+    T* const _distances;
+};
+
+template< typename T, size_t N >
+unsigned RayPacket< T, N >::test( const vec4& sphere, T* distances ) const
+{
+    return dispatch( _Test< vec4 >( *this, sphere, distances ));
+}
+
+template< typename T, size_t N >
+unsigned RayPacket< T, N >::test( const AABB< T >& aabb, T* distances ) const
+{
+    return dispatch( _Test< AABB< T > >( *this, aabb, distances ));
+}
+
+VMMLIB_SIMD_KERNELS_BEGIN
+template< typename T, size_t N > template< class P >
+unsigned RayPacket< T, N >::_test( const vec4& sphere, T* distances,
+                                   const size_t i ) const
+{
+    typedef typename P::type V;
+    typedef typename P::mask Mask;
+
+    // see Ray::test( sphere )
+    const V cx = P::sub( P::set( sphere.array[ 0 ] ),
+                         P::load( _origin[ 0 ] + i ));
+    const V cy = P::sub( P::set( sphere.array[ 1 ] ),
+                         P::load( _origin[ 1 ] + i ));
+    const V cz = P::sub( P::set( sphere.array[ 2 ] ),
+                         P::load( _origin[ 2 ] + i ));
+    const V projection = P::add( P::add(
+        P::mul( cx, P::load( _direction[ 0 ] + i )),
+        P::mul( cy, P::load( _direction[ 1 ] + i ))),
+        P::mul( cz, P::load( _direction[ 2 ] + i )));
+    const V sqDistance = P::add( P::add( P::mul( cx, cx ), P::mul( cy, cy )),
+                                 P::mul( cz, cz ));
+    const V sqRadius = P::set( sphere.array[ 3 ] * sphere.array[ 3 ] );
+    const V sqCenterToProjection = P::sub( sqDistance,
+                                           P::mul( projection, projection ));
+
+    const V zero = P::set( 0 );
+    const Mask outside = P::gt( sqDistance, sqRadius );
+    const Mask behind = P::andMask( P::lt( projection, zero ), outside );
+    const Mask miss = P::orMask( behind,
+                                 P::gt( sqCenterToProjection, sqRadius ));
+
+    const V surface = P::sqrt( P::max( P::sub( sqRadius, sqCenterToProjection ),
+                                       zero ));
+    const V distance = P::select( outside, P::sub( projection, surface ),
+                                  P::add( projection, surface ));
+    P::store( distances + i, P::select( miss, P::set( -1 ), distance ));
+    return ~P::bits( miss ) & ( ( 1u << P::width ) - 1 );
+}
+
+template< typename T, size_t N > template< class P >
+unsigned RayPacket< T, N >::_test( const AABB< T >& aabb, T* distances,
+                                   const size_t i ) const
+{
+    typedef typename P::type V;
+
+    // branchless slab test, see Ray::test( aabb ): the near and far bounds
+    // by direction sign, and a NaN distance of a ray in the plane of a slab
+    // as the first operand of max() and min(), which then ignore it
+    V entry = P::set( -std::numeric_limits< T >::max( ));
+    V exit = P::set( std::numeric_limits< T >::max( ));
+    for( size_t j = 0; j < 3; ++j )
+    {
+        const V origin = P::load( _origin[ j ] + i );
+        const V invDirection = P::load( _invDirection[ j ] + i );
+        const V lower = P::set( aabb.getMin().array[ j ] );
+        const V upper = P::set( aabb.getMax().array[ j ] );
+        const typename P::mask negative = P::lt( invDirection, P::set( 0 ));
+        const V t0 = P::mul( P::sub( P::select( negative, upper, lower ),
+                                     origin ), invDirection );
+        const V t1 = P::mul( P::sub( P::select( negative, lower, upper ),
+                                     origin ), invDirection );
+        entry = P::max( t0, entry );
+        exit = P::min( t1, exit );
+    }
+
+    const V zero = P::set( 0 );
+    const typename P::mask hit = P::andMask( P::le( entry, exit ),
+                                             P::ge( exit, zero ));
+    const V distance = P::select( P::ge( entry, zero ), entry, exit );
+    P::store( distances + i, P::select( hit, distance, P::set( -1 )));
+    return P::bits( hit );
+}
+VMMLIB_SIMD_KERNELS_END
+
+} // namespace vmml
+
+#endif
@@ -0,0 +1,651 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __VMML__SIMD__HPP__
+#define __VMML__SIMD__HPP__
+
+/**
+ * @file simd.hpp
+ *
+ * Detection of the SIMD instruction sets used by the optimized vmmlib
+ * kernels, and the SIMD pack types used by the batch kernels. Each
+ * VMMLIB_<ISA> macro is defined if the compiler targets the instruction set.
+ * Define VMMLIB_NO_SIMD before including any vmmlib header to force the
+ * portable scalar implementations.
+ *
+ * VMMLIB_SIMD_DISPATCH is defined if the compiler can generate code for
+ * instruction sets beyond its target in individual functions, which is the
+ * case for GCC, Clang and Visual Studio on x86-64. All pack types are then
+ * available, and the batch kernels select the instruction set at runtime, see
+ * dispatch.hpp.
+ */
+
+#ifndef VMMLIB_NO_SIMD
+#  if defined( __SSE2__ ) || defined( _M_X64 ) || \
+      ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#    define VMMLIB_SSE2
+#  endif
+#  ifdef __SSE4_1__
+#    define VMMLIB_SSE41
+#  endif
+#  ifdef __AVX__
+#    define VMMLIB_AVX
+#  endif
+#  ifdef __AVX2__
+#    define VMMLIB_AVX2
+#  endif
+#  ifdef __FMA__
+#    define VMMLIB_FMA
+#  endif
+#  ifdef __AVX512F__
+#    define VMMLIB_AVX512
+#  endif
+
+#  if defined( VMMLIB_SSE2 ) && \
+      ( defined( __clang__ ) || defined( _MSC_VER ) || \
+        ( defined( __GNUC__ ) && \
+          ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 9 ))))
+#    define VMMLIB_SIMD_DISPATCH
+#  endif
+#endif
+
+// Instruction sets of the functions compiled for a higher SIMD level than the
+// compiler targets. Visual Studio accepts all intrinsics in any function.
+#if defined( VMMLIB_SIMD_DISPATCH ) && !defined( _MSC_VER )
+#  define VMMLIB_TARGET( isa ) __attribute__(( target( isa )))
+#else
+#  define VMMLIB_TARGET( isa )
+#endif
+#define VMMLIB_TARGET_SSE41 VMMLIB_TARGET( "sse4.1" )
+#define VMMLIB_TARGET_AVX VMMLIB_TARGET( "avx" )
+#define VMMLIB_TARGET_AVX2 VMMLIB_TARGET( "avx2,fma" )
+#define VMMLIB_TARGET_AVX512 VMMLIB_TARGET( "avx512f,avx2,fma" )
+
+// Kernels instantiated for a pack type are inlined into the function compiled
+// for its instruction set. Since they are compiled for the default target,
+// they must not pass or return SIMD registers by value themselves.
+#ifdef _MSC_VER
+#  define VMMLIB_SIMD_INLINE __forceinline
+#else
+#  define VMMLIB_SIMD_INLINE inline __attribute__(( always_inline ))
+#endif
+
+// The alignment of types loaded with aligned SIMD instructions
+#ifdef _MSC_VER
+#  define VMMLIB_ALIGN( bytes ) __declspec( align( bytes ))
+#else
+#  define VMMLIB_ALIGN( bytes ) __attribute__(( aligned( bytes )))
+#endif
+
+// Enclose the kernels calling the packs of a higher SIMD level. GCC warns about
+// the vector ABI on these calls, which does not apply once they are inlined.
+#if defined( VMMLIB_SIMD_DISPATCH ) && defined( __GNUC__ ) && \
+    !defined( __clang__ )
+#  define VMMLIB_SIMD_KERNELS_BEGIN \
+    _Pragma( "GCC diagnostic push" ) \
+    _Pragma( "GCC diagnostic ignored \"-Wpsabi\"" )
+#  define VMMLIB_SIMD_KERNELS_END _Pragma( "GCC diagnostic pop" )
+#else
+#  define VMMLIB_SIMD_KERNELS_BEGIN
+#  define VMMLIB_SIMD_KERNELS_END
+#endif
+
+#ifdef VMMLIB_SSE2
+#  include <immintrin.h>
+#endif
+#include <cmath>
+#include <cstddef>
+#include <stdint.h>
+
+namespace vmml
+{
+/**
+ * The instruction set levels of the batch kernels, in increasing order. Each
+ * level includes all lower levels.
+ */
+enum SIMDLevel
+{
+    SIMD_SCALAR, //!< portable C++ code
+    SIMD_SSE2,
+    SIMD_SSE41,
+    SIMD_AVX,
+    SIMD_AVX2, //!< AVX2 and FMA
+    SIMD_AVX512 //!< AVX-512F, AVX2 and FMA
+};
+
+/**
+ * Thin wrappers around SIMD registers used by the batch kernels.
+ *
+ * Each pack type provides the same static interface, so that one kernel
+ * template can be instantiated for all supported register widths. The scalar
+ * pack is the portable fallback and processes the remainder of a batch. Masks
+ * are opaque; bits() returns them as an integer with one bit per lane.
+ * gather() and scatter() access one lane every stride elements, e.g. one
+ * component of an array of vectors. storeInt() and loadInt() convert to and
+ * from 32-bit integers, rounding to nearest, e.g. for quantization. Like the
+ * SSE instructions, min() and max() return the second operand if either
+ * operand is NaN.
+ */
+namespace simd
+{
+template< typename T > struct Scalar
+{
+    typedef T value_type;
+    typedef T type;
+    typedef bool mask;
+    enum { width = 1 };
+
+    static type set( const T value ) { return value; }
+    static type load( const T* ptr ) { return *ptr; }
+    static void store( T* ptr, const type a ) { *ptr = a; }
+    static type gather( const T* ptr, size_t ) { return *ptr; }
+    static void scatter( T* ptr, size_t, const type a ) { *ptr = a; }
+    static void storeInt( int32_t* ptr, const type a )
+        { *ptr = int32_t( std::lrint( a )); }
+    static type loadInt( const int32_t* ptr ) { return type( *ptr ); }
+
+    static type add( const type a, const type b ) { return a + b; }
+    static type sub( const type a, const type b ) { return a - b; }
+    static type mul( const type a, const type b ) { return a * b; }
+    static type div( const type a, const type b ) { return a / b; }
+    static type madd( const type a, const type b, const type c )
+        { return a * b + c; }
+    static type min( const type a, const type b ) { return a < b ? a : b; }
+    static type max( const type a, const type b ) { return a > b ? a : b; }
+    static type abs( const type a ) { return std::abs( a ); }
+    static type sqrt( const type a ) { return std::sqrt( a ); }
+
+    static mask lt( const type a, const type b ) { return a < b; }
+    static mask le( const type a, const type b ) { return a <= b; }
+    static mask gt( const type a, const type b ) { return a > b; }
+    static mask ge( const type a, const type b ) { return a >= b; }
+    static mask andMask( const mask a, const mask b ) { return a && b; }
+    static mask orMask( const mask a, const mask b ) { return a || b; }
+    static type select( const mask m, const type a, const type b )
+        { return m ? a : b; }
+    static unsigned bits( const mask m ) { return m ? 1u : 0u; }
+};
+
+#ifdef VMMLIB_SSE2
+struct Float4
+{
+    typedef float value_type;
+    typedef __m128 type;
+    typedef __m128 mask;
+    enum { width = 4 };
+
+    static type set( const float value ) { return _mm_set1_ps( value ); }
+    static type load( const float* ptr ) { return _mm_loadu_ps( ptr ); }
+    static void store( float* ptr, const type a ) { _mm_storeu_ps( ptr, a ); }
+    static type gather( const float* ptr, const size_t stride )
+        { return _mm_setr_ps( ptr[0], ptr[stride], ptr[2*stride],
+                              ptr[3*stride] ); }
+    static void scatter( float* ptr, const size_t stride, const type a )
+    {
+        float lanes[4];
+        _mm_storeu_ps( lanes, a );
+        ptr[0] = lanes[0]; ptr[stride] = lanes[1];
+        ptr[2*stride] = lanes[2]; ptr[3*stride] = lanes[3];
+    }
+    static void storeInt( int32_t* ptr, const type a )
+        { _mm_storeu_si128( (__m128i*)ptr, _mm_cvtps_epi32( a )); }
+    static type loadInt( const int32_t* ptr )
+        { return _mm_cvtepi32_ps( _mm_loadu_si128( (const __m128i*)ptr )); }
+
+    static type add( const type a, const type b ) { return _mm_add_ps( a, b ); }
+    static type sub( const type a, const type b ) { return _mm_sub_ps( a, b ); }
+    static type mul( const type a, const type b ) { return _mm_mul_ps( a, b ); }
+    static type div( const type a, const type b ) { return _mm_div_ps( a, b ); }
+    static type madd( const type a, const type b, const type c )
+#  ifdef VMMLIB_FMA
+        { return _mm_fmadd_ps( a, b, c ); }
+#  else
+        { return _mm_add_ps( _mm_mul_ps( a, b ), c ); }
+#  endif
+    static type min( const type a, const type b ) { return _mm_min_ps( a, b ); }
+    static type max( const type a, const type b ) { return _mm_max_ps( a, b ); }
+    static type abs( const type a )
+        { return _mm_andnot_ps( _mm_set1_ps( -0.f ), a ); }
+    static type sqrt( const type a ) { return _mm_sqrt_ps( a ); }
+
+    static mask lt( const type a, const type b ) { return _mm_cmplt_ps( a, b ); }
+    static mask le( const type a, const type b ) { return _mm_cmple_ps( a, b ); }
+    static mask gt( const type a, const type b ) { return _mm_cmpgt_ps( a, b ); }
+    static mask ge( const type a, const type b ) { return _mm_cmpge_ps( a, b ); }
+    static mask andMask( const mask a, const mask b )
+        { return _mm_and_ps( a, b ); }
+    static mask orMask( const mask a, const mask b )
+        { return _mm_or_ps( a, b ); }
+    static type select( const mask m, const type a, const type b )
+        { return _mm_or_ps( _mm_and_ps( m, a ), _mm_andnot_ps( m, b )); }
+    static unsigned bits( const mask m ) { return _mm_movemask_ps( m ); }
+};
+
+struct Double2
+{
+    typedef double value_type;
+    typedef __m128d type;
+    typedef __m128d mask;
+    enum { width = 2 };
+
+    static type set( const double value ) { return _mm_set1_pd( value ); }
+    static type load( const double* ptr ) { return _mm_loadu_pd( ptr ); }
+    static void store( double* ptr, const type a ) { _mm_storeu_pd( ptr, a ); }
+    static type gather( const double* ptr, const size_t stride )
+        { return _mm_setr_pd( ptr[0], ptr[stride] ); }
+    static void scatter( double* ptr, const size_t stride, const type a )
+        { _mm_storel_pd( ptr, a ); _mm_storeh_pd( ptr + stride, a ); }
+    static void storeInt( int32_t* ptr, const type a )
+        { _mm_storel_epi64( (__m128i*)ptr, _mm_cvtpd_epi32( a )); }
+    static type loadInt( const int32_t* ptr )
+        { return _mm_cvtepi32_pd( _mm_loadl_epi64( (const __m128i*)ptr )); }
+
+    static type add( const type a, const type b ) { return _mm_add_pd( a, b ); }
+    static type sub( const type a, const type b ) { return _mm_sub_pd( a, b ); }
+    static type mul( const type a, const type b ) { return _mm_mul_pd( a, b ); }
+    static type div( const type a, const type b ) { return _mm_div_pd( a, b ); }
+    static type madd( const type a, const type b, const type c )
+#  ifdef VMMLIB_FMA
+        { return _mm_fmadd_pd( a, b, c ); }
+#  else
+        { return _mm_add_pd( _mm_mul_pd( a, b ), c ); }
+#  endif
+    static type min( const type a, const type b ) { return _mm_min_pd( a, b ); }
+    static type max( const type a, const type b ) { return _mm_max_pd( a, b ); }
+    static type abs( const type a )
+        { return _mm_andnot_pd( _mm_set1_pd( -0. ), a ); }
+    static type sqrt( const type a ) { return _mm_sqrt_pd( a ); }
+
+    static mask lt( const type a, const type b ) { return _mm_cmplt_pd( a, b ); }
+    static mask le( const type a, const type b ) { return _mm_cmple_pd( a, b ); }
+    static mask gt( const type a, const type b ) { return _mm_cmpgt_pd( a, b ); }
+    static mask ge( const type a, const type b ) { return _mm_cmpge_pd( a, b ); }
+    static mask andMask( const mask a, const mask b )
+        { return _mm_and_pd( a, b ); }
+    static mask orMask( const mask a, const mask b )
+        { return _mm_or_pd( a, b ); }
+    static type select( const mask m, const type a, const type b )
+        { return _mm_or_pd( _mm_and_pd( m, a ), _mm_andnot_pd( m, b )); }
+    static unsigned bits( const mask m ) { return _mm_movemask_pd( m ); }
+};
+#endif
+
+#if defined( VMMLIB_AVX ) || defined( VMMLIB_SIMD_DISPATCH )
+struct Float8
+{
+    typedef float value_type;
+    typedef __m256 type;
+    typedef __m256 mask;
+    enum { width = 8 };
+
+    VMMLIB_TARGET_AVX static type set( const float value )
+        { return _mm256_set1_ps( value ); }
+    VMMLIB_TARGET_AVX static type load( const float* ptr )
+        { return _mm256_loadu_ps( ptr ); }
+    VMMLIB_TARGET_AVX static void store( float* ptr, const type a )
+        { _mm256_storeu_ps( ptr, a ); }
+    VMMLIB_TARGET_AVX static type gather( const float* ptr,
+                                          const size_t stride )
+        { return _mm256_setr_ps( ptr[0], ptr[stride], ptr[2*stride],
+                                 ptr[3*stride], ptr[4*stride], ptr[5*stride],
+                                 ptr[6*stride], ptr[7*stride] ); }
+    VMMLIB_TARGET_AVX static void scatter( float* ptr, const size_t stride,
+                                           const type a )
+    {
+        Float4::scatter( ptr, stride, _mm256_castps256_ps128( a ));
+        Float4::scatter( ptr + 4 * stride, stride,
+                         _mm256_extractf128_ps( a, 1 ));
+    }
+    VMMLIB_TARGET_AVX static void storeInt( int32_t* ptr, const type a )
+        { _mm256_storeu_si256( (__m256i*)ptr, _mm256_cvtps_epi32( a )); }
+    VMMLIB_TARGET_AVX static type loadInt( const int32_t* ptr )
+        { return _mm256_cvtepi32_ps(
+                     _mm256_loadu_si256( (const __m256i*)ptr )); }
+
+    VMMLIB_TARGET_AVX static type add( const type a, const type b )
+        { return _mm256_add_ps( a, b ); }
+    VMMLIB_TARGET_AVX static type sub( const type a, const type b )
+        { return _mm256_sub_ps( a, b ); }
+    VMMLIB_TARGET_AVX static type mul( const type a, const type b )
+        { return _mm256_mul_ps( a, b ); }
+    VMMLIB_TARGET_AVX static type div( const type a, const type b )
+        { return _mm256_div_ps( a, b ); }
+    VMMLIB_TARGET_AVX static type madd( const type a, const type b,
+                                        const type c )
+#  ifdef VMMLIB_FMA
+        { return _mm256_fmadd_ps( a, b, c ); }
+#  else
+        { return _mm256_add_ps( _mm256_mul_ps( a, b ), c ); }
+#  endif
+    VMMLIB_TARGET_AVX static type min( const type a, const type b )
+        { return _mm256_min_ps( a, b ); }
+    VMMLIB_TARGET_AVX static type max( const type a, const type b )
+        { return _mm256_max_ps( a, b ); }
+    VMMLIB_TARGET_AVX static type abs( const type a )
+        { return _mm256_andnot_ps( _mm256_set1_ps( -0.f ), a ); }
+    VMMLIB_TARGET_AVX static type sqrt( const type a )
+        { return _mm256_sqrt_ps( a ); }
+
+    VMMLIB_TARGET_AVX static mask lt( const type a, const type b )
+        { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+    VMMLIB_TARGET_AVX static mask le( const type a, const type b )
+        { return _mm256_cmp_ps( a, b, _CMP_LE_OQ ); }
+    VMMLIB_TARGET_AVX static mask gt( const type a, const type b )
+        { return _mm256_cmp_ps( a, b, _CMP_GT_OQ ); }
+    VMMLIB_TARGET_AVX static mask ge( const type a, const type b )
+        { return _mm256_cmp_ps( a, b, _CMP_GE_OQ ); }
+    VMMLIB_TARGET_AVX static mask andMask( const mask a, const mask b )
+        { return _mm256_and_ps( a, b ); }
+    VMMLIB_TARGET_AVX static mask orMask( const mask a, const mask b )
+        { return _mm256_or_ps( a, b ); }
+    VMMLIB_TARGET_AVX static type select( const mask m, const type a,
+                                          const type b )
+        { return _mm256_blendv_ps( b, a, m ); }
+    VMMLIB_TARGET_AVX static unsigned bits( const mask m )
+        { return _mm256_movemask_ps( m ); }
+};
+
+struct Double4
+{
+    typedef double value_type;
+    typedef __m256d type;
+    typedef __m256d mask;
+    enum { width = 4 };
+
+    VMMLIB_TARGET_AVX static type set( const double value )
+        { return _mm256_set1_pd( value ); }
+    VMMLIB_TARGET_AVX static type load( const double* ptr )
+        { return _mm256_loadu_pd( ptr ); }
+    VMMLIB_TARGET_AVX static void store( double* ptr, const type a )
+        { _mm256_storeu_pd( ptr, a ); }
+    VMMLIB_TARGET_AVX static type gather( const double* ptr,
+                                          const size_t stride )
+        { return _mm256_setr_pd( ptr[0], ptr[stride], ptr[2*stride],
+                                 ptr[3*stride] ); }
+    VMMLIB_TARGET_AVX static void scatter( double* ptr, const size_t stride,
+                                           const type a )
+    {
+        Double2::scatter( ptr, stride, _mm256_castpd256_pd128( a ));
+        Double2::scatter( ptr + 2 * stride, stride,
+                          _mm256_extractf128_pd( a, 1 ));
+    }
+    VMMLIB_TARGET_AVX static void storeInt( int32_t* ptr, const type a )
+        { _mm_storeu_si128( (__m128i*)ptr, _mm256_cvtpd_epi32( a )); }
+    VMMLIB_TARGET_AVX static type loadInt( const int32_t* ptr )
+        { return _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*)ptr )); }
+
+    VMMLIB_TARGET_AVX static type add( const type a, const type b )
+        { return _mm256_add_pd( a, b ); }
+    VMMLIB_TARGET_AVX static type sub( const type a, const type b )
+        { return _mm256_sub_pd( a, b ); }
+    VMMLIB_TARGET_AVX static type mul( const type a, const type b )
+        { return _mm256_mul_pd( a, b ); }
+    VMMLIB_TARGET_AVX static type div( const type a, const type b )
+        { return _mm256_div_pd( a, b ); }
+    VMMLIB_TARGET_AVX static type madd( const type a, const type b,
+                                        const type c )
+#  ifdef VMMLIB_FMA
+        { return _mm256_fmadd_pd( a, b, c ); }
+#  else
+        { return _mm256_add_pd( _mm256_mul_pd( a, b ), c ); }
+#  endif
+    VMMLIB_TARGET_AVX static type min( const type a, const type b )
+        { return _mm256_min_pd( a, b ); }
+    VMMLIB_TARGET_AVX static type max( const type a, const type b )
+        { return _mm256_max_pd( a, b ); }
+    VMMLIB_TARGET_AVX static type abs( const type a )
+        { return _mm256_andnot_pd( _mm256_set1_pd( -0. ), a ); }
+    VMMLIB_TARGET_AVX static type sqrt( const type a )
+        { return _mm256_sqrt_pd( a ); }
+
+    VMMLIB_TARGET_AVX static mask lt( const type a, const type b )
+        { return _mm256_cmp_pd( a, b, _CMP_LT_OQ ); }
+    VMMLIB_TARGET_AVX static mask le( const type a, const type b )
+        { return _mm256_cmp_pd( a, b, _CMP_LE_OQ ); }
+    VMMLIB_TARGET_AVX static mask gt( const type a, const type b )
+        { return _mm256_cmp_pd( a, b, _CMP_GT_OQ ); }
+    VMMLIB_TARGET_AVX static mask ge( const type a, const type b )
+        { return _mm256_cmp_pd( a, b, _CMP_GE_OQ ); }
+    VMMLIB_TARGET_AVX static mask andMask( const mask a, const mask b )
+        { return _mm256_and_pd( a, b ); }
+    VMMLIB_TARGET_AVX static mask orMask( const mask a, const mask b )
+        { return _mm256_or_pd( a, b ); }
+    VMMLIB_TARGET_AVX static type select( const mask m, const type a,
+                                          const type b )
+        { return _mm256_blendv_pd( b, a, m ); }
+    VMMLIB_TARGET_AVX static unsigned bits( const mask m )
+        { return _mm256_movemask_pd( m ); }
+};
+#endif
+
+#if defined( VMMLIB_FMA ) || defined( VMMLIB_SIMD_DISPATCH )
+// The packs of the SIMD_AVX2 level fuse the multiply-add
+struct Float4Fma : public Float4
+{
+    VMMLIB_TARGET_AVX2 static type madd( const type a, const type b,
+                                         const type c )
+        { return _mm_fmadd_ps( a, b, c ); }
+};
+
+struct Double2Fma : public Double2
+{
+    VMMLIB_TARGET_AVX2 static type madd( const type a, const type b,
+                                         const type c )
+        { return _mm_fmadd_pd( a, b, c ); }
+};
+
+struct Float8Fma : public Float8
+{
+    VMMLIB_TARGET_AVX2 static type madd( const type a, const type b,
+                                         const type c )
+        { return _mm256_fmadd_ps( a, b, c ); }
+};
+
+struct Double4Fma : public Double4
+{
+    VMMLIB_TARGET_AVX2 static type madd( const type a, const type b,
+                                         const type c )
+        { return _mm256_fmadd_pd( a, b, c ); }
+};
+#endif
+
+#if defined( VMMLIB_AVX512 ) || defined( VMMLIB_SIMD_DISPATCH )
+struct Float16
+{
+    typedef float value_type;
+    typedef __m512 type;
+    typedef __mmask16 mask;
+    enum { width = 16 };
+
+    VMMLIB_TARGET_AVX512 static type set( const float value )
+        { return _mm512_set1_ps( value ); }
+    VMMLIB_TARGET_AVX512 static type load( const float* ptr )
+        { return _mm512_loadu_ps( ptr ); }
+    VMMLIB_TARGET_AVX512 static void store( float* ptr, const type a )
+        { _mm512_storeu_ps( ptr, a ); }
+    // gather, min, max, sqrt and the conversions use the masked forms to avoid
+    // a GCC -Wmaybe-uninitialized false positive
+    VMMLIB_TARGET_AVX512 static type gather( const float* ptr,
+                                             const size_t stride )
+        { return _mm512_mask_i32gather_ps( _mm512_setzero_ps(), 0xffff,
+                                           _index( stride ), ptr, 4 ); }
+    VMMLIB_TARGET_AVX512 static void scatter( float* ptr, const size_t stride,
+                                              const type a )
+        { _mm512_i32scatter_ps( ptr, _index( stride ), a, 4 ); }
+    VMMLIB_TARGET_AVX512 static void storeInt( int32_t* ptr, const type a )
+        { _mm512_storeu_si512( ptr,
+                               _mm512_maskz_cvtps_epi32( 0xffff, a )); }
+    VMMLIB_TARGET_AVX512 static type loadInt( const int32_t* ptr )
+        { return _mm512_maskz_cvtepi32_ps( 0xffff,
+                                           _mm512_loadu_si512( ptr )); }
+
+    VMMLIB_TARGET_AVX512 static type add( const type a, const type b )
+        { return _mm512_add_ps( a, b ); }
+    VMMLIB_TARGET_AVX512 static type sub( const type a, const type b )
+        { return _mm512_sub_ps( a, b ); }
+    VMMLIB_TARGET_AVX512 static type mul( const type a, const type b )
+        { return _mm512_mul_ps( a, b ); }
+    VMMLIB_TARGET_AVX512 static type div( const type a, const type b )
+        { return _mm512_div_ps( a, b ); }
+    VMMLIB_TARGET_AVX512 static type madd( const type a, const type b,
+                                           const type c )
+        { return _mm512_fmadd_ps( a, b, c ); }
+    VMMLIB_TARGET_AVX512 static type min( const type a, const type b )
+        { return _mm512_maskz_min_ps( 0xffff, a, b ); }
+    VMMLIB_TARGET_AVX512 static type max( const type a, const type b )
+        { return _mm512_maskz_max_ps( 0xffff, a, b ); }
+    VMMLIB_TARGET_AVX512 static type abs( const type a )
+        { return _mm512_abs_ps( a ); }
+    VMMLIB_TARGET_AVX512 static type sqrt( const type a )
+        { return _mm512_maskz_sqrt_ps( 0xffff, a ); }
+
+    VMMLIB_TARGET_AVX512 static mask lt( const type a, const type b )
+        { return _mm512_cmp_ps_mask( a, b, _CMP_LT_OQ ); }
+    VMMLIB_TARGET_AVX512 static mask le( const type a, const type b )
+        { return _mm512_cmp_ps_mask( a, b, _CMP_LE_OQ ); }
+    VMMLIB_TARGET_AVX512 static mask gt( const type a, const type b )
+        { return _mm512_cmp_ps_mask( a, b, _CMP_GT_OQ ); }
+    VMMLIB_TARGET_AVX512 static mask ge( const type a, const type b )
+        { return _mm512_cmp_ps_mask( a, b, _CMP_GE_OQ ); }
+    VMMLIB_TARGET_AVX512 static mask andMask( const mask a, const mask b )
+        { return a & b; }
+    VMMLIB_TARGET_AVX512 static mask orMask( const mask a, const mask b )
+        { return a | b; }
+    VMMLIB_TARGET_AVX512 static type select( const mask m, const type a,
+                                             const type b )
+        { return _mm512_mask_blend_ps( m, b, a ); }
+    VMMLIB_TARGET_AVX512 static unsigned bits( const mask m ) { return m; }
+
+private:
+    VMMLIB_TARGET_AVX512 static __m512i _index( const size_t stride )
+    {
+        return _mm512_mullo_epi32( _mm512_set1_epi32( int( stride )),
+                                   _mm512_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7, 8,
+                                                      9, 10, 11, 12, 13, 14,
+                                                      15 ));
+    }
+};
+#endif
+
+template< bool C, class A, class B > struct Select { typedef A type; };
+template< class A, class B > struct Select< false, A, B > { typedef B type; };
+
+/**
+ * The widest pack of the SIMD level L with at most N lanes, e.g. for kernels
+ * on fixed-size data such as ray packets. Defined for all levels with
+ * VMMLIB_SIMD_DISPATCH, and up to NATIVE_LEVEL otherwise.
+ */
+template< typename T, SIMDLevel L, size_t N = 16 > struct Pack
+{
+    typedef Scalar< T > type;
+};
+
+#if defined( VMMLIB_SSE2 )
+template< size_t N > struct Pack< float, SIMD_SSE2, N >
+{
+    typedef typename Select< ( N >= 4 ), Float4, Scalar< float > >::type type;
+};
+template< size_t N > struct Pack< double, SIMD_SSE2, N >
+{
+    typedef typename Select< ( N >= 2 ), Double2, Scalar< double > >::type type;
+};
+template< typename T, size_t N > struct Pack< T, SIMD_SSE41, N >
+    : public Pack< T, SIMD_SSE2, N > {};
+#endif
+
+#if defined( VMMLIB_AVX ) || defined( VMMLIB_SIMD_DISPATCH )
+template< size_t N > struct Pack< float, SIMD_AVX, N >
+{
+    typedef typename Select< ( N >= 8 ), Float8,
+                      typename Pack< float, SIMD_SSE2, N >::type >::type type;
+};
+template< size_t N > struct Pack< double, SIMD_AVX, N >
+{
+    typedef typename Select< ( N >= 4 ), Double4,
+                      typename Pack< double, SIMD_SSE2, N >::type >::type type;
+};
+#endif
+
+#if defined( VMMLIB_FMA ) || defined( VMMLIB_SIMD_DISPATCH )
+template< size_t N > struct Pack< float, SIMD_AVX2, N >
+{
+    typedef typename Select< ( N >= 8 ), Float8Fma,
+            typename Select< ( N >= 4 ), Float4Fma,
+                             Scalar< float > >::type >::type type;
+};
+template< size_t N > struct Pack< double, SIMD_AVX2, N >
+{
+    typedef typename Select< ( N >= 4 ), Double4Fma,
+            typename Select< ( N >= 2 ), Double2Fma,
+                             Scalar< double > >::type >::type type;
+};
+#endif
+
+#if defined( VMMLIB_AVX512 ) || defined( VMMLIB_SIMD_DISPATCH )
+template< size_t N > struct Pack< float, SIMD_AVX512, N >
+{
+    typedef typename Select< ( N >= 16 ), Float16,
+                      typename Pack< float, SIMD_AVX2, N >::type >::type type;
+};
+template< size_t N > struct Pack< double, SIMD_AVX512, N >
+    : public Pack< double, SIMD_AVX2, N > {};
+#endif
+
+/** The SIMD level targeted by the compiler. */
+#if defined( VMMLIB_AVX512 )
+static const SIMDLevel NATIVE_LEVEL = SIMD_AVX512;
+#elif defined( VMMLIB_AVX2 ) && defined( VMMLIB_FMA )
+static const SIMDLevel NATIVE_LEVEL = SIMD_AVX2;
+#elif defined( VMMLIB_AVX )
+static const SIMDLevel NATIVE_LEVEL = SIMD_AVX;
+#elif defined( VMMLIB_SSE41 )
+static const SIMDLevel NATIVE_LEVEL = SIMD_SSE41;
+#elif defined( VMMLIB_SSE2 )
+static const SIMDLevel NATIVE_LEVEL = SIMD_SSE2;
+#else
+static const SIMDLevel NATIVE_LEVEL = SIMD_SCALAR;
+#endif
+
+/** The widest pack available at compile time for the given element type. */
+template< typename T > struct Native
+{
+    typedef typename Pack< T, NATIVE_LEVEL >::type type;
+};
+
+/** The widest pack available at compile time with at most N lanes. */
+template< typename T, size_t N > struct Fit
+{
+    typedef typename Pack< T, NATIVE_LEVEL, N >::type type;
+};
+} // namespace simd
+} // namespace vmml
+
+#endif
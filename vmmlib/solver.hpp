@@ -0,0 +1,516 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __VMML__SOLVER__HPP__
+#define __VMML__SOLVER__HPP__
+
+/**
+ * @file solver.hpp
+ *
+ * Decompositions of small dense matrices for solving linear systems and
+ * computing inverses and determinants, e.g. for calibration and bundle
+ * adjustment. The matrix sizes are template parameters: the decompositions
+ * work in place on fixed-size storage without heap allocations, and all loop
+ * bounds are compile-time constants which the compiler unrolls for small
+ * sizes.
+ *
+ * A matrix is treated as singular if a pivot is not larger than N * epsilon
+ * times its largest element. The solutions and inverses of singular matrices
+ * are quiet_NaN.
+ */
+
+#include <vmmlib/matrix.hpp> // member
+#include <vmmlib/types.hpp>
+#include <vmmlib/vector.hpp> // used inline
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vmml
+{
+/**
+ * The LU decomposition with partial pivoting of a square matrix, PA = LU.
+ *
+ * The general-purpose solver for square systems; used by computeInverse() and
+ * computeDeterminant() for matrices larger than 4x4.
+ */
+template< size_t N, typename T > class LU
+{
+public:
+    /** Decompose the given matrix. */
+    explicit LU( const Matrix< N, N, T >& matrix );
+
+    /** @return true if the matrix is singular. */
+    bool isSingular() const { return _singular; }
+
+    /** @return the solution x of Ax = b. */
+    vector< N, T > solve( const vector< N, T >& b ) const;
+
+    /** @return the solution X of AX = B. */
+    template< size_t M >
+    Matrix< N, M, T > solve( const Matrix< N, M, T >& b ) const;
+
+    /** @return the inverse of the matrix. */
+    Matrix< N, N, T > inverse() const;
+
+    /** @return the determinant of the matrix. */
+    T determinant() const;
+
+private:
+    Matrix< N, N, T > _lu; // L below the unit diagonal, U above and on it
+    T _inverseDiagonal[ N ]; // of U, to multiply instead of divide
+    size_t _pivots[ N ]; // the row swapped with each row
+    T _sign; // of the row permutation
+    bool _singular;
+
+    void _solve( T* b ) const;
+};
+
+/**
+ * The Cholesky decomposition of a symmetric positive definite matrix,
+ * A = LL^T.
+ *
+ * About twice as fast as LU, e.g. for the normal equations of least squares
+ * problems. Only the lower triangle of the matrix is read.
+ */
+template< size_t N, typename T > class Cholesky
+{
+public:
+    /** Decompose the given matrix. */
+    explicit Cholesky( const Matrix< N, N, T >& matrix );
+
+    /** @return false if the matrix is not positive definite. */
+    bool isPositiveDefinite() const { return _positiveDefinite; }
+
+    /** @return the solution x of Ax = b. */
+    vector< N, T > solve( const vector< N, T >& b ) const;
+
+    /** @return the solution X of AX = B. */
+    template< size_t M >
+    Matrix< N, M, T > solve( const Matrix< N, M, T >& b ) const;
+
+    /** @return the inverse of the matrix. */
+    Matrix< N, N, T > inverse() const;
+
+    /** @return the determinant, quiet_NaN if not positive definite. */
+    T determinant() const;
+
+private:
+    Matrix< N, N, T > _l; // L in the lower triangle
+    T _inverseDiagonal[ N ]; // of L, to multiply instead of divide
+    bool _positiveDefinite;
+
+    void _solve( T* b ) const;
+};
+
+/**
+ * The Householder QR decomposition of a matrix with at least as many rows as
+ * columns, A = QR.
+ *
+ * Slower than LU, but numerically more robust, and solve() computes the least
+ * squares solution of overdetermined systems.
+ */
+template< size_t R, size_t C, typename T > class QR
+{
+    static_assert( R >= C && C > 0, "QR decomposes matrices with at least as "
+                                    "many rows as columns" );
+
+public:
+    /** Decompose the given matrix. */
+    explicit QR( const Matrix< R, C, T >& matrix );
+
+    /** @return true if the columns of the matrix are linearly independent. */
+    bool isFullRank() const { return _fullRank; }
+
+    /** @return the x minimizing the length of Ax - b. */
+    vector< C, T > solve( const vector< R, T >& b ) const;
+
+    /** @return the X minimizing the Frobenius norm of AX - B. */
+    template< size_t M >
+    Matrix< C, M, T > solve( const Matrix< R, M, T >& b ) const;
+
+    /**
+     * @return the inverse of a square matrix, the pseudo-inverse
+     *         (A^T A)^-1 A^T of a matrix with more rows than columns.
+     */
+    Matrix< C, R, T > inverse() const;
+
+    /**
+     * @return the determinant of a square matrix. For more rows than
+     *         columns, its absolute value is sqrt(det(A^T A)).
+     */
+    T determinant() const;
+
+private:
+    Matrix< R, C, T > _qr; // the Householder vectors, R above the diagonal
+    T _diagonal[ C ]; // the diagonal of R
+    T _sign; // the determinant of Q
+    bool _fullRank;
+
+    void _solve( T* b ) const;
+};
+
+// - implementation -
+
+namespace detail
+{
+template< typename T >
+T getSingularThreshold( const T* array, const size_t size, const size_t n )
+{
+    T largest = 0;
+    for( size_t i = 0; i < size; ++i )
+        largest = std::max( largest, std::abs( array[i] ));
+    return T( n ) * std::numeric_limits< T >::epsilon() * largest;
+}
+
+template< size_t R, size_t C, typename T > Matrix< R, C, T > getNaNMatrix()
+{
+    Matrix< R, C, T > matrix;
+    std::fill( matrix.array, matrix.array + R * C,
+               std::numeric_limits< T >::quiet_NaN( ));
+    return matrix;
+}
+}
+
+template< size_t N, typename T >
+LU< N, T >::LU( const Matrix< N, N, T >& matrix )
+    : _lu( matrix )
+    , _sign( 1 )
+    , _singular( false )
+{
+    // right-looking Gaussian elimination, column by column of the column
+    // major storage
+    T* a = _lu.array;
+    const T threshold = detail::getSingularThreshold( a, N * N, N );
+    for( size_t k = 0; k < N; ++k )
+    {
+        size_t pivot = k;
+        for( size_t i = k + 1; i < N; ++i )
+            if( std::abs( a[ k * N + i ] ) > std::abs( a[ k * N + pivot ] ))
+                pivot = i;
+        _pivots[k] = pivot;
+        if( pivot != k )
+        {
+            for( size_t j = 0; j < N; ++j )
+                std::swap( a[ j * N + k ], a[ j * N + pivot ] );
+            _sign = -_sign;
+        }
+
+        const T diagonal = a[ k * N + k ];
+        if( !( std::abs( diagonal ) > threshold ))
+        {
+            _singular = true;
+            continue;
+        }
+
+        const T inverse = T( 1 ) / diagonal;
+        _inverseDiagonal[k] = inverse;
+        for( size_t i = k + 1; i < N; ++i )
+            a[ k * N + i ] *= inverse;
+        for( size_t j = k + 1; j < N; ++j )
+        {
+            const T factor = a[ j * N + k ];
+            for( size_t i = k + 1; i < N; ++i )
+                a[ j * N + i ] -= a[ k * N + i ] * factor;
+        }
+    }
+}
+
+template< size_t N, typename T >
+void LU< N, T >::_solve( T* b ) const
+{
+    if( _singular )
+    {
+        std::fill( b, b + N, std::numeric_limits< T >::quiet_NaN( ));
+        return;
+    }
+
+    const T* a = _lu.array;
+    for( size_t k = 0; k < N; ++k )
+        std::swap( b[k], b[ _pivots[k] ] );
+
+    // forward substitution with the unit lower triangle
+    for( size_t k = 0; k < N; ++k )
+        for( size_t i = k + 1; i < N; ++i )
+            b[i] -= a[ k * N + i ] * b[k];
+
+    // backward substitution with the upper triangle
+    for( size_t k = N; k-- > 0; )
+    {
+        b[k] *= _inverseDiagonal[k];
+        for( size_t i = 0; i < k; ++i )
+            b[i] -= a[ k * N + i ] * b[k];
+    }
+}
+
+template< size_t N, typename T >
+vector< N, T > LU< N, T >::solve( const vector< N, T >& b ) const
+{
+    vector< N, T > x( b );
+    _solve( x.array );
+    return x;
+}
+
+template< size_t N, typename T > template< size_t M >
+Matrix< N, M, T > LU< N, T >::solve( const Matrix< N, M, T >& b ) const
+{
+    Matrix< N, M, T > x( b );
+    for( size_t j = 0; j < M; ++j )
+        _solve( x.array + j * N );
+    return x;
+}
+
+template< size_t N, typename T >
+Matrix< N, N, T > LU< N, T >::inverse() const
+{
+    return solve( Matrix< N, N, T >( ));
+}
+
+template< size_t N, typename T >
+T LU< N, T >::determinant() const
+{
+    T determinant = _sign;
+    for( size_t k = 0; k < N; ++k )
+        determinant *= _lu.array[ k * N + k ];
+    return determinant;
+}
+
+template< size_t N, typename T >
+Cholesky< N, T >::Cholesky( const Matrix< N, N, T >& matrix )
+    : _l( matrix )
+    , _positiveDefinite( true )
+{
+    // left-looking: update column j with the columns left of it, then scale
+    T* l = _l.array;
+    for( size_t j = 0; j < N; ++j )
+    {
+        for( size_t k = 0; k < j; ++k )
+        {
+            const T factor = l[ k * N + j ];
+            for( size_t i = j; i < N; ++i )
+                l[ j * N + i ] -= l[ k * N + i ] * factor;
+        }
+
+        const T diagonal = l[ j * N + j ];
+        if( !( diagonal > 0 ))
+        {
+            _positiveDefinite = false;
+            return;
+        }
+
+        const T inverse = T( 1 ) / std::sqrt( diagonal );
+        _inverseDiagonal[j] = inverse;
+        for( size_t i = j; i < N; ++i )
+            l[ j * N + i ] *= inverse;
+    }
+}
+
+template< size_t N, typename T >
+void Cholesky< N, T >::_solve( T* b ) const
+{
+    if( !_positiveDefinite )
+    {
+        std::fill( b, b + N, std::numeric_limits< T >::quiet_NaN( ));
+        return;
+    }
+
+    // forward substitution with L, by columns
+    const T* l = _l.array;
+    for( size_t k = 0; k < N; ++k )
+    {
+        b[k] *= _inverseDiagonal[k];
+        for( size_t i = k + 1; i < N; ++i )
+            b[i] -= l[ k * N + i ] * b[k];
+    }
+
+    // backward substitution with L^T, by rows of L^T and columns of L
+    for( size_t k = N; k-- > 0; )
+    {
+        T sum = b[k];
+        for( size_t i = k + 1; i < N; ++i )
+            sum -= l[ k * N + i ] * b[i];
+        b[k] = sum * _inverseDiagonal[k];
+    }
+}
+
+template< size_t N, typename T >
+vector< N, T > Cholesky< N, T >::solve( const vector< N, T >& b ) const
+{
+    vector< N, T > x( b );
+    _solve( x.array );
+    return x;
+}
+
+template< size_t N, typename T > template< size_t M >
+Matrix< N, M, T > Cholesky< N, T >::solve( const Matrix< N, M, T >& b ) const
+{
+    Matrix< N, M, T > x( b );
+    for( size_t j = 0; j < M; ++j )
+        _solve( x.array + j * N );
+    return x;
+}
+
+template< size_t N, typename T >
+Matrix< N, N, T > Cholesky< N, T >::inverse() const
+{
+    return solve( Matrix< N, N, T >( ));
+}
+
+template< size_t N, typename T >
+T Cholesky< N, T >::determinant() const
+{
+    if( !_positiveDefinite )
+        return std::numeric_limits< T >::quiet_NaN();
+
+    T determinant = 1;
+    for( size_t k = 0; k < N; ++k )
+        determinant *= _l.array[ k * N + k ];
+    return determinant * determinant;
+}
+
+template< size_t R, size_t C, typename T >
+QR< R, C, T >::QR( const Matrix< R, C, T >& matrix )
+    : _qr( matrix )
+    , _sign( 1 )
+    , _fullRank( true )
+{
+    T* a = _qr.array;
+    const T threshold = detail::getSingularThreshold( a, R * C, R );
+    for( size_t k = 0; k < C; ++k )
+    {
+        T* column = a + k * R;
+        T norm = 0;
+        for( size_t i = k; i < R; ++i )
+            norm += column[i] * column[i];
+        norm = std::sqrt( norm );
+
+        // the reflection of column k onto -norm * e_k, stored as v / norm
+        // with v_k = 1 + |column_k| / norm
+        if( !( norm > threshold ))
+        {
+            _diagonal[k] = 0;
+            _fullRank = false;
+            continue;
+        }
+        if( column[k] < 0 )
+            norm = -norm;
+        const T inverse = T( 1 ) / norm;
+        for( size_t i = k; i < R; ++i )
+            column[i] *= inverse;
+        column[k] += 1;
+        _diagonal[k] = -norm;
+        _sign = -_sign;
+
+        for( size_t j = k + 1; j < C; ++j )
+        {
+            T* other = a + j * R;
+            T dot = 0;
+            for( size_t i = k; i < R; ++i )
+                dot += column[i] * other[i];
+            const T factor = -dot / column[k];
+            for( size_t i = k; i < R; ++i )
+                other[i] += factor * column[i];
+        }
+    }
+}
+
+template< size_t R, size_t C, typename T >
+void QR< R, C, T >::_solve( T* b ) const
+{
+    if( !_fullRank )
+    {
+        std::fill( b, b + C, std::numeric_limits< T >::quiet_NaN( ));
+        return;
+    }
+
+    // apply Q^T
+    const T* a = _qr.array;
+    for( size_t k = 0; k < C; ++k )
+    {
+        const T* column = a + k * R;
+        T dot = 0;
+        for( size_t i = k; i < R; ++i )
+            dot += column[i] * b[i];
+        const T factor = -dot / column[k];
+        for( size_t i = k; i < R; ++i )
+            b[i] += factor * column[i];
+    }
+
+    // backward substitution with R
+    for( size_t k = C; k-- > 0; )
+    {
+        b[k] /= _diagonal[k];
+        for( size_t i = 0; i < k; ++i )
+            b[i] -= a[ k * R + i ] * b[k];
+    }
+}
+
+template< size_t R, size_t C, typename T >
+vector< C, T > QR< R, C, T >::solve( const vector< R, T >& b ) const
+{
+    vector< R, T > x( b );
+    _solve( x.array );
+    return vector< C, T >( x.array );
+}
+
+template< size_t R, size_t C, typename T > template< size_t M >
+Matrix< C, M, T > QR< R, C, T >::solve( const Matrix< R, M, T >& b ) const
+{
+    Matrix< C, M, T > x;
+    for( size_t j = 0; j < M; ++j )
+    {
+        T column[ R ];
+        std::copy( b.array + j * R, b.array + ( j + 1 ) * R, column );
+        _solve( column );
+        std::copy( column, column + C, x.array + j * C );
+    }
+    return x;
+}
+
+template< size_t R, size_t C, typename T >
+Matrix< C, R, T > QR< R, C, T >::inverse() const
+{
+    return solve( Matrix< R, R, T >( ));
+}
+
+template< size_t R, size_t C, typename T >
+T QR< R, C, T >::determinant() const
+{
+    T determinant = _sign;
+    for( size_t k = 0; k < C; ++k )
+        determinant *= _diagonal[k];
+    return determinant;
+}
+
+} // namespace vmml
+
+#endif
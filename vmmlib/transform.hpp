@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__TRANSFORM__HPP__
+#define __VMML__TRANSFORM__HPP__
+
+#include <vmmlib/matrix.hpp> // used inline
+#include <vmmlib/quaternion.hpp> // used inline
+#include <vmmlib/vector.hpp> // used inline
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vmml
+{
+/**
+ * A 4x4 transformation matrix which tracks its class of transformation.
+ *
+ * The class is kept through composition, so that inverse() uses the cheapest
+ * correct kernel: the transposed rotation for rigid transformations, a 3x3
+ * inverse for affine transformations and the general inverse otherwise.
+ */
+template< typename T > class Transform
+{
+public:
+    /** The class of a transformation, from the most to the least specific. */
+    enum Type
+    {
+        RIGID, //!< rotation and translation only
+        AFFINE, //!< any matrix with a last row of 0 0 0 1
+        PROJECTIVE //!< any matrix
+    };
+
+    /** Construct an identity transformation. */
+    Transform() : _type( RIGID ) {}
+
+    /** Construct a rigid transformation from a rotation and a translation. */
+    Transform( const Quaternion< T >& rotation,
+               const vector< 3, T >& translation )
+        : _matrix( rotation, translation ), _type( RIGID ) {}
+
+    /**
+     * Construct a transformation of a known class.
+     *
+     * The class is not verified. Passing a too specific class yields wrong
+     * results from inverse().
+     */
+    Transform( const Matrix< 4, 4, T >& matrix, const Type type )
+        : _matrix( matrix ), _type( type ) {}
+
+    /** Construct a transformation, detecting its class using classify(). */
+    explicit Transform( const Matrix< 4, 4, T >& matrix )
+        : _matrix( matrix ), _type( classify( matrix )) {}
+
+    /** @return the transformation matrix. */
+    const Matrix< 4, 4, T >& getMatrix() const { return _matrix; }
+
+    /** @return the known class of the transformation. */
+    Type getType() const { return _type; }
+
+    /** @return true if the transformation is known to be rigid. */
+    bool isRigid() const { return _type == RIGID; }
+
+    /** @return true if the transformation is known to be affine. */
+    bool isAffine() const { return _type != PROJECTIVE; }
+
+    /**
+     * @return the composition of this and the other transformation, which
+     *         applies the other transformation first.
+     */
+    Transform operator*( const Transform& other ) const
+    {
+        return Transform( _matrix * other._matrix,
+                          std::max( _type, other._type ));
+    }
+
+    /** Append the other transformation, which is applied first. */
+    Transform& operator*=( const Transform& other )
+    {
+        _matrix *= other._matrix;
+        _type = std::max( _type, other._type );
+        return *this;
+    }
+
+    /**
+     * @return the transformed point, divided by the resulting w for
+     *         projective transformations.
+     */
+    vector< 3, T > operator*( const vector< 3, T >& point ) const;
+
+    /**
+     * @return the inverse transformation, of the same class.
+     *
+     * Sets values to quiet_NaN if not invertible.
+     */
+    Transform inverse() const;
+
+    /**
+     * @return the most specific class of the given matrix.
+     *
+     * The last row has to be exactly 0 0 0 1 for an affine matrix. Rigid
+     * matrices have an orthonormal upper 3x3 matrix within the given
+     * tolerance.
+     */
+    static Type classify( const Matrix< 4, 4, T >& matrix,
+                          T tolerance = std::numeric_limits< T >::epsilon() *
+                                        T( 16 ));
+
+private:
+    Matrix< 4, 4, T > _matrix;
+    Type _type;
+};
+
+template< typename T >
+vector< 3, T > Transform< T >::operator*( const vector< 3, T >& point ) const
+{
+    const T* m = _matrix.array;
+    vector< 3, T > result;
+    for( size_t row = 0; row < 3; ++row )
+        result.array[ row ] = m[ row ] * point.array[0] +
+                              m[ 4 + row ] * point.array[1] +
+                              m[ 8 + row ] * point.array[2] + m[ 12 + row ];
+    if( _type != PROJECTIVE )
+        return result;
+
+    const T w = m[3] * point.array[0] + m[7] * point.array[1] +
+                m[11] * point.array[2] + m[15];
+    return result / w;
+}
+
+template< typename T >
+Transform< T > Transform< T >::inverse() const
+{
+    switch( _type )
+    {
+    case RIGID:
+        return Transform( computeInverseRigid( _matrix ), RIGID );
+    case AFFINE:
+        return Transform( computeInverseAffine( _matrix ), AFFINE );
+    default:
+        return Transform( computeInverse( _matrix ), PROJECTIVE );
+    }
+}
+
+template< typename T >
+typename Transform< T >::Type
+Transform< T >::classify( const Matrix< 4, 4, T >& matrix, const T tolerance )
+{
+    const T* m = matrix.array;
+    if( m[3] != 0 || m[7] != 0 || m[11] != 0 || m[15] != 1 )
+        return PROJECTIVE;
+
+    // columns of a rotation are orthonormal: the dot product of columns i
+    // and j is 1 for i == j and 0 otherwise
+    for( size_t i = 0; i < 3; ++i )
+        for( size_t j = i; j < 3; ++j )
+        {
+            const T dot = m[ i * 4 ] * m[ j * 4 ] +
+                          m[ i * 4 + 1 ] * m[ j * 4 + 1 ] +
+                          m[ i * 4 + 2 ] * m[ j * 4 + 2 ];
+            if( std::abs( dot - ( i == j ? T( 1 ) : T( 0 ))) > tolerance )
+                return AFFINE;
+        }
+    return RIGID;
+}
+
+} // namespace vmml
+
+#endif
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2016, Visualization and Multimedia Lab,
+ *                     University of Zurich <http://vmml.ifi.uzh.ch>,
+ *                     Eyescale Software GmbH,
+ *                     Blue Brain Project, EPFL
+ *
+ * This file is part of VMMLib <https://github.com/VMML/vmmlib/>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.  Redistributions in binary
+ * form must reproduce the above copyright notice, this list of conditions and
+ * the following disclaimer in the documentation and/or other materials provided
+ * with the distribution.  Neither the name of the Visualization and Multimedia
+ * Lab, University of Zurich nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __VMML__TRANSFORM_ARRAY__HPP__
+#define __VMML__TRANSFORM_ARRAY__HPP__
+
+#include <vmmlib/dispatch.hpp> // used inline
+#include <vmmlib/matrix.hpp> // used inline
+#include <vmmlib/simd.hpp> // used inline
+#include <vmmlib/solver.hpp> // used inline
+#include <vmmlib/vector.hpp> // used inline
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace vmml
+{
+/** The interpretation of 3-component input by the array transformations. */
+enum TransformMode
+{
+    TRANSFORM_POINT, //!< (x, y, z, 1), the last matrix row is ignored
+    TRANSFORM_PROJECTIVE, //!< (x, y, z, 1), divided by the resulting w
+    TRANSFORM_DIRECTION, //!< (x, y, z, 0), the translation is ignored
+    TRANSFORM_NORMAL //!< multiplied by the inverse transpose of the 3x3 part
+};
+
+/** @name Array transformations */
+//@{
+/**
+ * Transform n 3-component elements from a strided stream of values.
+ *
+ * The strides are given in values of T, e.g. 3 for tightly packed xyz
+ * triplets or 8 for interleaved position, normal and texture coordinate
+ * vertices where only the first three values are transformed. The other
+ * values of the output are left untouched. Input and output may be the same
+ * stream, but must not overlap otherwise.
+ *
+ * The elements are transformed with the widest SIMD instructions of the CPU,
+ * see dispatch.hpp.
+ * When compiled with OpenMP, large arrays are transformed in parallel chunks.
+ *
+ * Normals are not renormalized after transformation. Transforming normals by
+ * a singular matrix, as detected by LU, throws a std::runtime_error.
+ */
+template< typename T >
+void transform( const Matrix< 4, 4, T >& matrix, const T* input,
+                size_t inputStride, T* output, size_t outputStride, size_t n,
+                TransformMode mode = TRANSFORM_POINT );
+
+/** Transform n 3-component vectors, see above. */
+template< typename T >
+void transform( const Matrix< 4, 4, T >& matrix,
+                const vector< 3, T >* input, vector< 3, T >* output,
+                size_t n, TransformMode mode = TRANSFORM_POINT );
+
+/** Transform n homogeneous 4-component vectors without perspective divide. */
+template< typename T >
+void transform( const Matrix< 4, 4, T >& matrix,
+                const vector< 4, T >* input, vector< 4, T >* output,
+                size_t n );
+
+/**
+ * Multiply n pairs of 4x4 matrices, result[i] = left[i] * right[i].
+ *
+ * Each result column is computed with the widest SIMD instructions of the CPU
+ * fitting four values, see dispatch.hpp. The result may be the left or the
+ * right array, but must not overlap them otherwise.
+ */
+template< typename T >
+void multiply( const Matrix< 4, 4, T >* left, const Matrix< 4, 4, T >* right,
+               Matrix< 4, 4, T >* result, size_t n );
+//@}
+
+namespace detail
+{
+VMMLIB_SIMD_KERNELS_BEGIN
+/** Transforms one SIMD pack of strided elements by a column-major matrix. */
+template< class P, typename T > class TransformKernel
+{
+public:
+    VMMLIB_SIMD_INLINE explicit TransformKernel( const T* matrix )
+    {
+        for( size_t i = 0; i < 16; ++i )
+            _matrix[i] = P::set( matrix[i] );
+    }
+
+    /**
+     * Transform P::width elements of N components, with an implicit w of 1
+     * for N == 3.
+     */
+    template< size_t N, bool divide >
+    VMMLIB_SIMD_INLINE void apply( const T* input, const size_t inputStride,
+                T* output, const size_t outputStride ) const
+    {
+        // Gather into structure-of-arrays form, one pack per component
+        const typename P::type x = P::gather( input, inputStride );
+        const typename P::type y = P::gather( input + 1, inputStride );
+        const typename P::type z = P::gather( input + 2, inputStride );
+        const typename P::type w = N == 4 ? P::gather( input + 3, inputStride )
+                                          : P::set( 1 );
+
+        typename P::type resultX, resultY, resultZ, resultW;
+        _transform< N >( 0, x, y, z, w, resultX );
+        _transform< N >( 1, x, y, z, w, resultY );
+        _transform< N >( 2, x, y, z, w, resultZ );
+        if( divide || N == 4 )
+            _transform< N >( 3, x, y, z, w, resultW );
+        if( divide )
+        {
+            const typename P::type invW = P::div( P::set( 1 ), resultW );
+            resultX = P::mul( resultX, invW );
+            resultY = P::mul( resultY, invW );
+            resultZ = P::mul( resultZ, invW );
+        }
+
+        P::scatter( output, outputStride, resultX );
+        P::scatter( output + 1, outputStride, resultY );
+        P::scatter( output + 2, outputStride, resultZ );
+        if( N == 4 )
+            P::scatter( output + 3, outputStride, resultW );
+    }
+
+private:
+    typename P::type _matrix[16];
+
+    template< size_t N >
+    VMMLIB_SIMD_INLINE void _transform( const size_t row,
+                                        const typename P::type& x,
+                                        const typename P::type& y,
+                                        const typename P::type& z,
+                                        const typename P::type& w,
+                                        typename P::type& result ) const
+    {
+        const typename P::type translation =
+            N == 4 ? P::mul( _matrix[ 12 + row ], w ) : _matrix[ 12 + row ];
+        result = P::madd( _matrix[ row ], x,
+                          P::madd( _matrix[ 4 + row ], y,
+                                   P::madd( _matrix[ 8 + row ], z,
+                                            translation )));
+    }
+
+};
+VMMLIB_SIMD_KERNELS_END
+
+/** Transforms a range of strided elements, run by dispatch(). */
+template< size_t N, bool divide, typename T > class TransformRange
+{
+public:
+    typedef void result_type;
+
+    TransformRange( const T* matrix, const T* input, const size_t inputStride,
+                    T* output, const size_t outputStride, const size_t n )
+        : _matrix( matrix ), _input( input ), _inputStride( inputStride )
+        , _output( output ), _outputStride( outputStride ), _n( n )
+    {}
+
+    /** @return the kernel of a subrange, see dispatchChunks(). */
+    TransformRange operator()( const size_t begin, const size_t count ) const
+    {
+        return TransformRange( _matrix, _input + begin * _inputStride,
+                               _inputStride, _output + begin * _outputStride,
+                               _outputStride, count );
+    }
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L >::type P;
+        const TransformKernel< P, T > kernel( _matrix );
+        const size_t end = _n - _n % P::width;
+        for( size_t i = 0; i < end; i += P::width )
+            kernel.template apply< N, divide >( _input + i * _inputStride,
+                                                _inputStride,
+                                                _output + i * _outputStride,
+                                                _outputStride );
+
+        const TransformKernel< simd::Scalar< T >, T > tail( _matrix );
+        for( size_t i = end; i < _n; ++i )
+            tail.template apply< N, divide >( _input + i * _inputStride,
+                                              _inputStride,
+                                              _output + i * _outputStride,
+                                              _outputStride );
+    }
+
+private:
+    const T* const _matrix;
+    const T* const _input;
+    const size_t _inputStride;
+    T* const _output;
+    const size_t _outputStride;
+    const size_t _n;
+};
+
+VMMLIB_SIMD_KERNELS_BEGIN
+/** Multiplies pairs of 4x4 matrices, run by dispatch(). */
+template< typename T > class MultiplyRange
+{
+public:
+    typedef void result_type;
+
+    MultiplyRange( const Matrix< 4, 4, T >* left,
+                   const Matrix< 4, 4, T >* right,
+                   Matrix< 4, 4, T >* result, const size_t n )
+        : _left( left ), _right( right ), _result( result ), _n( n )
+    {}
+
+    template< SIMDLevel L > VMMLIB_SIMD_INLINE void run() const
+    {
+        typedef typename simd::Pack< T, L, 4 >::type P;
+        typedef typename P::type V;
+        enum { packs = 4 / P::width }; // per column
+
+        for( size_t i = 0; i < _n; ++i )
+        {
+            // Load all of left first and read each column of right before
+            // storing the same result column, which allows in-place products.
+            const T* a = _left[i].array;
+            const T* b = _right[i].array;
+            T* c = _result[i].array;
+            V columns[ 4 ][ packs ];
+            for( size_t k = 0; k < 4; ++k )
+                for( size_t j = 0; j < packs; ++j )
+                    columns[ k ][ j ] = P::load( a + 4 * k + j * P::width );
+
+            for( size_t col = 0; col < 4; ++col )
+            {
+                const V b0 = P::set( b[ 4 * col ] );
+                const V b1 = P::set( b[ 4 * col + 1 ] );
+                const V b2 = P::set( b[ 4 * col + 2 ] );
+                const V b3 = P::set( b[ 4 * col + 3 ] );
+                for( size_t j = 0; j < packs; ++j )
+                {
+                    V sum = P::mul( columns[ 0 ][ j ], b0 );
+                    sum = P::madd( columns[ 1 ][ j ], b1, sum );
+                    sum = P::madd( columns[ 2 ][ j ], b2, sum );
+                    sum = P::madd( columns[ 3 ][ j ], b3, sum );
+                    P::store( c + 4 * col + j * P::width, sum );
+                }
+            }
+        }
+    }
+
+private:
+    const Matrix< 4, 4, T >* const _left;
+    const Matrix< 4, 4, T >* const _right;
+    Matrix< 4, 4, T >* const _result;
+    const size_t _n;
+};
+VMMLIB_SIMD_KERNELS_END
+
+template< size_t N, bool divide, typename T >
+void transform( const T* matrix, const T* input, const size_t inputStride,
+                T* output, const size_t outputStride, const size_t n )
+{
+    dispatchChunks( n, TransformRange< N, divide, T >(
+                           matrix, input, inputStride, output, outputStride,
+                           n ));
+}
+} // namespace detail
+
+template< typename T >
+void transform( const Matrix< 4, 4, T >& matrix, const T* input,
+                const size_t inputStride, T* output, const size_t outputStride,
+                const size_t n, const TransformMode mode )
+{
+    switch( mode )
+    {
+    case TRANSFORM_POINT:
+        detail::transform< 3, false >( matrix.array, input, inputStride,
+                                       output, outputStride, n );
+        return;
+
+    case TRANSFORM_PROJECTIVE:
+        detail::transform< 3, true >( matrix.array, input, inputStride,
+                                      output, outputStride, n );
+        return;
+
+    case TRANSFORM_DIRECTION:
+    {
+        Matrix< 4, 4, T > direction( matrix );
+        direction.array[12] = direction.array[13] = direction.array[14] = 0;
+        detail::transform< 3, false >( direction.array, input, inputStride,
+                                       output, outputStride, n );
+        return;
+    }
+
+    case TRANSFORM_NORMAL:
+    {
+        // The pivot test of LU is relative to the largest element, so well
+        // conditioned matrices with a small scale, e.g. 0.001 for millimeters
+        // to meters with a determinant of 1e-9, are not rejected.
+        const LU< 3, T > lu( matrix.template getSubMatrix< 3, 3 >( 0, 0 ));
+        if( lu.isSingular( ))
+        {
+            throw std::runtime_error( "Can't transform normals by a singular "
+                                      "matrix" );
+        }
+
+        const Matrix< 3, 3, T > inverse = lu.inverse();
+        Matrix< 4, 4, T > normal;
+        for( size_t row = 0; row < 3; ++row )
+            for( size_t col = 0; col < 3; ++col )
+                normal.array[ col * 4 + row ] = inverse.array[ row * 3 + col ];
+        detail::transform< 3, false >( normal.array, input, inputStride,
+                                       output, outputStride, n );
+        return;
+    }
+    }
+}
+
+template< typename T >
+void transform( const Matrix< 4, 4, T >& matrix,
+                const vector< 3, T >* input, vector< 3, T >* output,
+                const size_t n, const TransformMode mode )
+{
+    const size_t stride = sizeof( vector< 3, T >) / sizeof( T );
+    transform( matrix, reinterpret_cast< const T* >( input ), stride,
+               reinterpret_cast< T* >( output ), stride, n, mode );
+}
+
+template< typename T >
+void transform( const Matrix< 4, 4, T >& matrix,
+                const vector< 4, T >* input, vector< 4, T >* output,
+                const size_t n )
+{
+    const size_t stride = sizeof( vector< 4, T >) / sizeof( T );
+    detail::transform< 4, false >( matrix.array,
+                                   reinterpret_cast< const T* >( input ),
+                                   stride, reinterpret_cast< T* >( output ),
+                                   stride, n );
+}
+
+template< typename T >
+void multiply( const Matrix< 4, 4, T >* left, const Matrix< 4, 4, T >* right,
+               Matrix< 4, 4, T >* result, const size_t n )
+{
+    dispatch( detail::MultiplyRange< T >( left, right, result, n ));
+}
+
+} // namespace vmml
+
+#endif
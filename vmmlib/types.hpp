@@ -37,15 +37,63 @@ typedef UINT8 uint8_t;
 #  include <stdint.h>
 #endif
 
+// The core types are literal types usable in constant expressions with the
+// relaxed constexpr rules of C++14. Older standards get plain inline functions.
+#if __cplusplus >= 201402L || ( defined( _MSC_VER ) && _MSC_VER >= 1910 )
+#  define VMMLIB_HAS_CONSTEXPR
+#  define VMMLIB_CONSTEXPR constexpr
+#  define VMMLIB_CONSTEXPR_OR_CONST constexpr
+#else
+#  define VMMLIB_CONSTEXPR inline
+#  define VMMLIB_CONSTEXPR_OR_CONST const
+#endif
+
+// Selects the scalar code over the SIMD kernels during constant evaluation. If
+// the compiler cannot tell, the SIMD kernels are used and the affected float
+// and double operations are not usable in constant expressions.
+#ifdef VMMLIB_HAS_CONSTEXPR
+#  ifdef __has_builtin
+#    if __has_builtin( __builtin_is_constant_evaluated )
+#      define VMMLIB_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#    endif
+#  endif
+#  if !defined( VMMLIB_IS_CONSTANT_EVALUATED ) && \
+      (( defined( __GNUC__ ) && __GNUC__ >= 9 ) || \
+       ( defined( _MSC_VER ) && _MSC_VER >= 1925 ))
+#    define VMMLIB_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#  endif
+#endif
+#ifndef VMMLIB_IS_CONSTANT_EVALUATED
+#  define VMMLIB_IS_CONSTANT_EVALUATED() false
+#endif
+
 namespace vmml
 {
 template< size_t M, size_t N, typename T > class Matrix;
 template< size_t M, typename T > class vector;
 template< typename T > class AABB;
+class AABB4f;
+template< typename T > class BVH;
+template< size_t N, typename T > class Cholesky;
+template< typename T > class DualQuaternion;
+template< class E > class Expression;
 template< typename T > class Frustum;
 template< typename T > class FrustumCuller;
+class Half;
+template< typename T > class LODSelector;
+template< size_t N, typename T > class LU;
+template< typename T, size_t N > class MultiFrustumCuller;
+template< typename T > class OBB;
+class PackedNormal16;
+class PackedNormal32;
+class PackedQuaternion32;
+class PackedQuaternion48;
+template< size_t R, size_t C, typename T > class QR;
 template< typename T > class Quaternion;
+template< typename T > class QuaternionArray;
 template< typename T > class Ray;
+template< typename T, size_t N > class RayPacket;
+template< typename T > class Transform;
 
 typedef Matrix< 2, 2, double > Matrix2d; //!< A 2x2 double matrix
 typedef Matrix< 2, 2, float >  Matrix2f; //!< A 2x2 float matrix
@@ -71,18 +119,36 @@ typedef vector< 4, unsigned > Vector4ui; //!< A 4-component unsigned int vector
 typedef Quaternion< double > Quaterniond; //!< A double quaternion
 typedef Quaternion< float >  Quaternionf; //!< A float quaternion
 
+typedef QuaternionArray< double > QuaternionArrayd; //!< double quaternions
+typedef QuaternionArray< float >  QuaternionArrayf; //!< float quaternions
+
+typedef DualQuaternion< double > DualQuaterniond; //!< A double dual quaternion
+typedef DualQuaternion< float >  DualQuaternionf; //!< A float dual quaternion
+
 typedef Frustum< double > Frustumd; //!< A double frustum
 typedef Frustum< float >  Frustumf; //!< A float frustum
 
 typedef FrustumCuller< double > FrustumCullerd; //!< A double frustum culler
 typedef FrustumCuller< float >  FrustumCullerf; //!< A float frustum culler
 
+typedef LODSelector< double > LODSelectord; //!< A double LOD selector
+typedef LODSelector< float >  LODSelectorf; //!< A float LOD selector
+
 typedef AABB< double > AABBd; //!< A double bounding box
 typedef AABB< float >  AABBf; //!< A float bounding box
 
+typedef OBB< double > OBBd; //!< A double oriented bounding box
+typedef OBB< float >  OBBf; //!< A float oriented bounding box
+
+typedef BVH< double > BVHd; //!< A double bounding volume hierarchy
+typedef BVH< float >  BVHf; //!< A float bounding volume hierarchy
+
 typedef Ray< double > Rayd; //!< A double ray
 typedef Ray< float > Rayf; //!< A float ray
 
+typedef Transform< double > Transformd; //!< A double transformation
+typedef Transform< float > Transformf; //!< A float transformation
+
 }
 
 #endif
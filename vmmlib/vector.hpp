@@ -34,8 +34,10 @@
 #define __VMML__VECTOR__HPP__
 
 #include <vmmlib/enable_if.hpp>
+#include <vmmlib/types.hpp>
 
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <cstring>
 #include <iomanip>
@@ -60,18 +62,19 @@ public:
     static const size_t DIMENSION = M;
 
     // constructors
-    vector() : array() {} // http://stackoverflow.com/questions/5602030
-    explicit vector( const T& a ); // sets all components to a;
-    vector( const T& x, const T& y );
-    vector( const T& x, const T& y, const T& z );
-    vector( const T& x, const T& y, const T& z, const T& w );
+    // http://stackoverflow.com/questions/5602030
+    VMMLIB_CONSTEXPR vector() : array() {}
+    VMMLIB_CONSTEXPR explicit vector( const T& a ); // sets all components to a;
+    VMMLIB_CONSTEXPR vector( const T& x, const T& y );
+    VMMLIB_CONSTEXPR vector( const T& x, const T& y, const T& z );
+    VMMLIB_CONSTEXPR vector( const T& x, const T& y, const T& z, const T& w );
 
 #ifndef SWIG
     // initializes the first M-1 values from vector_, the last from last_
-    vector( const vector< M-1, T >& vector_, T last_ );
+    VMMLIB_CONSTEXPR vector( const vector< M-1, T >& vector_, T last_ );
 #endif
 
-    explicit vector( const T* values );
+    VMMLIB_CONSTEXPR explicit vector( const T* values );
 
 #ifdef __OSG_MATH
     template< typename OSGVEC3 >
@@ -82,21 +85,28 @@ public:
     // vec< M > with homogeneous coordinates <-> vec< M-1 > conversion ctor
     // to-homogenous-coordinates ctor
     template< size_t N >
-    vector( const vector< N, T >& source_,
-            typename enable_if< N == M - 1 >::type* = 0 );
+    VMMLIB_CONSTEXPR vector( const vector< N, T >& source_,
+                             typename enable_if< N == M - 1 >::type* = 0 );
 
     // from-homogenous-coordinates vector
     template< size_t N >
-    vector( const vector< N, T >& source_,
-            typename enable_if< N == M + 1 >::type* = 0  );
+    VMMLIB_CONSTEXPR vector( const vector< N, T >& source_,
+                             typename enable_if< N == M + 1 >::type* = 0  );
 
-    template< typename U > vector( const vector< M, U >& source_ );
+    template< typename U >
+    VMMLIB_CONSTEXPR vector( const vector< M, U >& source_ );
+
+    /** Construct from a lazily evaluated expression, see expression.hpp. */
+    template< class E >
+    vector( const Expression< E >& expression,
+            typename enable_if< is_same< typename E::result_type,
+                                         vector >::value >::type* = 0 );
 
     // iterators
-    inline iterator begin();
-    inline iterator end();
-    inline const_iterator begin() const;
-    inline const_iterator end() const;
+    VMMLIB_CONSTEXPR iterator begin();
+    VMMLIB_CONSTEXPR iterator end();
+    VMMLIB_CONSTEXPR const_iterator begin() const;
+    VMMLIB_CONSTEXPR const_iterator end() const;
     inline reverse_iterator rbegin();
     inline reverse_iterator rend();
     inline const_reverse_iterator rbegin() const;
@@ -104,117 +114,125 @@ public:
 
 #  ifndef VMMLIB_NO_CONVERSION_OPERATORS
     // conversion operators
-    inline operator T*();
-    inline operator const T*() const;
+    VMMLIB_CONSTEXPR operator T*();
+    VMMLIB_CONSTEXPR operator const T*() const;
 #  else
-    inline T& operator[]( size_t index );
-    inline const T& operator[]( size_t index ) const;
+    // unchecked element access, asserts the index in debug builds
+    VMMLIB_CONSTEXPR T& operator[]( size_t index );
+    VMMLIB_CONSTEXPR const T& operator[]( size_t index ) const;
 #  endif
 
-    // accessors
-    inline T& operator()( size_t index );
-    inline const T& operator()( size_t index ) const;
+    // accessors, unchecked and asserting the index in debug builds
+    VMMLIB_CONSTEXPR T& operator()( size_t index );
+    VMMLIB_CONSTEXPR const T& operator()( size_t index ) const;
 
-    inline T& at( size_t index );
-    inline const T& at( size_t index ) const;
+    // checked accessors, throw std::runtime_error for an invalid index
+    VMMLIB_CONSTEXPR T& at( size_t index );
+    VMMLIB_CONSTEXPR const T& at( size_t index ) const;
 
     // element accessors for M <= 4;
-    inline T& x();
-    inline T& y();
-    inline T& z();
-    inline T& w();
-    inline const T& x() const;
-    inline const T& y() const;
-    inline const T& z() const;
-    inline const T& w() const;
+    VMMLIB_CONSTEXPR T& x();
+    VMMLIB_CONSTEXPR T& y();
+    VMMLIB_CONSTEXPR T& z();
+    VMMLIB_CONSTEXPR T& w();
+    VMMLIB_CONSTEXPR const T& x() const;
+    VMMLIB_CONSTEXPR const T& y() const;
+    VMMLIB_CONSTEXPR const T& z() const;
+    VMMLIB_CONSTEXPR const T& w() const;
 
     // pixel color element accessors for M<= 4
-    inline T& r();
-    inline T& g();
-    inline T& b();
-    inline T& a();
-    inline const T& r() const;
-    inline const T& g() const;
-    inline const T& b() const;
-    inline const T& a() const;
-
-    bool operator==( const vector& other ) const;
-    bool operator!=( const vector& other ) const;
+    VMMLIB_CONSTEXPR T& r();
+    VMMLIB_CONSTEXPR T& g();
+    VMMLIB_CONSTEXPR T& b();
+    VMMLIB_CONSTEXPR T& a();
+    VMMLIB_CONSTEXPR const T& r() const;
+    VMMLIB_CONSTEXPR const T& g() const;
+    VMMLIB_CONSTEXPR const T& b() const;
+    VMMLIB_CONSTEXPR const T& a() const;
+
+    VMMLIB_CONSTEXPR bool operator==( const vector& other ) const;
+    VMMLIB_CONSTEXPR bool operator!=( const vector& other ) const;
     bool equals( const vector& other,
                  T tolerance = std::numeric_limits< T >::epsilon( )) const;
-    bool operator<( const vector& other ) const;
+    VMMLIB_CONSTEXPR bool operator<( const vector& other ) const;
 
     // remember kids: c_arrays are dangerous and evil!
-    vector& operator=( const T* c_array );
-    T operator=( T filler );
-
-    vector& operator=( const vector& other );
+    VMMLIB_CONSTEXPR vector& operator=( const T* c_array );
+    VMMLIB_CONSTEXPR T operator=( T filler );
 
     // returns void to avoid 'silent' loss of precision when chaining
-    template< typename U > void operator=( const vector< M, U >& other );
+    template< typename U >
+    VMMLIB_CONSTEXPR void operator=( const vector< M, U >& other );
+
+    /** Evaluate an expression in a single loop, see expression.hpp. */
+    template< class E >
+    typename enable_if< is_same< typename E::result_type, vector >::value,
+                        vector& >::type
+        operator=( const Expression< E >& expression );
 
     // to-homogenous-coordinates assignment operator
     // non-chainable because of sfinae
     template< size_t N >
-    typename enable_if< N == M - 1 >::type*
+    VMMLIB_CONSTEXPR typename enable_if< N == M - 1 >::type*
         operator=( const vector< N, T >& source_ );
 
     // from-homogenous-coordinates assignment operator
     // non-chainable because of sfinae
     template< size_t N >
-    typename enable_if< N == M + 1 >::type*
+    VMMLIB_CONSTEXPR typename enable_if< N == M + 1 >::type*
         operator=( const vector< N, T >& source_ );
 
-    vector operator*( const vector& other ) const;
-    vector operator/( const vector& other ) const;
-    vector operator+( const vector& other ) const;
-    vector operator-( const vector& other ) const;
+    VMMLIB_CONSTEXPR vector operator*( const vector& other ) const;
+    VMMLIB_CONSTEXPR vector operator/( const vector& other ) const;
+    VMMLIB_CONSTEXPR vector operator+( const vector& other ) const;
+    VMMLIB_CONSTEXPR vector operator-( const vector& other ) const;
 
-    void operator*=( const vector& other );
-    void operator/=( const vector& other );
-    void operator+=( const vector& other );
-    void operator-=( const vector& other );
+    VMMLIB_CONSTEXPR void operator*=( const vector& other );
+    VMMLIB_CONSTEXPR void operator/=( const vector& other );
+    VMMLIB_CONSTEXPR void operator+=( const vector& other );
+    VMMLIB_CONSTEXPR void operator-=( const vector& other );
 
-    vector operator*( const T other ) const;
-    vector operator/( const T other ) const;
-    vector operator+( const T other ) const;
-    vector operator-( const T other ) const;
+    VMMLIB_CONSTEXPR vector operator*( const T other ) const;
+    VMMLIB_CONSTEXPR vector operator/( const T other ) const;
+    VMMLIB_CONSTEXPR vector operator+( const T other ) const;
+    VMMLIB_CONSTEXPR vector operator-( const T other ) const;
 
-    void operator*=( const T other );
-    void operator/=( const T other );
-    void operator+=( const T other );
-    void operator-=( const T other );
+    VMMLIB_CONSTEXPR void operator*=( const T other );
+    VMMLIB_CONSTEXPR void operator/=( const T other );
+    VMMLIB_CONSTEXPR void operator+=( const T other );
+    VMMLIB_CONSTEXPR void operator-=( const T other );
 
-    vector operator-() const;
+    VMMLIB_CONSTEXPR vector operator-() const;
 
-    const vector& negate();
+    VMMLIB_CONSTEXPR const vector& negate();
 
-    void set( T a ); // sets all components to a;
+    VMMLIB_CONSTEXPR void set( T a ); // sets all components to a;
 #ifndef SWIG
-    void set( const vector< M-1, T >& v, T a );
+    VMMLIB_CONSTEXPR void set( const vector< M-1, T >& v, T a );
 #endif
     template< size_t N >
-    void set( const vector< N, T >& v );
+    VMMLIB_CONSTEXPR void set( const vector< N, T >& v );
 
     // sets the first few components to a certain value
-    void set( T x, T y );
-    void set( T x, T y, T z );
-    void set( T x, T y, T z, T w );
+    VMMLIB_CONSTEXPR void set( T x, T y );
+    VMMLIB_CONSTEXPR void set( T x, T y, T z );
+    VMMLIB_CONSTEXPR void set( T x, T y, T z, T w );
 
     template< typename input_iterator_t >
-    void iter_set( input_iterator_t begin_, input_iterator_t end_ );
+    VMMLIB_CONSTEXPR void iter_set( input_iterator_t begin_,
+                                    input_iterator_t end_ );
 
     // compute the cross product of two vectors
     // note: there's also a free function:
     // vector<> cross( const vector<>, const vector<> )
     template< typename TT >
-    vector< M, T >& cross( const vector< M, TT >& b,
+    VMMLIB_CONSTEXPR vector< M, T >& cross( const vector< M, TT >& b,
                            typename enable_if< M == 3, TT >::type* = 0 );
 
     // compute the dot product of two vectors
     // note: there's also a free function:
     // T dot( const vector<>, const vector<> );
-    inline T dot( const vector& other ) const;
+    VMMLIB_CONSTEXPR T dot( const vector& other ) const;
 
     // normalize the vector
     // note: there's also a free function:
@@ -228,26 +246,26 @@ public:
     void set_random( int seed = -1 );
 
     inline T length() const;
-    inline T squared_length() const;
+    VMMLIB_CONSTEXPR T squared_length() const;
 
     inline T distance( const vector& other ) const;
-    inline T squared_distance( const vector& other ) const;
+    VMMLIB_CONSTEXPR T squared_distance( const vector& other ) const;
 
     /** @return the product of all elements of this vector */
-    T product() const;
+    VMMLIB_CONSTEXPR T product() const;
 
     template< typename TT >
     vector< 3, T >& rotate( T theta, vector< M, TT > axis,
                             typename enable_if< M == 3, TT >::type* = 0 );
 
     /** @return the sub vector of the given length at the given offset. */
-    template< size_t N, size_t O >
+    template< size_t N, size_t O > VMMLIB_CONSTEXPR
     vector< N, T > get_sub_vector( typename enable_if< M >= N+O >::type* = 0 )
         const;
 
     /** Set the sub vector of the given length at the given offset. */
     template< size_t N, size_t O >
-    void set_sub_vector( const vector< N, T >& sub,
+    VMMLIB_CONSTEXPR void set_sub_vector( const vector< N, T >& sub,
                          typename enable_if< M >= N+O >::type* = 0 );
 
     // sphere functions - sphere layout: center xyz, radius w
@@ -283,7 +301,7 @@ public:
 
     void clamp( const T& min = 0.0, const T& max = 1.0 );
 
-    inline static size_t size(); // returns M
+    VMMLIB_CONSTEXPR static size_t size(); // returns M
 
     bool is_unit_vector() const;
 
@@ -351,29 +369,31 @@ public:
 //
 #ifndef SWIG
 template< size_t M, typename T >
-const vector< M, T > vector< M, T >::FORWARD( 0, 0, -1 );
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::FORWARD( 0, 0, -1 );
 template< size_t M, typename T >
-const vector< M, T > vector< M, T >::BACKWARD( 0, 0, 1 );
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::BACKWARD( 0, 0, 1 );
 template< size_t M, typename T >
-const vector< M, T > vector< M, T >::UP( 0, 1, 0 );
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::UP( 0, 1, 0 );
 template< size_t M, typename T >
-const vector< M, T > vector< M, T >::DOWN( 0, -1, 0 );
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::DOWN( 0, -1, 0 );
 template< size_t M, typename T >
-const vector< M, T > vector< M, T >::LEFT( -1, 0, 0 );
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::LEFT( -1, 0, 0 );
 template< size_t M, typename T >
-const vector< M, T > vector< M, T >::RIGHT( 1, 0, 0 );
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::RIGHT( 1, 0, 0 );
 template< size_t M, typename T >
 
-const vector< M, T > vector< M, T >::ONE( static_cast< T >( 1 ));
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::ONE(
+    static_cast< T >( 1 ));
 template< size_t M, typename T >
-const vector< M, T > vector< M, T >::ZERO( static_cast< T >( 0 ));
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::ZERO(
+    static_cast< T >( 0 ));
 template< size_t M, typename T >
 
-const vector< M, T > vector< M, T >::UNIT_X( 1, 0, 0 );
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::UNIT_X( 1, 0, 0 );
 template< size_t M, typename T >
-const vector< M, T > vector< M, T >::UNIT_Y( 0, 1, 0 );
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::UNIT_Y( 0, 1, 0 );
 template< size_t M, typename T >
-const vector< M, T > vector< M, T >::UNIT_Z( 0, 0, 1 );
+VMMLIB_CONSTEXPR_OR_CONST vector< M, T > vector< M, T >::UNIT_Z( 0, 0, 1 );
 #endif
 
 //
@@ -387,20 +407,20 @@ bool equals( const vector< M, T >& a, const vector< M, T >& b )
 }
 
 // allows float * vector, not only vector * float
-template< size_t M, typename T >
-static vector< M, T > operator* ( T factor, const vector< M, T >& vector_ )
+template< size_t M, typename T > static VMMLIB_CONSTEXPR
+vector< M, T > operator* ( T factor, const vector< M, T >& vector_ )
 {
     return vector_ * factor;
 }
 
-template< size_t M, typename T >
-inline T dot( const vector< M, T >& first, const vector< M, T >& second )
+template< size_t M, typename T > VMMLIB_CONSTEXPR
+T dot( const vector< M, T >& first, const vector< M, T >& second )
 {
     return first.dot( second );
 }
 
-template< size_t M, typename T >
-inline vector< M, T > cross( vector< M, T > a, const vector< M, T >& b )
+template< size_t M, typename T > VMMLIB_CONSTEXPR
+vector< M, T > cross( vector< M, T > a, const vector< M, T >& b )
 {
     return a.cross( b );
 }
@@ -447,23 +467,24 @@ inline vector< 4, T > compute_plane( const vector< 3, T >& a,
 }
 
 template< size_t M, typename T >
-vector< M, T >::vector( const T& _a )
+VMMLIB_CONSTEXPR vector< M, T >::vector( const T& _a )
+    : array()
 {
-    for( iterator it = begin(), it_end = end(); it != it_end; ++it )
-    {
-        *it = _a;
-    }
+    for( size_t i = 0; i < M; ++i )
+        array[ i ] = _a;
 }
 
 template< size_t M, typename T >
-vector< M, T >::vector( const T& _x, const T& _y )
+VMMLIB_CONSTEXPR vector< M, T >::vector( const T& _x, const T& _y )
+    : array()
 {
     array[ 0 ] = _x;
     array[ 1 ] = _y;
 }
 
 template< size_t M, typename T >
-vector< M, T >::vector( const T& _x, const T& _y, const T& _z )
+VMMLIB_CONSTEXPR vector< M, T >::vector( const T& _x, const T& _y, const T& _z )
+    : array()
 {
     array[ 0 ] = _x;
     array[ 1 ] = _y;
@@ -471,7 +492,9 @@ vector< M, T >::vector( const T& _x, const T& _y, const T& _z )
 }
 
 template< size_t M, typename T >
-vector< M, T >::vector( const T& _x, const T& _y, const T& _z, const T& _w )
+VMMLIB_CONSTEXPR vector< M, T >::vector( const T& _x, const T& _y, const T& _z,
+                                         const T& _w )
+    : array()
 {
     array[ 0 ] = _x;
     array[ 1 ] = _y;
@@ -480,9 +503,11 @@ vector< M, T >::vector( const T& _x, const T& _y, const T& _z, const T& _w )
 }
 
 template< size_t M, typename T >
-vector< M, T >::vector( const T* values )
+VMMLIB_CONSTEXPR vector< M, T >::vector( const T* values )
+    : array()
 {
-    memcpy( array, values, M * sizeof( T ));
+    for( size_t i = 0; i < M; ++i )
+        array[ i ] = values[ i ];
 }
 
 #ifdef __OSG_MATH
@@ -500,26 +525,22 @@ vector< M, T >::vector( const OSGVEC3& from,
 #ifndef SWIG
 template< size_t M, typename T >
 // initializes the first M-1 values from vector_, the last from last_
-vector< M, T >::vector( const vector< M-1, T >& vector_, T last_ )
+VMMLIB_CONSTEXPR vector< M, T >::vector( const vector< M-1, T >& vector_,
+                                         T last_ )
+    : array()
 {
-    typename vector< M-1, T >::const_iterator
-        it = vector_.begin(), it_end = vector_.end();
-
-    iterator my_it = begin();
-
-    for( ; it != it_end; ++it, ++my_it )
-    {
-        (*my_it) = *it;
-    }
-    (*my_it) = last_;
+    for( size_t i = 0; i < M - 1; ++i )
+        array[ i ] = vector_.array[ i ];
+    array[ M - 1 ] = last_;
 }
 #endif
 
 // to-homogenous-coordinates ctor
 template< size_t M, typename T >
 template< size_t N >
-vector< M, T >::vector( const vector< N, T >& source_,
-                        typename enable_if< N == M - 1 >::type* )
+VMMLIB_CONSTEXPR vector< M, T >::vector( const vector< N, T >& source_,
+                                  typename enable_if< N == M - 1 >::type* )
+    : array()
 {
     (*this) = source_;
 }
@@ -527,51 +548,66 @@ vector< M, T >::vector( const vector< N, T >& source_,
 // from-homogenous-coordinates ctor
 template< size_t M, typename T >
 template< size_t N >
-vector< M, T >::vector( const vector< N, T >& source_,
-                        typename enable_if< N == M + 1 >::type* )
+VMMLIB_CONSTEXPR vector< M, T >::vector( const vector< N, T >& source_,
+                                  typename enable_if< N == M + 1 >::type* )
+    : array()
 {
     (*this) = source_;
 }
 
 template< size_t M, typename T >
 template< typename U >
-vector< M, T >::vector( const vector< M, U >& source_ )
+VMMLIB_CONSTEXPR vector< M, T >::vector( const vector< M, U >& source_ )
+    : array()
 {
     (*this) = source_;
 }
 
-template< size_t M, typename T > void vector< M, T >::set( T _a )
+template< size_t M, typename T > template< class E >
+vector< M, T >::vector( const Expression< E >& expression,
+                        typename enable_if< is_same< typename E::result_type,
+                                                     vector >::value >::type* )
 {
-    for( iterator it = begin(), it_end = end(); it != it_end; ++it )
-        *it = _a;
+    const E& elements = expression.get();
+    for( size_t i = 0; i < M; ++i )
+        array[ i ] = elements[ i ];
+}
+
+template< size_t M, typename T >
+VMMLIB_CONSTEXPR void vector< M, T >::set( T _a )
+{
+    for( size_t i = 0; i < M; ++i )
+        array[ i ] = _a;
 }
 
 #ifndef SWIG
 template< size_t M, typename T >
-void vector< M, T >::set( const vector< M-1, T >& v, T _a )
+VMMLIB_CONSTEXPR void vector< M, T >::set( const vector< M-1, T >& v, T _a )
 {
-    memcpy( array, v.array, sizeof( T ) * (M-1) );
-    at( M-1 ) = _a;
+    for( size_t i = 0; i < M - 1; ++i )
+        array[ i ] = v.array[ i ];
+    array[ M-1 ] = _a;
 }
 #endif
 
 template< size_t M, typename T > template< size_t N >
-void vector< M, T >::set( const vector< N, T >& v )
+VMMLIB_CONSTEXPR void vector< M, T >::set( const vector< N, T >& v )
 {
     size_t minimum = M;
     if (N < M) minimum = N;
-    memcpy( array, v.array, sizeof( T ) * minimum );
+    for( size_t i = 0; i < minimum; ++i )
+        array[ i ] = v.array[ i ];
 }
 
 template< size_t M, typename T >
-void vector< M, T >::set( T _x, T _y )
+VMMLIB_CONSTEXPR void vector< M, T >::set( T _x, T _y )
 {
     array[ 0 ] = _x;
     array[ 1 ] = _y;
 }
 
 template< size_t M, typename T >
-void vector< M, T >::set( T _x, T _y, T _z )
+VMMLIB_CONSTEXPR void vector< M, T >::set( T _x, T _y, T _z )
 {
     array[ 0 ] = _x;
     array[ 1 ] = _y;
@@ -579,7 +615,7 @@ void vector< M, T >::set( T _x, T _y, T _z )
 }
 
 template< size_t M, typename T >
-void vector< M, T >::set( T _x, T _y, T _z, T _w )
+VMMLIB_CONSTEXPR void vector< M, T >::set( T _x, T _y, T _z, T _w )
 {
     array[ 0 ] = _x;
     array[ 1 ] = _y;
@@ -588,21 +624,23 @@ void vector< M, T >::set( T _x, T _y, T _z, T _w )
 }
 
 template< size_t M, typename T >
-inline T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::operator()( size_t index )
 {
-    return at( index );
+    assert( index < M );
+    return array[ index ];
 }
 
 template< size_t M, typename T >
-inline const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::operator()( size_t index ) const
 {
-    return at( index );
+    assert( index < M );
+    return array[ index ];
 }
 
 template< size_t M, typename T >
-inline T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::at( size_t index )
 {
     if( index >= M )
@@ -611,7 +649,7 @@ vector< M, T >::at( size_t index )
 }
 
 template< size_t M, typename T >
-inline const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::at( size_t index ) const
 {
     if ( index >= M )
@@ -622,30 +660,32 @@ vector< M, T >::at( size_t index ) const
 #ifndef VMMLIB_NO_CONVERSION_OPERATORS
 
 template< size_t M, typename T >
-vector< M, T >::operator T*()
+VMMLIB_CONSTEXPR vector< M, T >::operator T*()
 {
     return array;
 }
 
 template< size_t M, typename T >
-vector< M, T >::operator const T*() const
+VMMLIB_CONSTEXPR vector< M, T >::operator const T*() const
 {
     return array;
 }
 #else
 
 template< size_t M, typename T >
-T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::operator[]( size_t index )
 {
-    return at( index );
+    assert( index < M );
+    return array[ index ];
 }
 
 template< size_t M, typename T >
-const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::operator[]( size_t index ) const
 {
-    return at( index );
+    assert( index < M );
+    return array[ index ];
 }
 
 #endif
@@ -667,151 +707,151 @@ vector< M, T >::operator[]( size_t index ) const
 #endif
 
 template< size_t M, typename T >
-vector< M, T >
+VMMLIB_CONSTEXPR vector< M, T >
 vector< M, T >::operator*( const vector< M, T >& other ) const
 {
     vector< M, T > result;
     for( size_t index = 0; index < M; ++index )
-        result.at( index ) = at( index ) * other.at( index );
+        result.array[ index ] = array[ index ] * other.array[ index ];
     return result;
 }
 
 template< size_t M, typename T >
-vector< M, T >
+VMMLIB_CONSTEXPR vector< M, T >
 vector< M, T >::operator/( const vector< M, T >& other ) const
 {
     vector< M, T > result;
     for( size_t index = 0; index < M; ++index )
-        result.at( index ) = at( index ) / other.at( index );
+        result.array[ index ] = array[ index ] / other.array[ index ];
     return result;
 }
 
 template< size_t M, typename T >
-vector< M, T >
+VMMLIB_CONSTEXPR vector< M, T >
 vector< M, T >::operator+( const vector< M, T >& other ) const
 {
     vector< M, T > result;
     for( size_t index = 0; index < M; ++index )
-        result.at( index ) = at( index ) + other.at( index );
+        result.array[ index ] = array[ index ] + other.array[ index ];
     return result;
 }
 
 template< size_t M, typename T >
-vector< M, T >
+VMMLIB_CONSTEXPR vector< M, T >
 vector< M, T >::operator-( const vector< M, T >& other ) const
 {
     vector< M, T > result;
     for( size_t index = 0; index < M; ++index )
-        result.at( index ) = at( index ) - other.at( index );
+        result.array[ index ] = array[ index ] - other.array[ index ];
     return result;
 }
 
 template< size_t M, typename T >
-void
+VMMLIB_CONSTEXPR void
 vector< M, T >::operator*=( const vector< M, T >& other )
 {
     for( size_t index = 0; index < M; ++index )
-        at( index ) *= other.at( index );
+        array[ index ] *= other.array[ index ];
 }
 
 template< size_t M, typename T >
-void
+VMMLIB_CONSTEXPR void
 vector< M, T >::operator/=( const vector< M, T >& other )
 {
     for( size_t index = 0; index < M; ++index )
-        at( index ) /= other.at( index );
+        array[ index ] /= other.array[ index ];
 }
 
 template< size_t M, typename T >
-void
+VMMLIB_CONSTEXPR void
 vector< M, T >::operator+=( const vector< M, T >& other )
 {
     for( size_t index = 0; index < M; ++index )
-        at( index ) += other.at( index );
+        array[ index ] += other.array[ index ];
 }
 
 template< size_t M, typename T >
-void
+VMMLIB_CONSTEXPR void
 vector< M, T >::operator-=( const vector< M, T >& other )
 {
     for( size_t index = 0; index < M; ++index )
-        at( index ) -= other.at( index );
+        array[ index ] -= other.array[ index ];
 }
 
 template< size_t M, typename T >
-vector< M, T >
+VMMLIB_CONSTEXPR vector< M, T >
 vector< M, T >::operator*( const T other ) const
 {
     vector< M, T > result;
     for( size_t index = 0; index < M; ++index )
-        result.at( index ) = at( index ) * other;
+        result.array[ index ] = array[ index ] * other;
     return result;
 }
 
 template< size_t M, typename T >
-vector< M, T >
+VMMLIB_CONSTEXPR vector< M, T >
 vector< M, T >::operator/( const T other ) const
 {
     vector< M, T > result;
     for( size_t index = 0; index < M; ++index )
-        result.at( index ) = at( index ) / other;
+        result.array[ index ] = array[ index ] / other;
     return result;
 }
 
 template< size_t M, typename T >
-vector< M, T >
+VMMLIB_CONSTEXPR vector< M, T >
 vector< M, T >::operator+( const T other ) const
 {
     vector< M, T > result;
     for( size_t index = 0; index < M; ++index )
-        result.at( index ) = at( index ) + other;
+        result.array[ index ] = array[ index ] + other;
     return result;
 }
 
 template< size_t M, typename T >
-vector< M, T >
+VMMLIB_CONSTEXPR vector< M, T >
 vector< M, T >::operator-( const T other ) const
 {
     vector< M, T > result;
     for( size_t index = 0; index < M; ++index )
-        result.at( index ) = at( index ) - other;
+        result.array[ index ] = array[ index ] - other;
     return result;
 }
 
 template< size_t M, typename T >
-void
+VMMLIB_CONSTEXPR void
 vector< M, T >::operator*=( const T other )
 {
     for( size_t index = 0; index < M; ++index )
-        at( index ) *= other;
+        array[ index ] *= other;
 }
 
 template< size_t M, typename T >
-void
+VMMLIB_CONSTEXPR void
 vector< M, T >::operator/=( const T other )
 {
     for( size_t index = 0; index < M; ++index )
-        at( index ) /= other;
+        array[ index ] /= other;
 }
 
 template< size_t M, typename T >
-void
+VMMLIB_CONSTEXPR void
 vector< M, T >::operator+=( const T other )
 {
     for( size_t index = 0; index < M; ++index )
-        at( index ) += other;
+        array[ index ] += other;
 }
 
 template< size_t M, typename T >
-void
+VMMLIB_CONSTEXPR void
 vector< M, T >::operator-=( const T other )
 {
     for( size_t index = 0; index < M; ++index )
-        at( index ) -= other;
+        array[ index ] -= other;
 }
 
 template< size_t M, typename T >
-vector< M, T >
+VMMLIB_CONSTEXPR vector< M, T >
 vector< M, T >::operator-() const
 {
     vector< M, T > v( *this );
@@ -819,7 +859,7 @@ vector< M, T >::operator-() const
 }
 
 template< size_t M, typename T >
-const vector< M, T >&
+VMMLIB_CONSTEXPR const vector< M, T >&
 vector< M, T >::negate()
 {
     for( size_t index = 0; index < M; ++index )
@@ -828,136 +868,136 @@ vector< M, T >::negate()
 }
 
 template< size_t M, typename T >
-inline T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::x()
 {
     return array[ 0 ];
 }
 
 template< size_t M, typename T >
-inline T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::y()
 {
     return array[ 1 ];
 }
 
 template< size_t M, typename T >
-inline T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::z()
 {
     return array[ 2 ];
 }
 
 template< size_t M, typename T >
-inline T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::w()
 {
     return array[ 3 ];
 }
 
 template< size_t M, typename T >
-inline const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::x() const
 {
     return array[ 0 ];
 }
 
 template< size_t M, typename T >
-inline const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::y() const
 {
     return array[ 1 ];
 }
 
 template< size_t M, typename T >
-inline const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::z() const
 {
     return array[ 2 ];
 }
 
 template< size_t M, typename T >
-inline const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::w() const
 {
     return array[ 3 ];
 }
 
 template< size_t M, typename T >
-inline T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::r()
 {
     return array[ 0 ];
 }
 
 template< size_t M, typename T >
-inline T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::g()
 {
     return array[ 1 ];
 }
 
 template< size_t M, typename T >
-inline T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::b()
 {
     return array[ 2 ];
 }
 
 template< size_t M, typename T >
-inline T&
+VMMLIB_CONSTEXPR T&
 vector< M, T >::a()
 {
     return array[ 3 ];
 }
 
 template< size_t M, typename T >
-inline const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::r() const
 {
     return array[ 0 ];
 }
 
 template< size_t M, typename T >
-inline const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::g() const
 {
     return array[ 1 ];
 }
 
 template< size_t M, typename T >
-inline const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::b() const
 {
     return array[ 2 ];
 }
 
 template< size_t M, typename T >
-inline const T&
+VMMLIB_CONSTEXPR const T&
 vector< M, T >::a() const
 {
     return array[ 3 ];
 }
 
 template< size_t M, typename T > template< typename TT >
-vector< M, T >& vector< M, T >::cross( const vector< M, TT >& rhs,
-                                       typename enable_if< M == 3, TT >::type* )
-{
-    const T x_ = y() * rhs.z() - z() * rhs.y();
-    const T y_ = z() * rhs.x() - x() * rhs.z();
-    const T z_ = x() * rhs.y() - y() * rhs.x();
-    x() = x_;
-    y() = y_;
-    z() = z_;
+VMMLIB_CONSTEXPR vector< M, T >& vector< M, T >::cross(
+    const vector< M, TT >& rhs, typename enable_if< M == 3, TT >::type* )
+{
+    const T x_ = array[ 1 ] * rhs.array[ 2 ] - array[ 2 ] * rhs.array[ 1 ];
+    const T y_ = array[ 2 ] * rhs.array[ 0 ] - array[ 0 ] * rhs.array[ 2 ];
+    const T z_ = array[ 0 ] * rhs.array[ 1 ] - array[ 1 ] * rhs.array[ 0 ];
+    array[ 0 ] = x_;
+    array[ 1 ] = y_;
+    array[ 2 ] = z_;
     return *this;
 }
 
 template< size_t M, typename T >
-inline T vector< M, T >::dot( const vector< M, T >& other ) const
+VMMLIB_CONSTEXPR T vector< M, T >::dot( const vector< M, T >& other ) const
 {
     T tmp = 0.0;
     for( size_t index = 0; index < M; ++index )
-        tmp += at( index ) * other.at( index );
+        tmp += array[ index ] * other.array[ index ];
 
     return tmp;
 }
@@ -980,11 +1020,11 @@ inline T vector< M, T >::length() const
 }
 
 template< size_t M, typename T >
-inline T vector< M, T >::squared_length() const
+VMMLIB_CONSTEXPR T vector< M, T >::squared_length() const
 {
     T _squared_length = 0.0;
-    for( const_iterator it = begin(), it_end = end(); it != it_end; ++it )
-        _squared_length += (*it) * (*it);
+    for( size_t i = 0; i < M; ++i )
+        _squared_length += array[ i ] * array[ i ];
 
     return _squared_length;
 }
@@ -997,18 +1037,20 @@ vector< M, T >::distance( const vector< M, T >& other ) const
 }
 
 template< size_t M, typename T >
-inline T vector< M, T >::squared_distance( const vector< M, T >& other ) const
+VMMLIB_CONSTEXPR T vector< M, T >::squared_distance(
+    const vector< M, T >& other ) const
 {
     vector< M, T > tmp( *this );
     tmp -= other;
     return tmp.squared_length();
 }
 
-template< size_t M, typename T > inline T vector< M, T >::product() const
+template< size_t M, typename T >
+VMMLIB_CONSTEXPR T vector< M, T >::product() const
 {
-    T result = at( 0 );
+    T result = array[ 0 ];
     for( size_t i = 1; i < M; ++i )
-        result *= at( i );
+        result *= array[ i ];
     return result;
 }
 
@@ -1059,17 +1101,18 @@ vector< M, T >::distance_to_sphere( const vector< 3, TT >& point,
 }
 
 template< size_t M, typename T > template< size_t N, size_t O >
-vector< N, T > vector< M, T >::get_sub_vector(
+VMMLIB_CONSTEXPR vector< N, T > vector< M, T >::get_sub_vector(
     typename enable_if< M >= N+O >::type* ) const
 {
     return vector< N, T >( array + O );
 }
 
 template< size_t M, typename T > template< size_t N, size_t O >
-void vector< M, T >::set_sub_vector( const vector< N, T >& sub,
-                                     typename enable_if< M >= N+O >::type* )
+VMMLIB_CONSTEXPR void vector< M, T >::set_sub_vector(
+    const vector< N, T >& sub, typename enable_if< M >= N+O >::type* )
 {
-    ::memcpy( array + O, sub.array, N * sizeof( T ));
+    for( size_t i = 0; i < N; ++i )
+        array[ O + i ] = sub.array[ i ];
 }
 
 // plane: normal xyz, distance w
@@ -1091,13 +1134,18 @@ vector< M, T >::project_point_onto_plane( const vector< 3, TT >& point,
 }
 
 template< size_t M, typename T >
-bool vector< M, T >::operator==( const vector< M, T >& other ) const
+VMMLIB_CONSTEXPR bool vector< M, T >::operator==( const vector< M, T >& other )
+    const
 {
-    return memcmp( array, other.array, sizeof( array )) == 0;
+    for( size_t index = 0; index < M; ++index )
+        if( array[ index ] != other.array[ index ] )
+            return false;
+    return true;
 }
 
 template< size_t M, typename T >
-bool vector< M, T >::operator!=( const vector< M, T >& other ) const
+VMMLIB_CONSTEXPR bool vector< M, T >::operator!=( const vector< M, T >& other )
+    const
 {
     return ! this->operator==( other );
 }
@@ -1106,20 +1154,20 @@ template< size_t M, typename T >
 bool vector< M, T >::equals( const vector< M, T >& other, T tolerance ) const
 {
     for( size_t index = 0; index < M; ++index )
-        if( fabs( at( index ) - other( index ) ) >= tolerance )
+        if( fabs( array[ index ] - other.array[ index ] ) >= tolerance )
             return false;
     return true;
 
 }
 
 template< size_t M, typename T >
-bool
+VMMLIB_CONSTEXPR bool
 vector< M, T >::operator<( const vector< M, T >& other ) const
 {
     for(size_t index = 0; index < M; ++index )
     {
-        if (at( index ) < other.at( index )) return true;
-        if (other.at( index ) < at( index )) return false;
+        if (array[ index ] < other.array[ index ]) return true;
+        if (other.array[ index ] < array[ index ]) return false;
     }
     return false;
 }
@@ -1127,63 +1175,64 @@ vector< M, T >::operator<( const vector< M, T >& other ) const
 // to-homogenous-coordinates assignment operator
 // non-chainable because of sfinae
 template< size_t M, typename T > template< size_t N >
-typename enable_if< N == M - 1 >::type*
+VMMLIB_CONSTEXPR typename enable_if< N == M - 1 >::type*
 vector< M, T >::operator=( const vector< N, T >& source_ )
 {
-    std::copy( source_.begin(), source_.end(), begin() );
-    at( M - 1 ) = static_cast< T >( 1.0 );
+    for( size_t index = 0; index < N; ++index )
+        array[ index ] = source_.array[ index ];
+    array[ M - 1 ] = static_cast< T >( 1.0 );
     return 0;
 }
 
 // from-homogenous-coordinates assignment operator
 // non-chainable because of sfinae
 template< size_t M, typename T > template< size_t N >
-typename enable_if< N == M + 1 >::type*
+VMMLIB_CONSTEXPR typename enable_if< N == M + 1 >::type*
 vector< M, T >::operator=( const vector< N, T >& source_ )
 {
-    const T w_reci = static_cast< T >( 1.0 ) / source_( M );
-    iterator it = begin(), it_end = end();
-    for( size_t index = 0; it != it_end; ++it, ++index )
-        *it = source_( index ) * w_reci;
+    const T w_reci = static_cast< T >( 1.0 ) / source_.array[ M ];
+    for( size_t index = 0; index < M; ++index )
+        array[ index ] = source_.array[ index ] * w_reci;
     return 0;
 }
 
 template< size_t M, typename T >
-vector< M, T >& vector< M, T >::operator=( const T* c_array )
+VMMLIB_CONSTEXPR vector< M, T >& vector< M, T >::operator=( const T* c_array )
 {
     iter_set( c_array, c_array + M );
     return *this;
 }
 
 template< size_t M, typename T >
-T vector< M, T >::operator=( T filler_value )
+VMMLIB_CONSTEXPR T vector< M, T >::operator=( T filler_value )
 {
     for( size_t index = 0; index < M; ++index )
-        at( index ) = filler_value;
+        array[ index ] = filler_value;
     return filler_value;
 }
 
-template< size_t M, typename T >
-vector< M, T >& vector< M, T >::operator=( const vector< M, T >& other )
+// returns void to avoid 'silent' loss of precision when chaining
+template< size_t M, typename T > template< typename U >
+VMMLIB_CONSTEXPR void vector< M, T >::operator=( const vector< M, U >& source_ )
 {
-    if( this != &other )
-        memcpy( array, other.array, M * sizeof( T ) );
-    return *this;
+    for( size_t index = 0; index < M; ++index )
+        array[ index ] = static_cast< T >( source_.array[ index ] );
 }
 
-// returns void to avoid 'silent' loss of precision when chaining
-template< size_t M, typename T > template< typename U >
-void vector< M, T >::operator=( const vector< M, U >& source_ )
+template< size_t M, typename T > template< class E >
+typename enable_if< is_same< typename E::result_type, vector< M, T > >::value,
+                    vector< M, T >& >::type
+vector< M, T >::operator=( const Expression< E >& expression )
 {
-    typedef typename vector< M, U >::const_iterator u_c_iter;
-    u_c_iter it = source_.begin(), it_end = source_.end();
-    for( iterator my_it = begin(); it != it_end; ++it, ++my_it )
-        *my_it = static_cast< T >( *it );
+    const E& elements = expression.get();
+    for( size_t i = 0; i < M; ++i )
+        array[ i ] = elements[ i ];
+    return *this;
 }
 
 template< size_t M, typename T >
 template< typename input_iterator_t >
-void
+VMMLIB_CONSTEXPR void
 vector< M, T >::iter_set( input_iterator_t begin_, input_iterator_t end_ )
 {
     input_iterator_t in_it = begin_;
@@ -1205,7 +1254,7 @@ void vector< M, T >::clamp( const T& min, const T& max )
 }
 
 template< size_t M, typename T >
-inline size_t
+VMMLIB_CONSTEXPR size_t
 vector< M, T >::size()
 {
     return M;
@@ -1254,28 +1303,28 @@ vector< M, T >::find_max() const
 }
 
 template< size_t M, typename T >
-inline typename vector< M, T >::iterator
+VMMLIB_CONSTEXPR typename vector< M, T >::iterator
 vector< M, T >::begin()
 {
     return array;
 }
 
 template< size_t M, typename T >
-inline typename vector< M, T >::iterator
+VMMLIB_CONSTEXPR typename vector< M, T >::iterator
 vector< M, T >::end()
 {
     return array + M; ;
 }
 
 template< size_t M, typename T >
-inline typename vector< M, T >::const_iterator
+VMMLIB_CONSTEXPR typename vector< M, T >::const_iterator
 vector< M, T >::begin() const
 {
     return array;
 }
 
 template< size_t M, typename T >
-inline typename vector< M, T >::const_iterator
+VMMLIB_CONSTEXPR typename vector< M, T >::const_iterator
 vector< M, T >::end() const
 {
     return array + M; ;
@@ -1430,7 +1479,7 @@ vector< M, T >::set_random( int seed )
     for( size_t i = 0; i < M; ++i )
     {
         const double fillValue = double( rand( )) / double( RAND_MAX );
-        at( i ) = -1.0 + 2.0 * fillValue;
+        array[ i ] = -1.0 + 2.0 * fillValue;
     }
 }
 